@@ -0,0 +1,568 @@
+/**
+   @file
+   @brief throughput benchmark of conservation tracking on synthetic traxel stores
+
+   Generates a synthetic TraxelStore (random walks with divisions and
+   mergers), runs the full tracking pipeline with every available solver and
+   reports the per-stage measurements collected by pgmlink::Instrumentation
+   as JSON, so results of different builds can be compared automatically.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/python.hpp>
+
+#include "pgmlink/field_of_view.h"
+#include "pgmlink/instrumentation.h"
+#include "pgmlink/log.h"
+#include "pgmlink/tracking.h"
+#include "pgmlink/traxels.h"
+
+using namespace pgmlink;
+
+namespace
+{
+
+struct WorkloadConfig
+{
+    WorkloadConfig()
+        : frames(10),
+          objects(20),
+          division_rate(0.02),
+          merger_rate(0.02),
+          ndim(2),
+          seed(42)
+    {}
+
+    size_t frames;
+    size_t objects;         ///< objects in the first frame
+    double division_rate;   ///< probability that an object divides between two frames
+    double merger_rate;     ///< probability that an object merges with its neighbor in a frame
+    int ndim;
+    unsigned int seed;
+};
+
+struct BenchmarkConfig
+{
+    BenchmarkConfig()
+        : repetitions(3),
+          with_tracklets(true),
+          output("-")
+    {}
+
+    WorkloadConfig workload;
+    size_t repetitions;
+    bool with_tracklets;
+    std::vector<std::string> solvers;
+    std::string output;
+};
+
+struct SyntheticWorkload
+{
+    SyntheticWorkload()
+        : fs(boost::make_shared<FeatureStore>()), extent(0.), num_traxels(0), num_mergers(0), num_divisions(0)
+    {}
+
+    TraxelStore ts;
+    boost::shared_ptr<FeatureStore> fs;
+    double extent;
+    size_t num_traxels;
+    size_t num_mergers;
+    size_t num_divisions;
+};
+
+struct Object
+{
+    std::vector<double> position;
+    bool divides;
+};
+
+// square (2D) or cubic (3D) blob of pixels around the center, stored as x,y,z triples
+feature_array blob_coordinates(const std::vector<double>& center, int ndim)
+{
+    feature_array coordinates;
+    const int radius = 1;
+    for(int dx = -radius; dx <= radius; ++dx)
+    {
+        for(int dy = -radius; dy <= radius; ++dy)
+        {
+            for(int dz = (ndim == 3 ? -radius : 0); dz <= (ndim == 3 ? radius : 0); ++dz)
+            {
+                coordinates.push_back(std::floor(center[0]) + dx);
+                coordinates.push_back(std::floor(center[1]) + dy);
+                coordinates.push_back(std::floor(center[2]) + dz);
+            }
+        }
+    }
+    return coordinates;
+}
+
+void add_traxel(SyntheticWorkload& workload,
+                unsigned int id,
+                int timestep,
+                const std::vector<const Object*>& objects,
+                int ndim)
+{
+    Traxel trax;
+    trax.Id = id;
+    trax.Timestep = timestep;
+
+    feature_array com(3, 0.);
+    feature_array coordinates;
+    bool divides = false;
+    for(std::vector<const Object*>::const_iterator it = objects.begin(); it != objects.end(); ++it)
+    {
+        for(size_t d = 0; d < 3; ++d)
+        {
+            com[d] += (*it)->position[d] / objects.size();
+        }
+        feature_array blob = blob_coordinates((*it)->position, ndim);
+        coordinates.insert(coordinates.end(), blob.begin(), blob.end());
+        divides = divides || (*it)->divides;
+    }
+
+    // detection probabilities for 0, 1 and 2 objects
+    feature_array detProb(3, 0.05);
+    detProb[objects.size()] = 0.9;
+    feature_array divProb(1, divides ? 0.9 : 0.05);
+    feature_array count(1, static_cast<feature_type>(coordinates.size() / 3));
+
+    trax.features["com"] = com;
+    trax.features["detProb"] = detProb;
+    trax.features["divProb"] = divProb;
+    trax.features["count"] = count;
+    trax.features["coordinates"] = coordinates;
+    add(workload.ts, workload.fs, trax);
+    ++workload.num_traxels;
+}
+
+/**
+ * Objects perform a random walk in a box whose size grows with the number of
+ * objects, so that the density and hence the number of transition
+ * hypotheses per object does not depend on the workload size.
+ */
+SyntheticWorkload generate_workload(const WorkloadConfig& config)
+{
+    if(config.ndim != 2 && config.ndim != 3)
+    {
+        throw std::runtime_error("generate_workload(): ndim must be 2 or 3");
+    }
+
+    SyntheticWorkload workload;
+    std::mt19937 rng(config.seed);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::normal_distribution<double> step(0., 1.);
+
+    const double spacing = 10.;
+    workload.extent = spacing * std::ceil(std::pow(static_cast<double>(std::max<size_t>(config.objects, 1)),
+                                                   1. / config.ndim));
+
+    std::vector<Object> objects(config.objects);
+    for(std::vector<Object>::iterator it = objects.begin(); it != objects.end(); ++it)
+    {
+        it->position.assign(3, 0.);
+        for(int d = 0; d < config.ndim; ++d)
+        {
+            it->position[d] = uniform(rng) * workload.extent;
+        }
+        it->divides = false;
+    }
+
+    for(size_t t = 0; t < config.frames; ++t)
+    {
+        for(std::vector<Object>::iterator it = objects.begin(); it != objects.end(); ++it)
+        {
+            it->divides = (t + 1 < config.frames) && uniform(rng) < config.division_rate;
+        }
+
+        // objects merge with the next one in the list, the merger is moved to its mean position
+        unsigned int id = 1;
+        for(size_t i = 0; i < objects.size(); ++i)
+        {
+            std::vector<const Object*> detection(1, &objects[i]);
+            if(i + 1 < objects.size() && uniform(rng) < config.merger_rate)
+            {
+                ++i;
+                detection.push_back(&objects[i]);
+                for(int d = 0; d < config.ndim; ++d)
+                {
+                    const double mean = 0.5 * (detection[0]->position[d] + detection[1]->position[d]);
+                    objects[i - 1].position[d] = mean - 0.5;
+                    objects[i].position[d] = mean + 0.5;
+                }
+                ++workload.num_mergers;
+            }
+            add_traxel(workload, id++, static_cast<int>(t), detection, config.ndim);
+        }
+
+        // move and divide
+        std::vector<Object> next;
+        next.reserve(objects.size());
+        for(std::vector<Object>::iterator it = objects.begin(); it != objects.end(); ++it)
+        {
+            Object child = *it;
+            child.divides = false;
+            for(int d = 0; d < config.ndim; ++d)
+            {
+                child.position[d] = std::min(std::max(child.position[d] + step(rng), 0.), workload.extent);
+            }
+            next.push_back(child);
+            if(it->divides)
+            {
+                for(int d = 0; d < config.ndim; ++d)
+                {
+                    child.position[d] = std::min(child.position[d] + 3., workload.extent);
+                }
+                next.push_back(child);
+                ++workload.num_divisions;
+            }
+        }
+        objects.swap(next);
+    }
+    return workload;
+}
+
+std::vector<std::string> available_solvers()
+{
+    std::vector<std::string> solvers;
+#ifndef NO_ILP
+    solvers.push_back("cplex");
+#endif
+#ifdef WITH_DPCT
+    solvers.push_back("dynprog");
+    solvers.push_back("flow");
+#endif
+    return solvers;
+}
+
+SolverType solver_type(const std::string& name)
+{
+    if(name == "cplex")
+    {
+        return SolverType::CplexSolver;
+    }
+    else if(name == "dynprog")
+    {
+        return SolverType::DynProgSolver;
+    }
+    else if(name == "flow")
+    {
+        return SolverType::FlowSolver;
+    }
+    throw std::runtime_error("unknown solver " + name);
+}
+
+struct Summary
+{
+    Summary()
+        : min(std::numeric_limits<double>::max()), max(std::numeric_limits<double>::lowest()), sum(0.), n(0)
+    {}
+
+    void add(double value)
+    {
+        min = std::min(min, value);
+        max = std::max(max, value);
+        sum += value;
+        ++n;
+    }
+
+    double min, max, sum;
+    size_t n;
+};
+
+std::ostream& operator<<(std::ostream& out, const Summary& s)
+{
+    return out << "{\"min\": " << (s.n ? s.min : 0.)
+           << ", \"mean\": " << (s.n ? s.sum / s.n : 0.)
+           << ", \"max\": " << (s.n ? s.max : 0.) << "}";
+}
+
+struct StageSummary
+{
+    StageSummary()
+        : calls(0), process_peak_rss_kb(0)
+    {}
+
+    std::string name;
+    size_t calls;
+    Summary seconds;
+    /// high water mark of the whole process when the stage finished, not of the stage alone
+    long process_peak_rss_kb;
+    /// change of heap memory in use over the calls of the stage
+    Summary heap_delta_kb;
+    std::map<std::string, size_t> counters;
+};
+
+/// run the full pipeline (graph, inference, merger resolution, events) and write one JSON result object
+void run_solver(const std::string& solver,
+                const BenchmarkConfig& config,
+                SyntheticWorkload& workload,
+                std::ostream& json)
+{
+    const WorkloadConfig& wl = config.workload;
+    const bool with_mergers = wl.merger_rate > 0.;
+    FieldOfView fov(0, 0, 0, 0, wl.frames, workload.extent, workload.extent, wl.ndim == 3 ? workload.extent : 0);
+
+    Summary total;
+    std::vector<StageSummary> stages;
+    std::map<std::string, size_t> stage_index;
+    size_t num_events = 0;
+    std::string error;
+
+    for(size_t rep = 0; rep < config.repetitions && error.empty(); ++rep)
+    {
+        ConsTracking tracking(with_mergers ? 2 : 1, // max_number_objects
+                              false, // size_dependent_detection_prob
+                              9., // avg_obj_size
+                              15., // max_neighbor_distance
+                              wl.division_rate > 0., // with_divisions
+                              0.3, // division_threshold
+                              "none", // random_forest_filename
+                              fov,
+                              "none", // event_vector_dump_filename
+                              solver_type(solver),
+                              wl.ndim);
+        Parameter param;
+        Instrumentation& instrumentation = Instrumentation::instance();
+        instrumentation.reset();
+        instrumentation.enable(true);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        try
+        {
+            EventVectorVectorVector events = tracking(workload.ts,
+                                                      param,
+                                                      0, // forbidden_cost
+                                                      0.0, // ep_gap
+                                                      config.with_tracklets,
+                                                      10.0, // division_weight
+                                                      10.0, // transition_weight
+                                                      500., // disappearance_cost
+                                                      500., // appearance_cost
+                                                      with_mergers, // with_merger_resolution
+                                                      wl.ndim);
+            num_events = 0;
+            for(size_t t = 0; t < events[0].size(); ++t)
+            {
+                num_events += events[0][t].size();
+            }
+        }
+        catch(std::exception& e)
+        {
+            error = e.what();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        instrumentation.enable(false);
+        total.add(elapsed.count());
+
+        std::vector<StageStatistics> measured = instrumentation.stages();
+        for(std::vector<StageStatistics>::const_iterator it = measured.begin(); it != measured.end(); ++it)
+        {
+            if(stage_index.find(it->name) == stage_index.end())
+            {
+                stage_index[it->name] = stages.size();
+                stages.push_back(StageSummary());
+                stages.back().name = it->name;
+            }
+            StageSummary& s = stages[stage_index[it->name]];
+            s.calls = it->calls;
+            s.seconds.add(it->wall_seconds);
+            s.process_peak_rss_kb = std::max(s.process_peak_rss_kb, it->peak_rss_kb);
+            s.heap_delta_kb.add(it->heap_delta_kb);
+            s.counters = it->counters;
+        }
+
+        std::cerr << solver << " repetition " << rep + 1 << "/" << config.repetitions
+                  << ": " << elapsed.count() << " s" << (error.empty() ? "" : " (failed: " + error + ")") << std::endl;
+    }
+
+    json << "{\"solver\": \"" << Instrumentation::json_escape(solver) << "\""
+         << ", \"repetitions\": " << total.n
+         << ", \"total_seconds\": " << total
+         << ", \"num_events\": " << num_events
+         << ", \"process_peak_rss_kb\": " << Instrumentation::peak_rss_kb();
+    if(!error.empty())
+    {
+        json << ", \"error\": \"" << Instrumentation::json_escape(error) << "\"";
+    }
+    json << ", \"stages\": [";
+    for(size_t i = 0; i < stages.size(); ++i)
+    {
+        const StageSummary& s = stages[i];
+        json << (i == 0 ? "" : ", ")
+             << "{\"name\": \"" << Instrumentation::json_escape(s.name) << "\""
+             << ", \"calls\": " << s.calls
+             << ", \"seconds\": " << s.seconds
+             << ", \"process_peak_rss_kb\": " << s.process_peak_rss_kb
+             << ", \"heap_delta_kb\": " << s.heap_delta_kb
+             << ", \"counters\": {";
+        for(std::map<std::string, size_t>::const_iterator it = s.counters.begin(); it != s.counters.end(); ++it)
+        {
+            json << (it == s.counters.begin() ? "" : ", ")
+                 << "\"" << Instrumentation::json_escape(it->first) << "\": " << it->second;
+        }
+        json << "}}";
+    }
+    json << "]}";
+}
+
+void print_usage(const char* name)
+{
+    std::cout << "Benchmark of conservation tracking on synthetic data.\n\n"
+              << "USAGE: " << name << " [options]\n"
+              << "  --frames N           number of frames (default 10)\n"
+              << "  --objects N          objects in the first frame (default 20)\n"
+              << "  --division-rate P    division probability per object and frame (default 0.02)\n"
+              << "  --merger-rate P      merger probability per object and frame (default 0.02)\n"
+              << "  --ndim 2|3           spatial dimensions (default 2)\n"
+              << "  --seed N             random seed (default 42)\n"
+              << "  --repetitions N      runs per solver (default 3)\n"
+              << "  --no-tracklets       build the model on the traxel graph\n"
+              << "  --solver NAME        cplex, dynprog or flow, may be repeated (default: all available)\n"
+              << "  --output FILE        JSON output, '-' for stdout (default)\n";
+}
+
+BenchmarkConfig parse_arguments(int argc, char** argv)
+{
+    BenchmarkConfig config;
+    for(int i = 1; i < argc; ++i)
+    {
+        const std::string option(argv[i]);
+        if(option == "--no-tracklets")
+        {
+            config.with_tracklets = false;
+            continue;
+        }
+        if(i + 1 >= argc)
+        {
+            throw std::runtime_error("missing value for option " + option);
+        }
+        const std::string value(argv[++i]);
+        if(option == "--frames")
+        {
+            config.workload.frames = std::strtoul(value.c_str(), NULL, 10);
+        }
+        else if(option == "--objects")
+        {
+            config.workload.objects = std::strtoul(value.c_str(), NULL, 10);
+        }
+        else if(option == "--division-rate")
+        {
+            config.workload.division_rate = std::atof(value.c_str());
+        }
+        else if(option == "--merger-rate")
+        {
+            config.workload.merger_rate = std::atof(value.c_str());
+        }
+        else if(option == "--ndim")
+        {
+            config.workload.ndim = std::atoi(value.c_str());
+        }
+        else if(option == "--seed")
+        {
+            config.workload.seed = std::strtoul(value.c_str(), NULL, 10);
+        }
+        else if(option == "--repetitions")
+        {
+            config.repetitions = std::strtoul(value.c_str(), NULL, 10);
+        }
+        else if(option == "--solver")
+        {
+            config.solvers.push_back(value);
+        }
+        else if(option == "--output")
+        {
+            config.output = value;
+        }
+        else
+        {
+            throw std::runtime_error("unknown option " + option);
+        }
+    }
+    if(config.solvers.empty())
+    {
+        config.solvers = available_solvers();
+    }
+    return config;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    if(argc > 1 && (std::string(argv[1]) == "-h" || std::string(argv[1]) == "--help"))
+    {
+        print_usage(argv[0]);
+        return 0;
+    }
+
+    try
+    {
+        BenchmarkConfig config = parse_arguments(argc, argv);
+        if(config.solvers.empty())
+        {
+            throw std::runtime_error("pgmlink was built without any tracking solver");
+        }
+        FILELog::getReportingLevel() = logWARNING;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        SyntheticWorkload workload = generate_workload(config.workload);
+        std::chrono::duration<double> generation = std::chrono::steady_clock::now() - start;
+
+        const WorkloadConfig& wl = config.workload;
+        std::ostringstream json;
+        json.precision(9);
+        json << "{\"workload\": {"
+             << "\"frames\": " << wl.frames
+             << ", \"objects\": " << wl.objects
+             << ", \"division_rate\": " << wl.division_rate
+             << ", \"merger_rate\": " << wl.merger_rate
+             << ", \"ndim\": " << wl.ndim
+             << ", \"seed\": " << wl.seed
+             << ", \"with_tracklets\": " << (config.with_tracklets ? "true" : "false")
+             << ", \"traxels\": " << workload.num_traxels
+             << ", \"divisions\": " << workload.num_divisions
+             << ", \"mergers\": " << workload.num_mergers
+             << ", \"generation_seconds\": " << generation.count()
+             << "}, \"results\": [";
+        for(size_t i = 0; i < config.solvers.size(); ++i)
+        {
+            json << (i == 0 ? "" : ", ");
+            run_solver(config.solvers[i], config, workload, json);
+        }
+        json << "]}";
+
+        if(config.output == "-")
+        {
+            std::cout << json.str() << std::endl;
+        }
+        else
+        {
+            std::ofstream out(config.output.c_str());
+            if(!out)
+            {
+                throw std::runtime_error("could not open " + config.output);
+            }
+            out << json.str() << std::endl;
+        }
+    }
+    catch(std::exception& e)
+    {
+        std::cerr << "tracking_benchmark: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
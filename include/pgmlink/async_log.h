@@ -0,0 +1,66 @@
+/**
+   @file
+   @ingroup util
+   @brief asynchronous backend for the LOG macro
+*/
+
+#ifndef PGMLINK_ASYNC_LOG_H
+#define PGMLINK_ASYNC_LOG_H
+
+#include <string>
+#include <ostream>
+
+#include "pgmlink_export.h"
+
+namespace pgmlink
+{
+
+struct AsyncLogOptions
+{
+    AsyncLogOptions()
+        : buffer_capacity(4096), flush_interval_ms(50), binary(false)
+    {}
+
+    /// number of messages a thread can queue before it has to wait for the writer
+    size_t buffer_capacity;
+    /// the writer drains the queues and flushes at least this often
+    unsigned int flush_interval_ms;
+    /// write binary records (microseconds since epoch, length, message) instead of text lines
+    bool binary;
+    /// output file, the redirect of Output2FILE (stderr) if empty
+    std::string filename;
+};
+
+/**
+ * @brief Asynchronous, buffered logging.
+ *
+ * While running, LOG(...) only formats the message and appends it to a
+ * ring buffer of the calling thread; no timestamp formatting, no I/O and no
+ * lock shared with other threads. A background thread drains all buffers,
+ * orders the messages by time of logging and writes them in batches with
+ * one flush per batch.
+ *
+ * @code
+ * AsyncLog::start();
+ * tracker(...);          // LOG(...) as usual
+ * AsyncLog::stop();      // writes everything that is still queued
+ * @endcode
+ *
+ * Binary logs can be turned into the text format with convert_binary().
+ */
+class AsyncLog
+{
+public:
+    PGMLINK_EXPORT static void start(const AsyncLogOptions& options = AsyncLogOptions());
+    /// drain all buffers and return to synchronous logging
+    PGMLINK_EXPORT static void stop();
+    PGMLINK_EXPORT static bool running();
+    /// block until all messages logged before the call are written
+    PGMLINK_EXPORT static void flush();
+
+    PGMLINK_EXPORT static void convert_binary(const std::string& binary_filename, std::ostream& out);
+};
+
+} /* namespace pgmlink */
+
+#endif /* PGMLINK_ASYNC_LOG_H */
@@ -0,0 +1,73 @@
+/**
+   @file
+   @ingroup tracking
+   @brief spatial-temporal index over the bounding boxes of hypotheses graph traxels
+*/
+
+#ifndef BOUNDING_BOX_INDEX_H
+#define BOUNDING_BOX_INDEX_H
+
+#include <map>
+#include <vector>
+
+#include "pgmlink_export.h"
+#include "pgmlink/hypotheses.h"
+#include "pgmlink/field_of_view.h"
+
+namespace pgmlink
+{
+
+/**
+ * Index of the traxel bounding boxes (CoordMinimum/CoordMaximum) of a hypotheses graph.
+ *
+ * The boxes are read once on construction and kept per timestep, sorted by their
+ * lower x coordinate. A query with a field of view then only visits the timesteps
+ * of the field of view and, within each of them, the boxes whose x interval can
+ * overlap. Used to select the nodes of many crops without rescanning the graph.
+ */
+class BoundingBoxIndex
+{
+public:
+    typedef HypothesesGraph::Node Node;
+
+    /// ndim is 2 or 3, in 2d the z coordinate is ignored
+    PGMLINK_EXPORT BoundingBoxIndex(const HypothesesGraph& graph, unsigned int ndim);
+
+    /**
+     * Nodes within the time range of fov whose bounding box intersects the spatial
+     * extent of fov, in increasing timestep order.
+     */
+    PGMLINK_EXPORT std::vector<Node> query(const FieldOfView& fov) const;
+
+    PGMLINK_EXPORT size_t size() const;
+
+private:
+    struct Entry
+    {
+        double lower[3];
+        double upper[3];
+        Node node;
+
+        bool operator<(const Entry& other) const
+        {
+            return lower[0] < other.lower[0];
+        }
+    };
+
+    struct Timestep
+    {
+        Timestep() : max_x_extent(0.) {}
+        std::vector<Entry> entries;
+        // largest x extent of a box in this timestep, bounds the backwards search
+        double max_x_extent;
+    };
+
+    bool intersects(const Entry& entry, const FieldOfView& fov) const;
+
+    unsigned int ndim_;
+    std::map<int, Timestep> timesteps_;
+};
+
+} /* namespace pgmlink */
+
+#endif /* BOUNDING_BOX_INDEX_H */
@@ -14,6 +14,7 @@
 
 // pgmlink
 #include "pgmlink/features/feature.h"
+#include "pgmlink/features/feature_extraction.h"
 #include "pgmlink/traxels.h"
 #include "pgmlink_export.h"
 
@@ -313,10 +314,28 @@ public:
     virtual feature_array extract(const Traxel& t1) const;
     virtual feature_array extract(const Traxel& t1, const Traxel& t2) const;
     virtual feature_array extract(const Traxel& t1, const Traxel& t2, const Traxel& t3) const;
+    /// batch versions: row i of result holds extract() of t1[i], t2[i] (and t3[i]).
+    /// Calculators with a batch counterpart in feature_extraction go through
+    /// feature_extraction::FeatureExtractor, all others are extracted row by row.
+    virtual void extract(const feature_extraction::ConstTraxelRefVector& t1,
+                         const feature_extraction::ConstTraxelRefVector& t2,
+                         feature_extraction::feature_matrix& result) const;
+    virtual void extract(const feature_extraction::ConstTraxelRefVector& t1,
+                         const feature_extraction::ConstTraxelRefVector& t2,
+                         const feature_extraction::ConstTraxelRefVector& t3,
+                         feature_extraction::feature_matrix& result) const;
     boost::shared_ptr<FeatureCalculator> calculator() const;
     virtual std::string name() const;
 
 protected:
+    void extract_rows(const feature_extraction::ConstTraxelRefVector& t1,
+                      const feature_extraction::ConstTraxelRefVector& t2,
+                      feature_extraction::feature_matrix& result) const;
+    void extract_rows(const feature_extraction::ConstTraxelRefVector& t1,
+                      const feature_extraction::ConstTraxelRefVector& t2,
+                      const feature_extraction::ConstTraxelRefVector& t3,
+                      feature_extraction::feature_matrix& result) const;
+
     boost::shared_ptr<FeatureCalculator> calculator_;
     std::string feature_name_;
 };
@@ -328,6 +347,9 @@ public:
     FeatureExtractorSelective(boost::shared_ptr<FeatureCalculator> calculator, const std::string& feature_name);
     virtual ~FeatureExtractorSelective();
     virtual feature_array extract(const Traxel& t1, const Traxel& t2) const;
+    virtual void extract(const feature_extraction::ConstTraxelRefVector& t1,
+                         const feature_extraction::ConstTraxelRefVector& t2,
+                         feature_extraction::feature_matrix& result) const;
     virtual std::string name() const;
 };
 
@@ -380,6 +402,18 @@ public:
                           const Traxel& trax_in_second,
                           std::map<std::pair<unsigned, unsigned>, feature_array >& feature_map,
                           bool with_predict = true) = 0;
+    /// batch versions for all transitions (divisions) of a timestep: entry i of
+    /// probabilities belongs to traxs_out[i] and traxs_in[i] (and traxs_in_second[i]).
+    /// The default implementations call the single versions above.
+    virtual void classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                          const feature_extraction::ConstTraxelRefVector& traxs_in,
+                          std::vector<feature_array>& probabilities,
+                          bool with_predict = true);
+    virtual void classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                          const feature_extraction::ConstTraxelRefVector& traxs_in_first,
+                          const feature_extraction::ConstTraxelRefVector& traxs_in_second,
+                          std::vector<feature_array>& probabilities,
+                          bool with_predict = true);
 protected:
     std::string name_;
 };
@@ -473,6 +507,17 @@ protected:
                                   const Traxel& child2,
                                   vigra::MultiArrayView<2, feature_type>,
                                   vigra::MultiArrayView<2, feature_type>);
+    // one row of features per traxel pair (triplet)
+    virtual void extract_features(const feature_extraction::ConstTraxelRefVector& t1,
+                                  const feature_extraction::ConstTraxelRefVector& t2,
+                                  feature_extraction::feature_matrix& features);
+    virtual void extract_features(const feature_extraction::ConstTraxelRefVector& parents,
+                                  const feature_extraction::ConstTraxelRefVector& children1,
+                                  const feature_extraction::ConstTraxelRefVector& children2,
+                                  feature_extraction::feature_matrix& features);
+    // one random forest prediction for all rows of features
+    void predict(const feature_extraction::feature_matrix& features,
+                 std::vector<feature_array>& probabilities) const;
 
     vigra::RandomForest<> rf_;
     const std::vector<boost::shared_ptr<FeatureExtractor> > feature_extractors_;
@@ -495,6 +540,10 @@ public:
                           const Traxel& trax_in,
                           std::map<unsigned, feature_array >& feature_map,
                           bool with_predict);
+    virtual void classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                          const feature_extraction::ConstTraxelRefVector& traxs_in,
+                          std::vector<feature_array>& probabilities,
+                          bool with_predict);
 
 };
 
@@ -515,6 +564,11 @@ public:
                           const Traxel& trax_in_second,
                           std::map<std::pair<unsigned, unsigned>, feature_array >& feature_map,
                           bool with_predict);
+    virtual void classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                          const feature_extraction::ConstTraxelRefVector& traxs_in_first,
+                          const feature_extraction::ConstTraxelRefVector& traxs_in_second,
+                          std::vector<feature_array>& probabilities,
+                          bool with_predict);
 };
 
 
@@ -89,6 +89,8 @@ public:
     withClassifierPrior(withClassifierPrior),
     verbose(verbose),
     with_non_negative_weights(withNonNegativeWeights),
+    lazy_constraints(false),
+    persistent_solver(false),
     with_swap(true),
     max_number_paths(std::numeric_limits<size_t>::max())
     {}
@@ -143,6 +145,12 @@ public:
     unsigned int num_threads;
     double ep_gap;
     double cplex_timeout;
+    // start with the detection constraints only and add violated incoming / outgoing
+    // constraints between re-solves
+    bool lazy_constraints;
+    // diverse m-best: keep the MAP inference model and only raise the energies of previous
+    // solutions between iterations instead of building a perturbed model per iteration
+    bool persistent_solver;
 
     // dynprog settings
     size_t max_number_paths;
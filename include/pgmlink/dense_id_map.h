@@ -0,0 +1,203 @@
+/**
+   @file
+   @ingroup util
+   @brief array-backed maps from lemon nodes or arcs to indices
+*/
+
+#ifndef DENSE_ID_MAP_H
+#define DENSE_ID_MAP_H
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <lemon/list_graph.h>
+
+namespace pgmlink
+{
+
+/**
+ * One-to-one map from lemon nodes or arcs to indices, e.g. the opengm variables
+ * or factors that represent them.
+ *
+ * Both directions are arrays: the key side is indexed by the lemon id of the
+ * key, the value side by the value itself. Lookups are O(1) reads instead of
+ * the tree walks of std::map or boost::bimap, and iterating walks the entries
+ * in insertion order, which for variable maps is the order of the variables.
+ *
+ * Entries can be added and replaced but not removed, as the models never drop
+ * variables. Keys must be valid lemon items, values small non-negative
+ * integers.
+ */
+template <typename Key, typename Value = size_t, typename Graph = lemon::ListDigraph>
+class DenseIdMap
+{
+public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+    typedef std::pair<Key, Value> value_type;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+    typedef const_iterator iterator;
+
+    /// make room for keys with lemon ids below max_id without reallocating
+    void reserve(size_t max_id);
+
+    /// add key -> value, replacing the previous value of key
+    /// throws std::runtime_error if value is mapped to from another key
+    void insert(const Key& key, const Value& value);
+    void insert(const value_type& entry)
+    {
+        insert(entry.first, entry.second);
+    }
+
+    size_t count(const Key& key) const
+    {
+        return position(key) != npos ? 1 : 0;
+    }
+    const_iterator find(const Key& key) const
+    {
+        const size_t pos = position(key);
+        return pos != npos ? entries_.begin() + pos : entries_.end();
+    }
+    /// throws std::out_of_range if key is not in the map
+    const Value& at(const Key& key) const;
+    const Value& operator[](const Key& key) const
+    {
+        return at(key);
+    }
+
+    // reverse lookup
+    size_t count_value(const Value& value) const
+    {
+        return value_position(value) != npos ? 1 : 0;
+    }
+    /// throws std::out_of_range if no key maps to value
+    const Key& key_of(const Value& value) const;
+
+    const_iterator begin() const
+    {
+        return entries_.begin();
+    }
+    const_iterator end() const
+    {
+        return entries_.end();
+    }
+    size_t size() const
+    {
+        return entries_.size();
+    }
+    bool empty() const
+    {
+        return entries_.empty();
+    }
+    void clear();
+
+private:
+    static const size_t npos = static_cast<size_t>(-1);
+
+    size_t position(const Key& key) const
+    {
+        const int id = Graph::id(key);
+        return id >= 0 && static_cast<size_t>(id) < position_of_id_.size() ? position_of_id_[id] : npos;
+    }
+    size_t value_position(const Value& value) const
+    {
+        const size_t v = static_cast<size_t>(value);
+        return v < position_of_value_.size() ? position_of_value_[v] : npos;
+    }
+
+    std::vector<value_type> entries_;
+    std::vector<size_t> position_of_id_;
+    std::vector<size_t> position_of_value_;
+};
+
+
+
+////
+//// implementation
+////
+template <typename Key, typename Value, typename Graph>
+const size_t DenseIdMap<Key, Value, Graph>::npos;
+
+template <typename Key, typename Value, typename Graph>
+void DenseIdMap<Key, Value, Graph>::reserve(size_t max_id)
+{
+    entries_.reserve(max_id);
+    if (position_of_id_.size() < max_id)
+    {
+        position_of_id_.resize(max_id, npos);
+    }
+}
+
+template <typename Key, typename Value, typename Graph>
+void DenseIdMap<Key, Value, Graph>::insert(const Key& key, const Value& value)
+{
+    const int id = Graph::id(key);
+    if (id < 0)
+    {
+        throw std::runtime_error("DenseIdMap::insert(): invalid key");
+    }
+    const size_t v = static_cast<size_t>(value);
+    const size_t pos = position(key);
+    const size_t other = value_position(value);
+    if (other != npos && other != pos)
+    {
+        throw std::runtime_error("DenseIdMap::insert(): value is already mapped to from another key");
+    }
+
+    if (static_cast<size_t>(id) >= position_of_id_.size())
+    {
+        position_of_id_.resize(static_cast<size_t>(id) + 1, npos);
+    }
+    if (v >= position_of_value_.size())
+    {
+        position_of_value_.resize(v + 1, npos);
+    }
+
+    if (pos == npos)
+    {
+        position_of_id_[id] = entries_.size();
+        position_of_value_[v] = entries_.size();
+        entries_.push_back(value_type(key, value));
+    }
+    else
+    {
+        position_of_value_[static_cast<size_t>(entries_[pos].second)] = npos;
+        position_of_value_[v] = pos;
+        entries_[pos].second = value;
+    }
+}
+
+template <typename Key, typename Value, typename Graph>
+const Value& DenseIdMap<Key, Value, Graph>::at(const Key& key) const
+{
+    const size_t pos = position(key);
+    if (pos == npos)
+    {
+        throw std::out_of_range("DenseIdMap::at(): key does not exist");
+    }
+    return entries_[pos].second;
+}
+
+template <typename Key, typename Value, typename Graph>
+const Key& DenseIdMap<Key, Value, Graph>::key_of(const Value& value) const
+{
+    const size_t pos = value_position(value);
+    if (pos == npos)
+    {
+        throw std::out_of_range("DenseIdMap::key_of(): value does not exist");
+    }
+    return entries_[pos].first;
+}
+
+template <typename Key, typename Value, typename Graph>
+void DenseIdMap<Key, Value, Graph>::clear()
+{
+    entries_.clear();
+    position_of_id_.clear();
+    position_of_value_.clear();
+}
+
+} // namespace pgmlink
+
+#endif // DENSE_ID_MAP_H
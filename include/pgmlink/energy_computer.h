@@ -14,6 +14,7 @@ namespace pgmlink
 {
 
 class FeatureStore;
+class OutOfCoreTraxelStore;
 
 /// This class takes a hypotheses graph, a parameter object and a feature store,
 /// and evaluates the energy/cost functions for each detection,appearance,disappearance,division and transition.
@@ -39,6 +40,12 @@ public:
 	/// perform the computation and store results in featurestore
 	void operator()(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs);
 
+	/// same for a graph built from an OutOfCoreTraxelStore: the parameter functions get the
+	/// traxels with all features from store, walking through the graph one timestep at a time
+	/// and holding only the frames of that timestep and the next one. fs is the resident
+	/// feature store the graph was built with. Does not support tracklets.
+	void operator()(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, const OutOfCoreTraxelStore& store);
+
 	/// get the feature name used in the FeatureStore so that it can be queried lateron
 	const std::string getEnergyName(EnergyType t) const { return energyNames_.at(t); }
 	// const double getEnergyWeight(t) const { return energyWeights_.at(t); }
@@ -50,11 +57,13 @@ private:
 private:
 	/// Compute and store the energy of an event in the respective traxel.
 	/// In the case of tracklets, the energy is stored in all contained traxels for simplicity.
-	void computeDetectionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n);
-	void computeDivisionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n);
-	void computeAppearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n);
-	void computeDisappearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n);
-	void computeTransitionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Arc a);
+	/// tr (resp. from and to) is the traxel of the node with all its features, unused for tracklets.
+	void computeDetectionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr);
+	void computeDivisionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr);
+	void computeAppearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr);
+	void computeDisappearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr);
+	void computeTransitionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Arc a,
+		const Traxel& from, const Traxel& to);
 	void storeNodeEnergies(
 		HypothesesGraph& graph, 
 		boost::shared_ptr<FeatureStore> fs, 
@@ -62,7 +71,7 @@ private:
 		EnergyType t,
 		const feature_array& energies);
 	void convexifyEnergies(feature_array& energies, feature_type eps=0.000001);
-	double get_transition_probability(Traxel& tr1, Traxel& tr2, size_t state) const;
+	double get_transition_probability(const Traxel& tr1, const Traxel& tr2, size_t state) const;
 	double get_transition_prob(double distance, size_t state, double alpha) const;
 
 private:
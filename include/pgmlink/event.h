@@ -14,6 +14,7 @@
 #include "pgmlink_export.h"
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/vector.hpp>
 
 // template class PGMLINK_EXPORT std::vector<unsigned int>;
 
@@ -105,6 +106,189 @@ typedef std::vector<Event> EventVector;
 typedef std::vector<EventVector> EventVectorVector;
 typedef std::vector<EventVectorVector> EventVectorVectorVector;
 
+/**
+   \brief Events of one or more solutions as a struct of arrays.
+
+   Every event is a row: type, timestep, iteration, energy and up to
+   id_slots traxel ids are stored inline in one column each. The rare
+   events with more ids (ResolvedTo) keep the remaining ids, and events
+   with features keep their features followed by their weights, in buffers
+   shared by all rows. No allocation happens per event.
+
+   The table covers n_iterations() solutions and the timesteps
+   [first_timestep(), first_timestep() + n_timesteps()), converting it to
+   nested event vectors yields one vector per timestep even if it holds no
+   event. Within a timestep the rows keep the order they were added in.
+*/
+class EventTable
+{
+public:
+    static const size_t id_slots = 3;
+    static const uint64_t invalid_id = static_cast<uint64_t>(-1);
+    static const uint64_t no_offset = static_cast<uint64_t>(-1);
+
+    PGMLINK_EXPORT EventTable(size_t n_iterations = 0, int first_timestep = 0, size_t n_timesteps = 0);
+    /// events[t] happen at timestep first_timestep + t
+    PGMLINK_EXPORT explicit EventTable(const EventVectorVector& events, int first_timestep = 0);
+    /// events[i][t] happen at timestep first_timestep + t in solution i
+    PGMLINK_EXPORT explicit EventTable(const EventVectorVectorVector& events, int first_timestep = 0);
+
+    PGMLINK_EXPORT size_t size() const
+    {
+        return types_.size();
+    }
+    PGMLINK_EXPORT size_t n_iterations() const
+    {
+        return n_iterations_;
+    }
+    PGMLINK_EXPORT int first_timestep() const
+    {
+        return first_timestep_;
+    }
+    PGMLINK_EXPORT size_t n_timesteps() const
+    {
+        return n_timesteps_;
+    }
+    PGMLINK_EXPORT void reserve(size_t n_rows);
+
+    /**
+       \brief Append an event without traxel ids, add them with add_traxel_id().
+
+       The timestep is checked against the covered range.
+    */
+    PGMLINK_EXPORT EventTable& add_event(Event::EventType type, int timestep, size_t iteration = 0, double energy = 0.);
+    /// append a traxel id to the last row
+    PGMLINK_EXPORT EventTable& add_traxel_id(uint64_t id);
+    PGMLINK_EXPORT EventTable& add_event(const Event& e, int timestep, size_t iteration = 0);
+    /// append row of other, the id and feature buffers are copied along
+    PGMLINK_EXPORT EventTable& add_row(const EventTable& other, size_t row);
+
+    PGMLINK_EXPORT Event::EventType type(size_t row) const
+    {
+        return static_cast<Event::EventType>(types_[row]);
+    }
+    PGMLINK_EXPORT int timestep(size_t row) const
+    {
+        return timesteps_[row];
+    }
+    PGMLINK_EXPORT size_t iteration(size_t row) const
+    {
+        return iterations_[row];
+    }
+    PGMLINK_EXPORT double energy(size_t row) const
+    {
+        return energies_[row];
+    }
+    PGMLINK_EXPORT size_t n_traxel_ids(size_t row) const
+    {
+        return n_traxel_ids_[row];
+    }
+    PGMLINK_EXPORT uint64_t traxel_id(size_t row, size_t i) const;
+    PGMLINK_EXPORT size_t n_features(size_t row) const
+    {
+        return n_features_[row];
+    }
+    /// the features of row, n_features(row) values, NULL if there are none
+    PGMLINK_EXPORT const double* features(size_t row) const;
+    /// the weights of row, n_features(row) values, NULL if there are none
+    PGMLINK_EXPORT const double* weights(size_t row) const;
+
+    PGMLINK_EXPORT Event event(size_t row) const;
+    /// events of iteration i, one vector per covered timestep
+    PGMLINK_EXPORT void to_events(size_t iteration, EventVectorVector& events) const;
+    PGMLINK_EXPORT void to_events(EventVectorVectorVector& events) const;
+
+private:
+    void add_events(const EventVectorVector& events, size_t iteration);
+
+    size_t n_iterations_;
+    int first_timestep_;
+    size_t n_timesteps_;
+
+    // one entry per row
+    std::vector<uint8_t> types_;
+    std::vector<int32_t> timesteps_;
+    std::vector<uint32_t> iterations_;
+    std::vector<double> energies_;
+    std::vector<uint32_t> n_traxel_ids_;
+    std::vector<uint32_t> n_features_;
+    // id_slots entries per row
+    std::vector<uint64_t> traxel_ids_;
+    // offsets into the shared buffers, no_offset if unused
+    std::vector<uint64_t> extra_id_offsets_;
+    std::vector<uint64_t> feature_offsets_;
+
+    // shared buffers
+    std::vector<uint64_t> extra_ids_;
+    std::vector<double> feature_data_;
+
+    friend class boost::serialization::access;
+    template<class Archive>
+    void serialize(Archive & ar, const unsigned int /*version*/)
+    {
+        ar & n_iterations_;
+        ar & first_timestep_;
+        ar & n_timesteps_;
+        ar & types_;
+        ar & timesteps_;
+        ar & iterations_;
+        ar & energies_;
+        ar & n_traxel_ids_;
+        ar & n_features_;
+        ar & traxel_ids_;
+        ar & extra_id_offsets_;
+        ar & feature_offsets_;
+        ar & extra_ids_;
+        ar & feature_data_;
+    }
+};
+
+/**
+   \brief Flat, fixed-size representation of an Event.
+
+   Plain old data, so that a contiguous std::vector<EventRecord> can be
+   handed out as a NumPy structured array without any per-event conversion.
+   Unused id slots are set to EventRecord::invalid_id. A ResolvedTo event
+   with n new ids is stored as n records (merger id, new id), a Merger stores
+   (merger id, number of objects) just like the Event it stems from.
+*/
+struct EventRecord
+{
+    static const uint64_t invalid_id = static_cast<uint64_t>(-1);
+    static const size_t max_traxel_ids = 3;
+
+    int32_t type;
+    int32_t timestep;
+    int32_t iteration;
+    uint32_t n_traxel_ids;
+    uint64_t traxel_ids[max_traxel_ids];
+    double energy;
+};
+
+/**
+   \brief Append the events of a single solution to a flat record vector.
+
+   The timestep of a record is the index into the outer vector plus
+   first_timestep, which mirrors how the event vectors are indexed by
+   events().
+*/
+PGMLINK_EXPORT void flatten_events(const EventVectorVector& events,
+                                   std::vector<EventRecord>& records,
+                                   int iteration = 0,
+                                   int first_timestep = 0);
+/**
+   \brief Flatten the events of all solutions, the iteration field holds the
+   index of the solution.
+*/
+PGMLINK_EXPORT void flatten_events(const EventVectorVectorVector& events,
+                                   std::vector<EventRecord>& records,
+                                   int first_timestep = 0);
+/**
+   \brief Flatten an event table, timestep and iteration are taken from the rows.
+*/
+PGMLINK_EXPORT void flatten_events(const EventTable& events,
+                                   std::vector<EventRecord>& records);
+
 struct EventsStatistics
 {
     PGMLINK_EXPORT EventsStatistics()
@@ -0,0 +1,139 @@
+#pragma once
+#ifndef OPENGM_SPARSEBINARYFUNCTION_HXX
+#define OPENGM_SPARSEBINARYFUNCTION_HXX
+
+#include <limits>
+#include <map>
+#include <vector>
+#include "opengm/opengm.hxx"
+#include "opengm/functions/function_properties_base.hxx"
+
+namespace opengm
+{
+
+/// Sparse Binary Function
+///
+/// Function of binary variables that stores values only for a few
+/// configurations and assumes a default value (e.g. a forbidden cost)
+/// for all others. A configuration is identified by the positions of
+/// the variables in state 1, so a table whose configurations have at
+/// most k variables on takes O(k) memory per entry instead of
+/// 2^dimension entries. Evaluation only looks at the positions that
+/// are on and stops as soon as there are more than any stored
+/// configuration has.
+///
+/// \ingroup functions
+template<class T, class I = size_t, class L = size_t>
+class SparseBinaryFunction
+    : public FunctionBase<SparseBinaryFunction<T, I, L>, T, I, L>
+{
+public:
+    typedef T ValueType;
+    typedef I IndexType;
+    typedef L LabelType;
+    /// ascending positions of the variables in state 1
+    typedef std::vector<IndexType> ActiveSet;
+    typedef std::map<ActiveSet, ValueType> EntryMap;
+
+    SparseBinaryFunction(size_t dimension = 0, ValueType default_value = 0.)
+        : dimension_(dimension), default_(default_value), max_active_(0) {}
+
+    template<class ITERATOR> ValueType operator()(ITERATOR) const;
+
+    size_t dimension() const
+    {
+        return dimension_;
+    }
+    size_t shape(const IndexType) const
+    {
+        return 2;
+    }
+    /// number of configurations; throws if that does not fit into size_t
+    size_t size() const
+    {
+        if(dimension_ >= static_cast<size_t>(std::numeric_limits<size_t>::digits))
+        {
+            throw RuntimeError("SparseBinaryFunction::size(): too many configurations for size_t");
+        }
+        return dimension_ > 0 ? size_t(1) << dimension_ : 0;
+    }
+
+    /// set the value of the configuration where exactly the given variables are on
+    void set_value(const ActiveSet& active, const ValueType& v);
+    /// set the value of a configuration given by one label per variable
+    template<class ITERATOR> void set_value_of_labels(ITERATOR labels, const ValueType& v);
+
+    void default_value( const ValueType& v )
+    {
+        default_ = v;
+    }
+    ValueType default_value() const
+    {
+        return default_;
+    }
+    const EntryMap& entries() const
+    {
+        return entries_;
+    }
+
+private:
+    size_t dimension_;
+    EntryMap entries_;
+    ValueType default_;
+    size_t max_active_;
+};
+
+
+
+/**/
+/* implementation */
+/**/
+template<class T, class I, class L>
+template<class ITERATOR>
+inline typename SparseBinaryFunction<T, I, L>::ValueType
+SparseBinaryFunction<T, I, L>::operator()(ITERATOR begin) const
+{
+    ActiveSet active;
+    for(size_t i = 0; i < dimension_; ++i, ++begin)
+    {
+        if(*begin != 0)
+        {
+            if(active.size() == max_active_)
+            {
+                return default_;
+            }
+            active.push_back(i);
+        }
+    }
+    typename EntryMap::const_iterator it = entries_.find(active);
+    return it == entries_.end() ? default_ : it->second;
+}
+
+template<class T, class I, class L>
+inline void SparseBinaryFunction<T, I, L>::set_value(const ActiveSet& active, const ValueType& v)
+{
+    OPENGM_ASSERT(active.empty() || active.back() < dimension_);
+    entries_[active] = v;
+    if(active.size() > max_active_)
+    {
+        max_active_ = active.size();
+    }
+}
+
+template<class T, class I, class L>
+template<class ITERATOR>
+inline void SparseBinaryFunction<T, I, L>::set_value_of_labels(ITERATOR labels, const ValueType& v)
+{
+    ActiveSet active;
+    for(size_t i = 0; i < dimension_; ++i, ++labels)
+    {
+        if(*labels != 0)
+        {
+            active.push_back(i);
+        }
+    }
+    set_value(active, v);
+}
+} // namespace opengm
+
+#endif // #ifndef OPENGM_SPARSEBINARYFUNCTION_HXX
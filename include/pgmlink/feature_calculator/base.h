@@ -27,9 +27,26 @@ public:
     virtual PGMLINK_EXPORT feature_array calculate(const feature_array& /* f1 */, const feature_array& /* f2 */, const feature_array& /* f3 */) const;
     virtual PGMLINK_EXPORT const std::string& name() const;
 
+    /// Batch versions of calculate(): row i of result is calculate() of row i of
+    /// the arguments. result is reshaped to (rows, feature length), so the same
+    /// matrix can be passed again for the next batch without reallocating.
+    /// The default implementations call calculate() row by row, calculators
+    /// with a vectorisable formula override them.
+    virtual PGMLINK_EXPORT void calculate_batch(const feature_matrix& f1,
+            const feature_matrix& f2,
+            feature_matrix& result) const;
+    virtual PGMLINK_EXPORT void calculate_batch(const feature_matrix& f1,
+            const feature_matrix& f2,
+            const feature_matrix& f3,
+            feature_matrix& result) const;
+
     PGMLINK_EXPORT bool operator==(const FeatureCalculator& other);
     PGMLINK_EXPORT bool operator!=(const FeatureCalculator& other);
 
+protected:
+    /// throws if the batch arguments do not have the same shape
+    static PGMLINK_EXPORT void check_batch_shapes(const feature_matrix& f1, const feature_matrix& f2);
+
 private:
     static const std::string name_;
 };
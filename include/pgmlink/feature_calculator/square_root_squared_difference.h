@@ -24,6 +24,8 @@ public:
 
     virtual PGMLINK_EXPORT ~SquareRootSquaredDifferenceCalculator();
     virtual PGMLINK_EXPORT feature_array calculate(const feature_array& f1, const feature_array& f2) const;
+    virtual PGMLINK_EXPORT void calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const;
+    using FeatureCalculator::calculate_batch;
     virtual PGMLINK_EXPORT const std::string& name() const;
 };
 
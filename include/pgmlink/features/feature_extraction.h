@@ -5,10 +5,14 @@
 #include <string>
 #include <map>
 #include <utility>
+#include <vector>
 
 // boost
 #include <boost/shared_ptr.hpp>
 
+// vigra
+#include <vigra/multi_array.hxx>
+
 // pgmlink
 #include "feature.h"
 #include "../pgmlink_export.h"
@@ -22,6 +26,12 @@ namespace feature_extraction
 // forward declaration of FeatureCalculator
 class FeatureCalculator;
 
+/// features of many traxels or traxel pairs, one row per traxel (pair) and one
+/// column per feature component. The row index is the fastest, so a feature
+/// component of all rows is contiguous in memory.
+typedef vigra::MultiArray<2, feature_type> feature_matrix;
+typedef std::vector<const Traxel*> ConstTraxelRefVector;
+
 ////
 //// class FeatureExtractor
 ////
@@ -34,6 +44,14 @@ public:
     PGMLINK_EXPORT virtual feature_array extract(const Traxel& t1) const;
     PGMLINK_EXPORT virtual feature_array extract(const Traxel& t1, const Traxel& t2) const;
     PGMLINK_EXPORT virtual feature_array extract(const Traxel& t1, const Traxel& t2, const Traxel& t3) const;
+    /// batch versions: row i of result holds the features of t1[i], t2[i] (and t3[i])
+    PGMLINK_EXPORT virtual void extract(const ConstTraxelRefVector& t1,
+                                        const ConstTraxelRefVector& t2,
+                                        feature_matrix& result) const;
+    PGMLINK_EXPORT virtual void extract(const ConstTraxelRefVector& t1,
+                                        const ConstTraxelRefVector& t2,
+                                        const ConstTraxelRefVector& t3,
+                                        feature_matrix& result) const;
     PGMLINK_EXPORT boost::shared_ptr<FeatureCalculator> calculator() const;
     PGMLINK_EXPORT virtual std::string name() const;
 
@@ -51,11 +69,21 @@ class MultipleFeatureExtraction
 public:
     typedef std::pair<std::string, std::string> CombinedFeatureName;
     typedef std::map<CombinedFeatureName, feature_array> CombinedFeatureMap;
+    typedef std::map<CombinedFeatureName, feature_matrix> CombinedFeatureMatrixMap;
     typedef std::map< std::string, std::vector< std::string > > FeatureList;
 
     PGMLINK_EXPORT CombinedFeatureMap operator() ( const FeatureList& features, const Traxel& trax ) const;
     PGMLINK_EXPORT CombinedFeatureMap operator() ( const FeatureList& features, const Traxel& trax1, const Traxel& trax2 ) const;
     PGMLINK_EXPORT CombinedFeatureMap operator() ( const FeatureList& features, const Traxel& trax1, const Traxel& trax2, const Traxel& trax3 ) const;
+
+    // batch versions for all transitions or divisions of a timestep at once
+    PGMLINK_EXPORT CombinedFeatureMatrixMap operator() ( const FeatureList& features,
+            const ConstTraxelRefVector& trax1,
+            const ConstTraxelRefVector& trax2 ) const;
+    PGMLINK_EXPORT CombinedFeatureMatrixMap operator() ( const FeatureList& features,
+            const ConstTraxelRefVector& trax1,
+            const ConstTraxelRefVector& trax2,
+            const ConstTraxelRefVector& trax3 ) const;
 };
 
 
@@ -78,6 +106,13 @@ PGMLINK_EXPORT MultipleFeatureExtraction::CombinedFeatureMap convenience_feature
         const Traxel& trax1,
         const Traxel& trax2,
         const Traxel& trax3 );
+PGMLINK_EXPORT MultipleFeatureExtraction::CombinedFeatureMatrixMap convenience_feature_extraction( const MultipleFeatureExtraction::FeatureList& features,
+        const ConstTraxelRefVector& trax1,
+        const ConstTraxelRefVector& trax2 );
+PGMLINK_EXPORT MultipleFeatureExtraction::CombinedFeatureMatrixMap convenience_feature_extraction( const MultipleFeatureExtraction::FeatureList& features,
+        const ConstTraxelRefVector& trax1,
+        const ConstTraxelRefVector& trax2,
+        const ConstTraxelRefVector& trax3 );
 
 
 } /* namespace helpers */
@@ -0,0 +1,145 @@
+/**
+   @file
+   @ingroup features
+   @brief batched, asynchronous HDF5 output of per-track feature matrices
+*/
+
+#ifndef FEATURE_MATRIX_WRITER_H
+#define FEATURE_MATRIX_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+#include "pgmlink/pgmlink_export.h"
+
+namespace pgmlink
+{
+namespace features
+{
+
+/**
+ * Writes many small feature matrices (one per track or division) into a few
+ * large HDF5 datasets.
+ *
+ * All matrices appended under the same name are stacked row-wise into one
+ * chunked, compressed dataset. For a name "tracks/angles_com" the file gets
+ * - tracks/angles_com/values: (total rows, columns), the stacked matrices
+ * - tracks/angles_com/offsets: rows of the k-th matrix are [offsets[k], offsets[k + 1])
+ * - tracks/angles_com/ids: the id passed along with the k-th matrix
+ *
+ * The file is kept open for the lifetime of the writer. Appended matrices are
+ * collected in memory and handed to a background thread, which does all HDF5
+ * calls, whenever buffer_size bytes are pending; the caller only waits if the
+ * writer falls behind by more than two buffers. Datasets that exist already
+ * in the file are replaced. Errors of the writer thread are rethrown as
+ * std::runtime_error by the next call.
+ *
+ * No other HDF5 handle to the file may be used until close() returned.
+ */
+class FeatureMatrixWriter
+{
+public:
+    /// opens filename for appending or creates it
+    PGMLINK_EXPORT explicit FeatureMatrixWriter(
+        const std::string& filename,
+        size_t buffer_size = 16 << 20,
+        unsigned int compression = 4);
+    PGMLINK_EXPORT ~FeatureMatrixWriter();
+
+    /**
+     * Append the rows x columns matrix of item id to the stacked dataset name.
+     * Element (i, j) is data[i + j * rows], as in a vigra::MultiArray.
+     * Throws std::runtime_error if the number of columns differs from the
+     * matrices appended under the same name before.
+     */
+    PGMLINK_EXPORT void append(
+        const std::string& name,
+        size_t id,
+        const double* data,
+        size_t rows,
+        size_t columns);
+
+    /// write a rows x columns matrix on its own, laid out like vigra::writeHDF5 does
+    PGMLINK_EXPORT void write(
+        const std::string& name,
+        const double* data,
+        size_t rows,
+        size_t columns);
+
+    /// block until everything appended or written so far is in the file
+    PGMLINK_EXPORT void flush();
+    /// flush, stop the writer thread and close the file
+    PGMLINK_EXPORT void close();
+
+    PGMLINK_EXPORT const std::string& filename() const
+    {
+        return filename_;
+    }
+
+private:
+    struct Block
+    {
+        Block() : stacked(true), columns(0) {}
+
+        std::string name;
+        bool stacked;
+        size_t columns;
+        std::vector<uint64_t> ids;
+        // number of rows of each matrix
+        std::vector<uint64_t> rows;
+        // row-major
+        std::vector<double> values;
+    };
+
+    struct Dataset
+    {
+        int64_t values;
+        int64_t offsets;
+        int64_t ids;
+        uint64_t n_rows;
+        uint64_t n_items;
+    };
+
+    void queue_pending();
+    void check_error();
+    void run();
+    void write_block(const Block& block);
+    Dataset& dataset(const Block& block);
+    void remove_link(const std::string& name);
+
+    std::string filename_;
+    size_t buffer_size_;
+    unsigned int compression_;
+    int64_t file_;
+    bool open_;
+
+    // caller side
+    std::map<std::string, Block> pending_;
+    std::map<std::string, size_t> columns_;
+    size_t pending_bytes_;
+
+    // writer thread side
+    std::map<std::string, Dataset> datasets_;
+
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::deque<std::vector<Block> > queue_;
+    size_t queued_bytes_;
+    bool busy_;
+    bool stop_;
+    std::string error_;
+};
+
+} // end namespace features
+} // end namespace pgmlink
+
+#endif // FEATURE_MATRIX_WRITER_H
@@ -0,0 +1,73 @@
+/**
+   @file
+   @ingroup features
+   @brief binary, append-only storage of the feature vectors of tracking proposals
+*/
+
+#ifndef FEATURE_VECTOR_FILE_H
+#define FEATURE_VECTOR_FILE_H
+
+#include <string>
+#include <vector>
+
+#include "pgmlink/pgmlink_export.h"
+
+namespace pgmlink
+{
+namespace features
+{
+
+/**
+ * Binary file of proposal feature vectors, one fixed-width row per proposal.
+ *
+ * Layout (native byte order):
+ * - 8 bytes magic "PGMLFV1\0"
+ * - uint64 number of features n
+ * - uint64 offset of the first row, a multiple of 8
+ * - n feature names, each a uint32 length followed by the characters
+ * - zero padding up to the first row
+ * - one row of n doubles per proposal
+ *
+ * The number of proposals is (file size - offset) / (8 n), so appending a
+ * proposal only reads the header and writes one row. The rows can be
+ * memory-mapped as a (proposals x n) matrix of doubles, e.g. with
+ * numpy.memmap(filename, dtype='float64', offset=data_offset(filename)).
+ *
+ * The legacy text format of TrackingFeatureExtractor::append_feature_vector_to_file()
+ * (one line per feature, one column per proposal) can be converted with
+ * convert_text_file().
+ */
+class FeatureVectorFile
+{
+public:
+    /// append one proposal, create the file if it does not exist
+    /// throws std::runtime_error if the feature names differ from the ones in the file
+    PGMLINK_EXPORT static void append(
+        const std::string& filename,
+        const std::vector<std::string>& feature_names,
+        const std::vector<double>& features);
+
+    /// read the feature names, returns the byte offset of the first row
+    PGMLINK_EXPORT static size_t read_header(
+        const std::string& filename,
+        std::vector<std::string>& feature_names);
+    PGMLINK_EXPORT static size_t data_offset(const std::string& filename);
+
+    /// read all proposals, returns their number
+    PGMLINK_EXPORT static size_t read(
+        const std::string& filename,
+        std::vector<std::string>& feature_names,
+        std::vector<std::vector<double> >& proposals);
+
+    /// write all proposals of a legacy text file into a new binary file,
+    /// features are named by their index if no names are given
+    PGMLINK_EXPORT static size_t convert_text_file(
+        const std::string& text_filename,
+        const std::string& filename,
+        const std::vector<std::string>& feature_names = std::vector<std::string>());
+};
+
+} // end namespace features
+} // end namespace pgmlink
+
+#endif // FEATURE_VECTOR_FILE_H
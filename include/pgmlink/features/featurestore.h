@@ -46,6 +46,10 @@ public:
     /// Generic traxel feature retrieval
     PGMLINK_EXPORT FeatureMap& get_traxel_features(const std::vector<const Traxel*>& traxels);
 
+    /// Look up the features of a single traxel without inserting them,
+    /// returns NULL if the store has none. Safe to call from several threads.
+    PGMLINK_EXPORT const FeatureMap* find_traxel_features(const Traxel& traxel) const;
+
     /// dump contents to a stream
     PGMLINK_EXPORT void dump(std::ostream &stream);
 
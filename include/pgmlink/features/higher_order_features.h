@@ -51,6 +51,7 @@ diffusion_calculator.calculate(positions, return_value);
 #include <vector>
 #include <string> /* for deserialization of decision function */
 #include <sstream> /* for serialization of decision function */
+#include <cmath> /* for sqrt in the fused calculators */
 
 // pgmlink
 #include "pgmlink/traxels.h" /* for traxels */
@@ -198,11 +199,38 @@ public:
     virtual PGMLINK_EXPORT FeatureMatrix calculate(
         const FeatureMatrix& feature_matrix
     ) const;
-    // TODO documentation of member function
+    /**
+    \brief calculates the features of every subset of traxels
+
+    The flattened result for the n-th subset is written into the n-th column of
+    the return matrix, which has as many rows as the first non-empty result
+    (longer results are truncated, shorter ones padded with zeros). If all
+    results are empty the return matrix is a single zero.
+
+    With parallel set, the subsets are processed by OpenMP threads with one
+    extraction and calculation workspace per thread. The extractor and the
+    calculator must then be safe to call concurrently, which holds for all
+    calculators in this file.
+    */
     virtual PGMLINK_EXPORT void calculate_for_all(
         const ConstTraxelRefVectors& traxelrefs,
         FeatureMatrix& return_matrix,
-        boost::shared_ptr<TraxelsFeatureExtractor> feature_extractor_ref
+        boost::shared_ptr<TraxelsFeatureExtractor> feature_extractor_ref,
+        bool parallel = false
+    ) const;
+    /**
+    \brief calculates the features of every subset of traxels into its own matrix
+
+    results[n] holds the result for the n-th subset. Subsets with less than
+    min_size traxels are skipped and get an empty matrix. See calculate_for_all()
+    for the parallel mode.
+    */
+    PGMLINK_EXPORT void calculate_for_each(
+        const ConstTraxelRefVectors& traxelrefs,
+        std::vector<FeatureMatrix>& results,
+        const TraxelsFeatureExtractor& feature_extractor,
+        size_t min_size = 0,
+        bool parallel = false
     ) const;
 };
 
@@ -755,13 +783,276 @@ protected:
     static const std::string name_;
 };
 
+////
+//// class FusedCalculator
+////
+/**
+\brief stages of the fused calculators
+
+Every stage is a lazy matrix expression over the expression of the previous
+stage: it has a number of columns and rows and computes an element on access,
+so a chain of stages never materialises an intermediate matrix. The stages
+give the same results as the calculator of the same name, including the
+zero vectors returned for too small inputs.
+*/
+namespace fused
+{
+/// the feature matrix handed to FusedCalculator::calculate()
+class Input
+{
+public:
+    explicit Input(const FeatureMatrix& feature_matrix) : m_(feature_matrix) {}
+    size_t cols() const
+    {
+        return m_.shape(0);
+    }
+    size_t rows() const
+    {
+        return m_.shape(1);
+    }
+    FeatureScalar operator()(size_t col, size_t row) const
+    {
+        return m_(col, row);
+    }
+private:
+    const FeatureMatrix& m_;
+};
+
+/// difference of neighbouring columns, see DiffCalculator
+template<typename E>
+class Diff
+{
+public:
+    explicit Diff(const E& e) : e_(e) {}
+    size_t cols() const
+    {
+        return e_.cols() <= 1 ? 1 : e_.cols() - 1;
+    }
+    size_t rows() const
+    {
+        return e_.rows();
+    }
+    FeatureScalar operator()(size_t col, size_t row) const
+    {
+        return e_.cols() <= 1 ? 0 : e_(col + 1, row) - e_(col, row);
+    }
+private:
+    E e_;
+};
+
+/// second difference of neighbouring columns, see CurveCalculator
+template<typename E>
+class Curve
+{
+public:
+    explicit Curve(const E& e) : e_(e) {}
+    size_t cols() const
+    {
+        return e_.cols() <= 2 ? 1 : e_.cols() - 2;
+    }
+    size_t rows() const
+    {
+        return e_.rows();
+    }
+    FeatureScalar operator()(size_t col, size_t row) const
+    {
+        return e_.cols() <= 2 ? 0 : e_(col, row) - 2 * e_(col + 1, row) + e_(col + 2, row);
+    }
+private:
+    E e_;
+};
+
+/// squared norm of every column, see SquaredNormCalculator<0>
+template<typename E>
+class SquaredNorm
+{
+public:
+    explicit SquaredNorm(const E& e) : e_(e) {}
+    size_t cols() const
+    {
+        return e_.cols();
+    }
+    size_t rows() const
+    {
+        return 1;
+    }
+    FeatureScalar operator()(size_t col, size_t) const
+    {
+        FeatureScalar ret = 0;
+        for (size_t row = 0; row < e_.rows(); row++)
+        {
+            const FeatureScalar value = e_(col, row);
+            ret += value * value;
+        }
+        return ret;
+    }
+private:
+    E e_;
+};
+
+/// square of every element, see SquareCalculator
+template<typename E>
+class Square
+{
+public:
+    explicit Square(const E& e) : e_(e) {}
+    size_t cols() const
+    {
+        return e_.cols();
+    }
+    size_t rows() const
+    {
+        return e_.rows();
+    }
+    FeatureScalar operator()(size_t col, size_t row) const
+    {
+        const FeatureScalar value = e_(col, row);
+        return value * value;
+    }
+private:
+    E e_;
+};
+
+/// square root of every element, see SquareRootCalculator
+template<typename E>
+class SquareRoot
+{
+public:
+    explicit SquareRoot(const E& e) : e_(e) {}
+    size_t cols() const
+    {
+        return e_.cols();
+    }
+    size_t rows() const
+    {
+        return e_.rows();
+    }
+    FeatureScalar operator()(size_t col, size_t row) const
+    {
+        return std::sqrt(e_(col, row));
+    }
+private:
+    E e_;
+};
+
+/// mean column vector, see MeanCalculator<0>
+template<typename E>
+class Mean
+{
+public:
+    explicit Mean(const E& e) : e_(e) {}
+    size_t cols() const
+    {
+        return 1;
+    }
+    size_t rows() const
+    {
+        return empty() ? 1 : e_.rows();
+    }
+    FeatureScalar operator()(size_t, size_t row) const
+    {
+        if (empty())
+        {
+            return 0;
+        }
+        FeatureScalar ret = 0;
+        for (size_t col = 0; col < e_.cols(); col++)
+        {
+            ret += e_(col, row);
+        }
+        return ret / static_cast<FeatureScalar>(e_.cols());
+    }
+private:
+    bool empty() const
+    {
+        return e_.cols() == 0 or e_.rows() == 0;
+    }
+    E e_;
+};
+
+/// applies the stages from left to right
+template<typename E, template<typename> class... Stages>
+struct Chain;
+
+template<typename E>
+struct Chain<E>
+{
+    typedef E type;
+    static type make(const E& e)
+    {
+        return e;
+    }
+};
+
+template<typename E, template<typename> class Stage, template<typename> class... Stages>
+struct Chain<E, Stage, Stages...>
+{
+    typedef typename Chain<Stage<E>, Stages...>::type type;
+    static type make(const E& e)
+    {
+        return Chain<Stage<E>, Stages...>::make(Stage<E>(e));
+    }
+};
+
+/// writes every element of the expression once
+template<typename E>
+void evaluate(const E& e, FeatureMatrix& return_matrix)
+{
+    const size_t col_count = e.cols();
+    const size_t row_count = e.rows();
+    return_matrix.reshape(vigra::Shape2(col_count, row_count));
+    for (size_t row = 0; row < row_count; row++)
+    {
+        for (size_t col = 0; col < col_count; col++)
+        {
+            return_matrix(col, row) = e(col, row);
+        }
+    }
+}
+} // end namespace fused
+
+/**
+\brief composition of calculators fused into a single pass at compile time
+
+FusedCalculator<fused::Diff, fused::SquaredNorm, fused::Mean> gives the same
+result as the TCompositionCalculator chain of DiffCalculator,
+SquaredNormCalculator<0> and MeanCalculator<0>, but evaluates every element of
+the result directly from the feature matrix, without virtual calls or
+temporary matrices between the stages. Use CompositionCalculator to chain
+calculators at runtime or calculators that have no fused stage.
+*/
+template<template<typename> class... Stages>
+class FusedCalculator : public TraxelsFeatureCalculator
+{
+public:
+    FusedCalculator() {};
+    virtual ~FusedCalculator() {};
+    virtual const std::string& name() const
+    {
+        return name_;
+    }
+    virtual void calculate(
+        const FeatureMatrix& feature_matrix,
+        FeatureMatrix& return_matrix
+    ) const
+    {
+        typedef fused::Chain<fused::Input, Stages...> ChainType;
+        fused::evaluate(ChainType::make(fused::Input(feature_matrix)), return_matrix);
+    }
+protected:
+    static const std::string name_;
+};
+
+template<template<typename> class... Stages>
+const std::string FusedCalculator<Stages...>::name_ = "FusedCalculator";
+
 /**
 \brief calculates the euclidean norm for each column vector
 */
-typedef TCompositionCalculator <
-SquaredNormCalculator<0>,
-                      SquareRootCalculator
-                      > EuclideanNormCalculator;
+typedef FusedCalculator <
+fused::SquaredNorm,
+fused::SquareRoot
+> EuclideanNormCalculator;
 
 
 /**
@@ -779,18 +1070,18 @@ MeanCalculator<0>
 \brief calculates the squared norm of the difference of neighbouring column
   vectors
 */
-typedef TCompositionCalculator <
-DiffCalculator,
-SquaredNormCalculator<0>
+typedef FusedCalculator <
+fused::Diff,
+fused::SquaredNorm
 > SquaredDiffCalculator;
 
 /**
 \brief calculates the squared norm of the difference of neighbouring column
   vectors
 */
-typedef TCompositionCalculator <
-CurveCalculator,
-SquaredNormCalculator<0>
+typedef FusedCalculator <
+fused::Curve,
+fused::SquaredNorm
 > SquaredCurveCalculator;
 
 ////
@@ -805,9 +1096,10 @@ Returns \f$D = \langle \vec{v}^2 \rangle - {\langle \vec{v} \rangle}^2\f$, where
 therefore variance of the mean move distance if the column vectors are the cell
 positions.
 */
-typedef TCompositionCalculator <
-SquaredDiffCalculator,
-MeanCalculator<0>
+typedef FusedCalculator <
+fused::Diff,
+fused::SquaredNorm,
+fused::Mean
 > DiffusionCalculator;
 
 ////
@@ -1089,13 +1381,24 @@ public:
     typedef dlib::decision_function<KernelType> DecisionFunctionType;
     typedef dlib::svm_one_class_trainer<KernelType> OneClassSVMTrainerType;
 
-    PGMLINK_EXPORT SVMOutlierCalculator() : is_trained_(false) {};
+    /// no subsampling by default. The training time of the one-class SVM
+    /// grows faster than quadratic in the number of samples, set a limit with
+    /// set_max_training_samples() to subsample large training sets
+    static const size_t default_max_training_samples = 0;
+
+    PGMLINK_EXPORT SVMOutlierCalculator() :
+        is_trained_(false),
+        max_training_samples_(default_max_training_samples) {};
     virtual PGMLINK_EXPORT ~SVMOutlierCalculator() {};
     virtual PGMLINK_EXPORT const std::string& name() const;
+    /// trains on at most get_max_training_samples() columns of the feature
+    /// matrix, drawn uniformly at random (with a fixed seed) if there are more.
+    /// The normalization is computed from all columns.
     PGMLINK_EXPORT void train(
         const FeatureMatrix& feature_matrix,
         const FeatureScalar& kernel_width = 1.0
     );
+    /// scores the columns in parallel if built with OpenMP
     virtual PGMLINK_EXPORT void calculate(
         const FeatureMatrix& feature_matrix,
         FeatureMatrix& return_matrix
@@ -1103,11 +1406,18 @@ public:
     PGMLINK_EXPORT void normalize_features(FeatureMatrix& feature_matrix) const;
     PGMLINK_EXPORT void compute_feature_mean_var(const FeatureMatrix &feature_matrix);
     PGMLINK_EXPORT bool is_trained() const;
+    /// 0 trains on all samples
+    PGMLINK_EXPORT void set_max_training_samples(size_t max_training_samples);
+    PGMLINK_EXPORT size_t get_max_training_samples() const;
+    /// store a trained calculator to reuse it in later runs
+    PGMLINK_EXPORT void write_to_file(const std::string& filename) const;
+    PGMLINK_EXPORT void read_from_file(const std::string& filename);
 protected:
     DecisionFunctionType decision_function_;
     std::vector<double> feature_means_;
     std::vector<double> feature_vars_;
     bool is_trained_;
+    size_t max_training_samples_;
     static const std::string name_;
 private:
     friend class boost::serialization::access;
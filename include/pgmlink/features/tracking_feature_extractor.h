@@ -3,6 +3,7 @@
 
 #include "pgmlink/hypotheses.h"
 #include "pgmlink/features/higher_order_features.h"
+#include "pgmlink/features/feature_matrix_writer.h"
 
 namespace pgmlink
 {
@@ -132,7 +133,14 @@ public:
     /// Dispatch computation of features here
     PGMLINK_EXPORT void compute_features();
 
-    /// Set HDF5 filename to which the features of all tracks will be written
+    /// Compute the features of the tracks and divisions on OpenMP threads,
+    /// see TraxelsFeatureCalculator::calculate_for_all(). The feature vector
+    /// does not depend on this setting. Off by default.
+    PGMLINK_EXPORT void set_parallel(bool parallel);
+
+    /// Set HDF5 filename to which the features of all tracks will be written.
+    /// The matrices of all tracks are stacked per feature, see FeatureMatrixWriter;
+    /// the file is complete when compute_features() returns.
     PGMLINK_EXPORT void set_track_feature_output_file(const std::string& filename);
 
     /// Append features for this solution to the given file.
@@ -140,6 +148,10 @@ public:
     /// Comments are ignored, and will not be copied to the edited file
     PGMLINK_EXPORT void append_feature_vector_to_file(const std::string &filename);
 
+    /// Append features for this solution to the given binary FeatureVectorFile.
+    /// Only writes one row, use this for many proposals.
+    PGMLINK_EXPORT void append_feature_vector_to_binary_file(const std::string &filename);
+
 private:
     void push_back_feature(std::string feature_name, double feature_value);
     void push_back_feature(
@@ -147,6 +159,8 @@ private:
         const MinMaxMeanVarCalculator& mmmv_calculator);
 
     void save_features_to_h5(size_t track_id, const std::string& feature_name, FeatureMatrix &matrix, bool tracks = true);
+    FeatureMatrixWriter& feature_writer();
+    void save_matrix_to_h5(const std::string& name, FeatureMatrix& matrix);
     void save_traxel_ids_to_h5(ConstTraxelRefVectors& track_traxels);
     void save_division_traxels_to_h5(ConstTraxelRefVectors &division_traxels);
 
@@ -203,6 +217,8 @@ private:
     FeatureDescription feature_descriptions_;
     boost::shared_ptr<HypothesesGraph> graph_;
     std::string track_feature_output_file_;
+    boost::shared_ptr<FeatureMatrixWriter> feature_writer_;
+    bool parallel_;
 };
 
 class BorderDistanceFilter
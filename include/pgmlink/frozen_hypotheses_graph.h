@@ -0,0 +1,271 @@
+/**
+   @file
+   @ingroup tracking
+   @brief read-only compressed sparse row copy of a hypotheses graph
+*/
+
+#ifndef FROZEN_HYPOTHESES_GRAPH_H
+#define FROZEN_HYPOTHESES_GRAPH_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "pgmlink_export.h"
+#include "pgmlink/hypotheses.h"
+
+namespace pgmlink
+{
+
+/**
+ * Topology of a finished HypothesesGraph in compressed sparse row layout.
+ *
+ * Nodes get dense indices ordered by timestep (within a timestep in the order
+ * of the node_timestep map), arcs get dense indices ordered by their source
+ * node. Timesteps and traxel ids of the nodes are kept in contiguous arrays,
+ * the lemon handles are kept to get back to the property maps.
+ *
+ * Meant for the read-mostly phases after construction: the frozen copy does
+ * not follow changes of the graph, and lookups never touch lemon maps, so it
+ * can be read from several threads at once.
+ */
+class FrozenHypothesesGraph
+{
+public:
+    typedef HypothesesGraph::Node Node;
+    typedef HypothesesGraph::Arc Arc;
+
+    static const size_t invalid_index = static_cast<size_t>(-1);
+
+    PGMLINK_EXPORT explicit FrozenHypothesesGraph(const HypothesesGraph& g);
+
+    PGMLINK_EXPORT const HypothesesGraph& graph() const
+    {
+        return graph_;
+    }
+
+    PGMLINK_EXPORT size_t num_nodes() const
+    {
+        return nodes_.size();
+    }
+    PGMLINK_EXPORT size_t num_arcs() const
+    {
+        return arcs_.size();
+    }
+
+    // timesteps
+    PGMLINK_EXPORT int earliest_timestep() const
+    {
+        return earliest_timestep_;
+    }
+    PGMLINK_EXPORT int latest_timestep() const
+    {
+        return earliest_timestep_ + static_cast<int>(timestep_offsets_.size()) - 2;
+    }
+    /// the nodes of timestep t are [timestep_begin(t), timestep_end(t)), empty outside the graph
+    PGMLINK_EXPORT size_t timestep_begin(int t) const;
+    PGMLINK_EXPORT size_t timestep_end(int t) const;
+
+    // nodes
+    PGMLINK_EXPORT Node node(size_t i) const
+    {
+        return nodes_[i];
+    }
+    PGMLINK_EXPORT size_t index(Node n) const
+    {
+        return node_index_[graph_.id(n)];
+    }
+    PGMLINK_EXPORT int timestep(size_t i) const
+    {
+        return node_timesteps_[i];
+    }
+    /// Id of the node_traxel of node i, 0 if the graph has no traxels
+    PGMLINK_EXPORT unsigned int traxel_id(size_t i) const
+    {
+        return traxel_ids_.empty() ? 0 : traxel_ids_[i];
+    }
+
+    // arcs
+    /// the outgoing arcs of node i are [out_begin(i), out_end(i))
+    PGMLINK_EXPORT size_t out_begin(size_t i) const
+    {
+        return out_offsets_[i];
+    }
+    PGMLINK_EXPORT size_t out_end(size_t i) const
+    {
+        return out_offsets_[i + 1];
+    }
+    PGMLINK_EXPORT size_t out_degree(size_t i) const
+    {
+        return out_offsets_[i + 1] - out_offsets_[i];
+    }
+    /// the incoming arcs of node i are in_arc(k) for k in [in_begin(i), in_end(i))
+    PGMLINK_EXPORT size_t in_begin(size_t i) const
+    {
+        return in_offsets_[i];
+    }
+    PGMLINK_EXPORT size_t in_end(size_t i) const
+    {
+        return in_offsets_[i + 1];
+    }
+    PGMLINK_EXPORT size_t in_degree(size_t i) const
+    {
+        return in_offsets_[i + 1] - in_offsets_[i];
+    }
+    PGMLINK_EXPORT size_t in_arc(size_t k) const
+    {
+        return in_arcs_[k];
+    }
+    PGMLINK_EXPORT Arc arc(size_t a) const
+    {
+        return arcs_[a];
+    }
+    PGMLINK_EXPORT size_t index(Arc a) const
+    {
+        return arc_index_[graph_.id(a)];
+    }
+    PGMLINK_EXPORT size_t source(size_t a) const
+    {
+        return arc_sources_[a];
+    }
+    PGMLINK_EXPORT size_t target(size_t a) const
+    {
+        return arc_targets_[a];
+    }
+
+private:
+    const HypothesesGraph& graph_;
+    int earliest_timestep_;
+
+    // nodes of timestep earliest_timestep_ + k are [timestep_offsets_[k], timestep_offsets_[k + 1])
+    std::vector<size_t> timestep_offsets_;
+    std::vector<Node> nodes_;
+    std::vector<int> node_timesteps_;
+    std::vector<unsigned int> traxel_ids_;
+    // indexed by lemon id
+    std::vector<size_t> node_index_;
+
+    std::vector<size_t> out_offsets_;
+    std::vector<Arc> arcs_;
+    std::vector<size_t> arc_sources_;
+    std::vector<size_t> arc_targets_;
+    std::vector<size_t> arc_index_;
+
+    std::vector<size_t> in_offsets_;
+    std::vector<size_t> in_arcs_;
+};
+
+/**
+ * The solutions stored in the property maps of a hypotheses graph, indexed like
+ * the nodes and arcs of a FrozenHypothesesGraph.
+ *
+ * Reads node_active_count / arc_active_count / division_active_count if present
+ * (one column per stored solution), otherwise the single solution in
+ * node_active2 or node_active, arc_active and division_active. Node counts of
+ * one-solution graphs are returned for every iteration.
+ *
+ * The second constructor freezes only some iterations and timesteps, so
+ * callers that go through the solutions one by one can share one
+ * FrozenHypothesesGraph and pay for the part they read.
+ */
+class FrozenSolution
+{
+public:
+    static const unsigned int no_origin = static_cast<unsigned int>(-1);
+
+    /// all iterations of all nodes and arcs
+    PGMLINK_EXPORT explicit FrozenSolution(const FrozenHypothesesGraph& frozen);
+    /**
+     * The iterations [first_iteration, first_iteration + num_iterations) of the
+     * nodes in the timesteps [first_timestep, last_timestep] and of their
+     * incoming and outgoing arcs, both clamped to what the graph holds. The
+     * accessors must not be called for other nodes, arcs or iterations.
+     */
+    PGMLINK_EXPORT FrozenSolution(const FrozenHypothesesGraph& frozen,
+                                  size_t first_iteration,
+                                  size_t num_iterations,
+                                  int first_timestep,
+                                  int last_timestep);
+
+    /// all solutions stored in the graph, not only the frozen ones
+    PGMLINK_EXPORT size_t n_iterations() const
+    {
+        return n_iterations_;
+    }
+    PGMLINK_EXPORT bool with_mergers() const
+    {
+        return with_mergers_;
+    }
+    PGMLINK_EXPORT bool with_division_detection() const
+    {
+        return with_division_detection_;
+    }
+    PGMLINK_EXPORT bool with_origin() const
+    {
+        return with_origin_;
+    }
+
+    PGMLINK_EXPORT size_t node_active(size_t i, size_t iteration) const
+    {
+        return node_active_[(i - node_begin_) * n_columns_ + column(iteration)];
+    }
+    PGMLINK_EXPORT bool arc_active(size_t a, size_t iteration) const
+    {
+        return arc_active_[(a - arc_begin_) * n_columns_ + column(iteration)];
+    }
+    PGMLINK_EXPORT bool division_active(size_t i, size_t iteration) const
+    {
+        return division_active_[(i - node_begin_) * n_columns_ + column(iteration)];
+    }
+    /// first traxel id the node originated from, no_origin if none
+    PGMLINK_EXPORT unsigned int origin(size_t i) const
+    {
+        return with_origin_ ? origins_[i - node_begin_] : no_origin;
+    }
+
+    /// fraction of all solutions that disagree with the given one, 0 for single solutions;
+    /// only for arcs / divisions active in one of the frozen iterations
+    PGMLINK_EXPORT double arc_uncertainty(size_t a, size_t iteration) const;
+    PGMLINK_EXPORT double division_uncertainty(size_t i, size_t iteration) const;
+
+private:
+    size_t column(size_t iteration) const
+    {
+        return per_iteration_ ? iteration - first_iteration_ : 0;
+    }
+    void read(const FrozenHypothesesGraph& frozen,
+              size_t first_iteration,
+              size_t num_iterations,
+              int first_timestep,
+              int last_timestep);
+    template<typename Map, typename Key>
+    size_t count_active(const Map& map, const Key& key) const;
+    template<typename T>
+    double uncertainty(const std::vector<T>& values, const std::vector<size_t>& votes,
+                       size_t row, size_t iteration) const;
+
+    size_t n_iterations_;
+    size_t first_iteration_;
+    // 1 for graphs with a single solution, the number of frozen iterations otherwise
+    size_t n_columns_;
+    bool per_iteration_;
+    bool with_mergers_;
+    bool with_division_detection_;
+    bool with_origin_;
+
+    // the frozen nodes are [node_begin_, node_begin_ + #rows), the arcs likewise
+    size_t node_begin_;
+    size_t arc_begin_;
+
+    // row-major, n_columns_ entries per node / arc
+    std::vector<size_t> node_active_;
+    std::vector<uint8_t> arc_active_;
+    std::vector<uint8_t> division_active_;
+    std::vector<unsigned int> origins_;
+    // number of active iterations out of n_iterations_, see arc_uncertainty()
+    std::vector<size_t> arc_votes_;
+    std::vector<size_t> division_votes_;
+};
+
+} /* namespace pgmlink */
+
+#endif /* FROZEN_HYPOTHESES_GRAPH_H */
@@ -9,6 +9,7 @@
 
 #include <vector>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <map>
@@ -22,6 +23,7 @@
 #include "graph.h"
 #include "log.h"
 #include "pgmlink_export.h"
+#include "solution_matrix.h"
 #include "traxels.h"
 
 namespace pgmlink
@@ -123,7 +125,7 @@ struct node_active_count {};
 template <typename Graph>
 struct property_map<node_active_count, Graph>
 {
-    typedef IterableEditableValueMap< Graph, typename Graph::Node, std::vector<size_t> > type;
+    typedef SolutionCountMap< Graph, typename Graph::Node, size_t > type;
     //typedef lemon::IterableIntMap< Graph, typename Graph::Node> type;
     static const std::string name;
 };
@@ -135,7 +137,7 @@ struct arc_active_count {};
 template <typename Graph>
 struct property_map<arc_active_count, Graph>
 {
-    typedef IterableEditableValueMap< Graph, typename Graph::Arc, std::vector<bool> > type;
+    typedef SolutionCountMap< Graph, typename Graph::Arc, bool > type;
     //typedef lemon::IterableIntMap< Graph, typename Graph::Arc> type;
     static const std::string name;
 };
@@ -147,7 +149,7 @@ struct arc_value_count {};
 template <typename Graph>
 struct property_map<arc_value_count, Graph>
 {
-    typedef IterableEditableValueMap< Graph, typename Graph::Arc, std::vector<size_t> > type;
+    typedef SolutionCountMap< Graph, typename Graph::Arc, size_t > type;
     //typedef lemon::IterableIntMap< Graph, typename Graph::Arc> type;
     static const std::string name;
 };
@@ -159,7 +161,7 @@ struct division_active_count {};
 template <typename Graph>
 struct property_map<division_active_count, Graph>
 {
-    typedef IterableEditableValueMap< Graph, typename Graph::Node, std::vector<bool> > type;
+    typedef SolutionCountMap< Graph, typename Graph::Node, bool > type;
     static const std::string name;
 };
 template <typename Graph>
@@ -409,6 +411,9 @@ struct property_map<arc_origin_reference, Graph>
 template <typename Graph>
 const std::string property_map<arc_origin_reference, Graph>::name = "arc_origin_reference";
 
+class TrackletView;
+class FrozenHypothesesGraph;
+
 class HypothesesGraph
     : public PropertyGraph<lemon::ListDigraph>
 {
@@ -479,6 +484,10 @@ public:
                                    boost::function<double (const Traxel&)> appearance_cost,
                                    size_t max_number_objects,
                                    double transition_parameter) const;
+
+    // tracklets of a tracklet graph, see TrackletView
+    PGMLINK_EXPORT void set_tracklet_view(boost::shared_ptr<const TrackletView> view);
+    PGMLINK_EXPORT const TrackletView& tracklets() const;
 private:
     void initialize_node(HypothesesGraph::Node n);
 
@@ -491,17 +500,167 @@ private:
     BOOST_SERIALIZATION_SPLIT_MEMBER()
 
     std::set<node_timestep_map::Value> timesteps_;
+    // not copied or serialized, created on demand for graphs with a node_tracklet map
+    mutable boost::shared_ptr<const TrackletView> tracklet_view_;
+};
+
+/**
+ * @brief Traxels of each tracklet node as a contiguous range of traxel nodes
+ * of the traxel graph the tracklet graph was generated from.
+ *
+ * The view does not copy traxels, front(), back() and traxel() return
+ * references into the node_traxel map of the traxel graph, which therefore
+ * has to outlive the view. Tracklet graphs that only carry a node_tracklet
+ * map (e.g. created by generateTrackletGraph2() or read from disk) are
+ * wrapped by a view reading from that map instead.
+ */
+class TrackletView
+{
+public:
+    typedef HypothesesGraph::Node Node;
+
+    /// view on the node_tracklet, tracklet_intern_dist and tracklet_intern_arc_ids maps of a tracklet graph
+    PGMLINK_EXPORT explicit TrackletView(const HypothesesGraph& tracklet_graph);
+
+    PGMLINK_EXPORT size_t size(const Node& tracklet) const;
+    PGMLINK_EXPORT const Traxel& traxel(const Node& tracklet, size_t i) const;
+    PGMLINK_EXPORT const Traxel& front(const Node& tracklet) const
+    {
+        return traxel(tracklet, 0);
+    }
+    PGMLINK_EXPORT const Traxel& back(const Node& tracklet) const
+    {
+        return traxel(tracklet, size(tracklet) - 1);
+    }
+
+    /// distance and traxel graph arc id of the arc from traxel i to traxel i+1 of the tracklet
+    PGMLINK_EXPORT double intern_dist(const Node& tracklet, size_t i) const;
+    PGMLINK_EXPORT int intern_arc_id(const Node& tracklet, size_t i) const;
+
+    /// true if traxels are referenced in the traxel graph instead of being stored in the tracklet graph
+    PGMLINK_EXPORT bool references_traxel_graph() const
+    {
+        return traxel_graph_ != NULL;
+    }
+    /// traxel node i of the tracklet, only available if references_traxel_graph()
+    PGMLINK_EXPORT Node traxel_node(const Node& tracklet, size_t i) const;
+    PGMLINK_EXPORT std::map<Node, std::vector<Node> > tracklet2traxel_node_map() const;
+
+private:
+    typedef property_map<node_traxel, HypothesesGraph::base_graph>::type traxel_map_type;
+    typedef property_map<node_tracklet, HypothesesGraph::base_graph>::type tracklet_map_type;
+
+    TrackletView(const HypothesesGraph& traxel_graph, const HypothesesGraph& tracklet_graph);
+    size_t begin(const Node& tracklet) const
+    {
+        return ranges_[tracklet_graph_->id(tracklet)].first;
+    }
+
+    friend boost::shared_ptr<const TrackletView> generateTrackletView(
+        const HypothesesGraph&, HypothesesGraph&);
+
+    const HypothesesGraph* traxel_graph_;
+    const HypothesesGraph* tracklet_graph_;
+    const traxel_map_type* traxel_map_;
+    const tracklet_map_type* tracklet_map_;
+
+    // [begin, end) into the arrays below, indexed by tracklet node id
+    std::vector<std::pair<size_t, size_t> > ranges_;
+    std::vector<Node> traxel_nodes_;
+    // entry k belongs to the arc leaving traxel_nodes_[k], unused for the last traxel of a tracklet
+    std::vector<double> intern_dists_;
+    std::vector<int> intern_arc_ids_;
 };
 
+/**
+ * @brief build the tracklet graph of a traxel graph in one pass over its nodes.
+ *
+ * Consecutive traxels connected by the only outgoing arc of the first and the
+ * only incoming arc of the second are contracted into one tracklet node. The
+ * tracklet graph gets node_timestep, node_traxel (empty), arc_distance,
+ * traxel_arc_id and the label maps, its traxels are accessible through the
+ * returned view which is also attached to the tracklet graph (see
+ * HypothesesGraph::tracklets()).
+ */
+PGMLINK_EXPORT boost::shared_ptr<const TrackletView> generateTrackletView(
+    const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph);
+
 PGMLINK_EXPORT void generateTrackletGraph(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph);
 PGMLINK_EXPORT std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> > generateTrackletGraph2(
     const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph);
 PGMLINK_EXPORT HypothesesGraph& prune_inactive(HypothesesGraph&);
-PGMLINK_EXPORT boost::shared_ptr<std::vector< std::vector<Event> > > events(const HypothesesGraph& g, int iterationStep = 0);
+/**
+ * Events of solution iterationStep, one vector per timestep in
+ * [first_timestep, last_timestep] (clamped to the timesteps of the graph).
+ */
+PGMLINK_EXPORT boost::shared_ptr<std::vector< std::vector<Event> > > events(const HypothesesGraph& g,
+                                                                            int iterationStep = 0,
+                                                                            int first_timestep = std::numeric_limits<int>::min(),
+                                                                            int last_timestep = std::numeric_limits<int>::max());
+/**
+ * events() on a graph frozen by the caller, see FrozenHypothesesGraph. Callers
+ * that go through several iterations freeze the graph once and pass it in; only
+ * the requested iteration and timesteps of the solution are copied per call.
+ */
+PGMLINK_EXPORT boost::shared_ptr<std::vector< std::vector<Event> > > events(const FrozenHypothesesGraph& frozen,
+                                                                            int iterationStep = 0,
+                                                                            int first_timestep = std::numeric_limits<int>::min(),
+                                                                            int last_timestep = std::numeric_limits<int>::max());
+/**
+ * Events of the first num_iterations solutions (all stored solutions if 0) in the
+ * timesteps [first_timestep, last_timestep]. Equivalent to calling events() for every
+ * iteration, but the graph is traversed only once and the timesteps are processed in
+ * parallel. The rows are ordered by iteration and timestep.
+ */
+PGMLINK_EXPORT boost::shared_ptr<EventTable> event_table(const HypothesesGraph& g,
+                                                         size_t num_iterations = 0,
+                                                         int first_timestep = std::numeric_limits<int>::min(),
+                                                         int last_timestep = std::numeric_limits<int>::max());
+PGMLINK_EXPORT boost::shared_ptr<EventTable> event_table(const FrozenHypothesesGraph& frozen,
+                                                         size_t num_iterations = 0,
+                                                         int first_timestep = std::numeric_limits<int>::min(),
+                                                         int last_timestep = std::numeric_limits<int>::max());
+/**
+ * event_table() as nested vectors, indexed [iteration][timestep - first_timestep].
+ */
+PGMLINK_EXPORT boost::shared_ptr<EventVectorVectorVector> multi_events(const HypothesesGraph& g,
+                                                                       size_t num_iterations = 0,
+                                                                       int first_timestep = std::numeric_limits<int>::min(),
+                                                                       int last_timestep = std::numeric_limits<int>::max());
+PGMLINK_EXPORT boost::shared_ptr<EventVectorVectorVector> multi_events(const FrozenHypothesesGraph& frozen,
+                                                                       size_t num_iterations = 0,
+                                                                       int first_timestep = std::numeric_limits<int>::min(),
+                                                                       int last_timestep = std::numeric_limits<int>::max());
 PGMLINK_EXPORT boost::shared_ptr<std::vector< std::vector<Event> > > multi_frame_move_events(const HypothesesGraph& g);
 PGMLINK_EXPORT boost::shared_ptr<std::vector< std::vector<Event> > > resolved_to_events(const HypothesesGraph& g);
 PGMLINK_EXPORT EventVectorVector merge_event_vectors(const EventVectorVector& ev1, const EventVectorVector& ev2);
 PGMLINK_EXPORT boost::shared_ptr<std::vector< std::map<unsigned int, bool> > > state_of_nodes(const HypothesesGraph&);
+
+/**
+   \brief Solution state of a HypothesesGraph in contiguous arrays.
+
+   Rows follow the order of NodeIt / ArcIt. The active count matrices are
+   row-major with n_iterations columns, graphs that only hold a single
+   solution (node_active2 / arc_active) yield one column.
+*/
+struct HypothesesGraphState
+{
+    HypothesesGraphState() : n_iterations(0) {}
+
+    size_t n_iterations;
+
+    std::vector<int> node_ids;
+    std::vector<int> node_timesteps;
+    std::vector<unsigned int> node_traxel_ids;
+    std::vector<size_t> node_active_count;
+    std::vector<double> relative_uncertainty;
+
+    std::vector<int> arc_ids;
+    std::vector<int> arc_sources;
+    std::vector<int> arc_targets;
+    std::vector<uint8_t> arc_active_count;
+};
+PGMLINK_EXPORT boost::shared_ptr<HypothesesGraphState> hypotheses_graph_state(const HypothesesGraph&);
 // prune to specific start nodes
 PGMLINK_EXPORT HypothesesGraph& prune_to_node_descendants(HypothesesGraph& graph, const std::vector<HypothesesGraph::Node>& start_nodes);
 PGMLINK_EXPORT HypothesesGraph& set_descendants_active(HypothesesGraph& graph, const HypothesesGraph::Node& start_node);
@@ -529,6 +688,8 @@ protected:
 
 
 
+class OutOfCoreTraxelStore;
+
 ////
 //// SingleTimestepTraxel_HypothesesBuilder
 ////
@@ -553,9 +714,21 @@ public:
     };
 
     PGMLINK_EXPORT SingleTimestepTraxel_HypothesesBuilder(const TraxelStore* ts, const Options& o = Options())
-        : ts_(ts), options_(o)
+        : ts_(ts), options_(o), store_(NULL)
     {}
 
+    /**
+     * Build from an out-of-core store, which only has to hold the frames t
+     * and t + 1 at a time. The traxels in the graph keep only the resident
+     * features, which are copied into resident_fs. The features the graph
+     * construction reads are always resident: "com", "com_corrected" (if
+     * present) and "divProb" if divisions are considered.
+     */
+    PGMLINK_EXPORT SingleTimestepTraxel_HypothesesBuilder(const OutOfCoreTraxelStore* store,
+            boost::shared_ptr<FeatureStore> resident_fs,
+            const Options& o = Options(),
+            const std::vector<std::string>& resident_features = std::vector<std::string>());
+
 protected:
     // builder method implementations
     PGMLINK_EXPORT virtual HypothesesGraph* construct() const;
@@ -564,12 +737,60 @@ protected:
 
     const TraxelStore* ts_;
     Options options_;
+    const OutOfCoreTraxelStore* store_;
+    boost::shared_ptr<FeatureStore> resident_fs_;
+    std::vector<std::string> resident_features_;
 private:
     HypothesesGraph* add_edges_at(HypothesesGraph*, int timestep, bool reverse = false) const;
 };
 
 
 
+class NearestNeighborSearch;
+
+////
+//// IncrementalHypothesesBuilder
+////
+/**
+ * Builds the graph of SingleTimestepTraxel_HypothesesBuilder one timestep at a
+ * time, e.g. while the frames of a live experiment are acquired.
+ *
+ * add_timestep() adds the nodes of one frame and connects them to the previous
+ * frame. Only the previous frame's nodes and its nearest neighbor index are
+ * kept, so the cost of a call is proportional to the sizes of the two frames
+ * and does not grow with the length of the graph.
+ */
+class IncrementalHypothesesBuilder
+{
+public:
+    typedef SingleTimestepTraxel_HypothesesBuilder::Options Options;
+
+    /// start an empty graph
+    PGMLINK_EXPORT explicit IncrementalHypothesesBuilder(const Options& o = Options());
+    PGMLINK_EXPORT ~IncrementalHypothesesBuilder();
+
+    /// add the traxels of the next frame, which must all have the same
+    /// timestep, later than the one of the previous call. Arcs are only added
+    /// between consecutive timesteps. An empty frame is ignored.
+    PGMLINK_EXPORT void add_timestep(const std::vector<Traxel>& traxels);
+
+    PGMLINK_EXPORT boost::shared_ptr<HypothesesGraph> get_graph() const;
+
+private:
+    typedef std::map<unsigned int, HypothesesGraph::Node> NodeById;
+
+    boost::shared_ptr<HypothesesGraph> graph_;
+    Options options_;
+    bool has_previous_;
+    int previous_timestep_;
+    std::vector<HypothesesGraph::Node> previous_nodes_;
+    NodeById previous_node_by_id_;
+    // index of the previous frame for the backward nearest neighbors
+    boost::shared_ptr<NearestNeighborSearch> previous_reverse_nns_;
+};
+
+
+
 
 /**/
 /* implementation */
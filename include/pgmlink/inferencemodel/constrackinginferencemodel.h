@@ -13,7 +13,9 @@
 #include "pgmlink/inferencemodel/constraint_pool.hxx"
 #endif
 
+#include "pgmlink/dense_id_map.h"
 #include "pgmlink/hypotheses.h"
+#include "pgmlink/frozen_hypotheses_graph.h"
 #include "pgmlink/pgm.h"
 #include "pgmlink/inferencemodel/inferencemodel.h"
 #include "../pgmlink_export.h"
@@ -40,8 +42,9 @@ public:
     typedef opengm::LPCplex<PertGmType, pgm::OpengmModelDeprecated::ogmAccumulator> cplex_optimizer;
     typedef opengm::LPCplex2<PertGmType, opengm::Minimizer> cplex2_optimizer;
 #endif
-    typedef std::map<HypothesesGraph::Node, size_t> HypothesesGraphNodeMap;
-    typedef std::map<HypothesesGraph::Arc, size_t> HypothesesGraphArcMap;
+    // lemon id -> opengm variable (or factor) index and back, see DenseIdMap
+    typedef DenseIdMap<HypothesesGraph::Node> HypothesesGraphNodeMap;
+    typedef DenseIdMap<HypothesesGraph::Arc> HypothesesGraphArcMap;
 
 public: // API
     // constructor
@@ -66,6 +69,11 @@ public: // API
     PGMLINK_EXPORT IlpSolution extractSolution(size_t k, const std::string& ground_truth_filename);
     PGMLINK_EXPORT void set_starting_point(const IlpSolution& solution);
 
+    /// Diverse m-best without rebuilding the model: raise the energy of the given solution in every
+    /// finite factor by the weight of the factor's EnergyType, as a DivMBestPerturbation would.
+    /// Takes effect with the next set_inference_params().
+    PGMLINK_EXPORT void push_away_from_solution(const IlpSolution& solution, const std::vector<double>& weights);
+
     // write or extract results to hypotheses graph
     virtual PGMLINK_EXPORT void conclude(HypothesesGraph &g,
                           HypothesesGraph &tracklet_graph,
@@ -103,6 +111,9 @@ protected:
 
     virtual void add_constraints_to_pool(const HypothesesGraph& );
 
+    // CSR copy of g for the loops over nodes and their arcs, built on first use while building the model
+    const FrozenHypothesesGraph& get_frozen_graph(const HypothesesGraph& g);
+
     GraphicalModelType::FunctionIdentifier add_marray_as_explicit_function(
         const std::vector<size_t>& shape,
         const marray::Marray<double>& energies);
@@ -112,7 +123,7 @@ protected:
     HypothesesGraphNodeMap& get_appearance_node_map();
     HypothesesGraphNodeMap& get_disappearance_node_map();
     HypothesesGraphArcMap& get_arc_map();
-    std::map<HypothesesGraph::Node, size_t>& get_detection_factor_node_map();
+    HypothesesGraphNodeMap& get_detection_factor_node_map();
 
     template<class INF>
     void add_constraints(INF& optimizer);
@@ -126,12 +137,17 @@ protected:
     HypothesesGraphNodeMap app_node_map_;
     HypothesesGraphNodeMap dis_node_map_;
     HypothesesGraphArcMap arc_map_;
-    std::map<HypothesesGraph::Node, size_t> detection_f_node_map_;
+    HypothesesGraphNodeMap detection_f_node_map_;
+    // finite factors are added as detection, transition, division blocks
+    size_t first_transition_factor_, first_division_factor_;
+    boost::shared_ptr<const FrozenHypothesesGraph> frozen_graph_;
 
 #ifndef NO_ILP
     cplex_optimizer::Parameter cplex_param_;
     boost::shared_ptr<cplex_optimizer> optimizer_;
     pgm::ConstraintPool constraint_pool_;
+    // optimizer_ holds the core constraints only, see Parameter::lazy_constraints
+    bool lazy_constraints_;
 
     cplex2_optimizer::Parameter cplex2_param_;
     boost::shared_ptr<cplex2_optimizer> optimizer2_;
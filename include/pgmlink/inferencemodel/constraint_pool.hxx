@@ -68,6 +68,17 @@ public:
     template<class GM, class INF>
     void add_constraints_to_model(GM& model, INF& optimizer);
 
+    /// Lazy variant of add_constraints_to_problem: only the detection and fix-node-value
+    /// constraints are added, the incoming and outgoing constraints are held back until
+    /// add_violated_constraints_to_problem() finds a labeling that violates them.
+    template<class GM, class INF>
+    void add_core_constraints_to_problem(GM& model, INF& optimizer);
+
+    /// Add those held back constraints that are violated by the given labeling.
+    /// Returns the number of added constraints, 0 if the labeling satisfies the whole pool.
+    template<class GM, class INF>
+    size_t add_violated_constraints_to_problem(GM& model, INF& optimizer, const std::vector<LabelType>& labeling);
+
     /// Allow to add this set of constraints to a different model with the given index mapping (key is index of variable in original model)
     /// Only those constraints or functions are instanciated where all participating indices do have a mapping
     template<class GM, class INF>
@@ -283,6 +294,19 @@ protected:
 
     template<class CONSTRAINT_TYPE>
     bool check_all_constraint_vars_in_mapping(std::map<size_t, size_t>& index_mapping, const CONSTRAINT_TYPE& constraint);
+
+    // same conditions as the hard constraints added to CPLEX
+    template<class GM>
+    bool is_violated(const GM& model, const IncomingConstraint& constraint, const std::vector<LabelType>& labeling) const;
+    template<class GM>
+    bool is_violated(const GM& model, const OutgoingConstraint& constraint, const std::vector<LabelType>& labeling) const;
+
+    template<class GM, class CONSTRAINT_TYPE>
+    void collect_violated_constraints(const GM& model,
+                                      const std::vector<LabelType>& labeling,
+                                      const std::vector<CONSTRAINT_TYPE>& constraints,
+                                      std::vector<bool>& added,
+                                      std::vector<CONSTRAINT_TYPE>& violated) const;
 protected:
     std::vector<IncomingConstraint> incoming_constraints_;
     std::vector<OutgoingConstraint> outgoing_constraints_;
@@ -304,6 +328,11 @@ protected:
 
     bool force_softconstraint_;
 
+    // which incoming / outgoing constraints are already part of the problem in lazy mode
+    std::vector<bool> incoming_added_;
+    std::vector<bool> outgoing_added_;
+    std::vector<bool> outgoing_no_div_added_;
+
 private:
     // boost serialization interface
     PGMLINK_EXPORT friend class boost::serialization::access;
@@ -367,6 +396,113 @@ void ConstraintPool::add_constraints_to_model(GM& model, INF& inf)
     add_constraint_type_to_model<GM, INF, FixNodeValueLinearConstraintFunction<ValueType, IndexType, LabelType>, FixNodeValueLinearConstraint>(model, inf, fix_node_value_linear_constraints_);
 }
 
+template<class GM, class INF>
+void ConstraintPool::add_core_constraints_to_problem(GM& model, INF& inf)
+{
+    incoming_added_.assign(incoming_constraints_.size(), false);
+    outgoing_added_.assign(outgoing_constraints_.size(), false);
+    outgoing_no_div_added_.assign(outgoing_no_div_constraints_.size(), false);
+
+    add_constraint_type_to_problem<GM, INF, DetectionConstraintFunction<ValueType, IndexType, LabelType>, DetectionConstraint>(model, inf, detection_constraints_);
+    add_constraint_type_to_problem<GM, INF, FixNodeValueConstraintFunction<ValueType, IndexType, LabelType>, FixNodeValueConstraint>(model, inf, fix_node_value_constraints_);
+}
+
+template<class GM, class INF>
+size_t ConstraintPool::add_violated_constraints_to_problem(GM& model, INF& inf, const std::vector<LabelType>& labeling)
+{
+    std::vector<IncomingConstraint> violated_incoming_constraints;
+    std::vector<OutgoingConstraint> violated_outgoing_constraints;
+    std::vector<OutgoingConstraint> violated_outgoing_no_div_constraints;
+
+    collect_violated_constraints(model, labeling, incoming_constraints_, incoming_added_, violated_incoming_constraints);
+    collect_violated_constraints(model, labeling, outgoing_constraints_, outgoing_added_, violated_outgoing_constraints);
+    collect_violated_constraints(model, labeling, outgoing_no_div_constraints_, outgoing_no_div_added_, violated_outgoing_no_div_constraints);
+
+    add_constraint_type_to_problem<GM, INF, IncomingConstraintFunction<ValueType, IndexType, LabelType>, IncomingConstraint>(model, inf, violated_incoming_constraints);
+    add_constraint_type_to_problem<GM, INF, OutgoingConstraintFunction<ValueType, IndexType, LabelType>, OutgoingConstraint>(model, inf, violated_outgoing_constraints);
+    add_constraint_type_to_problem<GM, INF, OutgoingNoDivConstraintFunction<ValueType, IndexType, LabelType>, OutgoingConstraint>(model, inf, violated_outgoing_no_div_constraints);
+
+    return violated_incoming_constraints.size() + violated_outgoing_constraints.size() + violated_outgoing_no_div_constraints.size();
+}
+
+template<class GM, class CONSTRAINT_TYPE>
+void ConstraintPool::collect_violated_constraints(const GM& model,
+        const std::vector<LabelType>& labeling,
+        const std::vector<CONSTRAINT_TYPE>& constraints,
+        std::vector<bool>& added,
+        std::vector<CONSTRAINT_TYPE>& violated) const
+{
+    // constraints that came in after add_core_constraints_to_problem() are pending as well
+    added.resize(constraints.size(), false);
+    for(size_t i = 0; i < constraints.size(); ++i)
+    {
+        if(!added[i] && is_violated(model, constraints[i], labeling))
+        {
+            violated.push_back(constraints[i]);
+            added[i] = true;
+        }
+    }
+}
+
+template<class GM>
+bool ConstraintPool::is_violated(const GM&, const IncomingConstraint& constraint, const std::vector<LabelType>& labeling) const
+{
+    if(constraint.transition_nodes.empty())
+    {
+        return false;
+    }
+
+    // sum(Y_ij) = Dis_j
+    LabelType sum = 0;
+    for(auto t : constraint.transition_nodes)
+    {
+        sum += labeling[t];
+    }
+    return sum != labeling[constraint.disappearance_node];
+}
+
+template<class GM>
+bool ConstraintPool::is_violated(const GM& model, const OutgoingConstraint& constraint, const std::vector<LabelType>& labeling) const
+{
+    if(constraint.transition_nodes.empty())
+    {
+        return false;
+    }
+
+    const LabelType appearance = labeling[constraint.appearance_node];
+    const bool division = with_divisions_ && constraint.division_node >= 0 && labeling[constraint.division_node] == 1;
+
+    LabelType sum = 0;
+    size_t num_single_transitions = 0;
+    for(auto t : constraint.transition_nodes)
+    {
+        const LabelType transition = labeling[t];
+        // Y_ij <= App_i, the highest transition state is only bounded by the sum below
+        if(transition > appearance && transition + 1 < model.numberOfLabels(t))
+        {
+            return true;
+        }
+        // D_i = 1 => Y_ij <= 1
+        if(division && transition > 1)
+        {
+            return true;
+        }
+        sum += transition;
+        if(transition == 1)
+        {
+            ++num_single_transitions;
+        }
+    }
+
+    // sum(Y_ij) = D_i + App_i
+    if(sum != appearance + (division ? 1 : 0))
+    {
+        return true;
+    }
+    // D_i = 1 => App_i = 1 and at least two children
+    return division && (appearance != 1 || num_single_transitions < 2);
+}
+
 template<class GM, class INF>
 void ConstraintPool::add_constraints_to_problem(GM& model, INF& inf, std::map<size_t, size_t>& index_mapping)
 {
@@ -98,13 +98,12 @@ template<class ArcIterator>
 double DynProgConsTrackInferenceModel::getTransitionArcScore(const HypothesesGraph& g, ArcIterator a)
 {
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = g.get(node_tracklet());
 
     Traxel tr1, tr2;
     if (param_.with_tracklets)
     {
-        tr1 = tracklet_map[g.source(a)].back();
-        tr2 = tracklet_map[g.target(a)].front();
+        tr1 = g.tracklets().back(g.source(a));
+        tr2 = g.tracklets().front(g.target(a));
     }
     else
     {
@@ -0,0 +1,152 @@
+/**
+   @file
+   @ingroup util
+   @brief per-stage timing and memory instrumentation
+*/
+
+#ifndef PGMLINK_INSTRUMENTATION_H
+#define PGMLINK_INSTRUMENTATION_H
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "pgmlink_export.h"
+
+namespace pgmlink
+{
+
+/**
+ * @brief Accumulated measurements of one named pipeline stage
+ * (e.g. "build_hypotheses_graph", "solve", "conclude").
+ *
+ * Memory figures are in kilobytes. peak_rss_kb is the process high water mark
+ * observed when the stage finished last, heap_delta_kb the summed change of
+ * heap memory in use over all calls of the stage.
+ */
+struct StageStatistics
+{
+    StageStatistics()
+        : calls(0), wall_seconds(0.), peak_rss_kb(0), heap_delta_kb(0)
+    {}
+
+    std::string name;
+    size_t calls;
+    double wall_seconds;
+    long peak_rss_kb;
+    long heap_delta_kb;
+    std::map<std::string, size_t> counters;
+};
+
+/**
+ * @brief Process wide registry of stage measurements.
+ *
+ * Disabled by default. While disabled, StageTimer and the counter setters
+ * only test a flag, so the instrumentation can stay in the hot paths.
+ *
+ * @code
+ * Instrumentation::instance().enable(true);
+ * tracker.track(...);
+ * Instrumentation::instance().dump_json("timings.json");
+ * @endcode
+ */
+class Instrumentation
+{
+public:
+    PGMLINK_EXPORT static Instrumentation& instance();
+
+    PGMLINK_EXPORT void enable(bool enabled);
+    bool enabled() const
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+    PGMLINK_EXPORT void reset();
+
+    PGMLINK_EXPORT void add_stage_time(const std::string& stage,
+                                       double seconds,
+                                       long heap_delta_kb);
+    PGMLINK_EXPORT void set_counter(const std::string& stage,
+                                    const std::string& counter,
+                                    size_t value);
+    PGMLINK_EXPORT void add_counter(const std::string& stage,
+                                    const std::string& counter,
+                                    size_t value);
+
+    /// stages in the order they were first recorded
+    PGMLINK_EXPORT std::vector<StageStatistics> stages() const;
+    PGMLINK_EXPORT std::string to_json() const;
+    PGMLINK_EXPORT void dump_json(const std::string& filename) const;
+
+    /// high water mark of the resident set size of this process
+    PGMLINK_EXPORT static long peak_rss_kb();
+    /// heap memory currently in use, 0 where this is not available
+    PGMLINK_EXPORT static long heap_in_use_kb();
+    /// s quoted for use inside a JSON string
+    PGMLINK_EXPORT static std::string json_escape(const std::string& s);
+
+private:
+    Instrumentation();
+    Instrumentation(const Instrumentation&);
+    Instrumentation& operator=(const Instrumentation&);
+
+    StageStatistics& stage(const std::string& name);
+
+    std::atomic<bool> enabled_;
+    mutable std::mutex mutex_;
+    std::vector<StageStatistics> stages_;
+    std::map<std::string, size_t> stage_index_;
+};
+
+/**
+ * @brief RAII timer that adds its lifetime to the named stage.
+ */
+class StageTimer
+{
+public:
+    explicit StageTimer(const std::string& stage)
+        : active_(Instrumentation::instance().enabled())
+    {
+        if(active_)
+        {
+            stage_ = stage;
+            heap_before_kb_ = Instrumentation::heap_in_use_kb();
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~StageTimer()
+    {
+        if(active_)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_;
+            Instrumentation::instance().add_stage_time(stage_,
+                    elapsed.count(),
+                    Instrumentation::heap_in_use_kb() - heap_before_kb_);
+        }
+    }
+
+private:
+    StageTimer(const StageTimer&);
+    StageTimer& operator=(const StageTimer&);
+
+    bool active_;
+    std::string stage_;
+    long heap_before_kb_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/// record a count (nodes, arcs, factors, ...) for a stage if instrumentation is enabled
+inline void instrument_count(const std::string& stage, const std::string& counter, size_t value)
+{
+    if(Instrumentation::instance().enabled())
+    {
+        Instrumentation::instance().set_counter(stage, counter, value);
+    }
+}
+
+} /* namespace pgmlink */
+
+#endif /* PGMLINK_INSTRUMENTATION_H */
@@ -0,0 +1,55 @@
+/**
+   @file
+   @ingroup tracking
+   @brief sparse linear assignment between two sets of objects
+*/
+
+#ifndef LINEAR_ASSIGNMENT_H
+#define LINEAR_ASSIGNMENT_H
+
+#include <vector>
+
+#include "pgmlink_export.h"
+
+namespace pgmlink
+{
+
+/// a possible assignment of row to col at the given cost
+struct AssignmentCandidate
+{
+    AssignmentCandidate(size_t row = 0, size_t col = 0, double cost = 0.)
+        : row(row), col(col), cost(cost)
+    {}
+
+    size_t row, col;
+    double cost;
+};
+
+/**
+ * Minimum cost assignment between n_rows and n_cols objects over a sparse set
+ * of candidates.
+ *
+ * Every row is assigned to at most one col and vice versa. A row or col that
+ * is left unassigned costs unassigned_row_cost or unassigned_col_cost; in
+ * tracking these are the disappearance and appearance costs of the dummy rows
+ * and cols of the usual square cost matrix. Hence a candidate is only
+ * worth taking if its cost is below the sum of both unassigned costs.
+ *
+ * Solved with shortest augmenting paths and dual potentials, the core of the
+ * Jonker-Volgenant algorithm, one row at a time. Each row has a private
+ * dummy col to fall back to, so the searches stay within the candidates
+ * around the row and the runtime grows with the number of candidates instead
+ * of n_rows * n_cols.
+ *
+ * Returns the col assigned to each row, or -1 for unassigned rows. Throws
+ * std::runtime_error if a candidate is out of range.
+ */
+PGMLINK_EXPORT std::vector<int> solve_sparse_assignment(size_t n_rows,
+        size_t n_cols,
+        const std::vector<AssignmentCandidate>& candidates,
+        double unassigned_row_cost,
+        double unassigned_col_cost);
+
+} // namespace pgmlink
+
+#endif // LINEAR_ASSIGNMENT_H
@@ -19,6 +19,7 @@
 #include <ctime>
 #include <cstdio>
 
+#include <atomic>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -63,6 +64,13 @@
  *
  *
  *
+ * @section asynclogging Asynchronous logging
+ * By default every message is written and flushed to @c stderr on the logging thread.
+ * pgmlink::AsyncLog (see async_log.h) can be started at runtime to hand the messages to
+ * a background writer instead; the @c LOG macro is used in the same way.
+ *
+ *
+ *
  * @section disablelogging Turning off logging
  * If logging and the accompanying code is not desired in the final binary, a special logging
  * level is provided:
@@ -129,12 +137,21 @@ enum LogLevel {logNO_LOGGING, logERROR, logWARNING, logINFO, logDEBUG, logDEBUG1
 class Output2FILE
 {
 public:
+    typedef void (*Sink)(const std::string& msg);
+
     // getRedirect()
     /**
      * The file handle to which the logging stream is redirected.
      */
     static FILE*& getRedirect();
 
+    // getSink()
+    /**
+     * If set, messages are passed to the sink without timestamp instead of being written
+     * to the file handle. The sink is responsible for timestamping them (see AsyncLog).
+     */
+    static std::atomic<Sink>& getSink();
+
     // output()
     /**
      * Writes message to file handle.
@@ -142,6 +159,18 @@ public:
      * This function is used in the Log<T> and mandatory for every Redirector.
      */
     static void output(const std::string& msg);
+
+    // deferTimestamp()
+    /**
+     * True if the timestamp is added by output_untimed() rather than by Log<T>::get().
+     */
+    static bool deferTimestamp();
+
+    // output_untimed()
+    /**
+     * Writes a message that has no timestamp yet.
+     */
+    static void output_untimed(const std::string& msg);
 };
 
 
@@ -155,6 +184,15 @@ inline FILE*& pgmlink::Output2FILE::getRedirect()
 
 
 
+// getSink()
+inline std::atomic<pgmlink::Output2FILE::Sink>& pgmlink::Output2FILE::getSink()
+{
+    static std::atomic<Sink> sink(static_cast<Sink>(0));
+    return sink;
+}
+
+
+
 // output()
 inline void pgmlink::Output2FILE::output(const std::string& msg)
 {
@@ -169,6 +207,31 @@ inline void pgmlink::Output2FILE::output(const std::string& msg)
 
 
 
+// deferTimestamp()
+inline bool pgmlink::Output2FILE::deferTimestamp()
+{
+    return getSink().load(std::memory_order_acquire) != 0;
+}
+
+
+
+// output_untimed()
+inline void pgmlink::Output2FILE::output_untimed(const std::string& msg)
+{
+    Sink sink = getSink().load(std::memory_order_acquire);
+    if (sink)
+    {
+        sink(msg);
+    }
+    else
+    {
+        // the sink was removed after the message was started
+        output("- " + nowTime() + msg);
+    }
+}
+
+
+
 //Log<T>
 /**
  * A thread-safe logging tool
@@ -178,6 +241,8 @@ inline void pgmlink::Output2FILE::output(const std::string& msg)
  * You have to provide a Redirector with the following interface:
  * @code
  * void T::output(const std::string& msg)
+ * bool T::deferTimestamp()
+ * void T::output_untimed(const std::string& msg)
  * @endcode
  *
  * @author Bernhard X. Kausler <bernhard.kausler@iwr.uni-heidelberg.de>
@@ -239,6 +304,12 @@ protected:
      */
     std::ostringstream os_;
 
+    // timestamp_deferred_
+    /**
+     * True if get() left the timestamp to the Redirector.
+     */
+    bool timestamp_deferred_;
+
 private:
     // Declare copy constructor etc. as private, since we don't want them to be used.
     Log(const Log&);
@@ -250,6 +321,7 @@ private:
 // Log()
 template <typename T>
 pgmlink::Log<T>::Log()
+    : timestamp_deferred_(false)
 {
 }
 
@@ -268,7 +340,11 @@ std::ostringstream& pgmlink::Log<T>::get(LogLevel level)
     }
 
     // print standard logging preambel to logging stream
-    os_ << "- " << pgmlink::nowTime();
+    timestamp_deferred_ = T::deferTimestamp();
+    if (!timestamp_deferred_)
+    {
+        os_ << "- " << pgmlink::nowTime();
+    }
     os_ << " " << toString(ll) << ": ";
     os_ << std::string(ll > pgmlink::logDEBUG ? ll - pgmlink::logDEBUG : 0, '\t');
 
@@ -282,7 +358,14 @@ template <typename T>
 pgmlink::Log<T>::~Log()
 {
     os_ << std::endl;
-    T::output(os_.str());
+    if (timestamp_deferred_)
+    {
+        T::output_untimed(os_.str());
+    }
+    else
+    {
+        T::output(os_.str());
+    }
 }
 
 
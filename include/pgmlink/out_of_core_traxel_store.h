@@ -0,0 +1,113 @@
+/**
+   @file
+   @ingroup tracking
+   @brief traxels and features kept in a HDF5 file and loaded frame by frame
+*/
+
+#ifndef OUT_OF_CORE_TRAXEL_STORE_H
+#define OUT_OF_CORE_TRAXEL_STORE_H
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include "pgmlink_export.h"
+#include "pgmlink/traxels.h"
+
+namespace pgmlink
+{
+
+/**
+ * Traxel store for datasets that do not fit into memory.
+ *
+ * The traxels of timestep t and their features are stored in the HDF5 group
+ * timesteps/t of the file:
+ * - ids: the traxel ids of the frame
+ * - features/name: (traxels, dimension) matrix of feature name, one row per id
+ * Each dataset is a single compressed chunk, so a frame is read in one go.
+ *
+ * Only the ids of the frames are kept in memory. Frames are loaded on demand
+ * into a cache holding the cache_size frames used most recently; each loaded
+ * frame is an in-memory TraxelStore with a feature store of its own. Frames
+ * are handed out as shared pointers, so a frame stays valid while it is in
+ * use even if the cache drops it.
+ *
+ * Loaded traxels use the default locators. All methods are safe to call
+ * from several threads. Errors are reported as std::runtime_error.
+ */
+class OutOfCoreTraxelStore
+{
+public:
+    /// open filename, which has to be written by append_frame() or write()
+    PGMLINK_EXPORT explicit OutOfCoreTraxelStore(const std::string& filename, size_t cache_size = 4);
+    PGMLINK_EXPORT ~OutOfCoreTraxelStore();
+
+    /**
+     * Store the traxels of a timestep in filename, creating the file if
+     * necessary. All traxels need the same features with the same
+     * dimensions. Throws if the timestep is stored already.
+     */
+    PGMLINK_EXPORT static void append_frame(const std::string& filename,
+                                            int timestep,
+                                            const std::vector<Traxel>& traxels);
+    /// store all timesteps of ts with append_frame()
+    PGMLINK_EXPORT static void write(const std::string& filename, const TraxelStore& ts);
+
+    PGMLINK_EXPORT std::set<int> timesteps() const;
+    PGMLINK_EXPORT int earliest_timestep() const;
+    PGMLINK_EXPORT int latest_timestep() const;
+    /// number of traxels in all timesteps
+    PGMLINK_EXPORT size_t size() const;
+    PGMLINK_EXPORT bool empty() const
+    {
+        return size() == 0;
+    }
+    /// ids of the traxels of a timestep, without loading the frame
+    PGMLINK_EXPORT const std::vector<unsigned int>& ids(int timestep) const;
+
+    /// traxels of a timestep with all their features
+    PGMLINK_EXPORT boost::shared_ptr<const TraxelStore> frame(int timestep) const;
+    /// a single traxel with all its features; loads its frame if necessary
+    PGMLINK_EXPORT Traxel traxel(int timestep, unsigned int id) const;
+
+    PGMLINK_EXPORT size_t cache_size() const
+    {
+        return cache_size_;
+    }
+    /// number of frames read from the file so far
+    PGMLINK_EXPORT size_t frames_loaded() const;
+    PGMLINK_EXPORT const std::string& filename() const
+    {
+        return filename_;
+    }
+
+private:
+    OutOfCoreTraxelStore(const OutOfCoreTraxelStore&);
+    OutOfCoreTraxelStore& operator=(const OutOfCoreTraxelStore&);
+
+    boost::shared_ptr<const TraxelStore> load_frame(int timestep) const;
+
+    typedef std::list<std::pair<int, boost::shared_ptr<const TraxelStore> > > Cache;
+
+    std::string filename_;
+    size_t cache_size_;
+    int64_t file_;
+    size_t size_;
+    std::map<int, std::vector<unsigned int> > ids_;
+
+    // most recently used frame first
+    mutable Cache cache_;
+    mutable size_t frames_loaded_;
+    mutable std::mutex mutex_;
+};
+
+} // end namespace pgmlink
+
+#endif // OUT_OF_CORE_TRAXEL_STORE_H
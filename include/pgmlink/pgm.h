@@ -17,6 +17,7 @@
 #include <opengm/functions/explicit_function.hxx>
 #include <pgmlink/ext_opengm/decorator_weighted.hxx>
 #include <pgmlink/ext_opengm/indicator_function.hxx>
+#include <pgmlink/ext_opengm/sparse_binary_function.hxx>
 #include <opengm/operations/adder.hxx>
 #include <opengm/utilities/metaprogramming.hxx>
 #include <opengm/functions/modelviewfunction.hxx>
@@ -39,10 +40,12 @@ using boost::shared_ptr;
 typedef opengm::ExplicitFunction<double> ExplicitFunction;
 typedef opengm::FunctionDecoratorWeighted< opengm::IndicatorFunction<double> > FeatureFunction;
 typedef opengm::HammingFunction<double> LossFunction;
+typedef opengm::SparseBinaryFunction<double> SparseFunction;
 typedef opengm::LoglinearModel<double,
         opengm::meta::TypeList<ExplicitFunction,
         opengm::meta::TypeList<FeatureFunction,
-        opengm::meta::TypeList<LossFunction, opengm::meta::ListEnd > > > > OpengmModel;
+        opengm::meta::TypeList<LossFunction,
+        opengm::meta::TypeList<SparseFunction, opengm::meta::ListEnd > > > > > OpengmModel;
 
 class OpengmModelDeprecated
 {
@@ -156,6 +159,18 @@ private:
     void init_( VALUE init, std::vector<size_t> states_vars );
 };
 
+template <typename VALUE>
+class OpengmSparseFactor : public OpengmFactor<opengm::SparseBinaryFunction<VALUE> >
+{
+public:
+    typedef typename OpengmFactor<opengm::SparseBinaryFunction<VALUE> >::FunctionType FunctionType;
+
+    /// binary variables only, all configurations not set explicitly have the value init
+    OpengmSparseFactor( const std::vector<size_t>& ogm_var_indices, VALUE init = 0 );
+
+    void set_value( std::vector<size_t> coords, VALUE v);
+};
+
 template <typename VALUE>
 class OpengmWeightedFeature
     : public OpengmFactor< opengm::FunctionDecoratorWeighted< opengm::IndicatorFunction<VALUE> > >
@@ -323,6 +338,28 @@ void OpengmExplicitFactor<VALUE>::init_( VALUE init, std::vector<size_t> states_
 
 
 
+////
+//// class OpengmSparseFactor
+////
+template <typename VALUE>
+OpengmSparseFactor<VALUE>::OpengmSparseFactor( const std::vector<size_t>& ogm_var_indices, VALUE init )
+    : OpengmFactor<opengm::SparseBinaryFunction<VALUE> >(opengm::SparseBinaryFunction<VALUE>(ogm_var_indices.size(), init), ogm_var_indices)
+{
+}
+
+template <typename VALUE>
+void OpengmSparseFactor<VALUE>::set_value( std::vector<size_t> coords, VALUE v)
+{
+    if( coords.size() != this->vi_.size() )
+    {
+        throw std::invalid_argument("OpengmSparseFactor::set_value(): coordinate dimension differs from factor dimension");
+    }
+    indexsorter::reorder( coords, this->order_ );
+    this->ogmfunction_.set_value_of_labels( coords.begin(), v );
+}
+
+
+
 ////
 //// class OpengmWeightedFeature
 ////
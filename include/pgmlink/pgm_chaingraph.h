@@ -14,7 +14,6 @@
 #include <utility>
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
-#include <boost/bimap.hpp>
 #include <opengm/inference/inference.hxx>
 
 #ifndef NO_ILP
@@ -25,6 +24,7 @@
 #endif
 #endif
 
+#include "pgmlink/dense_id_map.h"
 #include "pgmlink/pgm.h"
 #include "pgmlink/hypotheses.h"
 #include "pgmlink/features/feature.h"
@@ -93,10 +93,8 @@ public:
     typedef HypothesesGraph::Node node_t;
     typedef HypothesesGraph::Arc arc_t;
     typedef OpengmModel::IndexType var_t;
-    typedef boost::bimap<node_t, var_t>::left_map node_var_map;
-    typedef boost::bimap<node_t, var_t>::right_map var_node_map;
-    typedef boost::bimap<arc_t, var_t>::left_map arc_var_map;
-    typedef boost::bimap<arc_t, var_t>::right_map var_arc_map;
+    typedef DenseIdMap<node_t, var_t> node_var_map;
+    typedef DenseIdMap<arc_t, var_t> arc_var_map;
 
     Model();
     Model( boost::shared_ptr<OpengmModel>,
@@ -106,10 +104,8 @@ public:
 
     boost::shared_ptr<OpengmModel> opengm_model; ///< opengm model usually constructed by chaingraph::ModelBuilder
 
-    const node_var_map& var_of_node() const; ///< maps nodes to random variables representing detections
-    const var_node_map& node_of_var() const;
-    const arc_var_map& var_of_arc() const; ///< maps arcs to random variables representing links
-    const var_arc_map& arc_of_var() const;
+    const node_var_map& var_of_node() const; ///< maps nodes to random variables representing detections and back
+    const arc_var_map& var_of_arc() const; ///< maps arcs to random variables representing links and back
 
     var_t var_of_node(node_t) const;
     var_t var_of_arc(arc_t) const;
@@ -129,8 +125,8 @@ private:
 
     void init();
 
-    boost::bimap<node_t, var_t> node_var_;
-    boost::bimap<arc_t, var_t> arc_var_;
+    node_var_map node_var_;
+    arc_var_map arc_var_;
 };
 
 class ModelBuilder
@@ -148,7 +144,9 @@ public:
           move_(move),
           opportunity_cost_(opportunity_cost),
           forbidden_cost_(forbidden_cost),
-          cplex_timeout_(1e+75) {}
+          cplex_timeout_(1e+75),
+          sparse_factor_dimension_(6),
+          decompose_large_factors_(false) {}
 
     virtual PGMLINK_EXPORT chaingraph::ModelBuilder* clone() const = 0;
     virtual PGMLINK_EXPORT ~ModelBuilder() {}
@@ -192,6 +190,36 @@ public:
         return *this;
     }
 
+    /// outgoing and incoming factors over at least this many variables store
+    /// only their allowed configurations, everything else evaluates to the
+    /// forbidden cost; smaller ones use a dense table of 2^#variables entries
+    PGMLINK_EXPORT size_t sparse_factor_dimension() const
+    {
+        return sparse_factor_dimension_;
+    }
+    PGMLINK_EXPORT ModelBuilder& sparse_factor_dimension( size_t d )
+    {
+        sparse_factor_dimension_ = d;
+        return *this;
+    }
+
+    /// leave out the outgoing and incoming factors over at least
+    /// sparse_factor_dimension() variables and add their energies as
+    /// detection, arc and (per pair of outgoing arcs) division terms instead;
+    /// only exact if the forbidden configurations are excluded by
+    /// add_hard_constraints(), so the solver never enumerates 2^#variables
+    /// configurations. Without detection vars the energy is shifted by a
+    /// constant per node, the minimizer is the same.
+    PGMLINK_EXPORT bool decompose_large_factors() const
+    {
+        return decompose_large_factors_;
+    }
+    PGMLINK_EXPORT ModelBuilder& decompose_large_factors( bool d )
+    {
+        decompose_large_factors_ = d;
+        return *this;
+    }
+
     //// optional parameters
     // detection vars
     PGMLINK_EXPORT ModelBuilder& with_detection_vars( function<double (const Traxel&)> detection = ConstantFeature(10),
@@ -246,6 +274,12 @@ protected:
             const Model&,
             const HypothesesGraph::Node&) const;
 
+    /// true if a factor over that many variables is replaced by low order terms
+    bool decomposed( size_t factor_dimension ) const
+    {
+        return decompose_large_factors_ && factor_dimension >= sparse_factor_dimension_;
+    }
+
 
 private:
 #ifndef NO_ILP
@@ -264,6 +298,8 @@ private:
     double opportunity_cost_;
     double forbidden_cost_;
     double cplex_timeout_;
+    size_t sparse_factor_dimension_;
+    bool decompose_large_factors_;
 };
 
 class TrainableModelBuilder : public chaingraph::ModelBuilder
@@ -284,8 +320,9 @@ private:
     void add_detection_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
     void add_outgoing_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
     void add_incoming_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
-
-
+    void add_decomposed_outgoing_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node&,
+                                         const vector<HypothesesGraph::Arc>& ) const;
+    void add_decomposed_incoming_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
 };
 
 class ECCV12ModelBuilder : public chaingraph::ModelBuilder
@@ -306,6 +343,9 @@ private:
     void add_detection_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
     void add_outgoing_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
     void add_incoming_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
+    void add_decomposed_outgoing_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node&,
+                                         const vector<HypothesesGraph::Arc>& ) const;
+    void add_decomposed_incoming_factor( const HypothesesGraph&, Model&, const HypothesesGraph::Node& ) const;
 };
 
 /* class ModelTrainer { */
@@ -14,7 +14,6 @@
 #include <utility>
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
-#include <boost/bimap.hpp>
 #include <opengm/inference/inference.hxx>
 
 #ifndef NO_ILP
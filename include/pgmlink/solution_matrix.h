@@ -0,0 +1,305 @@
+/**
+   @file
+   @ingroup tracking
+   @brief dense storage of the solutions of uncertainty and m-best runs
+*/
+
+#ifndef SOLUTION_MATRIX_H
+#define SOLUTION_MATRIX_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <stdint.h>
+#include <lemon/core.h>
+
+#include "pgmlink_export.h"
+
+namespace pgmlink
+{
+
+/**
+ * Matrix of small unsigned integers packed into 64 bit words, row by row.
+ *
+ * All entries share one bit width out of 1, 2, 4, 8, 16, 32 and 64. The
+ * width starts at the given one and is doubled (repacking all entries)
+ * whenever a value does not fit. Reading outside the matrix returns 0.
+ */
+class PackedMatrix
+{
+public:
+    PGMLINK_EXPORT explicit PackedMatrix(unsigned int bits = 1);
+
+    /// new entries are 0
+    PGMLINK_EXPORT void resize(size_t rows, size_t columns);
+    PGMLINK_EXPORT void clear();
+
+    PGMLINK_EXPORT size_t rows() const
+    {
+        return rows_;
+    }
+    PGMLINK_EXPORT size_t columns() const
+    {
+        return columns_;
+    }
+    PGMLINK_EXPORT unsigned int bits() const
+    {
+        return bits_;
+    }
+    /// bytes used by the entries
+    PGMLINK_EXPORT size_t memory_usage() const
+    {
+        return words_.size() * sizeof(uint64_t);
+    }
+
+    PGMLINK_EXPORT uint64_t get(size_t row, size_t column) const
+    {
+        if (row >= rows_ || column >= columns_)
+        {
+            return 0;
+        }
+        const size_t bit = column * bits_;
+        const uint64_t word = words_[row * words_per_row_ + bit / 64];
+        return bits_ == 64 ? word : (word >> (bit % 64)) & ((uint64_t(1) << bits_) - 1);
+    }
+    /// throws std::out_of_range outside the matrix
+    PGMLINK_EXPORT void set(size_t row, size_t column, uint64_t value);
+    /// number of rows with a non-zero entry in the column
+    PGMLINK_EXPORT size_t count_nonzero(size_t column) const;
+
+private:
+    void relayout(unsigned int bits, size_t rows, size_t columns);
+
+    unsigned int bits_;
+    size_t rows_;
+    size_t columns_;
+    size_t words_per_row_;
+    std::vector<uint64_t> words_;
+};
+
+/**
+ * Property map holding one small unsigned value per item (node or arc) and
+ * iteration of an uncertainty or m-best run, used for node_active_count,
+ * arc_active_count, arc_value_count and division_active_count.
+ *
+ * The values live in a PackedMatrix with one row per iteration and one
+ * column per item id, so states take one bit and counts as few bits as the
+ * largest value needs. Every item has its own number of iterations, which
+ * is reset to 0 when the item is erased from the graph. The matrix is the
+ * only storage: operator[] builds a std::vector from it, get_value()
+ * returns a proxy that reads and writes the matrix in place.
+ */
+template <typename Graph, typename Item, typename T>
+class SolutionCountMap
+{
+public:
+    typedef Item Key;
+    typedef std::vector<T> Value;
+
+    /// assignable reference to one entry, see get_value()
+    class ElementReference
+    {
+    public:
+        ElementReference(SolutionCountMap& map, const Key& key, size_t iteration)
+            : map_(map), key_(key), iteration_(iteration)
+        {
+        }
+        operator T() const
+        {
+            return map_.get(key_, iteration_);
+        }
+        ElementReference& operator=(T value)
+        {
+            map_.set(key_, iteration_, value);
+            return *this;
+        }
+        ElementReference& operator=(const ElementReference& other)
+        {
+            return *this = T(other);
+        }
+        ElementReference& operator++()
+        {
+            return *this = T(*this) + 1;
+        }
+        T operator++(int)
+        {
+            const T old = *this;
+            *this = old + 1;
+            return old;
+        }
+    private:
+        SolutionCountMap& map_;
+        Key key_;
+        size_t iteration_;
+    };
+
+    /// the solutions of one item, with the parts of the std::vector interface used on them
+    class Reference
+    {
+    public:
+        Reference(SolutionCountMap& map, const Key& key)
+            : map_(map), key_(key)
+        {
+        }
+        Reference& operator=(const Value& value)
+        {
+            map_.set(key_, value);
+            return *this;
+        }
+        Reference& operator=(const Reference& other)
+        {
+            return *this = Value(other);
+        }
+        operator Value() const
+        {
+            return map_[key_];
+        }
+        size_t size() const
+        {
+            return map_.size(key_);
+        }
+        bool empty() const
+        {
+            return size() == 0;
+        }
+        ElementReference operator[](size_t iteration) const
+        {
+            return ElementReference(map_, key_, iteration);
+        }
+        ElementReference back() const
+        {
+            return (*this)[size() - 1];
+        }
+        void push_back(T value) const
+        {
+            map_.push_back(key_, value);
+        }
+        void resize(size_t n, T value = T()) const
+        {
+            map_.resize(key_, n, value);
+        }
+        void clear() const
+        {
+            map_.resize(key_, 0);
+        }
+    private:
+        SolutionCountMap& map_;
+        Key key_;
+    };
+
+    explicit SolutionCountMap(const Graph& graph)
+        : lengths_(graph, 0)
+    {
+        values_.resize(0, graph.maxId(Item()) + 1);
+    }
+
+    /// copy of the solutions of the item, as for lemon's read maps
+    Value operator[](const Key& key) const
+    {
+        const size_t column = Graph::id(key);
+        Value value(lengths_[key]);
+        for (size_t iteration = 0; iteration < value.size(); ++iteration)
+        {
+            value[iteration] = static_cast<T>(values_.get(iteration, column));
+        }
+        return value;
+    }
+    void set(const Key& key, const Value& value)
+    {
+        const size_t column = Graph::id(key);
+        reserve(column, value.size());
+        for (size_t iteration = 0; iteration < value.size(); ++iteration)
+        {
+            values_.set(iteration, column, value[iteration]);
+        }
+        lengths_.set(key, value.size());
+    }
+    Reference get_value(const Key& key)
+    {
+        return Reference(*this, key);
+    }
+
+    /// number of iterations stored for the item
+    size_t size(const Key& key) const
+    {
+        return lengths_[key];
+    }
+    /// 0 / false past the iterations of the item
+    T get(const Key& key, size_t iteration) const
+    {
+        if (iteration >= lengths_[key])
+        {
+            return T();
+        }
+        return static_cast<T>(values_.get(iteration, Graph::id(key)));
+    }
+    /// throws std::out_of_range past the iterations of the item
+    void set(const Key& key, size_t iteration, T value)
+    {
+        if (iteration >= lengths_[key])
+        {
+            throw std::out_of_range("SolutionCountMap::set(): iteration out of range");
+        }
+        values_.set(iteration, Graph::id(key), value);
+    }
+    void push_back(const Key& key, T value)
+    {
+        const size_t iteration = lengths_[key];
+        const size_t column = Graph::id(key);
+        reserve(column, iteration + 1);
+        values_.set(iteration, column, value);
+        lengths_.set(key, iteration + 1);
+    }
+    void resize(const Key& key, size_t n, T value = T())
+    {
+        const size_t column = Graph::id(key);
+        reserve(column, n);
+        // entries past the old size may hold values of an erased item
+        for (size_t iteration = lengths_[key]; iteration < n; ++iteration)
+        {
+            values_.set(iteration, column, value);
+        }
+        lengths_.set(key, n);
+    }
+    /// number of iterations in which the item has a non-zero value
+    size_t count_nonzero(const Key& key) const
+    {
+        const size_t column = Graph::id(key);
+        size_t count = 0;
+        for (size_t iteration = 0; iteration < lengths_[key]; ++iteration)
+        {
+            if (values_.get(iteration, column) != 0)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+    /// bytes used by the values
+    size_t memory_usage() const
+    {
+        return values_.memory_usage();
+    }
+
+private:
+    void reserve(size_t column, size_t rows)
+    {
+        if (column < values_.columns() && rows <= values_.rows())
+        {
+            return;
+        }
+        size_t columns = std::max<size_t>(values_.columns(), 1);
+        while (columns <= column)
+        {
+            columns *= 2;
+        }
+        values_.resize(std::max(values_.rows(), rows), columns);
+    }
+
+    typename lemon::ItemSetTraits<Graph, Item>::template Map<size_t>::Type lengths_;
+    PackedMatrix values_;
+};
+
+} /* namespace pgmlink */
+
+#endif /* SOLUTION_MATRIX_H */
@@ -0,0 +1,120 @@
+/**
+   @file
+   @ingroup tracking
+   @brief tracking of large fields of view tile by tile
+*/
+
+#ifndef SPATIAL_TILING_H
+#define SPATIAL_TILING_H
+
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "pgmlink_export.h"
+#include "pgmlink/event.h"
+#include "pgmlink/field_of_view.h"
+#include "pgmlink/traxels.h"
+
+namespace pgmlink
+{
+
+/**
+ * Regular grid of tiles over the spatial extent of a field of view.
+ *
+ * The cores of the tiles partition the field of view; every tile spans all
+ * timesteps. Tracking a tile covers its core grown by the halo on every
+ * side (clipped to the field of view), so objects close to the core border
+ * are tracked with their neighbours in view. The halo should be at least as
+ * wide as the largest distance an object moves or its children spread
+ * between two timesteps.
+ */
+class SpatialTiling
+{
+public:
+    /// throws std::runtime_error if a grid dimension is 0 or the halo is negative
+    PGMLINK_EXPORT SpatialTiling(const FieldOfView& fov,
+                                 size_t n_x,
+                                 size_t n_y,
+                                 size_t n_z = 1,
+                                 double halo = 0.);
+
+    PGMLINK_EXPORT size_t size() const
+    {
+        return n_[0] * n_[1] * n_[2];
+    }
+    PGMLINK_EXPORT const FieldOfView& field_of_view() const
+    {
+        return fov_;
+    }
+    PGMLINK_EXPORT double halo() const
+    {
+        return halo_;
+    }
+
+    /// core of tile k, tiles are numbered x fastest, then y, then z
+    PGMLINK_EXPORT FieldOfView core(size_t k) const;
+    /// core of tile k grown by the halo
+    PGMLINK_EXPORT FieldOfView tile(size_t k) const;
+
+    /**
+     * Tile whose core owns a position. Positions on a face shared by two
+     * cores belong to the upper one, positions outside the field of view to
+     * the nearest core.
+     */
+    PGMLINK_EXPORT size_t owner(double x, double y, double z) const;
+
+    /**
+     * Add the traxels of tile k to out, using filter_by_fov().
+     * The traxels get a feature store of their own, so that the tiles can
+     * be tracked concurrently even if the trackers add features.
+     * @return the number of traxels of the tile
+     */
+    PGMLINK_EXPORT size_t extract(const TraxelStore& in, TraxelStore& out, size_t k) const;
+
+private:
+    size_t grid_index(size_t dim, double coordinate) const;
+
+    FieldOfView fov_;
+    size_t n_[3];
+    double halo_;
+};
+
+/**
+ * Merge the events of separately tracked tiles into the events of the
+ * whole traxelstore.
+ *
+ * tile_events[k] are the events of tile k, as returned by the tracker for
+ * the traxels of tiling.extract(ts, ..., k), i.e. indexed from the earliest
+ * timestep of the tile. An event is taken from the tile whose core owns it:
+ * the core of the source traxel for moves, divisions and disappearances and
+ * the core of the traxel itself for all others. When tiles disagree about
+ * the parent of a traxel in a halo, the link made by the tile that owns the
+ * traxel wins and the other parent loses that child, e.g. a move turns into
+ * a disappearance. Traxels which lose their parent that way appear.
+ *
+ * This is the merge step of track_tiled(), for tiles that were tracked
+ * elsewhere, e.g. in separate processes.
+ * Throws std::runtime_error if an event refers to a traxel not in ts.
+ */
+PGMLINK_EXPORT EventVectorVector merge_tiled_events(const TraxelStore& ts,
+                                                    const SpatialTiling& tiling,
+                                                    const std::vector<EventVectorVector>& tile_events);
+
+typedef boost::function<EventVectorVector (TraxelStore&)> TileTracker;
+
+/**
+ * Track ts tile by tile and merge the results with merge_tiled_events().
+ * The tiles are tracked in parallel, so tracker has to be safe to call
+ * concurrently for different traxelstores; pass parallel = false
+ * otherwise. Traxels outside the field of view of the tiling are not
+ * tracked.
+ */
+PGMLINK_EXPORT EventVectorVector track_tiled(const TraxelStore& ts,
+                                             const SpatialTiling& tiling,
+                                             const TileTracker& tracker,
+                                             bool parallel = true);
+
+} // namespace pgmlink
+
+#endif // SPATIAL_TILING_H
@@ -85,6 +85,20 @@ private:
     boost::shared_ptr<std::vector< std::map<unsigned int, bool> > > last_detections_;
 };
 
+/**
+ * Frame-to-frame tracking by linear assignment, a fast baseline without a
+ * graphical model.
+ *
+ * Each pair of consecutive frames is linked by a minimum cost assignment over
+ * the nearest neighbor arcs, with the squared distance over the given
+ * features (default "com") as cost. Objects that are not linked appear or
+ * disappear, which together costs as much as a move of movDist. Afterwards,
+ * objects left unlinked are attached as second child to the nearest linked
+ * parent within divDist whose "divProb" exceeds divisionThreshold.
+ *
+ * All detections are kept; splitterHandling, mergerHandling and
+ * maxTraxelIdAt are not used.
+ */
 class NNTracking
 {
 public:
@@ -20,6 +20,8 @@
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "pgmlink_export.h"
@@ -234,6 +236,63 @@ private:
     void serialize( Archive&, const unsigned int /*version*/ );
 };
 
+//
+// built-in locators as a plain value
+//
+/**
+ * Kind and scales of one of the built-in locators above. Unlike a Locator
+ * object it is copied without allocation and reading a coordinate is a
+ * single feature map lookup without a virtual call. Traxels keep their
+ * locators in this form unless a Locator of another type is set.
+ */
+class CompactLocator
+{
+public:
+    enum Kind {Com, ComCorrected, CoordMinimum, CoordMaximum, Intmaxpos};
+
+    PGMLINK_EXPORT CompactLocator(Kind kind = Com,
+                                  double x_scale = 1.0,
+                                  double y_scale = 1.0,
+                                  double z_scale = 1.0)
+        : kind(kind), x_scale(x_scale), y_scale(y_scale), z_scale(z_scale)
+    {}
+
+    /// true if l is exactly one of the built-in locator types, c is set accordingly
+    PGMLINK_EXPORT static bool from_locator(const Locator& l, CompactLocator& c);
+    /// a new Locator object of the matching type
+    PGMLINK_EXPORT Locator* to_locator() const;
+
+    PGMLINK_EXPORT const std::string& feature_name() const;
+    PGMLINK_EXPORT bool is_applicable(const FeatureMap& m) const
+    {
+        return m.count(feature_name()) == 1;
+    }
+
+    PGMLINK_EXPORT double X(const FeatureMap& m) const
+    {
+        return x_scale * coordinate_from(m, 0);
+    }
+    PGMLINK_EXPORT double Y(const FeatureMap& m) const
+    {
+        return y_scale * coordinate_from(m, 1);
+    }
+    PGMLINK_EXPORT double Z(const FeatureMap& m) const
+    {
+        return z_scale * coordinate_from(m, 2);
+    }
+
+    Kind kind;
+    double x_scale, y_scale, z_scale;
+
+private:
+    PGMLINK_EXPORT double coordinate_from(const FeatureMap&, size_t idx) const;
+
+    // boost serialize
+    friend class boost::serialization::access;
+    template< typename Archive >
+    void serialize( Archive&, const unsigned int /*version*/ );
+};
+
 //
 // Traxel datatype
 //
@@ -241,35 +300,32 @@ class Traxel
 {
 public:
     // construction / assignment
-    //takes ownership of locator pointer
+    //takes ownership of locator pointers, built-in locators are kept as CompactLocator
     PGMLINK_EXPORT Traxel(unsigned int id = 0,
                           int timestep = 0,
 //                        FeatureMap fmap = FeatureMap(),
-                          Locator* l = new ComLocator(),
-                          ComCorrLocator* lc = new ComCorrLocator(),
-                          MinLocator* minl = new MinLocator(),
-                          MaxLocator* maxl = new MaxLocator())
-        : Id(id),
-          Timestep(timestep),
-          locator_(l),
-          corr_locator_(lc),
-          min_locator_(minl),
-          max_locator_(maxl)
-    {
-        features = FeatureMapAccessor(this);
-    }
+                          Locator* l = NULL,
+                          ComCorrLocator* lc = NULL,
+                          MinLocator* minl = NULL,
+                          MaxLocator* maxl = NULL);
 
     PGMLINK_EXPORT Traxel(const Traxel& other);
     PGMLINK_EXPORT Traxel& operator=(const Traxel& other);
     PGMLINK_EXPORT ~Traxel()
     {
-        delete locator_;
+        delete custom_locator_;
     }
     PGMLINK_EXPORT Traxel& set_locator(Locator*);
-    PGMLINK_EXPORT Locator* locator()
-    {
-        return locator_;
-    }
+    PGMLINK_EXPORT Traxel& set_locator(const CompactLocator&);
+    /**
+     * The locator as object. A built-in locator is turned into a Locator
+     * object on the first call, such that changes through the returned
+     * pointer take effect; use the scale setters to keep it compact.
+     */
+    PGMLINK_EXPORT Locator* locator();
+    PGMLINK_EXPORT void set_x_scale(double s);
+    PGMLINK_EXPORT void set_y_scale(double s);
+    PGMLINK_EXPORT void set_z_scale(double s);
     PGMLINK_EXPORT boost::shared_ptr<FeatureStore> get_feature_store() const;
 
     // fields
@@ -299,7 +355,8 @@ public:
         PGMLINK_EXPORT FeatureMap::iterator begin();
         PGMLINK_EXPORT FeatureMap::iterator end();
 
-        // const access and iterators
+        // const access and iterators, these never insert into the feature store:
+        // a traxel without stored features reads as an empty feature map
         PGMLINK_EXPORT feature_array operator[](const std::string& feature_name) const;
         PGMLINK_EXPORT FeatureMap::const_iterator find(const std::string& feature_name) const;
         PGMLINK_EXPORT FeatureMap::const_iterator begin() const;
@@ -355,14 +412,18 @@ private:
     // boost serialize for Traxel datatype
     friend class boost::serialization::access;
     template< typename Archive >
-    void serialize( Archive&, const unsigned int /*version*/ );
-
-    Locator* locator_;
+    void save( Archive&, const unsigned int /*version*/ ) const;
+    template< typename Archive >
+    void load( Archive&, const unsigned int version );
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
 
-    ComCorrLocator* corr_locator_;
+    // locator_ is used unless a Locator of another type is set
+    CompactLocator locator_;
+    Locator* custom_locator_;
 
-    MinLocator* min_locator_;
-    MaxLocator* max_locator_;
+    CompactLocator corr_locator_;
+    CompactLocator min_locator_;
+    CompactLocator max_locator_;
 };
 
 // compare by (time,id) (Traxels can be used as keys (for instance in a std::map) )
@@ -468,7 +529,16 @@ void IntmaxposLocator::serialize( Archive& ar, const unsigned int /*version*/ )
 }
 
 template< typename Archive >
-void Traxel::serialize( Archive& ar, const unsigned int /*version*/ )
+void CompactLocator::serialize( Archive& ar, const unsigned int /*version*/ )
+{
+    ar & kind;
+    ar & x_scale;
+    ar & y_scale;
+    ar & z_scale;
+}
+
+template< typename Archive >
+void Traxel::save( Archive& ar, const unsigned int /*version*/ ) const
 {
     ar.template register_type<ComLocator>();
     ar.template register_type<IntmaxposLocator>();
@@ -477,6 +547,33 @@ void Traxel::serialize( Archive& ar, const unsigned int /*version*/ )
     ar & Timestep;
     ar & features;
     ar & locator_;
+    ar & custom_locator_;
+}
+
+template< typename Archive >
+void Traxel::load( Archive& ar, const unsigned int version )
+{
+    ar.template register_type<ComLocator>();
+    ar.template register_type<IntmaxposLocator>();
+
+    ar & Id;
+    ar & Timestep;
+    ar & features;
+    if (version == 0)
+    {
+        // archives before CompactLocator hold the locator object
+        Locator* l;
+        ar & l;
+        set_locator(l);
+    }
+    else
+    {
+        Locator* l;
+        ar & locator_;
+        ar & l;
+        delete custom_locator_;
+        custom_locator_ = l;
+    }
 }
 
 template< typename Archive >
@@ -506,5 +603,7 @@ TraxelStore& add(TraxelStore& ts, InputIt begin, InputIt end)
 
 } /* namespace pgmlink */
 
+// version 1: locators stored as CompactLocator
+BOOST_CLASS_VERSION(pgmlink::Traxel, 1)
 
 #endif /* TRAXELS_H */
@@ -8,6 +8,7 @@
 #define PGMLINK_UTIL_H
 
 #include <algorithm>
+#include <exception>
 #include <stdexcept>
 #include <sstream>
 #include <iterator>
@@ -81,5 +82,50 @@ void reorder_inverse( std::vector<T> & data, const std::vector<std::size_t> & or
 
 } /* namespace indexsorter */
 
+/**
+ * Exceptions must not leave an OpenMP parallel region, so every iteration
+ * stores the exception it throws and the first one is rethrown, unchanged,
+ * after the loop:
+ * @code
+ * ParallelExceptions exceptions(n);
+ * #pragma omp parallel for
+ * for (int i = 0; i < n; ++i)
+ * {
+ *     try { ... }
+ *     catch (...) { exceptions.capture(i); }
+ * }
+ * exceptions.rethrow();
+ * @endcode
+ */
+class ParallelExceptions
+{
+public:
+    explicit ParallelExceptions(size_t iterations)
+        : exceptions_(iterations)
+    {}
+
+    /// call in the catch (...) block of iteration i
+    void capture(size_t i)
+    {
+        exceptions_[i] = std::current_exception();
+    }
+
+    /// rethrow the exception of the first failed iteration, if any
+    void rethrow() const
+    {
+        for (std::vector<std::exception_ptr>::const_iterator it = exceptions_.begin();
+                it != exceptions_.end(); ++it)
+        {
+            if (*it)
+            {
+                std::rethrow_exception(*it);
+            }
+        }
+    }
+
+private:
+    std::vector<std::exception_ptr> exceptions_;
+};
+
 } /* namespace pgmlink */
 #endif /* PGMLINK_UTIL_H */
@@ -1,6 +1,7 @@
 #define PY_ARRAY_UNIQUE_SYMBOL pgmlink_pyarray
 #define NO_IMPORT_ARRAY
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
@@ -16,6 +17,8 @@
 
 #include <lemon/core.h>
 
+#include "pynumpy_buffer.h"
+
 using namespace pgmlink;
 using namespace boost::python;
 
@@ -237,6 +240,27 @@ boost::shared_ptr<HypothesesGraph> pyGenerateTrackletGraph(const HypothesesGraph
     return tracklet_graph;
 }
 
+/**
+ * @brief snapshot of node / arc solution states as numpy arrays sharing the C++ buffers
+ */
+dict pyGetGraphStateArrays(const HypothesesGraph& g)
+{
+    boost::shared_ptr<HypothesesGraphState> state = hypotheses_graph_state(g);
+    const size_t n_iterations = std::max<size_t>(state->n_iterations, 1);
+
+    dict arrays;
+    arrays["node_ids"] = numpy_view(state, state->node_ids, "intc");
+    arrays["node_timesteps"] = numpy_view(state, state->node_timesteps, "intc");
+    arrays["node_traxel_ids"] = numpy_view(state, state->node_traxel_ids, "uintc");
+    arrays["node_active_count"] = numpy_view(state, state->node_active_count, "uintp", n_iterations);
+    arrays["relative_uncertainty"] = numpy_view(state, state->relative_uncertainty, "f8");
+    arrays["arc_ids"] = numpy_view(state, state->arc_ids, "intc");
+    arrays["arc_sources"] = numpy_view(state, state->arc_sources, "intc");
+    arrays["arc_targets"] = numpy_view(state, state->arc_targets, "intc");
+    arrays["arc_active_count"] = numpy_view(state, state->arc_active_count, "u1", n_iterations);
+    return arrays;
+}
+
 void export_hypotheses()
 {
     class_<HypothesesGraph::Arc>("Arc");
@@ -349,6 +373,7 @@ void export_hypotheses()
     .def("write_hypotheses_graph_state", &HypothesesGraph::write_hypotheses_graph_state)
     .def("num_active_incoming_arcs", &num_active_incoming_arcs)
     .def("generate_tracklet_graph", &pyGenerateTrackletGraph)
+    .def("get_state_arrays", &pyGetGraphStateArrays)
 
     // extensions
     .def("addNodeTraxelMap", &addNodeTraxelMap, return_internal_reference<>())
@@ -0,0 +1,87 @@
+#ifndef PYNUMPY_BUFFER_H
+#define PYNUMPY_BUFFER_H
+
+#include <string>
+#include <vector>
+
+#include <boost/python.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vigra/numpy_array.hxx>
+
+// Expose memory owned by a C++ object as a NumPy array without copying.
+//
+// The array keeps a shared_ptr to the owner in a capsule that is set as the
+// array's base object, so the buffer stays valid as long as any view of it
+// is alive on the python side.
+template<class Owner>
+void release_numpy_buffer_owner(PyObject* capsule)
+{
+    delete static_cast<boost::shared_ptr<Owner>*>(PyCapsule_GetPointer(capsule, NULL));
+}
+
+template<class Owner>
+boost::python::object numpy_view(boost::shared_ptr<Owner> owner,
+                                 void* data,
+                                 boost::python::object dtype,
+                                 std::vector<npy_intp> shape)
+{
+    PyArray_Descr* descr = NULL;
+    if(!PyArray_DescrConverter(dtype.ptr(), &descr))
+    {
+        boost::python::throw_error_already_set();
+    }
+
+    npy_intp n_elements = 1;
+    for(size_t i = 0; i < shape.size(); ++i)
+    {
+        n_elements *= shape[i];
+    }
+    if(n_elements == 0)
+    {
+        // empty vectors may not own a buffer at all, let numpy allocate
+        data = NULL;
+    }
+
+    PyObject* array = PyArray_NewFromDescr(&PyArray_Type, descr,
+                                           static_cast<int>(shape.size()), &shape[0],
+                                           NULL, data, NPY_ARRAY_CARRAY, NULL);
+    if(!array)
+    {
+        boost::python::throw_error_already_set();
+    }
+
+    if(data)
+    {
+        PyObject* capsule = PyCapsule_New(new boost::shared_ptr<Owner>(owner), NULL,
+                                          &release_numpy_buffer_owner<Owner>);
+        if(!capsule || PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(array), capsule) != 0)
+        {
+            Py_XDECREF(capsule);
+            Py_DECREF(array);
+            boost::python::throw_error_already_set();
+        }
+    }
+    return boost::python::object(boost::python::handle<>(array));
+}
+
+template<class Owner, class T>
+boost::python::object numpy_view(boost::shared_ptr<Owner> owner,
+                                 std::vector<T>& values,
+                                 const std::string& dtype,
+                                 size_t n_columns = 0)
+{
+    std::vector<npy_intp> shape;
+    if(n_columns == 0)
+    {
+        shape.push_back(values.size());
+    }
+    else
+    {
+        shape.push_back(values.size() / n_columns);
+        shape.push_back(n_columns);
+    }
+    void* data = values.empty() ? NULL : static_cast<void*>(&values[0]);
+    return numpy_view(owner, data, boost::python::import("numpy").attr("dtype")(dtype), shape);
+}
+
+#endif // PYNUMPY_BUFFER_H
@@ -6,21 +6,27 @@
 #define OPENGM_UNSIGNED_INTEGER_POW_HXX_
 #endif
 
+#include <cstddef>
 #include <vector>
+#include <sstream>
 
 #include "../include/pgmlink/field_of_view.h"
 #include "../include/pgmlink/features/tracking_feature_extractor.h"
+#include "../include/pgmlink/features/feature_vector_file.h"
 #include "../include/pgmlink/features/feature_extraction.h"
 #include "../include/pgmlink/reasoner_constracking.h"
 #include "../include/pgmlink/tracking.h"
 #include "../include/pgmlink/structuredLearningTracking.h"
 #include "../include/pgmlink/log.h"
+#include "../include/pgmlink/instrumentation.h"
+#include "../include/pgmlink/async_log.h"
 #include <boost/utility.hpp>
 #include <boost/python/suite/indexing/map_indexing_suite.hpp>
 #include <boost/python/suite/indexing/vector_indexing_suite.hpp>
 #include <boost/python.hpp>
 
 #include "pytemplated_pickle_suite.h"
+#include "pynumpy_buffer.h"
 
 using namespace std;
 using namespace pgmlink;
@@ -46,6 +52,24 @@ vector<vector<Event> > pythonChaingraphTracking(ChaingraphTracking& tr, TraxelSt
 }
 #endif
 
+vector<vector<Event> > pythonNNTracking(NNTracking& tr, TraxelStore& ts)
+{
+    vector<vector<Event> > result;
+    // release the GIL
+    Py_BEGIN_ALLOW_THREADS
+    try
+    {
+        result = tr(ts);
+    }
+    catch (std::exception& e)
+    {
+        Py_BLOCK_THREADS
+        throw;
+    }
+    Py_END_ALLOW_THREADS
+    return result;
+}
+
 vector<vector<vector<Event> > > pythonConsTracking(
         ConsTracking& tr,
         TraxelStore& ts,
@@ -162,6 +186,104 @@ feature_array    (pgmlink::feature_extraction::FeatureExtractor::*extract1)(cons
 feature_array    (pgmlink::feature_extraction::FeatureExtractor::*extract2)(const Traxel& t1, const Traxel& t2) const = &pgmlink::feature_extraction::FeatureExtractor::extract;
 feature_array    (pgmlink::feature_extraction::FeatureExtractor::*extract3)(const Traxel& t1, const Traxel& t2, const Traxel& t3) const = &pgmlink::feature_extraction::FeatureExtractor::extract;
 
+// the traxels stay owned by the python sequence (list or TraxelVector)
+pgmlink::feature_extraction::ConstTraxelRefVector pytraxel_refs(boost::python::object traxels)
+{
+    pgmlink::feature_extraction::ConstTraxelRefVector refs;
+    const boost::python::ssize_t n = boost::python::len(traxels);
+    refs.reserve(n);
+    for(boost::python::ssize_t i = 0; i < n; ++i)
+    {
+        refs.push_back(&boost::python::extract<const Traxel&>(traxels[i])());
+    }
+    return refs;
+}
+
+// feature matrices are first-index-fastest: view the buffer C-ordered with
+// swapped axes and transpose, so python gets one row per traxel (pair)
+boost::python::object feature_matrix_to_numpy(boost::shared_ptr<pgmlink::feature_extraction::feature_matrix> features)
+{
+    std::vector<npy_intp> shape;
+    shape.push_back(features->shape(1));
+    shape.push_back(features->shape(0));
+    return numpy_view(features, features->data(), boost::python::import("numpy").attr("dtype")("f8"), shape).attr("T");
+}
+
+boost::python::object pyextract_batch2(const pgmlink::feature_extraction::FeatureExtractor& extractor,
+                                       boost::python::object traxels1,
+                                       boost::python::object traxels2)
+{
+    boost::shared_ptr<pgmlink::feature_extraction::feature_matrix> features(new pgmlink::feature_extraction::feature_matrix);
+    extractor.extract(pytraxel_refs(traxels1), pytraxel_refs(traxels2), *features);
+    return feature_matrix_to_numpy(features);
+}
+
+boost::python::object pyextract_batch3(const pgmlink::feature_extraction::FeatureExtractor& extractor,
+                                       boost::python::object traxels1,
+                                       boost::python::object traxels2,
+                                       boost::python::object traxels3)
+{
+    boost::shared_ptr<pgmlink::feature_extraction::feature_matrix> features(new pgmlink::feature_extraction::feature_matrix);
+    extractor.extract(pytraxel_refs(traxels1), pytraxel_refs(traxels2), pytraxel_refs(traxels3), *features);
+    return feature_matrix_to_numpy(features);
+}
+
+// {calculator name: [feature names]} -> {(calculator name, feature name): features}
+pgmlink::feature_extraction::MultipleFeatureExtraction::FeatureList pyfeature_list(boost::python::dict features)
+{
+    pgmlink::feature_extraction::MultipleFeatureExtraction::FeatureList feature_list;
+    boost::python::list calculators = features.keys();
+    for(boost::python::ssize_t i = 0; i < boost::python::len(calculators); ++i)
+    {
+        const std::string calculator = boost::python::extract<std::string>(calculators[i]);
+        boost::python::object names = features[calculators[i]];
+        std::vector<std::string>& feature_names = feature_list[calculator];
+        for(boost::python::ssize_t j = 0; j < boost::python::len(names); ++j)
+        {
+            feature_names.push_back(boost::python::extract<std::string>(names[j]));
+        }
+    }
+    return feature_list;
+}
+
+boost::python::dict pyfeature_matrix_map(pgmlink::feature_extraction::MultipleFeatureExtraction::CombinedFeatureMatrixMap& feature_matrices)
+{
+    boost::python::dict result;
+    for(pgmlink::feature_extraction::MultipleFeatureExtraction::CombinedFeatureMatrixMap::iterator it = feature_matrices.begin();
+            it != feature_matrices.end();
+            ++it)
+    {
+        boost::shared_ptr<pgmlink::feature_extraction::feature_matrix> features(new pgmlink::feature_extraction::feature_matrix);
+        features->swap(it->second);
+        result[boost::python::make_tuple(it->first.first, it->first.second)] = feature_matrix_to_numpy(features);
+    }
+    return result;
+}
+
+boost::python::dict pyextract_features_batch2(boost::python::dict features,
+                                              boost::python::object traxels1,
+                                              boost::python::object traxels2)
+{
+    pgmlink::feature_extraction::MultipleFeatureExtraction::CombinedFeatureMatrixMap feature_matrices =
+        pgmlink::feature_extraction::MultipleFeatureExtraction()(pyfeature_list(features),
+                pytraxel_refs(traxels1),
+                pytraxel_refs(traxels2));
+    return pyfeature_matrix_map(feature_matrices);
+}
+
+boost::python::dict pyextract_features_batch3(boost::python::dict features,
+                                              boost::python::object traxels1,
+                                              boost::python::object traxels2,
+                                              boost::python::object traxels3)
+{
+    pgmlink::feature_extraction::MultipleFeatureExtraction::CombinedFeatureMatrixMap feature_matrices =
+        pgmlink::feature_extraction::MultipleFeatureExtraction()(pyfeature_list(features),
+                pytraxel_refs(traxels1),
+                pytraxel_refs(traxels2),
+                pytraxel_refs(traxels3));
+    return pyfeature_matrix_map(feature_matrices);
+}
+
 std::vector<double> pyextractor_get_feature_vector(pgmlink::features::TrackingFeatureExtractor& fe)
 {
     std::vector<double> feature_vector;
@@ -169,6 +291,126 @@ std::vector<double> pyextractor_get_feature_vector(pgmlink::features::TrackingFe
     return feature_vector;
 }
 
+// numpy structured dtype matching the memory layout of EventRecord
+boost::python::object event_record_dtype()
+{
+    boost::python::list names, formats, offsets;
+    names.append("type");
+    formats.append("i4");
+    offsets.append(offsetof(EventRecord, type));
+    names.append("timestep");
+    formats.append("i4");
+    offsets.append(offsetof(EventRecord, timestep));
+    names.append("iteration");
+    formats.append("i4");
+    offsets.append(offsetof(EventRecord, iteration));
+    names.append("n_traxel_ids");
+    formats.append("u4");
+    offsets.append(offsetof(EventRecord, n_traxel_ids));
+    names.append("traxel_ids");
+    formats.append(boost::python::make_tuple("u8", static_cast<int>(EventRecord::max_traxel_ids)));
+    offsets.append(offsetof(EventRecord, traxel_ids));
+    names.append("energy");
+    formats.append("f8");
+    offsets.append(offsetof(EventRecord, energy));
+
+    boost::python::dict spec;
+    spec["names"] = names;
+    spec["formats"] = formats;
+    spec["offsets"] = offsets;
+    spec["itemsize"] = sizeof(EventRecord);
+    return boost::python::import("numpy").attr("dtype")(spec);
+}
+
+boost::python::object event_records_to_numpy(boost::shared_ptr<std::vector<EventRecord> > records)
+{
+    std::vector<npy_intp> shape(1, records->size());
+    void* data = records->empty() ? NULL : static_cast<void*>(&(*records)[0]);
+    return numpy_view(records, data, event_record_dtype(), shape);
+}
+
+boost::python::object pyevents_to_numpy(const EventVectorVector& events, int first_timestep)
+{
+    boost::shared_ptr<std::vector<EventRecord> > records(new std::vector<EventRecord>);
+    flatten_events(events, *records, 0, first_timestep);
+    return event_records_to_numpy(records);
+}
+
+boost::python::object pymulti_events_to_numpy(const EventVectorVectorVector& events, int first_timestep)
+{
+    boost::shared_ptr<std::vector<EventRecord> > records(new std::vector<EventRecord>);
+    flatten_events(events, *records, first_timestep);
+    return event_records_to_numpy(records);
+}
+
+void pyenable_instrumentation(bool enabled)
+{
+    Instrumentation::instance().enable(enabled);
+}
+
+void pyreset_instrumentation()
+{
+    Instrumentation::instance().reset();
+}
+
+boost::python::list pyinstrumentation_stages()
+{
+    boost::python::list result;
+    std::vector<StageStatistics> stages = Instrumentation::instance().stages();
+    for(std::vector<StageStatistics>::const_iterator it = stages.begin(); it != stages.end(); ++it)
+    {
+        boost::python::dict stage;
+        stage["name"] = it->name;
+        stage["calls"] = it->calls;
+        stage["wall_seconds"] = it->wall_seconds;
+        stage["peak_rss_kb"] = it->peak_rss_kb;
+        stage["heap_delta_kb"] = it->heap_delta_kb;
+        boost::python::dict counters;
+        for(std::map<std::string, size_t>::const_iterator c = it->counters.begin(); c != it->counters.end(); ++c)
+        {
+            counters[c->first] = c->second;
+        }
+        stage["counters"] = counters;
+        result.append(stage);
+    }
+    return result;
+}
+
+std::string pyinstrumentation_json()
+{
+    return Instrumentation::instance().to_json();
+}
+
+void pydump_instrumentation(const std::string& filename)
+{
+    Instrumentation::instance().dump_json(filename);
+}
+
+void pystart_async_logging(const std::string& filename,
+                           bool binary,
+                           size_t buffer_capacity,
+                           unsigned int flush_interval_ms)
+{
+    AsyncLogOptions options;
+    options.filename = filename;
+    options.binary = binary;
+    options.buffer_capacity = buffer_capacity;
+    options.flush_interval_ms = flush_interval_ms;
+    AsyncLog::start(options);
+}
+
+std::string pyconvert_binary_log(const std::string& filename)
+{
+    std::ostringstream out;
+    AsyncLog::convert_binary(filename, out);
+    return out.str();
+}
+
+size_t pyconvert_feature_vector_text_file(const std::string& text_filename, const std::string& filename)
+{
+    return features::FeatureVectorFile::convert_text_file(text_filename, filename);
+}
+
 void export_track()
 {
 
@@ -223,6 +465,13 @@ void export_track()
     ;
 #endif
 
+    class_<NNTracking>("NNTracking",
+                       init<optional<double, double> >(
+                           args("division_distance", "move_distance")))
+    .def("__call__", &pythonNNTracking)
+    .def("detections", &NNTracking::detections)
+    ;
+
     class_<Parameter>("ConservationTrackingParameter")
     .def("setWithNonNegativeWeights", &Parameter::setWithNonNegativeWeights)
     .def("register_detection_func", &Parameter::register_detection_func)
@@ -254,6 +503,8 @@ void export_track()
     .def_readwrite("with_optical_correction", &Parameter::with_optical_correction)
     .def_readwrite("solver", &Parameter::solver)
     .def_readwrite("num_threads", &Parameter::num_threads)
+    .def_readwrite("lazy_constraints", &Parameter::lazy_constraints)
+    .def_readwrite("persistent_solver", &Parameter::persistent_solver)
     .def_readwrite("max_number_paths", &Parameter::max_number_paths)
     .def_readwrite("with_swap", &Parameter::with_swap)
     ;
@@ -340,12 +591,23 @@ void export_track()
     .def("extract", extract1)
     .def("extract", extract2)
     .def("extract", extract3)
+    .def("extract_batch", pyextract_batch2, args("self", "traxels1", "traxels2"),
+         "features of all traxel pairs at once, one row per pair")
+    .def("extract_batch", pyextract_batch3, args("self", "traxels1", "traxels2", "traxels3"),
+         "features of all traxel triplets at once, one row per triplet")
     ;
 
+    def("extract_features_batch", pyextract_features_batch2, args("features", "traxels1", "traxels2"),
+        "features: dict of calculator name to feature names, returns a dict of (calculator, feature) to one row per traxel pair");
+    def("extract_features_batch", pyextract_features_batch3, args("features", "traxels1", "traxels2", "traxels3"),
+        "features: dict of calculator name to feature names, returns a dict of (calculator, feature) to one row per traxel triplet");
+
     class_<pgmlink::features::TrackingFeatureExtractor>("TrackingFeatureExtractor",
             init<boost::shared_ptr<HypothesesGraph>, FieldOfView>(args("HypothesesGraph, FieldOfView")))
     .def("compute_features", &pgmlink::features::TrackingFeatureExtractor::compute_features)
+    .def("set_parallel", &pgmlink::features::TrackingFeatureExtractor::set_parallel)
     .def("append_feature_vector_to_file", &pgmlink::features::TrackingFeatureExtractor::append_feature_vector_to_file)
+    .def("append_feature_vector_to_binary_file", &pgmlink::features::TrackingFeatureExtractor::append_feature_vector_to_binary_file)
 #ifdef WITH_DLIB
     .def("train_track_svm", &pgmlink::features::TrackingFeatureExtractor::train_track_svm)
     .def("get_track_svm", &pgmlink::features::TrackingFeatureExtractor::get_track_svm)
@@ -361,6 +623,11 @@ void export_track()
 
 #ifdef WITH_DLIB
     class_<pgmlink::features::SVMOutlierCalculator, boost::shared_ptr<pgmlink::features::SVMOutlierCalculator> >("SVMOutlierCalculator")
+    .def("is_trained", &pgmlink::features::SVMOutlierCalculator::is_trained)
+    .def("set_max_training_samples", &pgmlink::features::SVMOutlierCalculator::set_max_training_samples)
+    .def("get_max_training_samples", &pgmlink::features::SVMOutlierCalculator::get_max_training_samples)
+    .def("write_to_file", &pgmlink::features::SVMOutlierCalculator::write_to_file)
+    .def("read_from_file", &pgmlink::features::SVMOutlierCalculator::read_from_file)
     .def_pickle(TemplatedPickleSuite<pgmlink::features::SVMOutlierCalculator>());
 #endif
 
@@ -369,6 +636,35 @@ void export_track()
     .def(vector_indexing_suite<vector<vigra::UInt64> >())
     ;
 
+    def("events_to_numpy", &pyevents_to_numpy,
+        (arg("events"), arg("first_timestep") = 0),
+        "flat structured array (type, timestep, iteration, n_traxel_ids, traxel_ids, energy) of a single solution");
+    def("events_to_numpy", &pymulti_events_to_numpy,
+        (arg("events"), arg("first_timestep") = 0),
+        "flat structured array of all solutions, the iteration field holds the solution index");
+
+    def("enable_instrumentation", &pyenable_instrumentation, (arg("enabled") = true),
+        "record wall time, memory and sizes of the tracking pipeline stages");
+    def("reset_instrumentation", &pyreset_instrumentation);
+    def("instrumentation_stages", &pyinstrumentation_stages,
+        "list of dicts (name, calls, wall_seconds, peak_rss_kb, heap_delta_kb, counters) in pipeline order");
+    def("instrumentation_json", &pyinstrumentation_json);
+    def("dump_instrumentation", &pydump_instrumentation, (arg("filename")));
+
+    def("start_async_logging", &pystart_async_logging,
+        (arg("filename") = "", arg("binary") = false, arg("buffer_capacity") = 4096, arg("flush_interval_ms") = 50),
+        "write log messages from a background thread; to stderr if no filename is given");
+    def("stop_async_logging", &AsyncLog::stop);
+    def("flush_async_logging", &AsyncLog::flush);
+    def("convert_binary_log", &pyconvert_binary_log, (arg("filename")),
+        "text of a log written with start_async_logging(binary=True)");
+
+    def("feature_vector_file_offset", &features::FeatureVectorFile::data_offset, (arg("filename")),
+        "byte offset of the first proposal row in a binary feature vector file");
+    def("convert_feature_vector_text_file", &pyconvert_feature_vector_text_file,
+        (arg("text_filename"), arg("filename")),
+        "convert proposal features written by append_feature_vector_to_file into a binary feature vector file");
+
     class_<Event>("Event")
     .def_readonly("type", &Event::type)
     .def_readonly("traxel_ids", &Event::traxel_ids)
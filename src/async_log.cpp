@@ -0,0 +1,460 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <stdint.h>
+
+#include "pgmlink/async_log.h"
+#include "pgmlink/log.h"
+
+namespace pgmlink
+{
+
+namespace
+{
+
+struct Record
+{
+    int64_t usec;
+    std::string message;
+
+    bool operator<(const Record& other) const
+    {
+        return usec < other.usec;
+    }
+};
+
+int64_t now_usec()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// same format as nowTime(): "hh:mm:ss.ms"
+std::string format_time(int64_t usec)
+{
+    std::time_t t = static_cast<std::time_t>(usec / 1000000);
+    std::tm r;
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__)
+    if (localtime_s(&r, &t) != 0)
+#else
+    if (localtime_r(&t, &r) == NULL)
+#endif
+    {
+        return "Error_in_format_time().localtime";
+    }
+    char buffer[101];
+    if (std::strftime(buffer, sizeof(buffer), "%X", &r) == 0)
+    {
+        return "Error_in_format_time().strftime";
+    }
+    char result[120] = {0};
+    std::sprintf(result, "%s.%03ld", buffer, static_cast<long>((usec / 1000) % 1000));
+    return result;
+}
+
+/**
+ * Single producer (the logging thread), single consumer (the writer) queue.
+ */
+class RingBuffer
+{
+public:
+    explicit RingBuffer(size_t capacity)
+        : records_(std::max<size_t>(capacity, 1)), head_(0), tail_(0), orphaned_(false)
+    {}
+
+    bool push(Record& record)
+    {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == records_.size())
+        {
+            return false;
+        }
+        records_[head % records_.size()] = std::move(record);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    void drain(std::vector<Record>& out)
+    {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t head = head_.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i)
+        {
+            Record& record = records_[i % records_.size()];
+            out.push_back(std::move(record));
+            // a moved-from string may keep its storage, do not hold on to large messages
+            std::string().swap(record.message);
+        }
+        tail_.store(head, std::memory_order_release);
+    }
+
+    size_t size() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const
+    {
+        return records_.size();
+    }
+
+    void set_orphaned()
+    {
+        orphaned_.store(true, std::memory_order_release);
+    }
+
+    bool orphaned() const
+    {
+        return orphaned_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<Record> records_;
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+    std::atomic<bool> orphaned_;
+};
+
+class Writer
+{
+public:
+    Writer()
+        : running_(false), producers_(0), stop_(false), wake_(false), requested_pass_(0), completed_pass_(0),
+          out_(NULL), owns_out_(false)
+    {}
+
+    void start(const AsyncLogOptions& options)
+    {
+        std::lock_guard<std::mutex> control(control_mutex_);
+        if (running_)
+        {
+            throw std::runtime_error("AsyncLog::start(): asynchronous logging is already running");
+        }
+        options_ = options;
+        if (options_.filename.empty())
+        {
+            out_ = Output2FILE::getRedirect();
+            owns_out_ = false;
+        }
+        else
+        {
+            out_ = std::fopen(options_.filename.c_str(), options_.binary ? "wb" : "w");
+            if (!out_)
+            {
+                throw std::runtime_error("AsyncLog::start(): could not open " + options_.filename);
+            }
+            owns_out_ = true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = false;
+            wake_ = false;
+        }
+        thread_ = std::thread(&Writer::run, this);
+        running_ = true;
+        Output2FILE::getSink().store(&Writer::sink, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        std::lock_guard<std::mutex> control(control_mutex_);
+        if (!running_)
+        {
+            return;
+        }
+        Output2FILE::getSink().store(static_cast<Output2FILE::Sink>(0), std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        thread_.join();
+        running_ = false;
+        // wait for sinks that saw running_ before it was reset, then write what they pushed
+        while (producers_.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        write_pending();
+        if (owns_out_)
+        {
+            std::fclose(out_);
+        }
+        out_ = NULL;
+    }
+
+    bool running() const
+    {
+        return running_;
+    }
+
+    /// sink() registers while it may push, so that stop() can wait for it
+    void enter()
+    {
+        ++producers_;
+    }
+
+    void leave()
+    {
+        --producers_;
+    }
+
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stop_ || !running_)
+        {
+            return;
+        }
+        const size_t pass = ++requested_pass_;
+        wake_ = true;
+        cv_.notify_all();
+        done_cv_.wait(lock, [&] { return completed_pass_ >= pass || stop_; });
+    }
+
+    void wake()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    RingBuffer& local_buffer()
+    {
+        // the holder marks the buffer orphaned on thread exit, the writer drops it once it is empty
+        struct Holder
+        {
+            std::shared_ptr<RingBuffer> buffer;
+            ~Holder()
+            {
+                if (buffer)
+                {
+                    buffer->set_orphaned();
+                }
+            }
+        };
+        static thread_local Holder holder;
+        if (!holder.buffer)
+        {
+            holder.buffer = std::make_shared<RingBuffer>(options_.buffer_capacity);
+            std::lock_guard<std::mutex> lock(buffers_mutex_);
+            buffers_.push_back(holder.buffer);
+        }
+        return *holder.buffer;
+    }
+
+    static void sink(const std::string& msg);
+
+private:
+    void run()
+    {
+        bool stopping = false;
+        while (!stopping)
+        {
+            size_t pass;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait_for(lock, std::chrono::milliseconds(options_.flush_interval_ms),
+                             [&] { return wake_ || stop_; });
+                wake_ = false;
+                stopping = stop_;
+                pass = requested_pass_;
+            }
+            write_pending();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                completed_pass_ = pass;
+            }
+            done_cv_.notify_all();
+        }
+    }
+
+    void write_pending()
+    {
+        std::vector<std::shared_ptr<RingBuffer> > buffers;
+        {
+            std::lock_guard<std::mutex> lock(buffers_mutex_);
+            buffers = buffers_;
+        }
+        batch_.clear();
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            buffers[i]->drain(batch_);
+        }
+        {
+            std::lock_guard<std::mutex> lock(buffers_mutex_);
+            for (std::vector<std::shared_ptr<RingBuffer> >::iterator it = buffers_.begin(); it != buffers_.end();)
+            {
+                if ((*it)->orphaned() && (*it)->size() == 0)
+                {
+                    it = buffers_.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        if (batch_.empty() || !out_)
+        {
+            return;
+        }
+
+        // every buffer is in order, restore the order between threads
+        std::stable_sort(batch_.begin(), batch_.end());
+        for (std::vector<Record>::const_iterator it = batch_.begin(); it != batch_.end(); ++it)
+        {
+            if (options_.binary)
+            {
+                const uint32_t length = static_cast<uint32_t>(it->message.size());
+                std::fwrite(&it->usec, sizeof(it->usec), 1, out_);
+                std::fwrite(&length, sizeof(length), 1, out_);
+                std::fwrite(it->message.data(), 1, length, out_);
+            }
+            else
+            {
+                const std::string time = format_time(it->usec);
+                std::fputs("- ", out_);
+                std::fputs(time.c_str(), out_);
+                std::fwrite(it->message.data(), 1, it->message.size(), out_);
+            }
+        }
+        std::fflush(out_);
+        if (batch_.capacity() > 4 * options_.buffer_capacity)
+        {
+            // release the memory of an unusually large batch
+            std::vector<Record>().swap(batch_);
+        }
+        else
+        {
+            batch_.clear();
+        }
+    }
+
+    AsyncLogOptions options_;
+    std::atomic<bool> running_;
+    // sink() calls between their check of running_ and their last push
+    std::atomic<size_t> producers_;
+
+    // guards stop_, wake_ and the pass counters
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    bool stop_;
+    bool wake_;
+    size_t requested_pass_;
+    size_t completed_pass_;
+
+    // serializes start() and stop()
+    std::mutex control_mutex_;
+    std::thread thread_;
+
+    std::mutex buffers_mutex_;
+    std::vector<std::shared_ptr<RingBuffer> > buffers_;
+
+    // only used by the writer thread, and by stop() after joining it
+    std::vector<Record> batch_;
+    FILE* out_;
+    bool owns_out_;
+};
+
+// never destroyed: threads may still log during static destruction
+Writer& writer()
+{
+    static Writer* w = new Writer();
+    return *w;
+}
+
+void Writer::sink(const std::string& msg)
+{
+    Writer& w = writer();
+    Record record;
+    record.usec = now_usec();
+    record.message = msg;
+    w.enter();
+    if (!w.running())
+    {
+        // stop() is in progress
+        w.leave();
+        Output2FILE::output("- " + format_time(record.usec) + record.message);
+        return;
+    }
+    RingBuffer& buffer = w.local_buffer();
+    while (!buffer.push(record))
+    {
+        if (!w.running())
+        {
+            w.leave();
+            Output2FILE::output("- " + format_time(record.usec) + record.message);
+            return;
+        }
+        w.wake();
+        std::this_thread::yield();
+    }
+    if (buffer.size() * 2 > buffer.capacity())
+    {
+        w.wake();
+    }
+    w.leave();
+}
+
+} // anonymous namespace
+
+void AsyncLog::start(const AsyncLogOptions& options)
+{
+    writer().start(options);
+}
+
+void AsyncLog::stop()
+{
+    writer().stop();
+}
+
+bool AsyncLog::running()
+{
+    return writer().running();
+}
+
+void AsyncLog::flush()
+{
+    writer().flush();
+}
+
+void AsyncLog::convert_binary(const std::string& binary_filename, std::ostream& out)
+{
+    std::ifstream in(binary_filename.c_str(), std::ios::binary);
+    if (!in)
+    {
+        throw std::runtime_error("AsyncLog::convert_binary(): could not open " + binary_filename);
+    }
+    int64_t usec;
+    uint32_t length;
+    std::string message;
+    while (in.read(reinterpret_cast<char*>(&usec), sizeof(usec)))
+    {
+        if (!in.read(reinterpret_cast<char*>(&length), sizeof(length)))
+        {
+            throw std::runtime_error("AsyncLog::convert_binary(): truncated record in " + binary_filename);
+        }
+        message.resize(length);
+        if (length > 0 && !in.read(&message[0], length))
+        {
+            throw std::runtime_error("AsyncLog::convert_binary(): truncated record in " + binary_filename);
+        }
+        out << "- " << format_time(usec) << message;
+    }
+}
+
+} /* namespace pgmlink */
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "pgmlink/bounding_box_index.h"
+#include "pgmlink/log.h"
+
+namespace pgmlink
+{
+
+BoundingBoxIndex::BoundingBoxIndex(const HypothesesGraph& graph, unsigned int ndim)
+    : ndim_(ndim)
+{
+    if (ndim_ != 2 && ndim_ != 3)
+    {
+        throw std::runtime_error("BoundingBoxIndex: ndim must be 2 or 3");
+    }
+
+    typedef property_map<node_timestep, HypothesesGraph::base_graph>::type node_timestep_map_t;
+    node_timestep_map_t& timestep_map = graph.get(node_timestep());
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = graph.get(node_traxel());
+
+    for (HypothesesGraph::NodeIt n(graph); n != lemon::INVALID; ++n)
+    {
+        const Traxel& traxel = traxel_map[n];
+        Entry entry;
+        entry.lower[0] = traxel.X_min();
+        entry.lower[1] = traxel.Y_min();
+        entry.upper[0] = traxel.X_max();
+        entry.upper[1] = traxel.Y_max();
+        if (ndim_ == 3)
+        {
+            entry.lower[2] = traxel.Z_min();
+            entry.upper[2] = traxel.Z_max();
+        }
+        else
+        {
+            entry.lower[2] = entry.upper[2] = 0.;
+        }
+        entry.node = n;
+
+        Timestep& timestep = timesteps_[timestep_map[n]];
+        timestep.entries.push_back(entry);
+        timestep.max_x_extent = std::max(timestep.max_x_extent, entry.upper[0] - entry.lower[0]);
+    }
+
+    for (std::map<int, Timestep>::iterator it = timesteps_.begin(); it != timesteps_.end(); ++it)
+    {
+        std::sort(it->second.entries.begin(), it->second.entries.end());
+    }
+    LOG(logDEBUG) << "BoundingBoxIndex: indexed " << size() << " traxels in " << timesteps_.size() << " timesteps";
+}
+
+bool BoundingBoxIndex::intersects(const Entry& entry, const FieldOfView& fov) const
+{
+    // fov bounds are (t, x, y, z)
+    for (unsigned int d = 0; d < ndim_; ++d)
+    {
+        if (fov.upper_bound()[d + 1] < entry.lower[d] || entry.upper[d] < fov.lower_bound()[d + 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<BoundingBoxIndex::Node> BoundingBoxIndex::query(const FieldOfView& fov) const
+{
+    std::vector<Node> result;
+    std::map<int, Timestep>::const_iterator t_begin = timesteps_.lower_bound(static_cast<int>(fov.lower_bound()[0]));
+    std::map<int, Timestep>::const_iterator t_end = timesteps_.upper_bound(static_cast<int>(std::floor(fov.upper_bound()[0])));
+    for (std::map<int, Timestep>::const_iterator t = t_begin; t != t_end; ++t)
+    {
+        const std::vector<Entry>& entries = t->second.entries;
+        // a box can only overlap if lower x <= fov upper x and lower x >= fov lower x - widest box
+        Entry first;
+        first.lower[0] = fov.lower_bound()[1] - t->second.max_x_extent;
+        std::vector<Entry>::const_iterator it = std::lower_bound(entries.begin(), entries.end(), first);
+        for (; it != entries.end() && it->lower[0] <= fov.upper_bound()[1]; ++it)
+        {
+            if (intersects(*it, fov))
+            {
+                result.push_back(it->node);
+            }
+        }
+    }
+    return result;
+}
+
+size_t BoundingBoxIndex::size() const
+{
+    size_t n = 0;
+    for (std::map<int, Timestep>::const_iterator it = timesteps_.begin(); it != timesteps_.end(); ++it)
+    {
+        n += it->second.entries.size();
+    }
+    return n;
+}
+
+} /* namespace pgmlink */
@@ -17,6 +17,7 @@
 
 // pgmlink
 #include "pgmlink/features/feature.h"
+#include "pgmlink/features/feature_extraction.h"
 #include "pgmlink/traxels.h"
 #include "pgmlink/classifier_auxiliary.h"
 
@@ -511,6 +512,115 @@ feature_array FeatureExtractor::extract(const Traxel& t1, const Traxel& t2, cons
 }
 
 
+namespace
+{
+// calculators of the feature_extraction batch API that compute exactly the
+// same features as the calculator of the same name here. AbsDiff and
+// SqrtSquaredDiff are missing on purpose: their feature_extraction
+// counterparts return one entry per feature component instead of one.
+std::string batch_calculator_name(const std::string& name)
+{
+    if (name == SquaredDifferenceCalculator::name_)
+    {
+        return "SquaredDifference";
+    }
+    if (name == RatioCalculator::name_ || name == AsymmetricRatioCalculator::name_)
+    {
+        return name;
+    }
+    return "";
+}
+
+void check_batch_sizes(const feature_extraction::ConstTraxelRefVector& t1, const feature_extraction::ConstTraxelRefVector& t2)
+{
+    if (t1.size() != t2.size())
+    {
+        throw std::runtime_error("traxel vectors of a batch have different sizes");
+    }
+}
+
+void set_row(feature_extraction::feature_matrix& m, size_t row, const feature_array& values)
+{
+    if (row == 0)
+    {
+        m.reshape(vigra::Shape2(m.shape(0), values.size()));
+    }
+    else if (values.size() != static_cast<size_t>(m.shape(1)))
+    {
+        throw std::runtime_error("FeatureExtractor::extract(): extracted features of different length");
+    }
+    for (size_t col = 0; col < values.size(); ++col)
+    {
+        m(row, col) = values[col];
+    }
+}
+} /* namespace */
+
+
+void FeatureExtractor::extract(const feature_extraction::ConstTraxelRefVector& t1,
+                               const feature_extraction::ConstTraxelRefVector& t2,
+                               feature_extraction::feature_matrix& result) const
+{
+    check_batch_sizes(t1, t2);
+    const std::string batch_name = batch_calculator_name(calculator_->name());
+    if (batch_name.empty())
+    {
+        extract_rows(t1, t2, result);
+    }
+    else
+    {
+        feature_extraction::FeatureExtractor(batch_name, feature_name_).extract(t1, t2, result);
+    }
+}
+
+
+void FeatureExtractor::extract(const feature_extraction::ConstTraxelRefVector& t1,
+                               const feature_extraction::ConstTraxelRefVector& t2,
+                               const feature_extraction::ConstTraxelRefVector& t3,
+                               feature_extraction::feature_matrix& result) const
+{
+    check_batch_sizes(t1, t2);
+    check_batch_sizes(t1, t3);
+    const std::string batch_name = batch_calculator_name(calculator_->name());
+    if (batch_name.empty())
+    {
+        extract_rows(t1, t2, t3, result);
+    }
+    else
+    {
+        feature_extraction::FeatureExtractor(batch_name, feature_name_).extract(t1, t2, t3, result);
+    }
+}
+
+
+void FeatureExtractor::extract_rows(const feature_extraction::ConstTraxelRefVector& t1,
+                                    const feature_extraction::ConstTraxelRefVector& t2,
+                                    feature_extraction::feature_matrix& result) const
+{
+    check_batch_sizes(t1, t2);
+    result.reshape(vigra::Shape2(t1.size(), 0));
+    for (size_t row = 0; row < t1.size(); ++row)
+    {
+        set_row(result, row, extract(*t1[row], *t2[row]));
+    }
+}
+
+
+void FeatureExtractor::extract_rows(const feature_extraction::ConstTraxelRefVector& t1,
+                                    const feature_extraction::ConstTraxelRefVector& t2,
+                                    const feature_extraction::ConstTraxelRefVector& t3,
+                                    feature_extraction::feature_matrix& result) const
+{
+    check_batch_sizes(t1, t2);
+    check_batch_sizes(t1, t3);
+    result.reshape(vigra::Shape2(t1.size(), 0));
+    for (size_t row = 0; row < t1.size(); ++row)
+    {
+        set_row(result, row, extract(*t1[row], *t2[row], *t3[row]));
+    }
+}
+
+
 boost::shared_ptr<FeatureCalculator> FeatureExtractor::calculator() const
 {
     return calculator_;
@@ -562,6 +672,15 @@ feature_array FeatureExtractorSelective::extract(const Traxel& t1, const Traxel&
 }
 
 
+void FeatureExtractorSelective::extract(const feature_extraction::ConstTraxelRefVector& t1,
+                                        const feature_extraction::ConstTraxelRefVector& t2,
+                                        feature_extraction::feature_matrix& result) const
+{
+    // the overlap lookup has no batch counterpart
+    extract_rows(t1, t2, result);
+}
+
+
 std::string FeatureExtractorSelective::name() const
 {
     return feature_name_;
@@ -688,6 +807,55 @@ ClassifierStrategy::ClassifierStrategy(const std::string& name) :
 ClassifierStrategy::~ClassifierStrategy() {}
 
 
+void ClassifierStrategy::classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                                  const feature_extraction::ConstTraxelRefVector& traxs_in,
+                                  std::vector<feature_array>& probabilities,
+                                  bool with_predict)
+{
+    check_batch_sizes(traxs_out, traxs_in);
+    probabilities.assign(traxs_out.size(), feature_array());
+    for (size_t i = 0; i < traxs_out.size(); ++i)
+    {
+        // the single versions expect an initialized entry when predicting
+        std::map<unsigned, feature_array> feature_map;
+        classify(*traxs_out[i], *traxs_in[i], feature_map, false);
+        if (with_predict)
+        {
+            classify(*traxs_out[i], *traxs_in[i], feature_map, true);
+        }
+        if (!feature_map.empty())
+        {
+            probabilities[i] = feature_map.begin()->second;
+        }
+    }
+}
+
+
+void ClassifierStrategy::classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                                  const feature_extraction::ConstTraxelRefVector& traxs_in_first,
+                                  const feature_extraction::ConstTraxelRefVector& traxs_in_second,
+                                  std::vector<feature_array>& probabilities,
+                                  bool with_predict)
+{
+    check_batch_sizes(traxs_out, traxs_in_first);
+    check_batch_sizes(traxs_out, traxs_in_second);
+    probabilities.assign(traxs_out.size(), feature_array());
+    for (size_t i = 0; i < traxs_out.size(); ++i)
+    {
+        std::map<std::pair<unsigned, unsigned>, feature_array> feature_map;
+        classify(*traxs_out[i], *traxs_in_first[i], *traxs_in_second[i], feature_map, false);
+        if (with_predict)
+        {
+            classify(*traxs_out[i], *traxs_in_first[i], *traxs_in_second[i], feature_map, true);
+        }
+        if (!feature_map.empty())
+        {
+            probabilities[i] = feature_map.begin()->second;
+        }
+    }
+}
+
+
 ////
 //// ClassifierLazy
 ////
@@ -978,6 +1146,101 @@ void ClassifierRF::extract_features(const Traxel& parent,
 }
 
 
+namespace
+{
+// copies block into the columns of features starting at starting_index
+void append_columns(feature_extraction::feature_matrix& features,
+                    const feature_extraction::feature_matrix& block,
+                    size_t& starting_index)
+{
+    const size_t end_index = starting_index + block.shape(1);
+    if (end_index > static_cast<size_t>(features.shape(1)))
+    {
+        throw std::runtime_error("ClassifierRF::extract_features() -- extracted features size does not match random forest feature size");
+    }
+    vigra::MultiArrayView<2, feature_type> view = features.subarray(
+                vigra::Shape2(0, starting_index),
+                vigra::Shape2(features.shape(0), end_index));
+    view = block;
+    starting_index = end_index;
+}
+} /* namespace */
+
+
+void ClassifierRF::extract_features(const feature_extraction::ConstTraxelRefVector& t1,
+                                    const feature_extraction::ConstTraxelRefVector& t2,
+                                    feature_extraction::feature_matrix& features)
+{
+    features.reshape(vigra::Shape2(t1.size(), rf_.feature_count()));
+    if (t1.empty())
+    {
+        return;
+    }
+    size_t starting_index = 0;
+    feature_extraction::feature_matrix block;
+    for (std::vector<boost::shared_ptr<FeatureExtractor> >::const_iterator it = feature_extractors_.begin();
+            it != feature_extractors_.end();
+            ++it)
+    {
+        LOG(logDEBUG4) << "ClassifierRF: extracting " << (*it)->name() << " for " << t1.size() << " traxel pairs";
+        (*it)->extract(t1, t2, block);
+        append_columns(features, block, starting_index);
+    }
+    if (starting_index != static_cast<size_t>(features.shape(1)))
+    {
+        throw std::runtime_error("ClassifierRF -- extracted features size does not match random forest feature size");
+    }
+}
+
+
+void ClassifierRF::extract_features(const feature_extraction::ConstTraxelRefVector& parents,
+                                    const feature_extraction::ConstTraxelRefVector& children1,
+                                    const feature_extraction::ConstTraxelRefVector& children2,
+                                    feature_extraction::feature_matrix& features)
+{
+    features.reshape(vigra::Shape2(parents.size(), rf_.feature_count()));
+    if (parents.empty())
+    {
+        return;
+    }
+    size_t starting_index = 0;
+    feature_extraction::feature_matrix block;
+    for (std::vector<boost::shared_ptr<FeatureExtractor> >::const_iterator it = feature_extractors_.begin();
+            it != feature_extractors_.end();
+            ++it)
+    {
+        LOG(logDEBUG4) << "ClassifierRF:extract_features() -- extracting " << (*it)->name() << " for " << parents.size() << " divisions";
+        (*it)->extract(parents, children1, children2, block);
+        append_columns(features, block, starting_index);
+    }
+    if (starting_index != static_cast<size_t>(features.shape(1)))
+    {
+        throw std::runtime_error("ClassifierRF::extract_features() -- extracted features size does not match random forest feature size");
+    }
+}
+
+
+void ClassifierRF::predict(const feature_extraction::feature_matrix& features,
+                           std::vector<feature_array>& probabilities) const
+{
+    const size_t row_count = features.shape(0);
+    probabilities.assign(row_count, feature_array(rf_.class_count(), 0.));
+    if (row_count == 0)
+    {
+        return;
+    }
+    vigra::MultiArray<2, feature_type> probability_matrix(vigra::Shape2(row_count, rf_.class_count()));
+    rf_.predictProbabilities(features, probability_matrix);
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        for (size_t col = 0; col < probabilities[row].size(); ++col)
+        {
+            probabilities[row][col] = probability_matrix(row, col);
+        }
+    }
+}
+
+
 ClassifierMoveRF::ClassifierMoveRF(vigra::RandomForest<> rf,
                                    const std::vector<boost::shared_ptr<FeatureExtractor> >& feature_extractors,
                                    const std::string& name) :
@@ -1041,6 +1304,24 @@ void ClassifierMoveRF::classify(const Traxel& trax_out,
 }
 
 
+void ClassifierMoveRF::classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                                const feature_extraction::ConstTraxelRefVector& traxs_in,
+                                std::vector<feature_array>& probabilities,
+                                bool with_predict)
+{
+    check_batch_sizes(traxs_out, traxs_in);
+    if (!with_predict)
+    {
+        probabilities.assign(traxs_out.size(), feature_array(probabilities_.shape()[1], 0.));
+        return;
+    }
+    feature_extraction::feature_matrix features;
+    extract_features(traxs_out, traxs_in, features);
+    predict(features, probabilities);
+    LOG(logDEBUG4) << "ClassifierMoveRF::classify() -- predicted " << probabilities.size() << " transitions";
+}
+
+
 ClassifierDivisionRF::ClassifierDivisionRF(vigra::RandomForest<> rf,
         const std::vector<boost::shared_ptr<FeatureExtractor> >& feature_extractors,
         const std::string& name) :
@@ -1106,6 +1387,26 @@ void ClassifierDivisionRF::classify(const Traxel& trax_out,
 }
 
 
+void ClassifierDivisionRF::classify(const feature_extraction::ConstTraxelRefVector& traxs_out,
+                                    const feature_extraction::ConstTraxelRefVector& traxs_in_first,
+                                    const feature_extraction::ConstTraxelRefVector& traxs_in_second,
+                                    std::vector<feature_array>& probabilities,
+                                    bool with_predict)
+{
+    check_batch_sizes(traxs_out, traxs_in_first);
+    check_batch_sizes(traxs_out, traxs_in_second);
+    if (!with_predict)
+    {
+        probabilities.assign(traxs_out.size(), feature_array(probabilities_.shape()[1], 0.));
+        return;
+    }
+    feature_extraction::feature_matrix features;
+    extract_features(traxs_out, traxs_in_first, traxs_in_second, features);
+    predict(features, probabilities);
+    LOG(logDEBUG4) << "ClassifierDivisionRF::classify() -- predicted " << probabilities.size() << " divisions";
+}
+
+
 ClassifierCountRF::ClassifierCountRF(vigra::RandomForest<> rf,
                                      const std::vector<boost::shared_ptr<FeatureExtractor> >& feature_extractors,
                                      const std::string& name) :
@@ -1,6 +1,10 @@
 #include "pgmlink/energy_computer.h"
 #include "pgmlink/features/featurestore.h"
+#include "pgmlink/out_of_core_traxel_store.h"
 #include <limits>
+#include <set>
+#include <stdexcept>
+#include <boost/tuple/tuple.hpp>
 
 namespace pgmlink
 {
@@ -23,19 +27,79 @@ EnergyComputer::EnergyComputer(
 	energyNames_[Detection] = detectionEnergyName;
 }
 
+namespace
+{
+/// the traxel of a frame of an OutOfCoreTraxelStore with timestep and id of tr
+const Traxel& traxel_in(const TraxelStore& frame, const Traxel& tr)
+{
+	TraxelStoreByTimeid::const_iterator it = frame.get<by_timeid>().find(boost::make_tuple(tr.Timestep, tr.Id));
+	if(it == frame.get<by_timeid>().end())
+	{
+		throw std::runtime_error("EnergyComputer: traxel of the graph is missing in the out-of-core traxel store");
+	}
+	return *it;
+}
+}
+
 void EnergyComputer::operator()(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs)
 {
+	TraxelMap& traxel_map = graph.get(node_traxel());
 	for(HypothesesGraph::NodeIt n(graph); n != lemon::INVALID; ++n)
 	{
-		computeDetectionEnergy(graph, fs, n);
-		computeDivisionEnergy(graph, fs, n);
-		computeAppearanceEnergy(graph, fs, n);
-		computeDisappearanceEnergy(graph, fs, n);
+		const Traxel& tr = traxel_map[n];
+		computeDetectionEnergy(graph, fs, n, tr);
+		computeDivisionEnergy(graph, fs, n, tr);
+		computeAppearanceEnergy(graph, fs, n, tr);
+		computeDisappearanceEnergy(graph, fs, n, tr);
 	}
 
 	for(HypothesesGraph::ArcIt a(graph); a != lemon::INVALID; ++a)
 	{
-		computeTransitionEnergy(graph, fs, a);
+		computeTransitionEnergy(graph, fs, a, traxel_map[graph.source(a)], traxel_map[graph.target(a)]);
+	}
+}
+
+void EnergyComputer::operator()(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, const OutOfCoreTraxelStore& store)
+{
+	if(param_.with_tracklets)
+	{
+		throw std::runtime_error("EnergyComputer: tracklets are not supported with an out-of-core traxel store");
+	}
+
+	// visit the nodes frame by frame, the arcs of a node end in the next frame;
+	// both frames are fetched once and the traxels are looked up in them
+	TraxelMap& traxel_map = graph.get(node_traxel());
+	const HypothesesGraph::node_timestep_map& timestep_map = graph.get(node_timestep());
+	const std::set<int>& timesteps = graph.timesteps();
+	boost::shared_ptr<const TraxelStore> frame, next_frame;
+	for(std::set<int>::const_iterator t = timesteps.begin(); t != timesteps.end(); ++t)
+	{
+		frame = next_frame ? next_frame : store.frame(*t);
+		std::set<int>::const_iterator next = t;
+		++next;
+		next_frame.reset();
+		if(next != timesteps.end())
+		{
+			next_frame = store.frame(*next);
+		}
+
+		for(HypothesesGraph::node_timestep_map::ItemIt n(timestep_map, *t); n != lemon::INVALID; ++n)
+		{
+			const Traxel& tr = traxel_in(*frame, traxel_map[n]);
+			computeDetectionEnergy(graph, fs, n, tr);
+			computeDivisionEnergy(graph, fs, n, tr);
+			computeAppearanceEnergy(graph, fs, n, tr);
+			computeDisappearanceEnergy(graph, fs, n, tr);
+			for(HypothesesGraph::OutArcIt a(graph, n); a != lemon::INVALID; ++a)
+			{
+				const Traxel& target = traxel_map[graph.target(a)];
+				if(!next_frame || target.Timestep != *next)
+				{
+					throw std::runtime_error("EnergyComputer: arcs have to end in the next timestep of the graph");
+				}
+				computeTransitionEnergy(graph, fs, a, tr, traxel_in(*next_frame, target));
+			}
+		}
 	}
 }
 
@@ -47,15 +111,13 @@ void EnergyComputer::storeNodeEnergies(
 	const feature_array& energies)
 {
 	TraxelMap& traxel_map = graph.get(node_traxel());
-    TrackletMap& tracklet_map = graph.get(node_tracklet());
 
     if(param_.with_tracklets)
     {
-    	for(std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin();
-            trax_it != tracklet_map[n].end(); 
-            ++trax_it)
+        const TrackletView& tracklets = graph.tracklets();
+    	for(size_t i = 0; i < tracklets.size(n); ++i)
 		{
-			const Traxel& tr = *trax_it;
+			const Traxel& tr = tracklets.traxel(n, i);
 		    assert(tr.get_feature_store() == fs);
 		    fs->get_traxel_features(tr)[energyNames_[t]] = energies;
 		}
@@ -107,11 +169,8 @@ void EnergyComputer::convexifyEnergies(feature_array& energies, feature_type eps
 	}
 }
 
-void EnergyComputer::computeDetectionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n)
+void EnergyComputer::computeDetectionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& traxel)
 {
-	TraxelMap& traxel_map = graph.get(node_traxel());
-    TrackletMap& tracklet_map = graph.get(node_tracklet());
-
     feature_array energyPerCellCount(param_.max_number_objects + 1, std::numeric_limits<feature_type>::infinity());
     for(size_t state = 0; state <= param_.max_number_objects; ++state)
     {
@@ -120,23 +179,20 @@ void EnergyComputer::computeDetectionEnergy(HypothesesGraph& graph, boost::share
     	if(param_.with_tracklets)
         {
             energy = 0;
+            const TrackletView& tracklets = graph.tracklets();
             // add all detection factors of the internal nodes
-            for(std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin();
-                trax_it != tracklet_map[n].end(); 
-                ++trax_it)
+            for(size_t i = 0; i < tracklets.size(n); ++i)
             {
-                energy += param_.detection(*trax_it, state);
+                energy += param_.detection(tracklets.traxel(n, i), state);
             }
 
             // add all transition factors of the internal arcs
             Traxel tr_prev;
             bool first = true;
-            for(std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin();
-                trax_it != tracklet_map[n].end(); 
-                ++trax_it)
+            for(size_t i = 0; i < tracklets.size(n); ++i)
             {
-                LOG(logDEBUG4) << "internal arcs traxel " << *trax_it;
-                Traxel tr = *trax_it;
+                LOG(logDEBUG4) << "internal arcs traxel " << tracklets.traxel(n, i);
+                Traxel tr = tracklets.traxel(n, i);
                 if(!first)
                     energy += param_.transition( get_transition_probability(tr_prev, tr, state) );
 //                    energy += param_.transition( tr_prev, tr, state);
@@ -146,57 +202,43 @@ void EnergyComputer::computeDetectionEnergy(HypothesesGraph& graph, boost::share
             }
         }
         else
-            energy = param_.detection(traxel_map[n], state);
+            energy = param_.detection(traxel, state);
     }
 
 	convexifyEnergies(energyPerCellCount);
     storeNodeEnergies(graph, fs, n, Detection, energyPerCellCount);
 }
 
-void EnergyComputer::computeDivisionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n)
+void EnergyComputer::computeDivisionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr)
 {
     if(!param_.with_divisions)
         return;
 
-	TraxelMap& traxel_map = graph.get(node_traxel());
-    TrackletMap& tracklet_map = graph.get(node_tracklet());
-
-	Traxel tr;
-    if (param_.with_tracklets)
-    {
-        tr = tracklet_map[n].back();
-    }
-    else
-    {
-        tr = traxel_map[n];
-    }
+    const Traxel& parent = param_.with_tracklets ? graph.tracklets().back(n) : tr;
 
     feature_array division_energy;
     for (size_t state = 0; state <= 1; ++state)
     {
-        division_energy.push_back(param_.division(tr, state));
+        division_energy.push_back(param_.division(parent, state));
     }
 
 	// no need to convexify as this is binary
     storeNodeEnergies(graph, fs, n, Division, division_energy);
 }
 
-void EnergyComputer::computeAppearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n)
+void EnergyComputer::computeAppearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr)
 {
     if(!param_.with_appearance)
         return;
 
-	TraxelMap& traxel_map = graph.get(node_traxel());
-    TrackletMap& tracklet_map = graph.get(node_tracklet());
-
 	int node_begin_time = -1;
     if (param_.with_tracklets)
     {
-        node_begin_time = tracklet_map[n].front().Timestep;
+        node_begin_time = graph.tracklets().front(n).Timestep;
     }
     else
     {
-        node_begin_time = traxel_map[n].Timestep;
+        node_begin_time = tr.Timestep;
     }
 
     double energy;
@@ -209,11 +251,11 @@ void EnergyComputer::computeAppearanceEnergy(HypothesesGraph& graph, boost::shar
     {
         if (param_.with_tracklets)
         {
-            energy = param_.appearance_cost_fn(tracklet_map[n].front());
+            energy = param_.appearance_cost_fn(graph.tracklets().front(n));
         }
         else
         {
-            energy = param_.appearance_cost_fn(traxel_map[n]);
+            energy = param_.appearance_cost_fn(tr);
         }
     }
 
@@ -225,22 +267,19 @@ void EnergyComputer::computeAppearanceEnergy(HypothesesGraph& graph, boost::shar
     storeNodeEnergies(graph, fs, n, Appearance, energyPerCellCount);
 }
 
-void EnergyComputer::computeDisappearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n)
+void EnergyComputer::computeDisappearanceEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Node n, const Traxel& tr)
 {
     if(!param_.with_disappearance)
         return;
-    
-	TraxelMap& traxel_map = graph.get(node_traxel());
-    TrackletMap& tracklet_map = graph.get(node_tracklet());
 
     int node_end_time = -1;
     if (param_.with_tracklets)
     {
-        node_end_time = tracklet_map[n].back().Timestep;
+        node_end_time = graph.tracklets().back(n).Timestep;
     }
     else
     {
-        node_end_time = traxel_map[n].Timestep;
+        node_end_time = tr.Timestep;
     }
 
     double energy;
@@ -249,11 +288,11 @@ void EnergyComputer::computeDisappearanceEnergy(HypothesesGraph& graph, boost::s
     {
         if (param_.with_tracklets)
         {
-            energy = param_.disappearance_cost_fn(tracklet_map[n].back());
+            energy = param_.disappearance_cost_fn(graph.tracklets().back(n));
         }
         else
         {
-            energy = param_.disappearance_cost_fn(traxel_map[n]);
+            energy = param_.disappearance_cost_fn(tr);
         }
     }
     else
@@ -279,7 +318,7 @@ double EnergyComputer::get_transition_prob(double distance, size_t state, double
     return prob;
 }
 
-double EnergyComputer::get_transition_probability(Traxel& tr1, Traxel& tr2, size_t state) const
+double EnergyComputer::get_transition_probability(const Traxel& tr1, const Traxel& tr2, size_t state) const
 {
     double prob;
     double distance = 0;
@@ -298,22 +337,11 @@ double EnergyComputer::get_transition_probability(Traxel& tr1, Traxel& tr2, size
     return prob;
 }
 
-void EnergyComputer::computeTransitionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Arc a)
+void EnergyComputer::computeTransitionEnergy(HypothesesGraph& graph, boost::shared_ptr<FeatureStore> fs, HypothesesGraph::Arc a,
+    const Traxel& from, const Traxel& to)
 {
-	TraxelMap& traxel_map = graph.get(node_traxel());
-    TrackletMap& tracklet_map = graph.get(node_tracklet());
-
-    Traxel tr1, tr2;
-    if (param_.with_tracklets)
-    {
-        tr1 = tracklet_map[graph.source(a)].back();
-        tr2 = tracklet_map[graph.target(a)].front();
-    }
-    else
-    {
-        tr1 = traxel_map[graph.source(a)];
-        tr2 = traxel_map[graph.target(a)];
-    }
+    const Traxel& tr1 = param_.with_tracklets ? graph.tracklets().back(graph.source(a)) : from;
+    const Traxel& tr2 = param_.with_tracklets ? graph.tracklets().front(graph.target(a)) : to;
 
     feature_array energyPerCellCount;
     for (size_t state = 0; state <= param_.max_number_objects; ++state)
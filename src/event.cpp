@@ -1,4 +1,5 @@
 #include "pgmlink/event.h"
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 #include <stdexcept>
@@ -155,4 +156,346 @@ ostream& operator<< (ostream &out, const Event &e)
     return out;
 }
 
+///
+/// class EventTable
+///
+const size_t EventTable::id_slots;
+const uint64_t EventTable::invalid_id;
+const uint64_t EventTable::no_offset;
+
+EventTable::EventTable(size_t n_iterations, int first_timestep, size_t n_timesteps)
+    : n_iterations_(n_iterations), first_timestep_(first_timestep), n_timesteps_(n_timesteps)
+{
+}
+
+EventTable::EventTable(const EventVectorVector& events, int first_timestep)
+    : n_iterations_(1), first_timestep_(first_timestep), n_timesteps_(events.size())
+{
+    add_events(events, 0);
+}
+
+EventTable::EventTable(const EventVectorVectorVector& events, int first_timestep)
+    : n_iterations_(events.size()), first_timestep_(first_timestep), n_timesteps_(0)
+{
+    for(size_t i = 0; i < events.size(); ++i)
+    {
+        n_timesteps_ = std::max(n_timesteps_, events[i].size());
+    }
+    for(size_t i = 0; i < events.size(); ++i)
+    {
+        add_events(events[i], i);
+    }
+}
+
+void EventTable::add_events(const EventVectorVector& events, size_t iteration)
+{
+    size_t n_events = 0;
+    for(EventVectorVector::const_iterator t_it = events.begin(); t_it != events.end(); ++t_it)
+    {
+        n_events += t_it->size();
+    }
+    reserve(size() + n_events);
+
+    for(size_t t = 0; t < events.size(); ++t)
+    {
+        for(EventVector::const_iterator e = events[t].begin(); e != events[t].end(); ++e)
+        {
+            add_event(*e, first_timestep_ + static_cast<int>(t), iteration);
+        }
+    }
+}
+
+void EventTable::reserve(size_t n_rows)
+{
+    types_.reserve(n_rows);
+    timesteps_.reserve(n_rows);
+    iterations_.reserve(n_rows);
+    energies_.reserve(n_rows);
+    n_traxel_ids_.reserve(n_rows);
+    n_features_.reserve(n_rows);
+    traxel_ids_.reserve(n_rows * id_slots);
+    extra_id_offsets_.reserve(n_rows);
+    feature_offsets_.reserve(n_rows);
+}
+
+EventTable& EventTable::add_event(Event::EventType type, int timestep, size_t iteration, double energy)
+{
+    if(timestep < first_timestep_ || timestep >= first_timestep_ + static_cast<int>(n_timesteps_)
+            || iteration >= n_iterations_)
+    {
+        stringstream msg;
+        msg << "EventTable::add_event(): timestep " << timestep << " or iteration " << iteration
+            << " out of range";
+        throw out_of_range(msg.str());
+    }
+    types_.push_back(static_cast<uint8_t>(type));
+    timesteps_.push_back(timestep);
+    iterations_.push_back(static_cast<uint32_t>(iteration));
+    energies_.push_back(energy);
+    n_traxel_ids_.push_back(0);
+    n_features_.push_back(0);
+    traxel_ids_.insert(traxel_ids_.end(), id_slots, invalid_id);
+    extra_id_offsets_.push_back(no_offset);
+    feature_offsets_.push_back(no_offset);
+    return *this;
+}
+
+EventTable& EventTable::add_traxel_id(uint64_t id)
+{
+    if(size() == 0)
+    {
+        throw runtime_error("EventTable::add_traxel_id(): table is empty");
+    }
+    const size_t row = size() - 1;
+    uint32_t& n_ids = n_traxel_ids_[row];
+    if(n_ids < id_slots)
+    {
+        traxel_ids_[row * id_slots + n_ids] = id;
+    }
+    else
+    {
+        // the overflow of the last row is always at the end of the buffer
+        if(extra_id_offsets_[row] == no_offset)
+        {
+            extra_id_offsets_[row] = extra_ids_.size();
+        }
+        extra_ids_.push_back(id);
+    }
+    ++n_ids;
+    return *this;
+}
+
+EventTable& EventTable::add_event(const Event& e, int timestep, size_t iteration)
+{
+    add_event(e.type, timestep, iteration, e.energy());
+    for(size_t i = 0; i < e.traxel_ids.size(); ++i)
+    {
+        add_traxel_id(e.traxel_ids[i]);
+    }
+    if(e.number_of_features() > 0)
+    {
+        const size_t row = size() - 1;
+        n_features_[row] = e.number_of_features();
+        feature_offsets_[row] = feature_data_.size();
+        feature_data_.insert(feature_data_.end(), e.features().begin(), e.features().end());
+        feature_data_.insert(feature_data_.end(), e.weights().begin(), e.weights().end());
+    }
+    return *this;
+}
+
+EventTable& EventTable::add_row(const EventTable& other, size_t row)
+{
+    add_event(other.type(row), other.timestep(row), other.iteration(row), other.energy(row));
+    for(size_t i = 0; i < other.n_traxel_ids(row); ++i)
+    {
+        add_traxel_id(other.traxel_id(row, i));
+    }
+    const size_t n = other.n_features(row);
+    if(n > 0)
+    {
+        const size_t new_row = size() - 1;
+        n_features_[new_row] = n;
+        feature_offsets_[new_row] = feature_data_.size();
+        const double* data = other.features(row);
+        feature_data_.insert(feature_data_.end(), data, data + 2 * n);
+    }
+    return *this;
+}
+
+uint64_t EventTable::traxel_id(size_t row, size_t i) const
+{
+    if(i >= n_traxel_ids_[row])
+    {
+        throw out_of_range("EventTable::traxel_id(): index out of range");
+    }
+    if(i < id_slots)
+    {
+        return traxel_ids_[row * id_slots + i];
+    }
+    return extra_ids_[extra_id_offsets_[row] + i - id_slots];
+}
+
+const double* EventTable::features(size_t row) const
+{
+    if(n_features_[row] == 0)
+    {
+        return NULL;
+    }
+    return &feature_data_[feature_offsets_[row]];
+}
+
+const double* EventTable::weights(size_t row) const
+{
+    if(n_features_[row] == 0)
+    {
+        return NULL;
+    }
+    return &feature_data_[feature_offsets_[row] + n_features_[row]];
+}
+
+Event EventTable::event(size_t row) const
+{
+    Event e;
+    e.type = type(row);
+    e.traxel_ids.reserve(n_traxel_ids(row));
+    for(size_t i = 0; i < n_traxel_ids(row); ++i)
+    {
+        e.traxel_ids.push_back(traxel_id(row, i));
+    }
+    e.set_energy(energy(row));
+    const size_t n = n_features(row);
+    if(n > 0)
+    {
+        e.number_of_features(n);
+        e.features(std::vector<double>(features(row), features(row) + n));
+        e.weights(std::vector<double>(weights(row), weights(row) + n));
+    }
+    return e;
+}
+
+void EventTable::to_events(size_t iteration, EventVectorVector& events) const
+{
+    events.assign(n_timesteps_, EventVector());
+    for(size_t row = 0; row < size(); ++row)
+    {
+        if(iterations_[row] == iteration)
+        {
+            events[timesteps_[row] - first_timestep_].push_back(event(row));
+        }
+    }
+}
+
+void EventTable::to_events(EventVectorVectorVector& events) const
+{
+    events.assign(n_iterations_, EventVectorVector(n_timesteps_));
+    for(size_t row = 0; row < size(); ++row)
+    {
+        events[iterations_[row]][timesteps_[row] - first_timestep_].push_back(event(row));
+    }
+}
+
+///
+/// flat event records
+///
+namespace
+{
+EventRecord make_record(const Event& e, int timestep, int iteration)
+{
+    EventRecord r;
+    r.type = static_cast<int32_t>(e.type);
+    r.timestep = timestep;
+    r.iteration = iteration;
+    r.n_traxel_ids = 0;
+    for(size_t i = 0; i < EventRecord::max_traxel_ids; ++i)
+    {
+        r.traxel_ids[i] = EventRecord::invalid_id;
+    }
+    r.energy = e.energy();
+    return r;
+}
+} /* anonymous namespace */
+
+void flatten_events(const EventVectorVector& events,
+                    std::vector<EventRecord>& records,
+                    int iteration,
+                    int first_timestep)
+{
+    size_t n_events = 0;
+    for(EventVectorVector::const_iterator t_it = events.begin(); t_it != events.end(); ++t_it)
+    {
+        n_events += t_it->size();
+    }
+    records.reserve(records.size() + n_events);
+
+    for(size_t t = 0; t < events.size(); ++t)
+    {
+        const int timestep = static_cast<int>(t) + first_timestep;
+        for(EventVector::const_iterator e = events[t].begin(); e != events[t].end(); ++e)
+        {
+            if(e->type == Event::ResolvedTo && e->traxel_ids.size() > 2)
+            {
+                // one record per object the merger was resolved to
+                for(size_t i = 1; i < e->traxel_ids.size(); ++i)
+                {
+                    EventRecord r = make_record(*e, timestep, iteration);
+                    r.n_traxel_ids = 2;
+                    r.traxel_ids[0] = e->traxel_ids[0];
+                    r.traxel_ids[1] = e->traxel_ids[i];
+                    records.push_back(r);
+                }
+                continue;
+            }
+
+            if(e->traxel_ids.size() > EventRecord::max_traxel_ids)
+            {
+                stringstream msg;
+                msg << "flatten_events(): event " << *e << " has more than "
+                    << EventRecord::max_traxel_ids << " traxel ids";
+                throw runtime_error(msg.str());
+            }
+
+            EventRecord r = make_record(*e, timestep, iteration);
+            r.n_traxel_ids = e->traxel_ids.size();
+            std::copy(e->traxel_ids.begin(), e->traxel_ids.end(), r.traxel_ids);
+            records.push_back(r);
+        }
+    }
+}
+
+void flatten_events(const EventVectorVectorVector& events,
+                    std::vector<EventRecord>& records,
+                    int first_timestep)
+{
+    for(size_t iteration = 0; iteration < events.size(); ++iteration)
+    {
+        flatten_events(events[iteration], records, iteration, first_timestep);
+    }
+}
+
+void flatten_events(const EventTable& events,
+                    std::vector<EventRecord>& records)
+{
+    records.reserve(records.size() + events.size());
+    for(size_t row = 0; row < events.size(); ++row)
+    {
+        EventRecord r;
+        r.type = static_cast<int32_t>(events.type(row));
+        r.timestep = events.timestep(row);
+        r.iteration = static_cast<int32_t>(events.iteration(row));
+        r.energy = events.energy(row);
+        for(size_t i = 0; i < EventRecord::max_traxel_ids; ++i)
+        {
+            r.traxel_ids[i] = EventRecord::invalid_id;
+        }
+
+        const size_t n_ids = events.n_traxel_ids(row);
+        if(events.type(row) == Event::ResolvedTo && n_ids > 2)
+        {
+            // one record per object the merger was resolved to
+            r.n_traxel_ids = 2;
+            r.traxel_ids[0] = events.traxel_id(row, 0);
+            for(size_t i = 1; i < n_ids; ++i)
+            {
+                r.traxel_ids[1] = events.traxel_id(row, i);
+                records.push_back(r);
+            }
+            continue;
+        }
+
+        if(n_ids > EventRecord::max_traxel_ids)
+        {
+            stringstream msg;
+            msg << "flatten_events(): event " << events.event(row) << " has more than "
+                << EventRecord::max_traxel_ids << " traxel ids";
+            throw runtime_error(msg.str());
+        }
+        r.n_traxel_ids = n_ids;
+        for(size_t i = 0; i < n_ids; ++i)
+        {
+            r.traxel_ids[i] = events.traxel_id(row, i);
+        }
+        records.push_back(r);
+    }
+}
+
 } /* namespace pgmlink */
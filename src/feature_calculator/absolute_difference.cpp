@@ -27,13 +27,32 @@ feature_array AbsoluteDifferenceCalculator::calculate(const feature_array&f1, co
     feature_array::const_iterator f2_it = f2.begin();
     for (; f1_it != f1.end(); ++f1_it, ++f2_it)
     {
-        float res = *f1_it - *f2_it;
+        feature_type res = *f1_it - *f2_it;
         ret[0] += res > 0 ? res : -res;
     }
     return ret;
 }
 
 
+void AbsoluteDifferenceCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    const size_t row_count = f1.shape(0);
+    // same layout as calculate(): the sum goes to the first of f1.size() entries
+    result.reshape(f1.shape(), 0.);
+    feature_type* ret = result.data();
+    for (size_t col = 0; col < static_cast<size_t>(f1.shape(1)); ++col)
+    {
+        const feature_type* a = f1.data() + col * row_count;
+        const feature_type* b = f2.data() + col * row_count;
+        for (size_t row = 0; row < row_count; ++row)
+        {
+            ret[row] += std::abs(a[row] - b[row]);
+        }
+    }
+}
+
+
 const std::string& AbsoluteDifferenceCalculator::name() const
 {
     return AbsoluteDifferenceCalculator::name_;
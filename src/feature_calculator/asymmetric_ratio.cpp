@@ -51,6 +51,34 @@ feature_array AsymmetricRatioCalculator::calculate(const feature_array&, const f
 }
 
 
+void AsymmetricRatioCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    if (result.shape() != f1.shape())
+    {
+        result.reshape(f1.shape());
+    }
+    const size_t size = f1.size();
+    const feature_type* a = f1.data();
+    const feature_type* b = f2.data();
+    feature_type* ret = result.data();
+    // same cases as calculate(), written as selects so that the loop vectorises
+    for (size_t i = 0; i < size; ++i)
+    {
+        const feature_type x = a[i];
+        const feature_type y = b[i];
+        const bool one = x == y || (x < 0.0001 && y < 0.0001);
+        ret[i] = one ? 1.0 : x / y;
+    }
+}
+
+
+void AsymmetricRatioCalculator::calculate_batch(const feature_matrix&, const feature_matrix& f2, const feature_matrix& f3, feature_matrix& result) const
+{
+    calculate_batch(f2, f3, result);
+}
+
+
 const std::string& AsymmetricRatioCalculator::name() const
 {
     return AsymmetricRatioCalculator::name_;
@@ -1,3 +1,6 @@
+// stl
+#include <stdexcept>
+
 // pgmlink
 #include "pgmlink/features/feature.h"
 #include "pgmlink/feature_calculator/base.h"
@@ -8,6 +11,35 @@ namespace pgmlink
 namespace feature_extraction
 {
 
+namespace
+{
+feature_array get_row(const feature_matrix& m, size_t row)
+{
+    feature_array ret(m.shape(1));
+    for (size_t col = 0; col < ret.size(); ++col)
+    {
+        ret[col] = m(row, col);
+    }
+    return ret;
+}
+
+void set_row(feature_matrix& m, size_t row, const feature_array& values)
+{
+    if (row == 0)
+    {
+        m.reshape(vigra::Shape2(m.shape(0), values.size()));
+    }
+    else if (values.size() != static_cast<size_t>(m.shape(1)))
+    {
+        throw std::runtime_error("FeatureCalculator::calculate_batch(): calculate() returned features of different length");
+    }
+    for (size_t col = 0; col < values.size(); ++col)
+    {
+        m(row, col) = values[col];
+    }
+}
+} // namespace
+
 ////
 //// class FeatureCalculator
 ////
@@ -41,6 +73,40 @@ const std::string& FeatureCalculator::name() const
 }
 
 
+void FeatureCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    const size_t row_count = f1.shape(0);
+    result.reshape(vigra::Shape2(row_count, 0));
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        set_row(result, row, calculate(get_row(f1, row), get_row(f2, row)));
+    }
+}
+
+
+void FeatureCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, const feature_matrix& f3, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    check_batch_shapes(f1, f3);
+    const size_t row_count = f1.shape(0);
+    result.reshape(vigra::Shape2(row_count, 0));
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        set_row(result, row, calculate(get_row(f1, row), get_row(f2, row), get_row(f3, row)));
+    }
+}
+
+
+void FeatureCalculator::check_batch_shapes(const feature_matrix& f1, const feature_matrix& f2)
+{
+    if (f1.shape() != f2.shape())
+    {
+        throw std::runtime_error("FeatureCalculator::calculate_batch(): feature matrices have different shapes");
+    }
+}
+
+
 bool FeatureCalculator::operator==(const FeatureCalculator& other)
 {
     return this->name_ == other.name();
@@ -38,6 +38,25 @@ feature_array ElementWiseSquaredDistanceCalculator::calculate(const feature_arra
 }
 
 
+void ElementWiseSquaredDistanceCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    if (result.shape() != f1.shape())
+    {
+        result.reshape(f1.shape());
+    }
+    const size_t size = f1.size();
+    const feature_type* a = f1.data();
+    const feature_type* b = f2.data();
+    feature_type* ret = result.data();
+    for (size_t i = 0; i < size; ++i)
+    {
+        const feature_type diff = a[i] - b[i];
+        ret[i] = diff * diff;
+    }
+}
+
+
 const std::string& ElementWiseSquaredDistanceCalculator::name() const
 {
     return name_;
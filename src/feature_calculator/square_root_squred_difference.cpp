@@ -32,6 +32,34 @@ feature_array SquareRootSquaredDifferenceCalculator::calculate(const feature_arr
 }
 
 
+void SquareRootSquaredDifferenceCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    const size_t row_count = f1.shape(0);
+    // same layout as calculate(): the norm goes to the first of f1.size() entries
+    result.reshape(f1.shape(), 0.);
+    if (f1.shape(1) == 0)
+    {
+        return;
+    }
+    feature_type* ret = result.data();
+    for (size_t col = 0; col < static_cast<size_t>(f1.shape(1)); ++col)
+    {
+        const feature_type* a = f1.data() + col * row_count;
+        const feature_type* b = f2.data() + col * row_count;
+        for (size_t row = 0; row < row_count; ++row)
+        {
+            const feature_type diff = a[row] - b[row];
+            ret[row] += diff * diff;
+        }
+    }
+    for (size_t row = 0; row < row_count; ++row)
+    {
+        ret[row] = sqrt(ret[row]);
+    }
+}
+
+
 const std::string& SquareRootSquaredDifferenceCalculator::name() const
 {
     return SquareRootSquaredDifferenceCalculator::name_;
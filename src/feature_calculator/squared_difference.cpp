@@ -33,6 +33,25 @@ feature_array SquaredDifferenceCalculator::calculate(const feature_array& f1, co
 }
 
 
+void SquaredDifferenceCalculator::calculate_batch(const feature_matrix& f1, const feature_matrix& f2, feature_matrix& result) const
+{
+    check_batch_shapes(f1, f2);
+    const size_t row_count = f1.shape(0);
+    result.reshape(vigra::Shape2(row_count, 1), 0.);
+    feature_type* ret = result.data();
+    for (size_t col = 0; col < static_cast<size_t>(f1.shape(1)); ++col)
+    {
+        const feature_type* a = f1.data() + col * row_count;
+        const feature_type* b = f2.data() + col * row_count;
+        for (size_t row = 0; row < row_count; ++row)
+        {
+            const feature_type diff = a[row] - b[row];
+            ret[row] += diff * diff;
+        }
+    }
+}
+
+
 const std::string& SquaredDifferenceCalculator::name() const
 {
     return SquaredDifferenceCalculator::name_;
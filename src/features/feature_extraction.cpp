@@ -22,6 +22,41 @@ namespace feature_extraction
 // class FeatureCalculator;
 
 
+namespace
+{
+// one row per traxel, all traxels need the feature with the same length
+void gather_features(const ConstTraxelRefVector& traxels, const std::string& feature_name, feature_matrix& features)
+{
+    size_t length = 0;
+    for (size_t row = 0; row < traxels.size(); ++row)
+    {
+        FeatureMap::const_iterator f = traxels[row]->features.find(feature_name);
+        if ( f == traxels[row]->features.end() )
+        {
+            throw std::runtime_error("Feature " + feature_name + " not present in traxel.");
+        }
+        if (row == 0)
+        {
+            length = f->second.size();
+            features.reshape(vigra::Shape2(traxels.size(), length));
+        }
+        else if (f->second.size() != length)
+        {
+            throw std::runtime_error("Feature " + feature_name + " has different lengths in the traxels.");
+        }
+        for (size_t col = 0; col < length; ++col)
+        {
+            features(row, col) = f->second[col];
+        }
+    }
+    if (traxels.empty())
+    {
+        features.reshape(vigra::Shape2(0, 0));
+    }
+}
+} // namespace
+
+
 ////
 //// class FeatureExtractor
 ////
@@ -87,6 +122,36 @@ feature_array FeatureExtractor::extract(const Traxel& t1, const Traxel& t2, cons
 }
 
 
+void FeatureExtractor::extract(const ConstTraxelRefVector& t1, const ConstTraxelRefVector& t2, feature_matrix& result) const
+{
+    if (t1.size() != t2.size())
+    {
+        throw std::runtime_error("FeatureExtractor::extract(): traxel vectors have different sizes");
+    }
+    feature_matrix features1, features2;
+    gather_features(t1, feature_name_, features1);
+    gather_features(t2, feature_name_, features2);
+    calculator_->calculate_batch(features1, features2, result);
+}
+
+
+void FeatureExtractor::extract(const ConstTraxelRefVector& t1,
+                               const ConstTraxelRefVector& t2,
+                               const ConstTraxelRefVector& t3,
+                               feature_matrix& result) const
+{
+    if (t1.size() != t2.size() || t1.size() != t3.size())
+    {
+        throw std::runtime_error("FeatureExtractor::extract(): traxel vectors have different sizes");
+    }
+    feature_matrix features1, features2, features3;
+    gather_features(t1, feature_name_, features1);
+    gather_features(t2, feature_name_, features2);
+    gather_features(t3, feature_name_, features3);
+    calculator_->calculate_batch(features1, features2, features3, result);
+}
+
+
 boost::shared_ptr<FeatureCalculator> FeatureExtractor::calculator() const
 {
     return calculator_;
@@ -161,6 +226,47 @@ MultipleFeatureExtraction::CombinedFeatureMap MultipleFeatureExtraction::operato
 }
 
 
+MultipleFeatureExtraction::CombinedFeatureMatrixMap MultipleFeatureExtraction::operator() ( const FeatureList& features,
+        const ConstTraxelRefVector& trax1,
+        const ConstTraxelRefVector& trax2 ) const
+{
+    CombinedFeatureMatrixMap res;
+    for ( FeatureList::const_iterator outer_features = features.begin(); outer_features != features.end(); ++outer_features)
+    {
+        boost::shared_ptr<FeatureCalculator> calc = helpers::CalculatorLookup::extract_calculator(outer_features->first );
+        for ( std::vector<std::string>::const_iterator inner_features = outer_features->second.begin();
+                inner_features != outer_features->second.end();
+                ++inner_features )
+        {
+            FeatureExtractor extractor( calc, *inner_features );
+            extractor.extract( trax1, trax2, res[std::make_pair(outer_features->first, *inner_features)] );
+        }
+    }
+    return res;
+}
+
+
+MultipleFeatureExtraction::CombinedFeatureMatrixMap MultipleFeatureExtraction::operator() ( const FeatureList& features,
+        const ConstTraxelRefVector& trax1,
+        const ConstTraxelRefVector& trax2,
+        const ConstTraxelRefVector& trax3 ) const
+{
+    CombinedFeatureMatrixMap res;
+    for ( FeatureList::const_iterator outer_features = features.begin(); outer_features != features.end(); ++outer_features)
+    {
+        boost::shared_ptr<FeatureCalculator> calc = helpers::CalculatorLookup::extract_calculator(outer_features->first );
+        for ( std::vector<std::string>::const_iterator inner_features = outer_features->second.begin();
+                inner_features != outer_features->second.end();
+                ++inner_features )
+        {
+            FeatureExtractor extractor( calc, *inner_features );
+            extractor.extract( trax1, trax2, trax3, res[std::make_pair(outer_features->first, *inner_features)] );
+        }
+    }
+    return res;
+}
+
+
 
 namespace helpers
 {
@@ -193,6 +299,23 @@ MultipleFeatureExtraction::CombinedFeatureMap convenience_feature_extraction( co
 }
 
 
+MultipleFeatureExtraction::CombinedFeatureMatrixMap convenience_feature_extraction( const MultipleFeatureExtraction::FeatureList& features,
+        const ConstTraxelRefVector& trax1,
+        const ConstTraxelRefVector& trax2 )
+{
+    return MultipleFeatureExtraction()( features, trax1, trax2 );
+}
+
+
+MultipleFeatureExtraction::CombinedFeatureMatrixMap convenience_feature_extraction( const MultipleFeatureExtraction::FeatureList& features,
+        const ConstTraxelRefVector& trax1,
+        const ConstTraxelRefVector& trax2,
+        const ConstTraxelRefVector& trax3 )
+{
+    return MultipleFeatureExtraction()( features, trax1, trax2, trax3 );
+}
+
+
 }
 
 
@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <hdf5.h>
+
+#include "pgmlink/features/feature_matrix_writer.h"
+#include "pgmlink/log.h"
+
+namespace pgmlink
+{
+namespace features
+{
+
+namespace
+{
+// elements per chunk of the stacked datasets (128 kB of doubles)
+const hsize_t chunk_elements = 16384;
+
+template<typename T>
+T check(T status, const std::string& what)
+{
+    if (status < 0)
+    {
+        throw std::runtime_error("FeatureMatrixWriter: " + what);
+    }
+    return status;
+}
+
+size_t block_bytes(const std::vector<double>& values, size_t n_items)
+{
+    return values.size() * sizeof(double) + n_items * 2 * sizeof(uint64_t);
+}
+
+// extendible dataset of rank 1 (columns == 0) or 2, chunked along the first axis
+hid_t create_extendible(hid_t file,
+                        const std::string& name,
+                        hid_t type,
+                        hsize_t columns,
+                        unsigned int compression)
+{
+    const int rank = columns == 0 ? 1 : 2;
+    hsize_t dims[2] = {0, columns};
+    hsize_t max_dims[2] = {H5S_UNLIMITED, columns};
+    hsize_t chunk[2] = {std::max<hsize_t>(1, chunk_elements / std::max<hsize_t>(1, columns)), columns};
+
+    hid_t space = check(H5Screate_simple(rank, dims, max_dims), "cannot create dataspace for " + name);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(dcpl, rank, chunk);
+    if (compression > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+    {
+        H5Pset_deflate(dcpl, compression);
+    }
+    hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+    H5Pset_create_intermediate_group(lcpl, 1);
+    hid_t dataset = H5Dcreate2(file, name.c_str(), type, space, lcpl, dcpl, H5P_DEFAULT);
+    H5Pclose(lcpl);
+    H5Pclose(dcpl);
+    H5Sclose(space);
+    return check(dataset, "cannot create dataset " + name);
+}
+
+// append n_rows rows to the first axis of dataset
+void append_rows(hid_t dataset,
+                 hid_t type,
+                 hsize_t old_rows,
+                 hsize_t n_rows,
+                 hsize_t columns,
+                 const void* data)
+{
+    if (n_rows == 0)
+    {
+        return;
+    }
+    const int rank = columns == 0 ? 1 : 2;
+    hsize_t dims[2] = {old_rows + n_rows, columns};
+    hsize_t start[2] = {old_rows, 0};
+    hsize_t count[2] = {n_rows, columns};
+    check(H5Dset_extent(dataset, dims), "cannot extend dataset");
+    hid_t file_space = check(H5Dget_space(dataset), "cannot get dataspace");
+    H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
+    hid_t memory_space = H5Screate_simple(rank, count, NULL);
+    herr_t status = H5Dwrite(dataset, type, memory_space, file_space, H5P_DEFAULT, data);
+    H5Sclose(memory_space);
+    H5Sclose(file_space);
+    check(status, "cannot write to dataset");
+}
+} // end anonymous namespace
+
+FeatureMatrixWriter::FeatureMatrixWriter(
+    const std::string& filename,
+    size_t buffer_size,
+    unsigned int compression)
+    : filename_(filename),
+      buffer_size_(buffer_size),
+      compression_(compression),
+      file_(-1),
+      open_(false),
+      pending_bytes_(0),
+      queued_bytes_(0),
+      busy_(false),
+      stop_(false)
+{
+    bool exists = std::ifstream(filename.c_str()).good();
+    if (exists && H5Fis_hdf5(filename.c_str()) <= 0)
+    {
+        throw std::runtime_error("FeatureMatrixWriter: " + filename + " is not an HDF5 file");
+    }
+    file_ = exists
+            ? H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT)
+            : H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    check(file_, "cannot open " + filename);
+    open_ = true;
+    // from here on only the writer thread talks to HDF5 until close()
+    thread_ = std::thread(&FeatureMatrixWriter::run, this);
+}
+
+FeatureMatrixWriter::~FeatureMatrixWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (std::exception& e)
+    {
+        LOG(logERROR) << "FeatureMatrixWriter: closing " << filename_ << " failed: " << e.what();
+    }
+}
+
+void FeatureMatrixWriter::append(
+    const std::string& name,
+    size_t id,
+    const double* data,
+    size_t rows,
+    size_t columns)
+{
+    if (!open_)
+    {
+        throw std::runtime_error("FeatureMatrixWriter::append(): writer is closed");
+    }
+    check_error();
+
+    if (rows > 0 && columns > 0)
+    {
+        std::map<std::string, size_t>::iterator known = columns_.find(name);
+        if (known == columns_.end())
+        {
+            columns_[name] = columns;
+        }
+        else if (known->second != columns)
+        {
+            throw std::runtime_error("FeatureMatrixWriter::append(): " + name
+                                     + " has matrices with different numbers of columns");
+        }
+    }
+    else
+    {
+        rows = 0;
+    }
+
+    Block& block = pending_[name];
+    if (block.name.empty())
+    {
+        block.name = name;
+    }
+    if (!block.stacked)
+    {
+        throw std::runtime_error("FeatureMatrixWriter::append(): " + name + " is a single matrix");
+    }
+    if (rows > 0)
+    {
+        block.columns = columns;
+    }
+    block.ids.push_back(id);
+    block.rows.push_back(rows);
+    // transpose into row-major order
+    const size_t offset = block.values.size();
+    block.values.resize(offset + rows * columns);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (size_t j = 0; j < columns; ++j)
+        {
+            block.values[offset + i * columns + j] = data[i + j * rows];
+        }
+    }
+
+    pending_bytes_ += rows * columns * sizeof(double) + 2 * sizeof(uint64_t);
+    if (pending_bytes_ >= buffer_size_)
+    {
+        queue_pending();
+    }
+}
+
+void FeatureMatrixWriter::write(
+    const std::string& name,
+    const double* data,
+    size_t rows,
+    size_t columns)
+{
+    if (!open_)
+    {
+        throw std::runtime_error("FeatureMatrixWriter::write(): writer is closed");
+    }
+    check_error();
+    if (columns_.count(name) > 0 || (pending_.count(name) > 0 && pending_[name].stacked))
+    {
+        throw std::runtime_error("FeatureMatrixWriter::write(): " + name + " is a stacked dataset");
+    }
+
+    Block& block = pending_[name];
+    block.name = name;
+    block.stacked = false;
+    block.columns = columns;
+    block.rows.assign(1, rows);
+    block.values.assign(data, data + rows * columns);
+    pending_bytes_ += rows * columns * sizeof(double);
+    if (pending_bytes_ >= buffer_size_)
+    {
+        queue_pending();
+    }
+}
+
+void FeatureMatrixWriter::flush()
+{
+    if (!open_)
+    {
+        return;
+    }
+    queue_pending();
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return queue_.empty() && !busy_; });
+    }
+    check_error();
+}
+
+void FeatureMatrixWriter::close()
+{
+    if (!open_)
+    {
+        return;
+    }
+    queue_pending();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+
+    for (std::map<std::string, Dataset>::iterator it = datasets_.begin(); it != datasets_.end(); ++it)
+    {
+        if (it->second.values >= 0)
+        {
+            H5Dclose(it->second.values);
+        }
+        H5Dclose(it->second.offsets);
+        H5Dclose(it->second.ids);
+    }
+    datasets_.clear();
+    H5Fclose(file_);
+    file_ = -1;
+    open_ = false;
+    check_error();
+}
+
+void FeatureMatrixWriter::queue_pending()
+{
+    if (pending_.empty())
+    {
+        return;
+    }
+    std::vector<Block> blocks;
+    blocks.reserve(pending_.size());
+    size_t bytes = 0;
+    for (std::map<std::string, Block>::iterator it = pending_.begin(); it != pending_.end(); ++it)
+    {
+        bytes += block_bytes(it->second.values, it->second.ids.size());
+        blocks.push_back(Block());
+        blocks.back().name.swap(it->second.name);
+        blocks.back().stacked = it->second.stacked;
+        blocks.back().columns = it->second.columns;
+        blocks.back().ids.swap(it->second.ids);
+        blocks.back().rows.swap(it->second.rows);
+        blocks.back().values.swap(it->second.values);
+    }
+    pending_.clear();
+    pending_bytes_ = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // do not let the buffers grow without bound if the disk is slower than the features
+        done_cv_.wait(lock, [this] { return queued_bytes_ <= 2 * buffer_size_ || !error_.empty(); });
+        queue_.push_back(std::vector<Block>());
+        queue_.back().swap(blocks);
+        queued_bytes_ += bytes;
+    }
+    cv_.notify_one();
+}
+
+void FeatureMatrixWriter::check_error()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_.empty())
+    {
+        throw std::runtime_error(error_);
+    }
+}
+
+void FeatureMatrixWriter::run()
+{
+    while (true)
+    {
+        std::vector<Block> blocks;
+        bool failed;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+            if (queue_.empty())
+            {
+                break;
+            }
+            blocks.swap(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+            failed = !error_.empty();
+        }
+
+        size_t bytes = 0;
+        for (size_t k = 0; k < blocks.size(); ++k)
+        {
+            bytes += block_bytes(blocks[k].values, blocks[k].ids.size());
+        }
+        std::string error;
+        for (size_t k = 0; k < blocks.size() && !failed; ++k)
+        {
+            try
+            {
+                write_block(blocks[k]);
+            }
+            catch (std::exception& e)
+            {
+                // the file is in an unknown state, do not write anything else
+                error = e.what();
+                failed = true;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_ = false;
+            queued_bytes_ -= std::min(queued_bytes_, bytes);
+            if (!error.empty() && error_.empty())
+            {
+                error_ = error;
+            }
+        }
+        done_cv_.notify_all();
+    }
+    LOG(logDEBUG1) << "FeatureMatrixWriter: writer for " << filename_ << " stopped";
+}
+
+void FeatureMatrixWriter::write_block(const Block& block)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_.empty())
+        {
+            // the file is in an unknown state, do not make it worse
+            return;
+        }
+    }
+
+    if (!block.stacked)
+    {
+        remove_link(block.name);
+        // like vigra: the first axis of the matrix is the last axis in the file
+        hsize_t dims[2] = {block.columns, block.rows[0]};
+        hid_t space = check(H5Screate_simple(2, dims, NULL), "cannot create dataspace for " + block.name);
+        hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+        H5Pset_create_intermediate_group(lcpl, 1);
+        hid_t dataset = H5Dcreate2(file_, block.name.c_str(), H5T_NATIVE_DOUBLE, space, lcpl, H5P_DEFAULT, H5P_DEFAULT);
+        H5Pclose(lcpl);
+        herr_t status = dataset < 0 ? -1 : H5Dwrite(dataset, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, block.values.data());
+        if (dataset >= 0)
+        {
+            H5Dclose(dataset);
+        }
+        H5Sclose(space);
+        check(status, "cannot write " + block.name);
+        return;
+    }
+
+    Dataset& d = dataset(block);
+    if (d.values < 0 && block.columns > 0)
+    {
+        d.values = create_extendible(file_, block.name + "/values", H5T_NATIVE_DOUBLE, block.columns, compression_);
+    }
+    const hsize_t n_rows = block.columns > 0 ? block.values.size() / block.columns : 0;
+    if (n_rows > 0)
+    {
+        append_rows(d.values, H5T_NATIVE_DOUBLE, d.n_rows, n_rows, block.columns, block.values.data());
+    }
+
+    std::vector<uint64_t> offsets(block.rows.size());
+    uint64_t end = d.n_rows;
+    for (size_t k = 0; k < block.rows.size(); ++k)
+    {
+        end += block.rows[k];
+        offsets[k] = end;
+    }
+    append_rows(d.offsets, H5T_NATIVE_UINT64, d.n_items + 1, offsets.size(), 0, offsets.data());
+    append_rows(d.ids, H5T_NATIVE_UINT64, d.n_items, block.ids.size(), 0, block.ids.data());
+    d.n_rows = end;
+    d.n_items += block.ids.size();
+}
+
+FeatureMatrixWriter::Dataset& FeatureMatrixWriter::dataset(const Block& block)
+{
+    std::map<std::string, Dataset>::iterator it = datasets_.find(block.name);
+    if (it != datasets_.end())
+    {
+        return it->second;
+    }
+
+    remove_link(block.name);
+    Dataset d;
+    d.values = -1;
+    d.n_rows = 0;
+    d.n_items = 0;
+    d.offsets = create_extendible(file_, block.name + "/offsets", H5T_NATIVE_UINT64, 0, compression_);
+    d.ids = create_extendible(file_, block.name + "/ids", H5T_NATIVE_UINT64, 0, compression_);
+    const uint64_t zero = 0;
+    append_rows(d.offsets, H5T_NATIVE_UINT64, 0, 1, 0, &zero);
+    return datasets_[block.name] = d;
+}
+
+void FeatureMatrixWriter::remove_link(const std::string& name)
+{
+    // H5Lexists needs all parents to exist, so check them one by one
+    size_t end = 0;
+    while (end != std::string::npos)
+    {
+        end = name.find('/', end + 1);
+        const std::string path = name.substr(0, end);
+        if (!path.empty() && H5Lexists(file_, path.c_str(), H5P_DEFAULT) <= 0)
+        {
+            return;
+        }
+    }
+    check(H5Ldelete(file_, name.c_str(), H5P_DEFAULT), "cannot replace " + name);
+}
+
+} // end namespace features
+} // end namespace pgmlink
@@ -0,0 +1,233 @@
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <stdint.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "pgmlink/features/feature_vector_file.h"
+#include "pgmlink/log.h"
+
+namespace pgmlink
+{
+namespace features
+{
+
+namespace
+{
+const char magic[8] = {'P', 'G', 'M', 'L', 'F', 'V', '1', '\0'};
+
+void write_header(std::ofstream& out, const std::vector<std::string>& feature_names)
+{
+    uint64_t header_size = sizeof(magic) + 2 * sizeof(uint64_t);
+    for (size_t i = 0; i < feature_names.size(); ++i)
+    {
+        header_size += sizeof(uint32_t) + feature_names[i].size();
+    }
+    const uint64_t offset = (header_size + 7) / 8 * 8;
+    const uint64_t n_features = feature_names.size();
+
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&n_features), sizeof(n_features));
+    out.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    for (size_t i = 0; i < feature_names.size(); ++i)
+    {
+        const uint32_t length = feature_names[i].size();
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(feature_names[i].data(), length);
+    }
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    out.write(padding, offset - header_size);
+}
+
+void write_row(std::ofstream& out, const std::vector<double>& features)
+{
+    out.write(reinterpret_cast<const char*>(features.data()), features.size() * sizeof(double));
+}
+} // end anonymous namespace
+
+void FeatureVectorFile::append(
+    const std::string& filename,
+    const std::vector<std::string>& feature_names,
+    const std::vector<double>& features)
+{
+    if (feature_names.size() != features.size())
+    {
+        throw std::runtime_error("FeatureVectorFile::append(): number of feature names and features differ");
+    }
+
+    if (!std::ifstream(filename.c_str()).good())
+    {
+        std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+        write_header(out, feature_names);
+        write_row(out, features);
+        if (!out)
+        {
+            throw std::runtime_error("FeatureVectorFile::append(): cannot write " + filename);
+        }
+        return;
+    }
+
+    std::vector<std::string> stored_names;
+    const size_t offset = read_header(filename, stored_names);
+    if (stored_names != feature_names)
+    {
+        throw std::runtime_error("FeatureVectorFile::append(): " + filename + " stores different features");
+    }
+    const size_t size = std::ifstream(filename.c_str(), std::ios::binary | std::ios::ate).tellg();
+    if (!features.empty() && (size - offset) % (features.size() * sizeof(double)) != 0)
+    {
+        throw std::runtime_error("FeatureVectorFile::append(): " + filename + " ends with an incomplete row");
+    }
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::app);
+    write_row(out, features);
+    if (!out)
+    {
+        throw std::runtime_error("FeatureVectorFile::append(): cannot write " + filename);
+    }
+}
+
+size_t FeatureVectorFile::read_header(
+    const std::string& filename,
+    std::vector<std::string>& feature_names)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    char file_magic[sizeof(magic)];
+    uint64_t n_features = 0;
+    uint64_t offset = 0;
+    in.read(file_magic, sizeof(file_magic));
+    in.read(reinterpret_cast<char*>(&n_features), sizeof(n_features));
+    in.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+    if (!in || std::memcmp(file_magic, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("FeatureVectorFile: " + filename + " is not a feature vector file");
+    }
+
+    feature_names.resize(n_features);
+    for (size_t i = 0; i < n_features; ++i)
+    {
+        uint32_t length = 0;
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        feature_names[i].resize(length);
+        if (length > 0)
+        {
+            in.read(&feature_names[i][0], length);
+        }
+    }
+    if (!in || static_cast<uint64_t>(in.tellg()) > offset)
+    {
+        throw std::runtime_error("FeatureVectorFile: header of " + filename + " is corrupt");
+    }
+    return offset;
+}
+
+size_t FeatureVectorFile::data_offset(const std::string& filename)
+{
+    std::vector<std::string> feature_names;
+    return read_header(filename, feature_names);
+}
+
+size_t FeatureVectorFile::read(
+    const std::string& filename,
+    std::vector<std::string>& feature_names,
+    std::vector<std::vector<double> >& proposals)
+{
+    const size_t offset = read_header(filename, feature_names);
+    std::ifstream in(filename.c_str(), std::ios::binary | std::ios::ate);
+    const size_t size = in.tellg();
+    const size_t row_size = feature_names.size() * sizeof(double);
+    const size_t n_proposals = row_size > 0 ? (size - offset) / row_size : 0;
+    if (row_size > 0 && (size - offset) % row_size != 0)
+    {
+        LOG(logWARNING) << "FeatureVectorFile::read(): ignoring incomplete last row of " << filename;
+    }
+
+    in.seekg(offset);
+    proposals.assign(n_proposals, std::vector<double>(feature_names.size()));
+    for (size_t k = 0; k < n_proposals; ++k)
+    {
+        in.read(reinterpret_cast<char*>(proposals[k].data()), row_size);
+    }
+    if (!in)
+    {
+        throw std::runtime_error("FeatureVectorFile::read(): cannot read " + filename);
+    }
+    return n_proposals;
+}
+
+size_t FeatureVectorFile::convert_text_file(
+    const std::string& text_filename,
+    const std::string& filename,
+    const std::vector<std::string>& feature_names)
+{
+    std::ifstream text_file(text_filename.c_str());
+    if (!text_file.good())
+    {
+        throw std::runtime_error("FeatureVectorFile::convert_text_file(): cannot open " + text_filename);
+    }
+
+    // one line per feature, one column per proposal
+    std::vector<std::vector<double> > features;
+    std::string line;
+    while (std::getline(text_file, line))
+    {
+        line = line.substr(0, line.find('#'));
+        boost::algorithm::trim(line);
+        if (line.empty())
+        {
+            continue;
+        }
+        std::istringstream linestream(line);
+        features.push_back(std::vector<double>());
+        double f;
+        while (linestream >> f)
+        {
+            features.back().push_back(f);
+        }
+        if (features.back().size() != features.front().size())
+        {
+            throw std::runtime_error("FeatureVectorFile::convert_text_file(): features of "
+                                     + text_filename + " have different numbers of proposals");
+        }
+    }
+
+    std::vector<std::string> names(feature_names);
+    if (names.empty())
+    {
+        for (size_t i = 0; i < features.size(); ++i)
+        {
+            names.push_back(boost::lexical_cast<std::string>(i));
+        }
+    }
+    else if (names.size() != features.size())
+    {
+        throw std::runtime_error("FeatureVectorFile::convert_text_file(): " + text_filename
+                                 + " does not have one line per feature name");
+    }
+
+    const size_t n_proposals = features.empty() ? 0 : features.front().size();
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+    write_header(out, names);
+    std::vector<double> row(features.size());
+    for (size_t k = 0; k < n_proposals; ++k)
+    {
+        for (size_t i = 0; i < features.size(); ++i)
+        {
+            row[i] = features[i][k];
+        }
+        write_row(out, row);
+    }
+    if (!out)
+    {
+        throw std::runtime_error("FeatureVectorFile::convert_text_file(): cannot write " + filename);
+    }
+    LOG(logINFO) << "FeatureVectorFile: converted " << n_proposals << " proposals of "
+                 << features.size() << " features from " << text_filename;
+    return n_proposals;
+}
+
+} // end namespace features
+} // end namespace pgmlink
@@ -22,6 +22,13 @@ FeatureMap &FeatureStore::get_traxel_features(const Traxel &traxel)
     return traxel_feature_map_[std::vector<std::pair<int, unsigned int>>(1, std::make_pair(traxel.Timestep, traxel.Id))];
 }
 
+const FeatureMap* FeatureStore::find_traxel_features(const Traxel &traxel) const
+{
+    TraxelFeatureMap::const_iterator it =
+        traxel_feature_map_.find(std::vector<TimeId>(1, std::make_pair(traxel.Timestep, traxel.Id)));
+    return it != traxel_feature_map_.end() ? &it->second : NULL;
+}
+
 FeatureMap &FeatureStore::get_traxel_features(const Traxel &traxel_a, const Traxel &traxel_b)
 {
     std::vector<std::pair<int, unsigned int>> ret;
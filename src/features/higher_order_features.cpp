@@ -1,4 +1,5 @@
 #include "pgmlink/features/higher_order_features.h"
+#include "pgmlink/util.h" /* for ParallelExceptions */
 #include <cmath> /* for sqrt */
 
 #include <vigra/multi_math.hxx> /* for operator+ */
@@ -11,6 +12,15 @@
 
 #include <algorithm> /* for std::copy, std::min */
 
+#include <stdexcept> /* for std::runtime_error */
+
+#include <fstream> /* for storing the outlier svm */
+
+#include <boost/random/mersenne_twister.hpp> /* for subsampling the svm training set */
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/archive/text_oarchive.hpp> /* for storing the outlier svm */
+#include <boost/archive/text_iarchive.hpp>
+
 #include <iso646.h> // for not, and, or on MSVC
 
 namespace pgmlink
@@ -114,25 +124,25 @@ void set_solution(HypothesesGraph& graph, const size_t solution_index)
     // solution_index into the node_active_map
     for (NodeIt n_it(graph); n_it != lemon::INVALID; ++n_it)
     {
-        if (nodes_active_map[n_it].size() <= solution_index)
+        if (nodes_active_map.size(n_it) <= solution_index)
         {
             throw std::runtime_error(
                 "In set_solution(): Solution index out of range"
             );
         }
-        node_active_map[n_it] = nodes_active_map[n_it][solution_index];
-        node_active2_map.set(n_it, nodes_active_map[n_it][solution_index]);
-        div_active_map[n_it] = divisions_active_map[n_it][solution_index];
+        node_active_map[n_it] = nodes_active_map.get(n_it, solution_index);
+        node_active2_map.set(n_it, nodes_active_map.get(n_it, solution_index));
+        div_active_map[n_it] = divisions_active_map.get(n_it, solution_index);
     }
     for (ArcIt a_it(graph); a_it != lemon::INVALID; ++a_it)
     {
-        if (arcs_active_map[a_it].size() <= solution_index)
+        if (arcs_active_map.size(a_it) <= solution_index)
         {
             throw std::runtime_error(
                 "In set_solution(): Solution index out of range"
             );
         }
-        arc_active_map[a_it] = arcs_active_map[a_it][solution_index];
+        arc_active_map[a_it] = arcs_active_map.get(a_it, solution_index);
     }
 }
 
@@ -302,80 +312,137 @@ FeatureMatrix TraxelsFeatureCalculator::calculate(
     return ret_;
 }
 
+namespace
+{
+// write the first row_count values of the flattened result into column col
+void write_column(
+    const FeatureMatrix& calc_features,
+    size_t col,
+    size_t row_count,
+    FeatureMatrix& return_matrix
+)
+{
+    size_t row_max = std::min(row_count, size_t(calc_features.size()));
+    FeatureMatrix::const_iterator calc_features_it = calc_features.begin();
+    for (size_t current_row = 0; current_row < row_max; current_row++, calc_features_it++)
+    {
+        return_matrix(col, current_row) = *calc_features_it;
+    }
+}
+
+} // end anonymous namespace
+
 void TraxelsFeatureCalculator::calculate_for_all(
     const ConstTraxelRefVectors& traxelrefs,
     FeatureMatrix& return_matrix,
-    boost::shared_ptr<TraxelsFeatureExtractor> feature_extractor_ref
+    boost::shared_ptr<TraxelsFeatureExtractor> feature_extractor_ref,
+    bool parallel
 ) const
 {
     size_t col_count = traxelrefs.size();
-    // check if the vector of traxels is empty
-    if (col_count == 0)
+    // row count will contain the size of the row_count of the return matrix
+    size_t row_count = 0;
+    // the first subset with a non-empty result determines the row count, find
+    // it serially so the return matrix can be allocated before the other
+    // subsets are processed
+    size_t first_col = 0;
     {
-        LOG(logDEBUG) << "In " << name() << ": vector of traxels is empty";
+        FeatureMatrix extr_features;
+        FeatureMatrix calc_features;
+        for (; first_col < col_count && row_count == 0; first_col++)
+        {
+            feature_extractor_ref->extract(traxelrefs[first_col], extr_features);
+            calculate(extr_features, calc_features);
+            row_count = calc_features.size();
+            if (row_count != 0)
+            {
+                return_matrix.reshape(vigra::Shape2(col_count, row_count));
+                return_matrix.init(0.0);
+                write_column(calc_features, first_col, row_count, return_matrix);
+            }
+        }
+    }
+
+    if (row_count == 0)
+    {
+        // check if the vector of traxels is empty
+        if (col_count == 0)
+        {
+            LOG(logDEBUG) << "In " << name() << ": vector of traxels is empty";
+        }
+        else
+        {
+            LOG(logDEBUG) << "In " << name()
+                          << ": all feature calculators returned empty matrices";
+        }
         LOG(logDEBUG) << "Returning zero";
         return_matrix.reshape(vigra::Shape2(1, 1));
         return_matrix.init(0.0);
+        return;
     }
-    else
+
+    // write the flattened result of the feature calculator for the n-th subset
+    // into the n-th column of the return matrix, every column is written by one
+    // iteration only
+    ParallelExceptions exceptions(col_count);
+    #pragma omp parallel if(parallel)
     {
-        // allocate memory for result of feature extractor and feature calculator
+        // workspace of this thread, reused for all of its subsets
         FeatureMatrix extr_features;
         FeatureMatrix calc_features;
-        // row count will contain the size of the row_count of the return matrix
-        size_t row_count = 0;
-        size_t current_col = 0;
-        // iterate over all subsets of traxels and write the flattened result of
-        // the feature calculator for the n-th subset into the n-th column of the
-        // return matrix
-        for (
-            ConstTraxelRefVectors::const_iterator traxelrefs_it = traxelrefs.begin();
-            traxelrefs_it != traxelrefs.end();
-            traxelrefs_it++, current_col++
-        )
+        #pragma omp for schedule(dynamic, 16)
+        for (int col = static_cast<int>(first_col); col < static_cast<int>(col_count); col++)
         {
-            // do the feature extraction and calculation
-            feature_extractor_ref->extract(*traxelrefs_it, extr_features);
-            calculate(extr_features, calc_features);
-            if (row_count == 0)
+            try
             {
-                // if we never had an feature matrix with a size larger than 0 get the
-                // current feature size
-                row_count = calc_features.size();
-                if (row_count != 0)
-                {
-                    // if this feature size is not zero set the row count of the return
-                    // matrix to this size
-                    return_matrix.reshape(vigra::Shape2(col_count, row_count));
-                    return_matrix.init(0.0);
-                }
+                feature_extractor_ref->extract(traxelrefs[col], extr_features);
+                calculate(extr_features, calc_features);
+                write_column(calc_features, col, row_count, return_matrix);
             }
-            if (row_count != 0)
+            catch (...)
             {
-                // write the result if the row count of the return matrix is set
-                // only write the first <row_max> values from the flattened feature
-                // matrix into the current row of the return matrix
-                size_t row_max = std::min(row_count, size_t(calc_features.size()));
-                FeatureMatrix::iterator calc_features_it = calc_features.begin();
-                for (
-                    size_t current_row = 0;
-                    current_row < row_max;
-                    current_row++, calc_features_it++
-                )
-                {
-                    return_matrix(current_col, current_row) = *calc_features_it;
-                }
+                exceptions.capture(col);
             }
         }
-        if (row_count == 0)
+    }
+    exceptions.rethrow();
+}
+
+void TraxelsFeatureCalculator::calculate_for_each(
+    const ConstTraxelRefVectors& traxelrefs,
+    std::vector<FeatureMatrix>& results,
+    const TraxelsFeatureExtractor& feature_extractor,
+    size_t min_size,
+    bool parallel
+) const
+{
+    const int subset_count = static_cast<int>(traxelrefs.size());
+    results.clear();
+    results.resize(subset_count);
+    ParallelExceptions exceptions(subset_count);
+    #pragma omp parallel if(parallel)
+    {
+        // extraction workspace of this thread, reused for all of its subsets
+        FeatureMatrix extr_features;
+        #pragma omp for schedule(dynamic, 16)
+        for (int i = 0; i < subset_count; i++)
         {
-            LOG(logDEBUG) << "In " << name()
-                          << ": all feature calculators returned empty matrices";
-            LOG(logDEBUG) << "Returning zero";
-            return_matrix.reshape(vigra::Shape2(1, 1));
-            return_matrix.init(0.0);
+            if (traxelrefs[i].size() < min_size)
+            {
+                continue;
+            }
+            try
+            {
+                feature_extractor.extract(traxelrefs[i], extr_features);
+                calculate(extr_features, results[i]);
+            }
+            catch (...)
+            {
+                exceptions.capture(i);
+            }
         }
     }
+    exceptions.rethrow();
 }
 
 /*=============================================================================
@@ -2349,6 +2416,8 @@ void MVNOutlierCalculator::calculate(
 ////
 const std::string SVMOutlierCalculator::name_ = "SVMOutlierCalculator";
 
+const size_t SVMOutlierCalculator::default_max_training_samples;
+
 const std::string& SVMOutlierCalculator::name() const
 {
     return name_;
@@ -2430,9 +2499,32 @@ void SVMOutlierCalculator::train(
 
 //    LOG(logINFO) << "Training outlier SVM from " << col_count << " samples:\n" << normalized_feature_matrix;
 
+    // reservoir sampling of the columns, keeps all of them if there are few
+    const size_t sample_count = max_training_samples_ == 0 ? col_count : std::min(col_count, max_training_samples_);
+    std::vector<size_t> sample_cols;
+    boost::random::mt19937 rng(42);
     for (size_t col = 0; col < col_count; col++)
     {
-        FeatureVectorView column = normalized_feature_matrix.bind<0>(col);
+        if (col < sample_count)
+        {
+            sample_cols.push_back(col);
+            continue;
+        }
+        boost::random::uniform_int_distribution<size_t> position(0, col);
+        const size_t k = position(rng);
+        if (k < sample_count)
+        {
+            sample_cols[k] = col;
+        }
+    }
+    if (sample_count < col_count)
+    {
+        LOG(logINFO) << "Training outlier SVM from " << sample_count << " of " << col_count << " samples";
+    }
+
+    for (size_t i = 0; i < sample_cols.size(); i++)
+    {
+        FeatureVectorView column = normalized_feature_matrix.bind<0>(sample_cols[i]);
         SampleType sample(row_count);
         std::copy(column.begin(), column.end(), sample.begin());
         samples.push_back(sample);
@@ -2459,40 +2551,61 @@ void SVMOutlierCalculator::calculate(
     FeatureMatrix& return_matrix
 ) const
 {
-    size_t col_count = feature_matrix.shape(0);
-    size_t row_count = feature_matrix.shape(1);
-    std::vector<SampleType> samples;
+    const size_t col_count = feature_matrix.shape(0);
+    const size_t row_count = feature_matrix.shape(1);
+    if (not is_trained_)
+    {
+        throw std::runtime_error("SVMOutlierCalculator not trained");
+    }
 
     // normalize features
     FeatureMatrix normalized_feature_matrix(feature_matrix);
     normalize_features(normalized_feature_matrix);
 
-    // TODO assert num_samples >> dim ?
-    for (size_t col = 0; col < col_count; col++)
+    return_matrix.reshape(vigra::Shape2(col_count, 1));
+    // every column costs one kernel evaluation per support vector, the
+    // decision function is only read
+    #pragma omp parallel for schedule(static)
+    for (int col = 0; col < static_cast<int>(col_count); col++)
     {
         FeatureVectorView column = normalized_feature_matrix.bind<0>(col);
         SampleType sample(row_count);
         std::copy(column.begin(), column.end(), sample.begin());
-        samples.push_back(sample);
+        return_matrix(col, 0) = decision_function_(sample);
     }
-    if (is_trained_)
-    {
-//        LOG(logINFO) << "Predicting from SVM with " << decision_function_.alpha.size() << " weights for samples of size " << row_count;
-//        LOG(logINFO) << "Using learned SVM weights: \n" << decision_function_.alpha;
-        return_matrix.reshape(vigra::Shape2(col_count, 1));
-//        LOG(logINFO) << "and support vectors: \n" << decision_function_.basis_vectors;
+}
 
-        for(size_t col = 0; col < col_count; col++)
-        {
-            return_matrix(col, 0) = decision_function_(samples[col]);
-        }
+void SVMOutlierCalculator::set_max_training_samples(size_t max_training_samples)
+{
+    max_training_samples_ = max_training_samples;
+}
+
+size_t SVMOutlierCalculator::get_max_training_samples() const
+{
+    return max_training_samples_;
+}
 
-//        LOG(logINFO) << "SVM predictions from samples\n" << samples << "\n yielded: " << return_matrix.transpose();
+void SVMOutlierCalculator::write_to_file(const std::string& filename) const
+{
+    std::ofstream ofs(filename.c_str());
+    if (!ofs)
+    {
+        throw std::runtime_error("SVMOutlierCalculator::write_to_file(): cannot open " + filename);
     }
-    else
+    boost::archive::text_oarchive out_archive(ofs);
+    const SVMOutlierCalculator& self = *this;
+    out_archive << self;
+}
+
+void SVMOutlierCalculator::read_from_file(const std::string& filename)
+{
+    std::ifstream ifs(filename.c_str());
+    if (!ifs)
     {
-        throw std::runtime_error("SVMOutlierCalculator not trained");
+        throw std::runtime_error("SVMOutlierCalculator::read_from_file(): cannot open " + filename);
     }
+    boost::archive::text_iarchive in_archive(ifs);
+    in_archive >> *this;
 }
 #endif
 
@@ -1,4 +1,5 @@
 #include "pgmlink/features/tracking_feature_extractor.h"
+#include "pgmlink/features/feature_vector_file.h"
 #include <boost/algorithm/string.hpp>
 
 #include <cmath> /* for std::abs */
@@ -411,7 +412,8 @@ TrackingFeatureExtractor::TrackingFeatureExtractor(boost::shared_ptr<HypothesesG
     child_parent_diff_calc_ptr_(new ChildParentDiffCalculator),
     sq_norm_calc_ptr_(new SquaredNormCalculator<0>),
     child_decel_calc_ptr_(new ChildDeceleration),
-    div_angle_calc_ptr_(new DivAngleCosineCalculator)
+    div_angle_calc_ptr_(new DivAngleCosineCalculator),
+    parallel_(false)
 {}
 
 TrackingFeatureExtractor::TrackingFeatureExtractor(boost::shared_ptr<HypothesesGraph> graph,
@@ -433,7 +435,8 @@ TrackingFeatureExtractor::TrackingFeatureExtractor(boost::shared_ptr<HypothesesG
     child_parent_diff_calc_ptr_(new ChildParentDiffCalculator),
     sq_norm_calc_ptr_(new SquaredNormCalculator<0>),
     child_decel_calc_ptr_(new ChildDeceleration),
-    div_angle_calc_ptr_(new DivAngleCosineCalculator)
+    div_angle_calc_ptr_(new DivAngleCosineCalculator),
+    parallel_(false)
 {}
 
 void TrackingFeatureExtractor::get_feature_vector(TrackingFeatureExtractor::JointFeatureVector &feature_vector) const
@@ -506,24 +509,32 @@ void TrackingFeatureExtractor::save_features_to_h5(size_t track_id, const std::s
 {
     if(track_feature_output_file_.size() > 0)
     {
-        std::stringstream dataset_name;
-        if(tracks)
-        {
-            dataset_name << "tracks/";
-        }
-        else
-        {
-            dataset_name << "divisions/";
-        }
-        dataset_name << track_id << "/" << feature_name;
-        vigra::writeHDF5(track_feature_output_file_.c_str(), dataset_name.str().c_str(), matrix);
+        std::string dataset_name = (tracks ? "tracks/" : "divisions/") + feature_name;
+        feature_writer().append(dataset_name, track_id, matrix.data(), matrix.shape(0), matrix.shape(1));
+    }
+}
+
+FeatureMatrixWriter& TrackingFeatureExtractor::feature_writer()
+{
+    if (!feature_writer_)
+    {
+        feature_writer_.reset(new FeatureMatrixWriter(track_feature_output_file_));
+    }
+    return *feature_writer_;
+}
+
+void TrackingFeatureExtractor::save_matrix_to_h5(const std::string& name, FeatureMatrix& matrix)
+{
+    if(track_feature_output_file_.size() > 0)
+    {
+        feature_writer().write(name, matrix.data(), matrix.shape(0), matrix.shape(1));
     }
 }
 
 void TrackingFeatureExtractor::save_traxel_ids_to_h5(ConstTraxelRefVectors &track_traxels)
 {
     size_t track_id = 0;
-    for(auto track : track_traxels)
+    for(const ConstTraxelRefVector& track : track_traxels)
     {
         if(track.size() == 0)
         {
@@ -544,7 +555,7 @@ void TrackingFeatureExtractor::save_traxel_ids_to_h5(ConstTraxelRefVectors &trac
 void TrackingFeatureExtractor::save_division_traxels_to_h5(ConstTraxelRefVectors &division_traxels)
 {
     size_t division_id = 0;
-    for(auto div : division_traxels)
+    for(const ConstTraxelRefVector& div : division_traxels)
     {
         if(div.size() < 3)
         {
@@ -676,10 +687,27 @@ void TrackingFeatureExtractor::compute_features()
     compute_all_track_features();
     compute_all_division_features();
     compute_all_app_dis_features();
+
+    if (feature_writer_)
+    {
+        // the writer flushed in the background so far, wait for the rest
+        feature_writer_->close();
+        feature_writer_.reset();
+    }
+}
+
+void TrackingFeatureExtractor::set_parallel(bool parallel)
+{
+    parallel_ = parallel;
 }
 
 void TrackingFeatureExtractor::set_track_feature_output_file(const std::string &filename)
 {
+    if (feature_writer_)
+    {
+        feature_writer_->close();
+        feature_writer_.reset();
+    }
     track_feature_output_file_ = filename;
 }
 
@@ -747,6 +775,11 @@ void TrackingFeatureExtractor::append_feature_vector_to_file(const std::string&
     }
 }
 
+void TrackingFeatureExtractor::append_feature_vector_to_binary_file(const std::string& filename)
+{
+    FeatureVectorFile::append(filename, feature_descriptions_, joint_feature_vector_);
+}
+
 void TrackingFeatureExtractor::compute_sq_diff_features(
     ConstTraxelRefVectors& track_traxels,
     std::string feature_name)
@@ -754,28 +787,24 @@ void TrackingFeatureExtractor::compute_sq_diff_features(
     MinMaxMeanVarCalculator sq_diff_mmmv;
 //    sq_diff_mmmv.set_max(0.0);
 
+    // compute the squared norm of the differences of the column vectors,
+    // only compute velocities if track is longer than 1 element
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    std::vector<FeatureMatrix> sq_diff_matrices;
+    sq_diff_calc_ptr_->calculate_for_each(track_traxels, sq_diff_matrices, feature_extractor, 2, parallel_);
+
     // for each track:
     size_t track_id = 0;
-    for(auto track : track_traxels)
+    for (size_t i = 0; i < track_traxels.size(); ++i)
     {
-        // only compute velocities if track is longer than 1 element
-        if(track.size() < 2)
+        if(track_traxels[i].size() < 2)
         {
             continue;
         }
 
-        // extract features
-        FeatureMatrix feature_matrix;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(track, feature_matrix);
-
-        // compute the squared norm of the differences of the column vectors
-        FeatureMatrix sq_diff_matrix;
-        sq_diff_calc_ptr_->calculate(feature_matrix, sq_diff_matrix);
-
         // add values to min/max/mean/var calculator
-        sq_diff_mmmv.add_values(sq_diff_matrix);
-        save_features_to_h5(track_id++, "sq_diff_" + feature_name, sq_diff_matrix);
+        sq_diff_mmmv.add_values(sq_diff_matrices[i]);
+        save_features_to_h5(track_id++, "sq_diff_" + feature_name, sq_diff_matrices[i]);
     }
     push_back_feature("squared difference of " + feature_name, sq_diff_mmmv);
 }
@@ -787,28 +816,24 @@ void TrackingFeatureExtractor::compute_sq_accel_features(
     MinMaxMeanVarCalculator sq_accel_mmmv;
 //    sq_accel_mmmv.set_max(0.0);
 
+    // compute the squared norm of the accelerations of the column vectors,
+    // only compute accelerations if track is longer than 2 elements
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    std::vector<FeatureMatrix> sq_accel_matrices;
+    sq_curve_calc_ptr_->calculate_for_each(track_traxels, sq_accel_matrices, feature_extractor, 3, parallel_);
+
     // for each track:
     size_t track_id = 0;
-    for(auto track : track_traxels)
+    for (size_t i = 0; i < track_traxels.size(); ++i)
     {
-        // only compute accelerations if track is longer than 2 elements
-        if(track.size() < 3)
+        if(track_traxels[i].size() < 3)
         {
             continue;
         }
 
-        // extract features
-        FeatureMatrix feature_matrix;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(track, feature_matrix);
-
-        // compute the squared norm of the accelerations of the column vectors
-        FeatureMatrix sq_accel_matrix;
-        sq_curve_calc_ptr_->calculate(feature_matrix, sq_accel_matrix);
-
         // add values to min/max/mean/var calculator
-        sq_accel_mmmv.add_values(sq_accel_matrix);
-        save_features_to_h5(track_id++, "sq_accel_" + feature_name, sq_accel_matrix);
+        sq_accel_mmmv.add_values(sq_accel_matrices[i]);
+        save_features_to_h5(track_id++, "sq_accel_" + feature_name, sq_accel_matrices[i]);
     }
     push_back_feature("squared acceleration of " + feature_name, sq_accel_mmmv);
 }
@@ -820,27 +845,23 @@ void TrackingFeatureExtractor::compute_angle_features(
     MinMaxMeanVarCalculator angle_mmmv;
 //    angle_mmmv.set_max(0.0);
 
+    // compute for all triples of features the angle of change of direction,
+    // only compute angles in track if track is longer than 2 elements
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    std::vector<FeatureMatrix> angles;
+    angle_cos_calc_ptr_->calculate_for_each(track_traxels, angles, feature_extractor, 3, parallel_);
+
     // for each track:
     size_t track_id = 0;
-    for(auto track : track_traxels)
+    for (size_t i = 0; i < track_traxels.size(); ++i)
     {
-        // only compute angles in track if track is longer than 2 elements
-        if(track.size() < 3)
+        if(track_traxels[i].size() < 3)
         {
             continue;
         }
 
-        // extract features
-        FeatureMatrix feature_matrix;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(track, feature_matrix);
-
-        // compute for all triples of features the angle of change of direction
-        FeatureMatrix angles;
-        angle_cos_calc_ptr_->calculate(feature_matrix, angles);
-
-        angle_mmmv.add_values(angles);
-        save_features_to_h5(track_id++, "angles_" + feature_name, angles);
+        angle_mmmv.add_values(angles[i]);
+        save_features_to_h5(track_id++, "angles_" + feature_name, angles[i]);
     }
     push_back_feature(
         "Mean of all angle cosines of feature " + feature_name,
@@ -857,7 +878,7 @@ void TrackingFeatureExtractor::compute_track_length_features(
 //    track_length_mmmv.set_max(0.0);
 
     size_t track_id = 0;
-    for (auto track : track_traxels)
+    for (const ConstTraxelRefVector& track : track_traxels)
     {
         track_length_mmmv.add_value(static_cast<double>(track.size()));
         FeatureMatrix m(vigra::Shape2(1, 1));
@@ -875,7 +896,7 @@ void TrackingFeatureExtractor::compute_id_features(
     MinMaxMeanVarCalculator track_id_feat_mmmv;
 
     size_t track_id = 0;
-    for (auto track : track_traxels)
+    for (const ConstTraxelRefVector& track : track_traxels)
     {
         track_id_feat_mmmv.add_value(static_cast<double>(track.size()));
         FeatureMatrix m(vigra::Shape2(1, 1));
@@ -900,13 +921,14 @@ void TrackingFeatureExtractor::compute_track_id_outlier(
     size_t track_id = 0;
     // get the feature matrices of all tracks into one large vector
     std::vector<FeatureMatrix> feature_matrices;
+    feature_matrices.reserve(track_traxels.size());
     size_t cols = 0;
-    for (auto track : track_traxels)
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    for (const ConstTraxelRefVector& track : track_traxels)
     {
         // create a new empty feature matrix at the end of the vector
         feature_matrices.emplace_back();
         // extract features
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
         feature_extractor.extract(track, feature_matrices.back());
         // accumulate the number of columns for the final joint feature matrix
         cols += feature_matrices.back().shape(0);
@@ -915,7 +937,7 @@ void TrackingFeatureExtractor::compute_track_id_outlier(
     size_t rows = feature_matrices.back().shape(1);
     FeatureMatrix feature_matrix(vigra::Shape2(cols, rows));
     std::vector<size_t> offsets(1, 0);
-    for (auto matrix : feature_matrices)
+    for (const FeatureMatrix& matrix : feature_matrices)
     {
         const size_t& offset = offsets.back();
         assert(rows == matrix.shape(1));
@@ -964,26 +986,21 @@ void TrackingFeatureExtractor::compute_track_diff_outlier(
     MinMaxMeanVarCalculator diff_out_mmmv;
     size_t track_id = 0;
     // get the feature matrices of all tracks into one large vector
+    // calculate the differences of every track
     std::vector<FeatureMatrix> feature_matrices;
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    diff_calc_ptr_->calculate_for_each(track_traxels, feature_matrices, feature_extractor, 0, parallel_);
     size_t cols = 0;
-    for (auto track : track_traxels)
+    for (const FeatureMatrix& matrix : feature_matrices)
     {
-        // create a new empty feature matrix at the end of the vector
-        feature_matrices.emplace_back();
-        // extract features
-        FeatureMatrix temp;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(track, temp);
-        // calculate differences
-        diff_calc_ptr_->calculate(temp, feature_matrices.back());
         // accumulate the number of columns for the final joint feature matrix
-        cols += feature_matrices.back().shape(0);
+        cols += matrix.shape(0);
     }
     // make one large feature matrix
     size_t rows = feature_matrices.back().shape(1);
     FeatureMatrix feature_matrix(vigra::Shape2(cols, rows));
     std::vector<size_t> offsets(1, 0);
-    for (auto matrix : feature_matrices)
+    for (const FeatureMatrix& matrix : feature_matrices)
     {
         const size_t& offset = offsets.back();
         assert(rows == matrix.shape(1));
@@ -1051,10 +1068,7 @@ void TrackingFeatureExtractor::compute_svm_track_feature_outlier(
     mmmv_score.add_values(score_matrix);
     push_back_feature("track feature outlier score", mmmv_score);
 
-    if(track_feature_output_file_.size() > 0)
-    {
-        vigra::writeHDF5(track_feature_output_file_.c_str(), "track_outliers_svm", score_matrix);
-    }
+    save_matrix_to_h5("track_outliers_svm", score_matrix);
 }
 #endif
 
@@ -1065,21 +1079,18 @@ void TrackingFeatureExtractor::compute_division_sq_diff_features(
     MinMaxMeanVarCalculator sq_diff_mmmv;
 //    sq_diff_mmmv.set_max(0.0);
 
-    size_t division_id = 0;
-    for (auto div : div_traxels)
-    {
-        // extract features
-        FeatureMatrix feature_matrix;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(div, feature_matrix);
+    // calculate the squared child-parent difference
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    CompositionCalculator sq_diff_calc(
+        child_parent_diff_calc_ptr_,
+        sq_norm_calc_ptr_);
+    std::vector<FeatureMatrix> sq_diff_matrices;
+    sq_diff_calc.calculate_for_each(div_traxels, sq_diff_matrices, feature_extractor, 0, parallel_);
 
-        // calculate the squared child-parent difference
-        FeatureMatrix temp;
-        FeatureMatrix sq_diff_matrix;
-        child_parent_diff_calc_ptr_->calculate(feature_matrix, temp);
-        sq_norm_calc_ptr_->calculate(temp, sq_diff_matrix);
-        sq_diff_mmmv.add_values(sq_diff_matrix);
-        save_features_to_h5(division_id++, "sq_diff_" + feature_name, sq_diff_matrix, false);
+    for (size_t division_id = 0; division_id < div_traxels.size(); ++division_id)
+    {
+        sq_diff_mmmv.add_values(sq_diff_matrices[division_id]);
+        save_features_to_h5(division_id, "sq_diff_" + feature_name, sq_diff_matrices[division_id], false);
     }
     push_back_feature(
         "squared child-parent " + feature_name + " difference",
@@ -1100,7 +1111,8 @@ void TrackingFeatureExtractor::compute_division_sq_diff_outlier(
     sq_diff_calc.calculate_for_all(
         div_traxels,
         sq_diff_matrix,
-        feature_extractor_ptr);
+        feature_extractor_ptr,
+        parallel_);
     double outlier = 0.0;
     if (sq_diff_matrix.size(0) > sq_diff_matrix.size(1))
     {
@@ -1137,20 +1149,15 @@ void TrackingFeatureExtractor::compute_child_deceleration_features(
     MinMaxMeanVarCalculator child_decel_mmmv;
 //    child_decel_mmmv.set_max(0.0);
 
-    size_t division_id = 0;
-    for (auto div : div_traxels)
-    {
-        // extract features
-        FeatureMatrix feature_matrix;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(div, feature_matrix);
-
-        // calculate the child decelerations
-        FeatureMatrix child_decel_mat;
-        child_decel_calc_ptr_->calculate(feature_matrix, child_decel_mat);
+    // calculate the child decelerations
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    std::vector<FeatureMatrix> child_decel_mats;
+    child_decel_calc_ptr_->calculate_for_each(div_traxels, child_decel_mats, feature_extractor, 0, parallel_);
 
-        child_decel_mmmv.add_values(child_decel_mat);
-        save_features_to_h5(division_id++, "child_decel_" + feature_name, child_decel_mat, false);
+    for (size_t division_id = 0; division_id < div_traxels.size(); ++division_id)
+    {
+        child_decel_mmmv.add_values(child_decel_mats[division_id]);
+        save_features_to_h5(division_id, "child_decel_" + feature_name, child_decel_mats[division_id], false);
     }
     push_back_feature("child " + feature_name + " deceleration", child_decel_mmmv);
 }
@@ -1166,7 +1173,8 @@ void TrackingFeatureExtractor::compute_child_deceleration_outlier(
     child_decel_calc_ptr_->calculate_for_all(
         div_traxels,
         child_decel_mat,
-        feature_extractor_ptr);
+        feature_extractor_ptr,
+        parallel_);
     double outlier = 0.0;
     if (child_decel_mat.size(0) > child_decel_mat.size(1))
     {
@@ -1201,20 +1209,15 @@ void TrackingFeatureExtractor::compute_division_angle_features(
     MinMaxMeanVarCalculator div_angle_mmmv;
 //    child_decel_mmmv.set_max(0.0);
 
-    size_t division_id = 0;
-    for (auto div : div_traxels)
-    {
-        // extract features
-        FeatureMatrix feature_matrix;
-        TraxelsFeaturesIdentity feature_extractor(feature_name);
-        feature_extractor.extract(div, feature_matrix);
-
-        // calculate the child angles
-        FeatureMatrix div_angle_mat;
-        div_angle_calc_ptr_->calculate(feature_matrix, div_angle_mat);
+    // calculate the child angles
+    TraxelsFeaturesIdentity feature_extractor(feature_name);
+    std::vector<FeatureMatrix> div_angle_mats;
+    div_angle_calc_ptr_->calculate_for_each(div_traxels, div_angle_mats, feature_extractor, 0, parallel_);
 
-        div_angle_mmmv.add_values(div_angle_mat);
-        save_features_to_h5(division_id++, "div_angle_" + feature_name, div_angle_mat, false);
+    for (size_t division_id = 0; division_id < div_traxels.size(); ++division_id)
+    {
+        div_angle_mmmv.add_values(div_angle_mats[division_id]);
+        save_features_to_h5(division_id, "div_angle_" + feature_name, div_angle_mats[division_id], false);
     }
     push_back_feature("div " + feature_name + " angle", div_angle_mmmv);
 }
@@ -1230,7 +1233,8 @@ void TrackingFeatureExtractor::compute_division_angle_outlier(
     div_angle_calc_ptr_->calculate_for_all(
         div_traxels,
         div_angle_mat,
-        feature_extractor_ptr);
+        feature_extractor_ptr,
+        parallel_);
     double outlier = 0.0;
     if (div_angle_mat.size(0) > div_angle_mat.size(1))
     {
@@ -1282,10 +1286,7 @@ void TrackingFeatureExtractor::compute_svm_division_feature_outlier(
     mmmv_score.add_values(score_matrix);
     push_back_feature("division feature outlier score", mmmv_score);
 
-    if(track_feature_output_file_.size() > 0)
-    {
-        vigra::writeHDF5(track_feature_output_file_.c_str(), "division_outliers_svm", score_matrix);
-    }
+    save_matrix_to_h5("division_outliers_svm", score_matrix);
 }
 #endif
 
@@ -1296,7 +1297,7 @@ void TrackingFeatureExtractor::compute_border_distances(
     MinMaxMeanVarCalculator border_dist_mmmv;
 //    border_dist_mmmv.set_max(0.0);
 
-    for (auto appearance : appearance_traxels)
+    for (const ConstTraxelRefVector& appearance : appearance_traxels)
     {
         FeatureMatrix position;
         TraxelsFeaturesIdentity position_extractor("RegionCenter");
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <set>
+
+#include "pgmlink/frozen_hypotheses_graph.h"
+#include "pgmlink/log.h"
+
+namespace pgmlink
+{
+
+////
+//// class FrozenHypothesesGraph
+////
+const size_t FrozenHypothesesGraph::invalid_index;
+
+FrozenHypothesesGraph::FrozenHypothesesGraph(const HypothesesGraph& g)
+    : graph_(g), earliest_timestep_(0)
+{
+    typedef HypothesesGraph::node_timestep_map node_timestep_map_t;
+    node_timestep_map_t& timestep_map = g.get(node_timestep());
+    const std::set<int>& timesteps = g.timesteps();
+
+    // nodes by timestep
+    const size_t n_nodes = lemon::countNodes(g);
+    nodes_.reserve(n_nodes);
+    node_timesteps_.reserve(n_nodes);
+    node_index_.assign(g.maxNodeId() + 1, invalid_index);
+    if (!timesteps.empty())
+    {
+        earliest_timestep_ = *timesteps.begin();
+        timestep_offsets_.assign(*timesteps.rbegin() - earliest_timestep_ + 2, 0);
+    }
+    for (std::set<int>::const_iterator t = timesteps.begin(); t != timesteps.end(); ++t)
+    {
+        for (node_timestep_map_t::ItemIt n(timestep_map, *t); n != lemon::INVALID; ++n)
+        {
+            node_index_[g.id(n)] = nodes_.size();
+            nodes_.push_back(n);
+            node_timesteps_.push_back(*t);
+        }
+        timestep_offsets_[*t - earliest_timestep_ + 1] = nodes_.size();
+    }
+    // timesteps without nodes
+    for (size_t k = 1; k < timestep_offsets_.size(); ++k)
+    {
+        timestep_offsets_[k] = std::max(timestep_offsets_[k], timestep_offsets_[k - 1]);
+    }
+
+    if (g.has_property(node_traxel()))
+    {
+        property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g.get(node_traxel());
+        traxel_ids_.reserve(nodes_.size());
+        for (size_t i = 0; i < nodes_.size(); ++i)
+        {
+            traxel_ids_.push_back(traxel_map[nodes_[i]].Id);
+        }
+    }
+
+    // outgoing arcs, grouped by source
+    const size_t n_arcs = lemon::countArcs(g);
+    arcs_.reserve(n_arcs);
+    arc_sources_.reserve(n_arcs);
+    arc_targets_.reserve(n_arcs);
+    arc_index_.assign(g.maxArcId() + 1, invalid_index);
+    out_offsets_.assign(nodes_.size() + 1, 0);
+    in_offsets_.assign(nodes_.size() + 1, 0);
+    for (size_t i = 0; i < nodes_.size(); ++i)
+    {
+        for (HypothesesGraph::OutArcIt a(g, nodes_[i]); a != lemon::INVALID; ++a)
+        {
+            const size_t target = node_index_[g.id(g.target(a))];
+            arc_index_[g.id(a)] = arcs_.size();
+            arcs_.push_back(a);
+            arc_sources_.push_back(i);
+            arc_targets_.push_back(target);
+            ++in_offsets_[target + 1];
+        }
+        out_offsets_[i + 1] = arcs_.size();
+    }
+
+    // incoming arcs by counting sort on the target
+    for (size_t i = 0; i < nodes_.size(); ++i)
+    {
+        in_offsets_[i + 1] += in_offsets_[i];
+    }
+    std::vector<size_t> next(in_offsets_.begin(), in_offsets_.end() - 1);
+    in_arcs_.resize(arcs_.size());
+    for (size_t a = 0; a < arcs_.size(); ++a)
+    {
+        in_arcs_[next[arc_targets_[a]]++] = a;
+    }
+    LOG(logDEBUG1) << "FrozenHypothesesGraph: " << nodes_.size() << " nodes, " << arcs_.size() << " arcs";
+}
+
+size_t FrozenHypothesesGraph::timestep_begin(int t) const
+{
+    if (timestep_offsets_.empty() || t < earliest_timestep_)
+    {
+        return 0;
+    }
+    const size_t k = std::min<size_t>(t - earliest_timestep_, timestep_offsets_.size() - 1);
+    return timestep_offsets_[k];
+}
+
+size_t FrozenHypothesesGraph::timestep_end(int t) const
+{
+    if (timestep_offsets_.empty() || t < earliest_timestep_)
+    {
+        return 0;
+    }
+    const size_t k = std::min<size_t>(t - earliest_timestep_ + 1, timestep_offsets_.size() - 1);
+    return timestep_offsets_[k];
+}
+
+////
+//// class FrozenSolution
+////
+const unsigned int FrozenSolution::no_origin;
+
+FrozenSolution::FrozenSolution(const FrozenHypothesesGraph& frozen)
+    : n_iterations_(1),
+      first_iteration_(0),
+      n_columns_(1),
+      per_iteration_(false),
+      with_mergers_(false),
+      with_division_detection_(false),
+      with_origin_(false),
+      node_begin_(0),
+      arc_begin_(0)
+{
+    read(frozen, 0, static_cast<size_t>(-1), frozen.earliest_timestep(), frozen.latest_timestep());
+}
+
+FrozenSolution::FrozenSolution(const FrozenHypothesesGraph& frozen,
+                               size_t first_iteration,
+                               size_t num_iterations,
+                               int first_timestep,
+                               int last_timestep)
+    : n_iterations_(1),
+      first_iteration_(0),
+      n_columns_(1),
+      per_iteration_(false),
+      with_mergers_(false),
+      with_division_detection_(false),
+      with_origin_(false),
+      node_begin_(0),
+      arc_begin_(0)
+{
+    read(frozen, first_iteration, num_iterations, first_timestep, last_timestep);
+}
+
+void FrozenSolution::read(const FrozenHypothesesGraph& frozen,
+                          size_t first_iteration,
+                          size_t num_iterations,
+                          int first_timestep,
+                          int last_timestep)
+{
+    const HypothesesGraph& g = frozen.graph();
+
+    // the nodes of the timesteps and all arcs touching them
+    first_timestep = std::max(first_timestep, frozen.earliest_timestep());
+    last_timestep = std::min(last_timestep, frozen.latest_timestep());
+    size_t node_end = node_begin_;
+    if (first_timestep <= last_timestep)
+    {
+        node_begin_ = frozen.timestep_begin(first_timestep);
+        node_end = frozen.timestep_end(last_timestep);
+    }
+    arc_begin_ = frozen.out_begin(node_begin_);
+    size_t arc_end = frozen.out_begin(node_end);
+    for (size_t k = frozen.in_begin(node_begin_); k < frozen.in_begin(node_end); ++k)
+    {
+        arc_begin_ = std::min(arc_begin_, frozen.in_arc(k));
+        arc_end = std::max(arc_end, frozen.in_arc(k) + 1);
+    }
+    const size_t n_nodes = node_end - node_begin_;
+    const size_t n_arcs = arc_end - arc_begin_;
+
+    if (g.getProperties().count("node_active_count") > 0)
+    {
+        property_map<node_active_count, HypothesesGraph::base_graph>::type& nodes = g.get(node_active_count());
+        property_map<arc_active_count, HypothesesGraph::base_graph>::type& arcs = g.get(arc_active_count());
+        per_iteration_ = true;
+        with_mergers_ = g.getProperties().count("node_active2") > 0;
+        n_iterations_ = frozen.num_nodes() > 0 ? nodes.size(frozen.node(0)) : 0;
+        first_iteration_ = std::min(first_iteration, n_iterations_);
+        n_columns_ = std::min(num_iterations, n_iterations_ - first_iteration_);
+        const size_t iteration_end = first_iteration_ + n_columns_;
+
+        // solutions missing for single nodes or arcs count as inactive
+        node_active_.assign(n_nodes * n_columns_, 0);
+        for (size_t i = 0; i < n_nodes; ++i)
+        {
+            const HypothesesGraph::Node n = frozen.node(node_begin_ + i);
+            for (size_t it = first_iteration_; it < std::min(nodes.size(n), iteration_end); ++it)
+            {
+                node_active_[i * n_columns_ + it - first_iteration_] = nodes.get(n, it);
+            }
+        }
+        arc_active_.assign(n_arcs * n_columns_, 0);
+        arc_votes_.assign(n_arcs, 0);
+        for (size_t a = 0; a < n_arcs; ++a)
+        {
+            const HypothesesGraph::Arc arc = frozen.arc(arc_begin_ + a);
+            bool active = false;
+            for (size_t it = first_iteration_; it < std::min(arcs.size(arc), iteration_end); ++it)
+            {
+                arc_active_[a * n_columns_ + it - first_iteration_] = arcs.get(arc, it);
+                active = active || arcs.get(arc, it);
+            }
+            // only the uncertainty of events needs the other iterations
+            if (active)
+            {
+                arc_votes_[a] = count_active(arcs, arc);
+            }
+        }
+        if (g.getProperties().count("division_active") > 0 && g.has_property(division_active_count()))
+        {
+            with_division_detection_ = true;
+            property_map<division_active_count, HypothesesGraph::base_graph>::type& divisions = g.get(division_active_count());
+            division_active_.assign(n_nodes * n_columns_, 0);
+            division_votes_.assign(n_nodes, 0);
+            for (size_t i = 0; i < n_nodes; ++i)
+            {
+                const HypothesesGraph::Node n = frozen.node(node_begin_ + i);
+                bool active = false;
+                for (size_t it = first_iteration_; it < std::min(divisions.size(n), iteration_end); ++it)
+                {
+                    division_active_[i * n_columns_ + it - first_iteration_] = divisions.get(n, it);
+                    active = active || divisions.get(n, it);
+                }
+                if (active)
+                {
+                    division_votes_[i] = count_active(divisions, n);
+                }
+            }
+        }
+    }
+    else
+    {
+        node_active_.resize(n_nodes);
+        if (g.getProperties().count("node_active2") > 0)
+        {
+            with_mergers_ = true;
+            property_map<node_active2, HypothesesGraph::base_graph>::type& nodes = g.get(node_active2());
+            for (size_t i = 0; i < n_nodes; ++i)
+            {
+                node_active_[i] = nodes[frozen.node(node_begin_ + i)];
+            }
+        }
+        else
+        {
+            property_map<node_active, HypothesesGraph::base_graph>::type& nodes = g.get(node_active());
+            for (size_t i = 0; i < n_nodes; ++i)
+            {
+                node_active_[i] = nodes[frozen.node(node_begin_ + i)];
+            }
+        }
+        property_map<arc_active, HypothesesGraph::base_graph>::type& arcs = g.get(arc_active());
+        arc_active_.resize(n_arcs);
+        for (size_t a = 0; a < n_arcs; ++a)
+        {
+            arc_active_[a] = arcs[frozen.arc(arc_begin_ + a)];
+        }
+        if (g.getProperties().count("division_active") > 0)
+        {
+            with_division_detection_ = true;
+            property_map<division_active, HypothesesGraph::base_graph>::type& divisions = g.get(division_active());
+            division_active_.resize(n_nodes);
+            for (size_t i = 0; i < n_nodes; ++i)
+            {
+                division_active_[i] = divisions[frozen.node(node_begin_ + i)];
+            }
+        }
+    }
+
+    if (g.getProperties().count("node_originated_from") > 0)
+    {
+        with_origin_ = true;
+        property_map<node_originated_from, HypothesesGraph::base_graph>::type& origin_map = g.get(node_originated_from());
+        origins_.assign(n_nodes, no_origin);
+        for (size_t i = 0; i < n_nodes; ++i)
+        {
+            const std::vector<unsigned int>& origin = origin_map[frozen.node(node_begin_ + i)];
+            if (!origin.empty())
+            {
+                origins_[i] = origin[0];
+            }
+        }
+    }
+}
+
+template<typename Map, typename Key>
+size_t FrozenSolution::count_active(const Map& map, const Key& key) const
+{
+    size_t count = 0;
+    for (size_t it = 0; it < std::min(map.size(key), n_iterations_); ++it)
+    {
+        if (map.get(key, it))
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+template<typename T>
+double FrozenSolution::uncertainty(const std::vector<T>& values,
+                                   const std::vector<size_t>& votes,
+                                   size_t row,
+                                   size_t iteration) const
+{
+    if (!per_iteration_ || values.empty() || n_iterations_ == 0)
+    {
+        return 0.;
+    }
+    // fraction of all stored iterations that disagree
+    const double active = votes[row];
+    return values[row * n_columns_ + column(iteration)] ? 1 - active / n_iterations_ : active / n_iterations_;
+}
+
+double FrozenSolution::arc_uncertainty(size_t a, size_t iteration) const
+{
+    return uncertainty(arc_active_, arc_votes_, a - arc_begin_, iteration);
+}
+
+double FrozenSolution::division_uncertainty(size_t i, size_t iteration) const
+{
+    return uncertainty(division_active_, division_votes_, i - node_begin_, iteration);
+}
+
+} /* namespace pgmlink */
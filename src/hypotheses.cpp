@@ -16,9 +16,12 @@
 #include <lemon/maps.h>
 #include <lemon/adaptors.h>
 #include "pgmlink/hypotheses.h"
+#include "pgmlink/out_of_core_traxel_store.h"
+#include "pgmlink/frozen_hypotheses_graph.h"
 #include "pgmlink/log.h"
 #include "pgmlink/nearest_neighbors.h"
 #include "pgmlink/traxels.h"
+#include "pgmlink/util.h"
 
 namespace pgmlink
 {
@@ -60,7 +63,7 @@ void HypothesesGraph::initialize_node(HypothesesGraph::Node n)
         {
             if(n_it == n)
                 continue;
-            num_solutions = node_active_count_map[n_it].size();
+            num_solutions = node_active_count_map.size(n_it);
             break;
         }
 
@@ -75,7 +78,7 @@ void HypothesesGraph::initialize_node(HypothesesGraph::Node n)
         {
             if(n_it == n)
                 continue;
-            num_solutions = division_active_count_map[n_it].size();
+            num_solutions = division_active_count_map.size(n_it);
             break;
         }
 
@@ -95,7 +98,7 @@ HypothesesGraph::Arc HypothesesGraph::addArc(HypothesesGraph::Node s, Hypotheses
         {
             if(a_it == a)
                 continue;
-            num_solutions = arc_active_count_map[a_it].size();
+            num_solutions = arc_active_count_map.size(a_it);
             break;
         }
 
@@ -132,9 +135,9 @@ void HypothesesGraph::write_hypotheses_graph_state(const std::string out_fn)
         std::stringstream ss;
         size_t label = std::max(appearance_labels[n], disappearance_labels[n]);
         ss << label << " ";
-        for(auto it = active_nodes_count[n].begin(); it != active_nodes_count[n].end(); ++it)
+        for(size_t i = 0; i < active_nodes_count.size(n); ++i)
         {
-            ss << *it << " ";
+            ss << active_nodes_count.get(n, i) << " ";
         }
         out_file << ss.str() << std::endl;
     }
@@ -145,9 +148,9 @@ void HypothesesGraph::write_hypotheses_graph_state(const std::string out_fn)
         std::stringstream ss;
         size_t label = division_labels[n];
         ss << label << " ";
-        for(auto it = active_divisions_count[n].begin(); it != active_divisions_count[n].end(); ++it)
+        for(size_t i = 0; i < active_divisions_count.size(n); ++i)
         {
-            ss << *it << " ";
+            ss << active_divisions_count.get(n, i) << " ";
         }
         out_file << ss.str() << std::endl;
     }
@@ -158,9 +161,9 @@ void HypothesesGraph::write_hypotheses_graph_state(const std::string out_fn)
         std::stringstream ss;
         size_t label = arc_labels[a];
         ss << label << " ";
-        for(auto it = active_arcs_count[a].begin(); it != active_arcs_count[a].end(); ++it)
+        for(size_t i = 0; i < active_arcs_count.size(a); ++i)
         {
-            ss << *it << " ";
+            ss << active_arcs_count.get(a, i) << " ";
         }
         out_file << ss.str() << std::endl;
     }
@@ -385,459 +388,440 @@ HypothesesGraph& set_descendants_active(HypothesesGraph& graph, const Hypotheses
     return graph;
 }
 
-// Introducing: Three awkward workarounds.
-// We don't want to have ifs everywhere,
-// so we decided to write these three magnificent convenience functions
-size_t get_active_node(
-    property_map<node_active, HypothesesGraph::base_graph>::type* nodes,
-    property_map<node_active2, HypothesesGraph::base_graph>::type* nodes2,
-    property_map<node_active_count, HypothesesGraph::base_graph>::type* nodes_vector,
-    size_t map_type_id,
-    HypothesesGraph::Node node,
-    size_t iterationStep = 0)
-{
-    if (map_type_id == 0)
-    {
-        return (*nodes)[node];
-    }
-    else if (map_type_id == 1)
-    {
-        return (*nodes2)[node];
-    }
-    return (*nodes_vector)[node][iterationStep];
-}
-
-bool get_active_arc(
-    property_map<arc_active, HypothesesGraph::base_graph>::type* arcs,
-    property_map<arc_active_count, HypothesesGraph::base_graph>::type* arcs_vector,
-    size_t map_type_id,
-    HypothesesGraph::Arc arc,
-    size_t iterationStep = 0)
-{
-    if (map_type_id == 2)
-    {
-        return (*arcs_vector)[arc][iterationStep];
-    }
-    return (*arcs)[arc];
-}
-
-bool get_active_division(
-    property_map<division_active, HypothesesGraph::base_graph>::type* divs,
-    property_map<division_active_count, HypothesesGraph::base_graph>::type* divs_vector,
-    size_t map_type_id,
-    HypothesesGraph::Node node,
-    size_t iterationStep = 0)
-{
-    if (map_type_id == 2)
-    {
-        return (*divs_vector)[node][iterationStep];
-    }
-    return (*divs)[node];
-}
-
-
-double get_uncertainty(
-    property_map<division_active, HypothesesGraph::base_graph>::type*,
-    property_map<division_active_count, HypothesesGraph::base_graph>::type* divs_vector,
-    size_t map_type_id,
-    HypothesesGraph::Node node,
-    size_t iterationStep = 0)
+namespace
 {
-    if (map_type_id == 2)
-    {
-        size_t res = (*divs_vector)[node][iterationStep];
-        double votes = 0.;
-        for (auto it = (*divs_vector)[node].begin(); it != (*divs_vector)[node].end(); ++it )
-        {
-            if (*it == res)
-            {
-                votes += 1;
-            }
-        }
-        return 1 - votes / (*divs_vector)[node].size();
-    }
-    return 0.;
-}
-
-double get_uncertainty(
-    property_map<arc_active, HypothesesGraph::base_graph>::type*,
-    property_map<arc_active_count, HypothesesGraph::base_graph>::type* arcs_vector,
-    size_t map_type_id,
-    HypothesesGraph::Arc arc,
-    size_t iterationStep = 0)
+void add_resolved_to_events(const std::map<unsigned int, std::vector<unsigned int> >& resolver_map,
+                            int t,
+                            size_t num_iterations,
+                            EventTable& table)
 {
-    if (map_type_id == 2)
+    for (std::map<unsigned int, std::vector<unsigned int> >::const_iterator map_it = resolver_map.begin(); map_it != resolver_map.end(); ++map_it)
     {
-        size_t res = (*arcs_vector)[arc][iterationStep];
-        double votes = 0.;
-        for (auto it = (*arcs_vector)[arc].begin(); it != (*arcs_vector)[arc].end(); ++it )
+        for (size_t i = 0; i < num_iterations; ++i)
         {
-            if (*it == res)
+            table.add_event(Event::ResolvedTo, t, i).add_traxel_id(map_it->first);
+            for (std::vector<unsigned int>::const_iterator it = map_it->second.begin(); it != map_it->second.end(); ++it)
             {
-                votes += 1;
+                table.add_traxel_id(*it);
             }
         }
-        return 1 - votes / (*arcs_vector)[arc].size();
+        LOG(logDEBUG1) << table.event(table.size() - 1);
     }
-    return 0.;
 }
 
-double get_uncertainty(
-    property_map<node_active, HypothesesGraph::base_graph>::type*,
-    property_map<node_active2, HypothesesGraph::base_graph>::type*,
-    property_map<node_active_count, HypothesesGraph::base_graph>::type* nodes_vector,
-    size_t map_type_id,
-    HypothesesGraph::Node node,
-    size_t iterationStep = 0)
+void add_merger_events(const FrozenSolution& solution,
+                       size_t n,
+                       unsigned int id,
+                       int t,
+                       size_t first_iteration,
+                       size_t num_iterations,
+                       EventTable& table)
 {
-    if (map_type_id == 2)
+    for (size_t i = 0; i < num_iterations; ++i)
     {
-        size_t res = (*nodes_vector)[node][iterationStep];
-        double votes = 0.;
-        for (auto it = (*nodes_vector)[node].begin(); it != (*nodes_vector)[node].end(); ++it )
+        const size_t active = solution.node_active(n, first_iteration + i);
+        if (active > 1)
         {
-            if (*it == res)
-            {
-                votes += 1;
-            }
+            table.add_event(Event::Merger, t, i).add_traxel_id(id).add_traxel_id(active);
+            LOG(logDEBUG3) << table.event(table.size() - 1);
         }
-        return 1 - votes / (*nodes_vector)[node].size();
     }
-    return 0.;
 }
 
-
-boost::shared_ptr<std::vector< std::vector<Event> > > events(const HypothesesGraph& g, int iterationStep)
+/**
+ * Events of timestep t < latest_timestep for the iterations [first_iteration, first_iteration + num_iterations).
+ *
+ * present: ResolvedTo and Merger events of the nodes at t
+ * arrived: Move, Division and Disappearance events of the nodes at t and Appearance events at t + 1,
+ *          these belong to the event slot of t + 1
+ * Both are filled in the order events() always used, the iteration column holds the
+ * iteration relative to first_iteration. All iterations are handled in one pass over
+ * the nodes and their arcs.
+ */
+void timestep_events(const FrozenHypothesesGraph& frozen,
+                     const FrozenSolution& solution,
+                     int t,
+                     size_t first_iteration,
+                     size_t num_iterations,
+                     bool with_present,
+                     bool with_arrived,
+                     EventTable& present,
+                     EventTable& arrived)
 {
+    LOG(logDEBUG2) << "events(): processing timestep: " << t;
+    std::map<unsigned int, std::vector<unsigned int> > resolver_map;
+    std::vector<size_t> active_out_arcs;
+    const size_t begin = frozen.timestep_begin(t);
+    const size_t end = frozen.timestep_end(t);
 
-    LOG(logDEBUG) << "events(): entered";
-    boost::shared_ptr<std::vector< std::vector<Event> > > ret(new std::vector< std::vector<Event> >);
-    typedef property_map<node_timestep, HypothesesGraph::base_graph>::type node_timestep_map_t;
-    node_timestep_map_t& node_timestep_map = g.get(node_timestep());
-    typedef property_map<node_traxel, HypothesesGraph::base_graph>::type node_traxel_map_t;
-    node_traxel_map_t& node_traxel_map = g.get(node_traxel());
-
-    property_map<node_active, HypothesesGraph::base_graph>::type* nodes = 0;
-    property_map<node_active2, HypothesesGraph::base_graph>::type* nodes2 = 0;
-    property_map<node_active_count, HypothesesGraph::base_graph>::type* nodes_vector = 0;
-
-
-    property_map<arc_active, HypothesesGraph::base_graph>::type* arcs = 0;
-    property_map<arc_active_count, HypothesesGraph::base_graph>::type* arcs_vector = 0;
-
-    bool with_division_detection = false;
-    property_map<division_active, HypothesesGraph::base_graph>::type* divisions = 0;
-    property_map<division_active_count, HypothesesGraph::base_graph>::type* divisions_vector = 0;
-
-    size_t map_type_id;
-    bool with_mergers = false;
-    if (g.getProperties().count("node_active_count") > 0)
+    // for every node: destiny
+    LOG(logDEBUG2) << "events(): for every node: destiny";
+    for (size_t n = begin; n < end; ++n)
     {
-        map_type_id = 2;
-        arcs_vector =  &g.get(arc_active_count());
-        nodes_vector = &g.get(node_active_count());
-        if (g.getProperties().count("node_active2") > 0)
-        {
-            with_mergers = true;
-        }
-    }
-    else if (g.getProperties().count("node_active2") > 0)
-    {
-        with_mergers = true;
-        nodes2 = &g.get(node_active2());
-        arcs =  &g.get(arc_active());
-        LOG(logDEBUG1) << "events(): with_mergers = true";
-        map_type_id = 1;
-    }
-    else
-    {
-        map_type_id = 0;
-        arcs =  &g.get(arc_active());
-        nodes = &g.get(node_active());
-    }
+        const unsigned int id = frozen.traxel_id(n);
+        LOG(logDEBUG4) << t << " " << id;
 
-    if (g.getProperties().count("division_active") > 0)
-    {
-        with_division_detection = true;
-        if (map_type_id == 2)
+        if (with_present && solution.origin(n) != FrozenSolution::no_origin)
         {
-            if(g.has_property(division_active_count()))
-                divisions_vector = &g.get(division_active_count());
-            else
-                with_division_detection = false;
+            const unsigned int origin_traxel_id = solution.origin(n);
+            LOG(logDEBUG3) << "events(): collecting resolver node ids for all merger nodes " << t << ", " << origin_traxel_id;
+            resolver_map[origin_traxel_id].push_back(id);
         }
-        else
+
+        if (!with_arrived)
         {
-            divisions = &g.get(division_active());
+            continue;
         }
-    }
-    bool with_origin = false;
-    property_map<node_originated_from, HypothesesGraph::base_graph>::type* origin_map;
-    if (g.getProperties().count("node_originated_from") > 0)
-    {
-        origin_map = &g.get(node_originated_from());
-        with_origin = true;
-        LOG(logDEBUG1) << "events(): with_origin enabled";
-    }
-
-    // for every timestep
-    LOG(logDEBUG1) << "events(): earliest_timestep: " << g.earliest_timestep();
-    LOG(logDEBUG1) << "events(): latest_timestep: " << g.latest_timestep();
 
-    // add an empty first timestep
-    ret->push_back(std::vector<Event>());
-
-    for(int t = g.earliest_timestep(); t < g.latest_timestep(); ++t)
-    {
-        LOG(logDEBUG2) << "events(): processing timestep: " << t;
-        ret->push_back(std::vector<Event>());
-
-        std::map<unsigned int, std::vector<unsigned int> > resolver_map;
-
-        // for every node: destiny
-        LOG(logDEBUG2) << "events(): for every node: destiny";
-        for(node_timestep_map_t::ItemIt node_at(node_timestep_map, t); node_at != lemon::INVALID; ++node_at)
+        for (size_t i = 0; i < num_iterations; ++i)
         {
-            assert(node_traxel_map[node_at].Timestep == t);
-            LOG(logDEBUG4) << t << " " << node_traxel_map[node_at].Id;
-
-            if (with_origin){
-                if((*origin_map)[node_at].size() > 0) {
-                    const unsigned int& origin_traxel_id = (*origin_map)[node_at][0];
-                    const unsigned int& resolved_traxel_id = node_traxel_map[node_at].Id;
-                    LOG(logDEBUG3) << "events(): collecting resolver node ids for all merger nodes " << t << ", " << origin_traxel_id;
-                    resolver_map[origin_traxel_id].push_back(resolved_traxel_id);
-                }
-            }
-
-            LOG(logDEBUG3) << "Number of detected objects: " << get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep);
+            const size_t iteration = first_iteration + i;
+            LOG(logDEBUG3) << "Number of detected objects: " << solution.node_active(n, iteration);
 
-            // count outgoing arcs
-
-            size_t count = 0;
-            for(HypothesesGraph::base_graph::OutArcIt a(g, node_at); a != lemon::INVALID; ++a)
+            active_out_arcs.clear();
+            for (size_t a = frozen.out_begin(n); a < frozen.out_end(n); ++a)
             {
-                if (get_active_arc(arcs, arcs_vector, map_type_id, a, iterationStep))
+                if (solution.arc_active(a, iteration))
                 {
-                    ++count;
+                    active_out_arcs.push_back(a);
                 }
             }
 
             // construct suitable Event object
-            switch(count)
+            switch(active_out_arcs.size())
             {
                 // Disappearance
                 case 0:
                 {
-
-                    if(!get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep))
+                    if(!solution.node_active(n, iteration))
                     {
                         continue;
                     }
-
-                    if (t < g.latest_timestep())
-                    {
-                        Event e;
-                        e.type = Event::Disappearance;
-                        e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-                        (*ret)[t - g.earliest_timestep() + 1].push_back(e);
-                        LOG(logDEBUG3) << e;
-                    }
+                    arrived.add_event(Event::Disappearance, t + 1, i).add_traxel_id(id);
+                    LOG(logDEBUG3) << arrived.event(arrived.size() - 1);
                     break;
                 }
                 // Move
                 case 1:
                 {
-                    Event e;
-                    e.type = Event::Move;
-                    e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-
-                    for(HypothesesGraph::base_graph::OutArcIt a(g, node_at); a != lemon::INVALID; ++a)
-                    {
-                        if (get_active_arc(arcs, arcs_vector, map_type_id, a, iterationStep))
-                        {
-                            e.traxel_ids.push_back(node_traxel_map[g.target(a)].Id);
-                            e.set_energy(get_uncertainty(arcs, arcs_vector, map_type_id, a, iterationStep));
-                        }
-
-                    }
-                    (*ret)[t - g.earliest_timestep() + 1].push_back(e);
-
-                    LOG(logDEBUG3) << e;
+                    arrived.add_event(Event::Move, t + 1, i, solution.arc_uncertainty(active_out_arcs[0], iteration))
+                        .add_traxel_id(id)
+                        .add_traxel_id(frozen.traxel_id(frozen.target(active_out_arcs[0])));
+                    LOG(logDEBUG3) << arrived.event(arrived.size() - 1);
                     break;
                 }
                 // Division or Splitting
                 default:
                 {
-                    Event e;
-                    if (with_division_detection)
+                    const size_t count = active_out_arcs.size();
+                    if (!solution.with_division_detection() && count != 2)
                     {
-                        if (count == 2 && get_active_division(divisions, divisions_vector, map_type_id, node_at, iterationStep))
-                        {
-                            e.type = Event::Division;
-                            e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-                            for(HypothesesGraph::base_graph::OutArcIt a(g, node_at); a != lemon::INVALID; ++a)
-                            {
-                                if (get_active_arc(arcs, arcs_vector, map_type_id, a, iterationStep))
-                                {
-                                    e.traxel_ids.push_back(node_traxel_map[g.target(a)].Id);
-                                }
-                            }
-                            e.set_energy(get_uncertainty(divisions, divisions_vector, map_type_id, node_at, iterationStep));
-                            (*ret)[t - g.earliest_timestep() + 1].push_back(e);
-
-
-                            LOG(logDEBUG3) << e;
-                        }
-                        else
-                        {
-
-                            for(HypothesesGraph::base_graph::OutArcIt a(g, node_at); a != lemon::INVALID; ++a)
-                            {
-                                if (get_active_arc(arcs, arcs_vector, map_type_id, a, iterationStep))
-                                {
-
-                                    e.type = Event::Move;
-                                    e.traxel_ids.clear();
-                                    e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-                                    e.traxel_ids.push_back(node_traxel_map[g.target(a)].Id);
-                                    e.set_energy(get_uncertainty(arcs, arcs_vector, map_type_id, a, iterationStep));
-                                    (*ret)[t - g.earliest_timestep() + 1].push_back(e);
-                                    LOG(logDEBUG3) << e;
-                                }
-                            }
-                        }
+                        // for backward compatibility
+                        throw std::runtime_error("events(): encountered node dividing in three or more nodes in graph");
                     }
-                    else     // for backward compatibility
+                    if (!solution.with_division_detection()
+                            || (count == 2 && solution.division_active(n, iteration)))
                     {
-                        if (count != 2)
+                        arrived.add_event(Event::Division, t + 1, i, solution.division_uncertainty(n, iteration))
+                            .add_traxel_id(id);
+                        for (std::vector<size_t>::const_iterator a = active_out_arcs.begin(); a != active_out_arcs.end(); ++a)
                         {
-                            throw std::runtime_error("events(): encountered node dividing in three or more nodes in graph");
+                            arrived.add_traxel_id(frozen.traxel_id(frozen.target(*a)));
                         }
-                        e.type = Event::Division;
-                        e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-                        for(HypothesesGraph::base_graph::OutArcIt a(g, node_at); a != lemon::INVALID; ++a)
+                        LOG(logDEBUG3) << arrived.event(arrived.size() - 1);
+                    }
+                    else
+                    {
+                        for (std::vector<size_t>::const_iterator a = active_out_arcs.begin(); a != active_out_arcs.end(); ++a)
                         {
-                            if (get_active_arc(arcs, arcs_vector, map_type_id, a, iterationStep))
-                            {
-                                e.traxel_ids.push_back(node_traxel_map[g.target(a)].Id);
-                            }
+                            arrived.add_event(Event::Move, t + 1, i, solution.arc_uncertainty(*a, iteration))
+                                .add_traxel_id(id)
+                                .add_traxel_id(frozen.traxel_id(frozen.target(*a)));
+                            LOG(logDEBUG3) << arrived.event(arrived.size() - 1);
                         }
-                        e.set_energy(get_uncertainty(divisions, divisions_vector, map_type_id, node_at, iterationStep));
-                        (*ret)[t - g.earliest_timestep() + 1].push_back(e);
-
-                        LOG(logDEBUG3) << e;
                     }
                     break;
                 }
             }
         }
-        // resolved to
-        for (std::map<unsigned int, std::vector<unsigned int> >::iterator map_it = resolver_map.begin(); map_it != resolver_map.end(); ++map_it)
-        {
-            Event e;
-            e.type = Event::ResolvedTo;
-            e.traxel_ids.push_back(map_it->first);
-            for (std::vector<unsigned int>::iterator it = map_it->second.begin(); it != map_it->second.end(); ++it)
-            {
-                e.traxel_ids.push_back(*it);
-            }
-            (*ret)[t - g.earliest_timestep()].push_back(e);
-            LOG(logDEBUG1) << e;
-        }
-
+    }
 
-        // mergers in next timestep
+    // resolved to
+    if (with_present)
+    {
+        add_resolved_to_events(resolver_map, t, num_iterations, present);
+    }
 
+    // appearances in next timestep
+    if (with_arrived)
+    {
         LOG(logDEBUG2) << "events(): appearances in next timestep";
-        if (t + 1 <= g.latest_timestep())
+        for (size_t n = frozen.timestep_begin(t + 1); n < frozen.timestep_end(t + 1); ++n)
         {
-            for(node_timestep_map_t::ItemIt node_at(node_timestep_map, t + 1); node_at != lemon::INVALID; ++node_at)
+            for (size_t i = 0; i < num_iterations; ++i)
             {
-                // count incoming arcs
-
-                if (!get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep))
+                const size_t iteration = first_iteration + i;
+                if (!solution.node_active(n, iteration))
                 {
-		  continue;
-		}
+                    continue;
+                }
 
-                int count = 0;
-                for(HypothesesGraph::base_graph::InArcIt a(g, node_at); a != lemon::INVALID; ++a)
+                // no incoming arcs => appearance
+                bool has_active_in_arc = false;
+                for (size_t k = frozen.in_begin(n); k < frozen.in_end(n) && !has_active_in_arc; ++k)
                 {
-                    if (get_active_arc(arcs, arcs_vector, map_type_id, a, iterationStep))
-                    {
-                        ++count;
-                    }
+                    has_active_in_arc = solution.arc_active(frozen.in_arc(k), iteration);
                 }
-                LOG(logDEBUG3) << "events(): counted incoming arcs in next timestep: " << count;
-                // no incoming arcs => appearance
-                if(count == 0 && t + 1 > g.earliest_timestep())
+                if (!has_active_in_arc)
                 {
-                    Event e;
-                    e.type = Event::Appearance;
-                    e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-                    (*ret)[t - g.earliest_timestep() + 1].push_back(e);
-                    LOG(logDEBUG3) << e;
+                    arrived.add_event(Event::Appearance, t + 1, i).add_traxel_id(frozen.traxel_id(n));
+                    LOG(logDEBUG3) << arrived.event(arrived.size() - 1);
                 }
             }
         }
-        for(node_timestep_map_t::ItemIt node_at(node_timestep_map, t); node_at != lemon::INVALID; ++node_at)
+    }
+
+    // mergers
+    if (with_present && solution.with_mergers())
+    {
+        for (size_t n = begin; n < end; ++n)
         {
-            if(with_mergers && get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep) > 1)
-            {
-                Event e;
-                e.type = Event::Merger;
-                e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-                e.traxel_ids.push_back(get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep));
-                (*ret)[t - g.earliest_timestep()].push_back(e);
-                LOG(logDEBUG3) << e;
-            }
+            add_merger_events(solution, n, frozen.traxel_id(n), t, first_iteration, num_iterations, present);
         }
-    } // end for t
+    }
+}
+
+/**
+ * Merger and ResolvedTo events of the last timestep.
+ */
+void last_timestep_events(const FrozenHypothesesGraph& frozen,
+                          const FrozenSolution& solution,
+                          size_t first_iteration,
+                          size_t num_iterations,
+                          EventTable& present)
+{
+    const int t = frozen.latest_timestep();
 
-    LOG(logDEBUG2) << "events(): last timestep: " << g.latest_timestep();
+    LOG(logDEBUG2) << "events(): last timestep: " << t;
     std::map<unsigned int, std::vector<unsigned int> > resolver_map;
-    int t = g.latest_timestep();
-    for(node_timestep_map_t::ItemIt node_at(node_timestep_map, g.latest_timestep()); node_at!=lemon::INVALID; ++node_at) 
+    for (size_t n = frozen.timestep_begin(t); n < frozen.timestep_end(t); ++n)
     {
-        if(with_mergers && get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep) > 1) 
+        if (solution.with_mergers())
         {
-            Event e;
-            e.type = Event::Merger;
-            e.traxel_ids.push_back(node_traxel_map[node_at].Id);
-            e.traxel_ids.push_back(get_active_node(nodes, nodes2, nodes_vector, map_type_id, node_at, iterationStep));
-            (*ret)[g.latest_timestep() - g.earliest_timestep()].push_back(e);
-            LOG(logDEBUG3) << e;
+            add_merger_events(solution, n, frozen.traxel_id(n), t, first_iteration, num_iterations, present);
         }
 
-        if (with_origin && (*origin_map)[node_at].size() > 0 && t > g.earliest_timestep()) {
-            const unsigned int& origin_traxel_id = (*origin_map)[node_at][0];
-            const unsigned int& resolved_traxel_id = node_traxel_map[node_at].Id;
+        if (solution.origin(n) != FrozenSolution::no_origin && t > frozen.earliest_timestep())
+        {
+            const unsigned int origin_traxel_id = solution.origin(n);
             LOG(logDEBUG3) << "events(): collecting resolver node ids for all merger nodes " << t << ", " << origin_traxel_id;
-            resolver_map[origin_traxel_id].push_back(resolved_traxel_id);
+            resolver_map[origin_traxel_id].push_back(frozen.traxel_id(n));
         }
     }
+    add_resolved_to_events(resolver_map, t, num_iterations, present);
+}
+
+/**
+ * Row indices of table grouped by iteration: the rows of iteration i are
+ * order[begin[i]] .. order[begin[i + 1] - 1], in the order they were added.
+ */
+void rows_by_iteration(const EventTable& table, size_t num_iterations,
+                       std::vector<size_t>& begin, std::vector<size_t>& order)
+{
+    begin.assign(num_iterations + 1, 0);
+    for (size_t row = 0; row < table.size(); ++row)
+    {
+        ++begin[table.iteration(row) + 1];
+    }
+    for (size_t i = 0; i < num_iterations; ++i)
+    {
+        begin[i + 1] += begin[i];
+    }
+    std::vector<size_t> next(begin.begin(), begin.end() - 1);
+    order.resize(table.size());
+    for (size_t row = 0; row < table.size(); ++row)
+    {
+        order[next[table.iteration(row)]++] = row;
+    }
+}
+
+/**
+ * Common implementation of events(), multi_events() and event_table().
+ *
+ * The table holds the events of the iterations [first_iteration, first_iteration + num_iterations),
+ * counted from 0, in the timesteps [first_timestep, last_timestep]; num_iterations == 0 takes all
+ * solutions stored in the graph. The events arriving at a
+ * timestep are moves, divisions and disappearances of the previous timestep, appearances, and
+ * mergers and resolved-to events of the timestep itself. The timesteps are processed in parallel,
+ * each into its own tables, which are concatenated ordered by iteration and timestep. Graph and
+ * solutions are read from frozen copies, so the workers never touch the lemon maps; only the
+ * requested iterations of the traversed timesteps are copied out of the solution maps.
+ */
+boost::shared_ptr<EventTable> extract_events(const FrozenHypothesesGraph& frozen,
+                                             size_t first_iteration,
+                                             size_t num_iterations,
+                                             int first_timestep,
+                                             int last_timestep)
+{
+    LOG(logDEBUG) << "events(): entered";
+    const int earliest = frozen.earliest_timestep();
+    const int latest = frozen.latest_timestep();
+    LOG(logDEBUG1) << "events(): earliest_timestep: " << earliest;
+    LOG(logDEBUG1) << "events(): latest_timestep: " << latest;
+
+    first_timestep = std::max(first_timestep, earliest);
+    last_timestep = std::min(last_timestep, latest);
+    const size_t num_timesteps = first_timestep > last_timestep ? 0 : last_timestep - first_timestep + 1;
+    // the events arriving at first_timestep start at the timestep before
+    const int first_traversed = std::max(first_timestep - 1, earliest);
+
+    const FrozenSolution solution(frozen, first_iteration,
+                                  num_iterations == 0 ? static_cast<size_t>(-1) : num_iterations,
+                                  first_traversed, last_timestep);
+    LOG(logDEBUG1) << "events(): with_mergers = " << solution.with_mergers()
+                   << ", with_origin = " << solution.with_origin();
+    if (num_iterations == 0)
+    {
+        num_iterations = solution.n_iterations();
+    }
+    boost::shared_ptr<EventTable> result(new EventTable(num_iterations, first_timestep, num_timesteps));
+    if (num_timesteps == 0 || num_iterations == 0)
+    {
+        return result;
+    }
 
-    for (std::map<unsigned int, std::vector<unsigned int> >::iterator map_it = resolver_map.begin(); map_it != resolver_map.end(); ++map_it) {
-        Event e;
-        e.type = Event::ResolvedTo;
-        e.traxel_ids.push_back(map_it->first);
-        for (std::vector<unsigned int>::iterator it = map_it->second.begin(); it != map_it->second.end(); ++it) {
-            e.traxel_ids.push_back(*it);
+    const int num_traversed = last_timestep - first_traversed + 1;
+    const EventTable empty(num_iterations, first_timestep, num_timesteps);
+    std::vector<EventTable> present(num_traversed, empty);
+    std::vector<EventTable> arrived(num_traversed, empty);
+    ParallelExceptions exceptions(num_traversed);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < num_traversed; ++k)
+    {
+        const int t = first_traversed + k;
+        try
+        {
+            if (t == latest)
+            {
+                last_timestep_events(frozen, solution, first_iteration, num_iterations, present[k]);
+            }
+            else
+            {
+                timestep_events(frozen, solution, t, first_iteration, num_iterations,
+                                t >= first_timestep, t < last_timestep,
+                                present[k], arrived[k]);
+            }
+        }
+        catch (...)
+        {
+            exceptions.capture(k);
+        }
+    }
+    exceptions.rethrow();
+    size_t num_rows = 0;
+    for (int k = 0; k < num_traversed; ++k)
+    {
+        num_rows += present[k].size() + arrived[k].size();
+    }
+
+    std::vector<std::vector<size_t> > present_begin(num_traversed), present_order(num_traversed);
+    std::vector<std::vector<size_t> > arrived_begin(num_traversed), arrived_order(num_traversed);
+    for (int k = 0; k < num_traversed; ++k)
+    {
+        rows_by_iteration(present[k], num_iterations, present_begin[k], present_order[k]);
+        rows_by_iteration(arrived[k], num_iterations, arrived_begin[k], arrived_order[k]);
+    }
+
+    result->reserve(num_rows);
+    for (size_t i = 0; i < num_iterations; ++i)
+    {
+        for (int t = first_timestep; t <= last_timestep; ++t)
+        {
+            if (t - 1 >= first_traversed)
+            {
+                const size_t k = t - 1 - first_traversed;
+                for (size_t j = arrived_begin[k][i]; j < arrived_begin[k][i + 1]; ++j)
+                {
+                    result->add_row(arrived[k], arrived_order[k][j]);
+                }
+            }
+            const size_t k = t - first_traversed;
+            for (size_t j = present_begin[k][i]; j < present_begin[k][i + 1]; ++j)
+            {
+                result->add_row(present[k], present_order[k][j]);
+            }
         }
-        (*ret)[t-g.earliest_timestep()].push_back(e);
-        LOG(logDEBUG1) << e;
     }
     LOG(logDEBUG2) << "events(): done.";
-    for(int i=0; i < (*ret).size(); i++){
+    return result;
+}
+} // anonymous namespace
+
+boost::shared_ptr<std::vector< std::vector<Event> > > events(const HypothesesGraph& g,
+                                                             int iterationStep,
+                                                             int first_timestep,
+                                                             int last_timestep)
+{
+    const FrozenHypothesesGraph frozen(g);
+    return events(frozen, iterationStep, first_timestep, last_timestep);
+}
+
+boost::shared_ptr<std::vector< std::vector<Event> > > events(const FrozenHypothesesGraph& frozen,
+                                                             int iterationStep,
+                                                             int first_timestep,
+                                                             int last_timestep)
+{
+    boost::shared_ptr<EventTable> table = extract_events(frozen, iterationStep, 1, first_timestep, last_timestep);
+    boost::shared_ptr<EventVectorVector> ret(new EventVectorVector);
+    table->to_events(0, *ret);
+    for(size_t i = 0; i < ret->size(); i++)
+    {
         LOG(logDEBUG3) << i << "--->" << (*ret)[i].size();
-        for(int j=0; j < (*ret)[i].size(); j++){
+        for(size_t j = 0; j < (*ret)[i].size(); j++)
+        {
             LOG(logDEBUG3) << i << " ---> " << j << " ===> " << (*ret)[i][j];
         }
     }
     return ret;
 }
 
+boost::shared_ptr<EventTable> event_table(const HypothesesGraph& g,
+                                          size_t num_iterations,
+                                          int first_timestep,
+                                          int last_timestep)
+{
+    const FrozenHypothesesGraph frozen(g);
+    return extract_events(frozen, 0, num_iterations, first_timestep, last_timestep);
+}
+
+boost::shared_ptr<EventTable> event_table(const FrozenHypothesesGraph& frozen,
+                                          size_t num_iterations,
+                                          int first_timestep,
+                                          int last_timestep)
+{
+    return extract_events(frozen, 0, num_iterations, first_timestep, last_timestep);
+}
+
+boost::shared_ptr<EventVectorVectorVector> multi_events(const HypothesesGraph& g,
+                                                        size_t num_iterations,
+                                                        int first_timestep,
+                                                        int last_timestep)
+{
+    const FrozenHypothesesGraph frozen(g);
+    return multi_events(frozen, num_iterations, first_timestep, last_timestep);
+}
+
+boost::shared_ptr<EventVectorVectorVector> multi_events(const FrozenHypothesesGraph& frozen,
+                                                        size_t num_iterations,
+                                                        int first_timestep,
+                                                        int last_timestep)
+{
+    boost::shared_ptr<EventVectorVectorVector> ret(new EventVectorVectorVector);
+    event_table(frozen, num_iterations, first_timestep, last_timestep)->to_events(*ret);
+    return ret;
+}
+
 template<typename T>
 std::ostream& operator<<(std::ostream& stream, const std::vector<T>& values)
 {
@@ -979,6 +963,123 @@ boost::shared_ptr< EventVectorVector > resolved_to_events(const HypothesesGraph&
     return ret;
 }
 
+boost::shared_ptr<HypothesesGraphState> hypotheses_graph_state(const HypothesesGraph& g)
+{
+    LOG(logDEBUG) << "hypotheses_graph_state(): entered";
+    boost::shared_ptr<HypothesesGraphState> state(new HypothesesGraphState);
+
+    typedef property_map<node_timestep, HypothesesGraph::base_graph>::type node_timestep_map_t;
+    node_timestep_map_t& node_timestep_map = g.get(node_timestep());
+
+    property_map<node_traxel, HypothesesGraph::base_graph>::type* node_traxel_map = 0;
+    if(g.has_property(node_traxel()))
+    {
+        node_traxel_map = &g.get(node_traxel());
+    }
+    property_map<relative_uncertainty, HypothesesGraph::base_graph>::type* uncertainty_map = 0;
+    if(g.has_property(relative_uncertainty()))
+    {
+        uncertainty_map = &g.get(relative_uncertainty());
+    }
+    property_map<node_active_count, HypothesesGraph::base_graph>::type* node_count_map = 0;
+    property_map<node_active2, HypothesesGraph::base_graph>::type* node_active2_map = 0;
+    property_map<node_active, HypothesesGraph::base_graph>::type* node_active_map = 0;
+    property_map<arc_active_count, HypothesesGraph::base_graph>::type* arc_count_map = 0;
+    property_map<arc_active, HypothesesGraph::base_graph>::type* arc_active_map = 0;
+
+    if(g.has_property(node_active_count()))
+    {
+        node_count_map = &g.get(node_active_count());
+        HypothesesGraph::NodeIt n(g);
+        state->n_iterations = (n != lemon::INVALID) ? node_count_map->size(n) : 0;
+    }
+    else
+    {
+        if(g.has_property(node_active2()))
+        {
+            node_active2_map = &g.get(node_active2());
+        }
+        else if(g.has_property(node_active()))
+        {
+            node_active_map = &g.get(node_active());
+        }
+        state->n_iterations = (node_active2_map || node_active_map) ? 1 : 0;
+    }
+
+    if(g.has_property(arc_active_count()))
+    {
+        arc_count_map = &g.get(arc_active_count());
+    }
+    else if(g.has_property(arc_active()))
+    {
+        arc_active_map = &g.get(arc_active());
+    }
+
+    const size_t n_nodes = lemon::countNodes(g);
+    const size_t n_arcs = lemon::countArcs(g);
+    const size_t n_iterations = state->n_iterations;
+
+    state->node_ids.reserve(n_nodes);
+    state->node_timesteps.reserve(n_nodes);
+    state->node_traxel_ids.reserve(n_nodes);
+    state->relative_uncertainty.reserve(n_nodes);
+    state->node_active_count.resize(n_nodes * n_iterations, 0);
+
+    size_t row = 0;
+    for(HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n, ++row)
+    {
+        state->node_ids.push_back(g.id(n));
+        state->node_timesteps.push_back(node_timestep_map[n]);
+        state->node_traxel_ids.push_back(node_traxel_map ? (*node_traxel_map)[n].Id : 0);
+        state->relative_uncertainty.push_back(uncertainty_map ? (*uncertainty_map)[n] : 0.);
+
+        size_t* active = n_iterations ? &state->node_active_count[row * n_iterations] : 0;
+        if(node_count_map)
+        {
+            for(size_t i = 0; i < std::min(node_count_map->size(n), n_iterations); ++i)
+            {
+                active[i] = node_count_map->get(n, i);
+            }
+        }
+        else if(node_active2_map)
+        {
+            active[0] = (*node_active2_map)[n];
+        }
+        else if(node_active_map)
+        {
+            active[0] = (*node_active_map)[n];
+        }
+    }
+
+    state->arc_ids.reserve(n_arcs);
+    state->arc_sources.reserve(n_arcs);
+    state->arc_targets.reserve(n_arcs);
+    state->arc_active_count.resize(n_arcs * n_iterations, 0);
+
+    row = 0;
+    for(HypothesesGraph::ArcIt a(g); a != lemon::INVALID; ++a, ++row)
+    {
+        state->arc_ids.push_back(g.id(a));
+        state->arc_sources.push_back(g.id(g.source(a)));
+        state->arc_targets.push_back(g.id(g.target(a)));
+
+        uint8_t* active = n_iterations ? &state->arc_active_count[row * n_iterations] : 0;
+        if(arc_count_map)
+        {
+            for(size_t i = 0; i < std::min(arc_count_map->size(a), n_iterations); ++i)
+            {
+                active[i] = arc_count_map->get(a, i);
+            }
+        }
+        else if(arc_active_map && n_iterations)
+        {
+            active[0] = (*arc_active_map)[a];
+        }
+    }
+
+    return state;
+}
+
 //
 // generateTrackletGraph
 //
@@ -1149,190 +1250,249 @@ void generateTrackletGraph(const HypothesesGraph& traxel_graph, HypothesesGraph&
     }
 }
 
-namespace
+//
+// TrackletView
+//
+TrackletView::TrackletView(const HypothesesGraph& tracklet_graph)
+    : traxel_graph_(NULL),
+      tracklet_graph_(&tracklet_graph),
+      traxel_map_(NULL),
+      tracklet_map_(&tracklet_graph.get(node_tracklet()))
 {
-std::vector<HypothesesGraph::Arc> getOutgoingArcs(const HypothesesGraph& graph, const HypothesesGraph::Node& n)
+}
+
+TrackletView::TrackletView(const HypothesesGraph& traxel_graph, const HypothesesGraph& tracklet_graph)
+    : traxel_graph_(&traxel_graph),
+      tracklet_graph_(&tracklet_graph),
+      traxel_map_(&traxel_graph.get(node_traxel())),
+      tracklet_map_(NULL)
 {
-    std::vector<HypothesesGraph::Arc> result;
-    for(HypothesesGraph::OutArcIt a(graph, n); a != lemon::INVALID; ++a)
+}
+
+size_t TrackletView::size(const Node& tracklet) const
+{
+    if (traxel_graph_)
     {
-        result.push_back(a);
+        const std::pair<size_t, size_t>& range = ranges_[tracklet_graph_->id(tracklet)];
+        return range.second - range.first;
     }
-    return result;
+    return (*tracklet_map_)[tracklet].size();
 }
 
-std::vector<HypothesesGraph::Arc> getIncomingArcs(const HypothesesGraph& graph, const HypothesesGraph::Node& n)
+const Traxel& TrackletView::traxel(const Node& tracklet, size_t i) const
 {
-    std::vector<HypothesesGraph::Arc> result;
-    for(HypothesesGraph::InArcIt a(graph, n); a != lemon::INVALID; ++a)
+    assert(i < size(tracklet));
+    if (traxel_graph_)
     {
-        result.push_back(a);
+        return (*traxel_map_)[traxel_nodes_[begin(tracklet) + i]];
     }
-    return result;
+    return (*tracklet_map_)[tracklet][i];
 }
 
-void addNodeToTracklet(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph,
-                       const HypothesesGraph::Node& traxel_node, const HypothesesGraph::Node& ancestor_traxel_node,
-                       std::map<HypothesesGraph::Node, HypothesesGraph::Node>& traxel2tracklet, double traxel_arc_dist,
-                       std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> >& tracklet2traxel, const int arc_id)
+double TrackletView::intern_dist(const Node& tracklet, size_t i) const
 {
-    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = traxel_graph.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = tracklet_graph.get(node_tracklet());
-    property_map<tracklet_intern_dist, HypothesesGraph::base_graph>::type& tracklet_arc_dist_map = tracklet_graph.get(tracklet_intern_dist());
-    property_map<tracklet_intern_arc_ids, HypothesesGraph::base_graph>::type& tracklet_arc_id_map = tracklet_graph.get(tracklet_intern_arc_ids());
-
-    //	property_map<node_timestep, HypothesesGraph::base_graph>::type& timestep_map = tracklet_graph.get(node_timestep());
-
-    assert(traxel2tracklet.find(ancestor_traxel_node) != traxel2tracklet.end());
-    HypothesesGraph::Node tracklet_node = traxel2tracklet[ancestor_traxel_node];
-    std::vector<Traxel> tracklet = tracklet_map[tracklet_node];
-    Traxel tr = traxel_map[traxel_node];
-    tracklet.push_back(tr);
-    tracklet_map.set(tracklet_node, tracklet);
-    traxel2tracklet[traxel_node] = tracklet_node;
-
-
-    if(traxel_graph.getProperties().count("appearance_label") > 0)
+    assert(i + 1 < size(tracklet));
+    if (traxel_graph_)
     {
-        // create appropriate labels in tracklet node
-        tracklet_graph.add_appearance_label(tracklet_node, traxel_graph.get(appearance_label())[traxel_node]);
-        tracklet_graph.add_disappearance_label(tracklet_node, traxel_graph.get(disappearance_label())[traxel_node]);
-        tracklet_graph.add_division_label(tracklet_node, traxel_graph.get(division_label())[traxel_node]);
+        return intern_dists_[begin(tracklet) + i];
     }
-    //	size_t timestep = tr.Timestep;
-    //	timestep_map[tracklet_node].add(timestep);
-    //	tracklet_graph.timesteps_.insert(timestep);
-
-    // add internal arc
-    std::vector<double> arc_dists = tracklet_arc_dist_map[tracklet_node];
-    arc_dists.push_back(traxel_arc_dist);
-    tracklet_arc_dist_map.set(tracklet_node, arc_dists);
-
-    tracklet2traxel[tracklet_node].push_back(traxel_node);
-
-    std::vector<int> arc_ids = tracklet_arc_id_map[tracklet_node];
-    arc_ids.push_back(arc_id);
-    tracklet_arc_id_map.set(tracklet_node, arc_ids);
-    LOG(logDEBUG4) << "addNodeToTracklet: added arc_id " << arc_id;
+    return tracklet_graph_->get(tracklet_intern_dist())[tracklet][i];
 }
 
-void addNodeToGraph(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph,
-                    const HypothesesGraph::Node& traxel_node, std::map<HypothesesGraph::Node, HypothesesGraph::Node>& traxel2tracklet,
-                    std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> >& tracklet2traxel,
-                    bool with_ground_truth_labeling = false)
+int TrackletView::intern_arc_id(const Node& tracklet, size_t i) const
 {
-    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = traxel_graph.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = tracklet_graph.get(node_tracklet());
-    property_map<tracklet_intern_dist, HypothesesGraph::base_graph>::type& tracklet_intern_dist_map = tracklet_graph.get(tracklet_intern_dist());
-    std::vector<Traxel> tracklet;
-    Traxel tr = traxel_map[traxel_node];
-    tracklet.push_back(tr);
-    size_t timestep = tr.Timestep;
-    HypothesesGraph::Node tracklet_node = tracklet_graph.add_node(timestep);
-    LOG(logDEBUG4) << "added tracklet node " << tracklet_graph.id(tracklet_node);
-    tracklet_map.set(tracklet_node, tracklet);
-    traxel2tracklet[traxel_node] = tracklet_node;
-    std::vector<double> arc_dists;
-    tracklet_intern_dist_map.set(tracklet_node, arc_dists);
+    assert(i + 1 < size(tracklet));
+    if (traxel_graph_)
+    {
+        return intern_arc_ids_[begin(tracklet) + i];
+    }
+    return tracklet_graph_->get(tracklet_intern_arc_ids())[tracklet][i];
+}
 
-    if(with_ground_truth_labeling)
+TrackletView::Node TrackletView::traxel_node(const Node& tracklet, size_t i) const
+{
+    if (!traxel_graph_)
     {
-        // create appropriate labels in tracklet node
-        tracklet_graph.add_appearance_label(tracklet_node, traxel_graph.get(appearance_label())[traxel_node]);
-        tracklet_graph.add_disappearance_label(tracklet_node, traxel_graph.get(disappearance_label())[traxel_node]);
-        tracklet_graph.add_division_label(tracklet_node, traxel_graph.get(division_label())[traxel_node]);
+        throw std::runtime_error("TrackletView::traxel_node(): tracklet graph does not reference a traxel graph");
     }
+    assert(i < size(tracklet));
+    return traxel_nodes_[begin(tracklet) + i];
+}
 
-    tracklet2traxel[tracklet_node].push_back(traxel_node);
+std::map<TrackletView::Node, std::vector<TrackletView::Node> > TrackletView::tracklet2traxel_node_map() const
+{
+    if (!traxel_graph_)
+    {
+        throw std::runtime_error("TrackletView::tracklet2traxel_node_map(): tracklet graph does not reference a traxel graph");
+    }
+    std::map<Node, std::vector<Node> > result;
+    for (HypothesesGraph::NodeIt n(*tracklet_graph_); n != lemon::INVALID; ++n)
+    {
+        const std::pair<size_t, size_t>& range = ranges_[tracklet_graph_->id(n)];
+        result[n].assign(traxel_nodes_.begin() + range.first, traxel_nodes_.begin() + range.second);
+    }
+    return result;
 }
 
-void addArcsToGraph(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph,
-                    const std::vector<HypothesesGraph::Arc>& incoming_arcs, std::map<HypothesesGraph::Node, HypothesesGraph::Node>& traxel2tracklet,
-                    bool with_ground_truth_labeling = false)
+void HypothesesGraph::set_tracklet_view(boost::shared_ptr<const TrackletView> view)
 {
-    property_map<arc_distance, HypothesesGraph::base_graph>::type& traxel_arc_distances = traxel_graph.get(arc_distance());
-    property_map<arc_distance, HypothesesGraph::base_graph>::type& tracklet_arc_distances = tracklet_graph.get(arc_distance());
-    property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& traxel_arc_ids = tracklet_graph.get(traxel_arc_id());
+    tracklet_view_ = view;
+}
 
-    for(std::vector<HypothesesGraph::Arc>::const_iterator a = incoming_arcs.begin(); a != incoming_arcs.end(); ++a)
+const TrackletView& HypothesesGraph::tracklets() const
+{
+    if (!tracklet_view_)
     {
-        HypothesesGraph::Arc arc = *a;
-        LOG(logDEBUG4) << "traxel arc source " << traxel_graph.id(traxel_graph.source(arc));
-        LOG(logDEBUG4) << "traxel arc target " << traxel_graph.id(traxel_graph.target(arc));
-        HypothesesGraph::Node from = traxel2tracklet[traxel_graph.source(arc)];
-        HypothesesGraph::Node to = traxel2tracklet[traxel_graph.target(arc)];
-        LOG(logDEBUG4) << "tracklet node from " << tracklet_graph.id(traxel2tracklet[traxel_graph.source(arc)]);
-        LOG(logDEBUG4) << "tracklet node to " << tracklet_graph.id(traxel2tracklet[traxel_graph.target(arc)]);
-        assert(from != to);
-
-        HypothesesGraph::Arc tracklet_arc = tracklet_graph.addArc(from, to);
-        if(with_ground_truth_labeling)
+        if (!has_property(node_tracklet()))
         {
-            tracklet_graph.add_arc_label(tracklet_arc, traxel_graph.get(arc_label())[arc]);
+            throw std::runtime_error("HypothesesGraph::tracklets(): not a tracklet graph");
         }
-        tracklet_arc_distances.set(tracklet_arc, traxel_arc_distances[arc]);
-        traxel_arc_ids.set(tracklet_arc, (int) traxel_graph.id(arc));
+        tracklet_view_.reset(new TrackletView(*this));
     }
+    return *tracklet_view_;
 }
 
-} // anonymous namespace
-
-std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> > generateTrackletGraph2(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph)
+//
+// generateTrackletView()
+//
+boost::shared_ptr<const TrackletView> generateTrackletView(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph)
 {
-    property_map<arc_distance, HypothesesGraph::base_graph>::type& traxel_arc_dist_map = traxel_graph.get(arc_distance());
-
     typedef property_map<node_timestep, HypothesesGraph::base_graph>::type node_timestep_map_t;
     node_timestep_map_t& node_timestep_map = traxel_graph.get(node_timestep());
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = traxel_graph.get(node_traxel());
+    property_map<arc_distance, HypothesesGraph::base_graph>::type& traxel_arc_dist_map = traxel_graph.get(arc_distance());
 
     // add empty traxel_map to the tracklet graph in order to make the tracklet graph equivalent to traxelgraphs
-    tracklet_graph.add(node_traxel()).add(arc_distance());
+    tracklet_graph.add(node_traxel()).add(arc_distance()).add(traxel_arc_id());
+    property_map<arc_distance, HypothesesGraph::base_graph>::type& tracklet_arc_dist_map = tracklet_graph.get(arc_distance());
+    property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& tracklet_traxel_arc_id_map = tracklet_graph.get(traxel_arc_id());
 
-    tracklet_graph.add(node_tracklet()).add(tracklet_intern_dist()).add(tracklet_intern_arc_ids()).add(traxel_arc_id());
-
-    std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> > tracklet_node_to_traxel_nodes;
-    // maps traxel_nodes to tracklet_nodes
-    std::map<HypothesesGraph::Node, HypothesesGraph::Node > traxel_node_to_tracklet_node;
-
-    bool with_ground_truth_labeling = (traxel_graph.getProperties().count("appearance_label") > 0);
+    bool with_ground_truth_labeling = traxel_graph.has_property(appearance_label());
     if (with_ground_truth_labeling)
     {
         tracklet_graph.add(appearance_label()).add(disappearance_label()).add(division_label()).add(arc_label());
     }
 
-    for(int t = traxel_graph.earliest_timestep(); t <= traxel_graph.latest_timestep(); ++t)
+    boost::shared_ptr<TrackletView> view(new TrackletView(traxel_graph, tracklet_graph));
+    const size_t num_traxels = lemon::countNodes(traxel_graph);
+    view->traxel_nodes_.reserve(num_traxels);
+    view->intern_dists_.reserve(num_traxels);
+    view->intern_arc_ids_.reserve(num_traxels);
+
+    HypothesesGraph::base_graph::NodeMap<HypothesesGraph::Node> traxel2tracklet(traxel_graph, lemon::INVALID);
+
+    // Tracklets start at traxels that do not have exactly one incoming arc or whose predecessor
+    // has more than one outgoing arc. Every other traxel is reached by following the chain from
+    // the start of its tracklet, so each traxel node is visited once and the traxels of a
+    // tracklet end up next to each other.
+    for (int t = traxel_graph.earliest_timestep(); t <= traxel_graph.latest_timestep(); ++t)
     {
-        for(node_timestep_map_t::ItemIt traxel_node(node_timestep_map, t); traxel_node != lemon::INVALID; ++traxel_node)
+        for (node_timestep_map_t::ItemIt traxel_node(node_timestep_map, t); traxel_node != lemon::INVALID; ++traxel_node)
         {
-            LOG(logDEBUG4) << "traxel_node = " << traxel_graph.id(traxel_node);
-            std::vector<HypothesesGraph::Arc> incoming_arcs = getIncomingArcs(traxel_graph, traxel_node);
-            if(incoming_arcs.size() != 1)
+            HypothesesGraph::InArcIt in_arc(traxel_graph, traxel_node);
+            if (lemon::countInArcs(traxel_graph, traxel_node) == 1
+                    && lemon::countOutArcs(traxel_graph, traxel_graph.source(in_arc)) == 1)
             {
-                addNodeToGraph(traxel_graph, tracklet_graph, traxel_node, traxel_node_to_tracklet_node, tracklet_node_to_traxel_nodes,
-                               with_ground_truth_labeling);
-                addArcsToGraph(traxel_graph, tracklet_graph, incoming_arcs, traxel_node_to_tracklet_node, with_ground_truth_labeling);
-                LOG(logDEBUG4) << "traxel2tracklet.size(): " << traxel_node_to_tracklet_node.size();
+                assert(traxel2tracklet[traxel_node] != lemon::INVALID);
                 continue;
             }
 
-            HypothesesGraph::Node ancestor = traxel_graph.source(incoming_arcs[0]);
-            if(getOutgoingArcs(traxel_graph, ancestor).size() > 1)
+            HypothesesGraph::Node tracklet_node = tracklet_graph.add_node(traxel_map[traxel_node].Timestep);
+            LOG(logDEBUG4) << "added tracklet node " << tracklet_graph.id(tracklet_node);
+
+            for (; in_arc != lemon::INVALID; ++in_arc)
             {
-                addNodeToGraph(traxel_graph, tracklet_graph, traxel_node, traxel_node_to_tracklet_node, tracklet_node_to_traxel_nodes,
-                               with_ground_truth_labeling);
-                assert(incoming_arcs.size() == 1);
-                addArcsToGraph(traxel_graph, tracklet_graph, incoming_arcs, traxel_node_to_tracklet_node,
-                               with_ground_truth_labeling);
-                LOG(logDEBUG4) << "traxel2tracklet.size(): " << traxel_node_to_tracklet_node.size();
-                continue;
+                HypothesesGraph::Node from = traxel2tracklet[traxel_graph.source(in_arc)];
+                assert(from != lemon::INVALID && from != tracklet_node);
+                HypothesesGraph::Arc tracklet_arc = tracklet_graph.addArc(from, tracklet_node);
+                if (with_ground_truth_labeling)
+                {
+                    tracklet_graph.add_arc_label(tracklet_arc, traxel_graph.get(arc_label())[in_arc]);
+                }
+                tracklet_arc_dist_map.set(tracklet_arc, traxel_arc_dist_map[in_arc]);
+                tracklet_traxel_arc_id_map.set(tracklet_arc, traxel_graph.id(in_arc));
+            }
+
+            const size_t begin = view->traxel_nodes_.size();
+            HypothesesGraph::Node current = traxel_node;
+            while (true)
+            {
+                traxel2tracklet[current] = tracklet_node;
+                view->traxel_nodes_.push_back(current);
+
+                HypothesesGraph::OutArcIt out_arc(traxel_graph, current);
+                if (lemon::countOutArcs(traxel_graph, current) != 1
+                        || lemon::countInArcs(traxel_graph, traxel_graph.target(out_arc)) != 1)
+                {
+                    view->intern_dists_.push_back(0.);
+                    view->intern_arc_ids_.push_back(-1);
+                    break;
+                }
+                view->intern_dists_.push_back(traxel_arc_dist_map[out_arc]);
+                view->intern_arc_ids_.push_back(traxel_graph.id(out_arc));
+                current = traxel_graph.target(out_arc);
             }
 
-            double dist = traxel_arc_dist_map[incoming_arcs[0]];
-            int arc_id = traxel_graph.id(incoming_arcs[0]);
-            addNodeToTracklet(traxel_graph, tracklet_graph, traxel_node, ancestor, traxel_node_to_tracklet_node, dist,
-                              tracklet_node_to_traxel_nodes, arc_id);
+            if (with_ground_truth_labeling)
+            {
+                // the labels of the last traxel of the tracklet
+                tracklet_graph.add_appearance_label(tracklet_node, traxel_graph.get(appearance_label())[current]);
+                tracklet_graph.add_disappearance_label(tracklet_node, traxel_graph.get(disappearance_label())[current]);
+                tracklet_graph.add_division_label(tracklet_node, traxel_graph.get(division_label())[current]);
+            }
+
+            const size_t id = tracklet_graph.id(tracklet_node);
+            if (view->ranges_.size() <= id)
+            {
+                view->ranges_.resize(id + 1, std::make_pair(0, 0));
+            }
+            view->ranges_[id] = std::make_pair(begin, view->traxel_nodes_.size());
+        }
+    }
+
+    tracklet_graph.set_tracklet_view(view);
+    return view;
+}
+
+//
+// generateTrackletGraph2()
+//
+std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> > generateTrackletGraph2(const HypothesesGraph& traxel_graph, HypothesesGraph& tracklet_graph)
+{
+    boost::shared_ptr<const TrackletView> view = generateTrackletView(traxel_graph, tracklet_graph);
+
+    // store copies of the traxels in the tracklet graph, so that it does not depend on the traxel graph
+    tracklet_graph.add(node_tracklet()).add(tracklet_intern_dist()).add(tracklet_intern_arc_ids());
+    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = tracklet_graph.get(node_tracklet());
+    property_map<tracklet_intern_dist, HypothesesGraph::base_graph>::type& tracklet_intern_dist_map = tracklet_graph.get(tracklet_intern_dist());
+    property_map<tracklet_intern_arc_ids, HypothesesGraph::base_graph>::type& tracklet_arc_id_map = tracklet_graph.get(tracklet_intern_arc_ids());
+
+    for (HypothesesGraph::NodeIt n(tracklet_graph); n != lemon::INVALID; ++n)
+    {
+        const size_t size = view->size(n);
+        std::vector<Traxel> tracklet;
+        std::vector<double> arc_dists;
+        std::vector<int> arc_ids;
+        tracklet.reserve(size);
+        arc_dists.reserve(size - 1);
+        arc_ids.reserve(size - 1);
+        for (size_t i = 0; i < size; ++i)
+        {
+            tracklet.push_back(view->traxel(n, i));
+            if (i + 1 < size)
+            {
+                arc_dists.push_back(view->intern_dist(n, i));
+                arc_ids.push_back(view->intern_arc_id(n, i));
+            }
         }
+        tracklet_map.set(n, tracklet);
+        tracklet_intern_dist_map.set(n, arc_dists);
+        tracklet_arc_id_map.set(n, arc_ids);
     }
 
+    std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> > tracklet_node_to_traxel_nodes = view->tracklet2traxel_node_map();
+    // from now on read the tracklets from node_tracklet
+    tracklet_graph.set_tracklet_view(boost::shared_ptr<const TrackletView>());
     return tracklet_node_to_traxel_nodes;
 }
 
@@ -1739,6 +1899,35 @@ double getDivisionProbability(const Traxel& tr)
 ////
 //// class SingleTimestepTraxel_HypothesesBuilder
 ////
+SingleTimestepTraxel_HypothesesBuilder::SingleTimestepTraxel_HypothesesBuilder(
+    const OutOfCoreTraxelStore* store,
+    boost::shared_ptr<FeatureStore> resident_fs,
+    const Options& o,
+    const std::vector<std::string>& resident_features)
+    : ts_(NULL), options_(o), store_(store), resident_fs_(resident_fs), resident_features_(resident_features)
+{
+    if (!resident_fs_)
+    {
+        throw std::runtime_error("SingleTimestepTraxel_HypothesesBuilder: need a feature store for the resident features");
+    }
+    // the nearest neighbor search reads these from the graph traxels:
+    // X_corr() of the query traxel ("com_corrected" if present) and divProb
+    // when divisions are considered
+    std::vector<std::string> required(1, "com");
+    required.push_back("com_corrected");
+    if (options_.consider_divisions)
+    {
+        required.push_back("divProb");
+    }
+    for (std::vector<std::string>::const_iterator name = required.begin(); name != required.end(); ++name)
+    {
+        if (std::find(resident_features_.begin(), resident_features_.end(), *name) == resident_features_.end())
+        {
+            resident_features_.push_back(*name);
+        }
+    }
+}
+
 HypothesesGraph* SingleTimestepTraxel_HypothesesBuilder::construct() const
 {
     HypothesesGraph* graph = new HypothesesGraph();
@@ -1752,6 +1941,34 @@ HypothesesGraph* SingleTimestepTraxel_HypothesesBuilder::add_nodes(HypothesesGra
     LOG(logDEBUG) << "SingleTimestepTraxel_HypothesesBuilder::add_nodes(): entered";
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_m = graph->get(node_traxel());
 
+    if (store_)
+    {
+        // one frame at a time, keeping only the resident features
+        const std::set<int> timesteps = store_->timesteps();
+        for (std::set<int>::const_iterator t = timesteps.begin(); t != timesteps.end(); ++t)
+        {
+            boost::shared_ptr<const TraxelStore> frame = store_->frame(*t);
+            for (TraxelStore::const_iterator it = frame->begin(); it != frame->end(); ++it)
+            {
+                Traxel traxel(*it);
+                traxel.set_feature_store(resident_fs_);
+                FeatureMap& resident = resident_fs_->get_traxel_features(traxel);
+                for (std::vector<std::string>::const_iterator name = resident_features_.begin();
+                        name != resident_features_.end(); ++name)
+                {
+                    FeatureMap::const_iterator feature = it->features.find(*name);
+                    if (feature != it->features.end())
+                    {
+                        resident[*name] = feature->second;
+                    }
+                }
+                HypothesesGraph::Node node = graph->add_node(traxel.Timestep);
+                traxel_m.set(node, traxel);
+            }
+        }
+        return graph;
+    }
+
     for(TraxelStoreByTimestep::const_iterator it = ts_->begin(); it != ts_->end(); ++it)
     {
         HypothesesGraph::Node node = graph->add_node(it->Timestep);
@@ -1796,8 +2013,6 @@ HypothesesGraph* SingleTimestepTraxel_HypothesesBuilder::add_edges_at(Hypotheses
                 node_timestep());
     typedef property_map<node_traxel, HypothesesGraph::base_graph>::type traxelmap_t;
     const traxelmap_t& traxelmap = graph->get(node_traxel());
-    const TraxelStoreByTimeid& traxels_by_timeid = ts_->get<by_timeid>();
-    const TraxelStoreByTimestep& traxels_by_timestep = ts_->get<by_timestep>();
 
     int to_timestep = timestep + 1;
     if (reverse)
@@ -1806,6 +2021,24 @@ HypothesesGraph* SingleTimestepTraxel_HypothesesBuilder::add_edges_at(Hypotheses
         to_timestep = timestep - 1;
     }
 
+    // out-of-core stores only provide the frame searched in, which is empty
+    // for gaps between timesteps
+    boost::shared_ptr<const TraxelStore> frame;
+    if (store_)
+    {
+        if (store_->timesteps().count(to_timestep))
+        {
+            frame = store_->frame(to_timestep);
+        }
+        else
+        {
+            frame.reset(new TraxelStore);
+        }
+    }
+    const TraxelStore& traxels = store_ ? *frame : *ts_;
+    const TraxelStoreByTimeid& traxels_by_timeid = traxels.get<by_timeid>();
+    const TraxelStoreByTimestep& traxels_by_timestep = traxels.get<by_timestep>();
+
     //// find k nearest neighbors in next timestep
     // init nearest neighbor search
     std::pair<TraxelStoreByTimestep::const_iterator,
@@ -1884,6 +2117,134 @@ HypothesesGraph* SingleTimestepTraxel_HypothesesBuilder::add_edges_at(Hypotheses
     return graph;
 }
 
+////
+//// class IncrementalHypothesesBuilder
+////
+namespace
+{
+// connect each of from_nodes with its nearest neighbors among the traxels of
+// nns, as SingleTimestepTraxel_HypothesesBuilder::add_edges_at() does
+void add_nearest_neighbor_arcs(HypothesesGraph& graph,
+                               const std::vector<HypothesesGraph::Node>& from_nodes,
+                               NearestNeighborSearch& nns,
+                               const std::map<unsigned int, HypothesesGraph::Node>& to_node_by_id,
+                               const SingleTimestepTraxel_HypothesesBuilder::Options& options,
+                               bool reverse)
+{
+    typedef property_map<node_traxel, HypothesesGraph::base_graph>::type traxelmap_t;
+    const traxelmap_t& traxelmap = graph.get(node_traxel());
+
+    for (std::vector<HypothesesGraph::Node>::const_iterator curr_node = from_nodes.begin();
+            curr_node != from_nodes.end(); ++curr_node)
+    {
+        unsigned int max_nn = options.max_nearest_neighbors;
+        if (options.consider_divisions && !reverse && max_nn < 2)
+        {
+            double div_prob = getDivisionProbability(traxelmap[*curr_node]);
+            if (div_prob > options.division_threshold)
+            {
+                max_nn = 2;
+            }
+        }
+
+        std::map<unsigned int, double> nearest_neighbors = nns.knn_in_range(
+                    traxelmap[*curr_node], options.distance_threshold,
+                    max_nn, reverse);
+
+        for (std::map<unsigned int, double>::const_iterator neighbor =
+                    nearest_neighbors.begin(); neighbor != nearest_neighbors.end();
+                ++neighbor)
+        {
+            std::map<unsigned int, HypothesesGraph::Node>::const_iterator neighbor_node =
+                to_node_by_id.find(neighbor->first);
+            assert(neighbor_node != to_node_by_id.end());
+            if (!reverse)
+            {
+                graph.addArc(*curr_node, neighbor_node->second);
+            }
+            else if (lemon::findArc(graph, neighbor_node->second, *curr_node) == lemon::INVALID)
+            {
+                graph.addArc(neighbor_node->second, *curr_node);
+            }
+        }
+    }
+}
+}
+
+IncrementalHypothesesBuilder::IncrementalHypothesesBuilder(const Options& o)
+    : graph_(new HypothesesGraph()),
+      options_(o),
+      has_previous_(false),
+      previous_timestep_(0)
+{
+    graph_->add(node_traxel());
+}
+
+IncrementalHypothesesBuilder::~IncrementalHypothesesBuilder()
+{
+}
+
+void IncrementalHypothesesBuilder::add_timestep(const std::vector<Traxel>& traxels)
+{
+    if (traxels.empty())
+    {
+        return;
+    }
+    const int timestep = traxels.front().Timestep;
+    for (std::vector<Traxel>::const_iterator it = traxels.begin(); it != traxels.end(); ++it)
+    {
+        if (it->Timestep != timestep)
+        {
+            throw std::runtime_error("IncrementalHypothesesBuilder::add_timestep(): traxels of different timesteps");
+        }
+    }
+    if (has_previous_ && timestep <= previous_timestep_)
+    {
+        throw std::runtime_error("IncrementalHypothesesBuilder::add_timestep(): timesteps have to be added in increasing order");
+    }
+    LOG(logDEBUG) << "IncrementalHypothesesBuilder::add_timestep(): adding " << traxels.size()
+                  << " traxels at timestep " << timestep;
+
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_m = graph_->get(node_traxel());
+    std::vector<HypothesesGraph::Node> nodes;
+    nodes.reserve(traxels.size());
+    NodeById node_by_id;
+    for (std::vector<Traxel>::const_iterator it = traxels.begin(); it != traxels.end(); ++it)
+    {
+        HypothesesGraph::Node node = graph_->add_node(timestep);
+        traxel_m.set(node, *it);
+        nodes.push_back(node);
+        node_by_id[it->Id] = node;
+    }
+
+    if (has_previous_ && timestep == previous_timestep_ + 1)
+    {
+        // forward: previous frame -> nearest neighbors in this frame
+        NearestNeighborSearch nns(traxels.begin(), traxels.end());
+        add_nearest_neighbor_arcs(*graph_, previous_nodes_, nns, node_by_id, options_, false);
+        // backward: this frame -> nearest neighbors in the previous frame
+        if (options_.forward_backward)
+        {
+            add_nearest_neighbor_arcs(*graph_, nodes, *previous_reverse_nns_, previous_node_by_id_, options_, true);
+        }
+    }
+
+    // this frame is the previous frame of the next call
+    has_previous_ = true;
+    previous_timestep_ = timestep;
+    previous_nodes_.swap(nodes);
+    previous_node_by_id_.swap(node_by_id);
+    if (options_.forward_backward)
+    {
+        previous_reverse_nns_.reset(new NearestNeighborSearch(traxels.begin(), traxels.end(), true));
+    }
+}
+
+boost::shared_ptr<HypothesesGraph> IncrementalHypothesesBuilder::get_graph() const
+{
+    return graph_;
+}
+
 // graph copy methods
 template<class Graph>
 void PropertyGraph<Graph>::copy(PropertyGraph<Graph>& src, PropertyGraph<Graph>& dest)
@@ -2320,12 +2681,13 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
         throw std::runtime_error("graph has no node traxel map ");
     }
 
-    if(with_tracklets && !has_property(node_tracklet()))
+    if(with_tracklets && !tracklet_view_ && !has_property(node_tracklet()))
     {
         throw std::runtime_error("graph has no node tracklet map even though with_tracklets=true");
     }
 
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = get(node_traxel());
+    const TrackletView* tracklet_view = with_tracklets ? &tracklets() : NULL;
 
     out_file << "digraph G {\n";
 
@@ -2334,10 +2696,9 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
     {
         if(with_tracklets)
         {
-            property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
             // add all detection factors of the internal nodes
-            Traxel a = tracklet_map[n].front();
-            Traxel b = tracklet_map[n].back();
+            Traxel a = tracklet_view->front(n);
+            Traxel b = tracklet_view->back(n);
 
             out_file << "\t" << id(n) << " [ label=\"timesteps : " << a.Timestep << " - " << b.Timestep << "\\nid : " << a.Id << std::flush;
         }
@@ -2352,19 +2713,18 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
             double energy = 0.0;
             if (with_tracklets)
             {
-                property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
                 // add all detection factors of the internal nodes
-                for (std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin(); trax_it != tracklet_map[n].end(); ++trax_it)
+                for (size_t i = 0; i < tracklet_view->size(n); ++i)
                 {
-                    energy += detection(*trax_it, state);
+                    energy += detection(tracklet_view->traxel(n, i), state);
                 }
 
                 // add all transition factors of the internal arcs
                 Traxel tr_prev;
                 bool first = true;
-                for (std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin(); trax_it != tracklet_map[n].end(); ++trax_it)
+                for (size_t i = 0; i < tracklet_view->size(n); ++i)
                 {
-                    Traxel tr = *trax_it;
+                    const Traxel& tr = tracklet_view->traxel(n, i);
                     if (!first)
                     {
                         // FIXME: hard coded choice here
@@ -2398,9 +2758,8 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
         int node_end_time = -1;
         if (with_tracklets)
         {
-            property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
-            node_begin_time = tracklet_map[n].front().Timestep;
-            node_end_time = tracklet_map[n].back().Timestep;
+            node_begin_time = tracklet_view->front(n).Timestep;
+            node_end_time = tracklet_view->back(n).Timestep;
         }
         else
         {
@@ -2412,8 +2771,7 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
         Traxel tr;
         if(with_tracklets)
         {
-            property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
-            tr = tracklet_map[n].front();
+            tr = tracklet_view->front(n);
         }
         else
         {
@@ -2425,8 +2783,7 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
 
         if(with_tracklets)
         {
-            property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
-            tr = tracklet_map[n].back();
+            tr = tracklet_view->back(n);
         }
         double dis_score = disappearance_cost(tr);
         out_file << "\\ndis : " << dis_score << std::flush;
@@ -2446,8 +2803,7 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
                 Traxel tr;
                 if (with_tracklets)
                 {
-                    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
-                    tr = tracklet_map[n].back();
+                    tr = tracklet_view->back(n);
                 }
                 else
                 {
@@ -2467,9 +2823,8 @@ void HypothesesGraph::save_to_graphviz_dot_file(const std::string &filename,
         Traxel tr1, tr2;
         if (with_tracklets)
         {
-            property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = get(node_tracklet());
-            tr1 = tracklet_map[source(a)].back();
-            tr2 = tracklet_map[target(a)].front();
+            tr1 = tracklet_view->back(source(a));
+            tr2 = tracklet_view->front(target(a));
         }
         else
         {
@@ -2498,14 +2853,14 @@ size_t HypothesesGraph::get_node_active(HypothesesGraph::Node n, int iteration)
     {
         property_map<node_active_count, HypothesesGraph::base_graph>::type& node_active_count_map = this->get(node_active_count());
         size_t val = false;
-        assert(node_active_count_map[n].size() > 0);
+        assert(node_active_count_map.size(n) > 0);
         if(iteration >= 0)
         {
-            assert(node_active_count_map[n].size() > iteration);
-            val = node_active_count_map[n][iteration];
+            assert(node_active_count_map.size(n) > iteration);
+            val = node_active_count_map.get(n, iteration);
         }
         else
-            val = node_active_count_map[n].back();
+            val = node_active_count_map.get(n, node_active_count_map.size(n) - 1);
         assert(node_active_map[n] == val);
         return val;
     }
@@ -2520,14 +2875,14 @@ bool HypothesesGraph::get_division_active(HypothesesGraph::Node n, int iteration
     {
         property_map<division_active_count, HypothesesGraph::base_graph>::type& division_active_count_map = this->get(division_active_count());
         bool val = false;
-        assert(division_active_count_map[n].size() > 0);
+        assert(division_active_count_map.size(n) > 0);
         if(iteration >= 0)
         {
-            assert(division_active_count_map[n].size() > iteration);
-            val = division_active_count_map[n][iteration];
+            assert(division_active_count_map.size(n) > iteration);
+            val = division_active_count_map.get(n, iteration);
         }
         else
-            val = division_active_count_map[n].back();
+            val = division_active_count_map.get(n, division_active_count_map.size(n) - 1);
         assert(division_active_map[n] == val);
         return val;
     }
@@ -2542,14 +2897,14 @@ bool HypothesesGraph::get_arc_active(HypothesesGraph::Arc a, int iteration) cons
     {
         property_map<arc_active_count, HypothesesGraph::base_graph>::type& arc_active_count_map = this->get(arc_active_count());
         bool val = false;
-        assert(arc_active_count_map[a].size() > 0);
+        assert(arc_active_count_map.size(a) > 0);
         if(iteration >= 0)
         {
-            assert(arc_active_count_map[a].size() > iteration);
-            val = arc_active_count_map[a][iteration];
+            assert(arc_active_count_map.size(a) > iteration);
+            val = arc_active_count_map.get(a, iteration);
         }
         else
-            val = arc_active_count_map[a].back();
+            val = arc_active_count_map.get(a, arc_active_count_map.size(a) - 1);
         assert(arc_active_map[a] == val);
         return val;
     }
@@ -2566,7 +2921,7 @@ void HypothesesGraph::set_node_active(HypothesesGraph::Node n, size_t newState,
     {
         property_map<node_active_count, HypothesesGraph::base_graph>::type& node_active_count_map = this->get(node_active_count());
         
-        assert(node_active_count_map[n].size() > 0);
+        assert(node_active_count_map.size(n) > 0);
         if(iteration >= 0)
         {
             node_active_count_map.get_value(n)[iteration] = newState;
@@ -2585,7 +2940,7 @@ void HypothesesGraph::set_division_active(HypothesesGraph::Node n, bool newState
     {
         property_map<division_active_count, HypothesesGraph::base_graph>::type& division_active_count_map = this->get(division_active_count());
         
-        assert(division_active_count_map[n].size() > 0);
+        assert(division_active_count_map.size(n) > 0);
         if(iteration >= 0)
         {
             division_active_count_map.get_value(n)[iteration] = newState;
@@ -2604,7 +2959,7 @@ void HypothesesGraph::set_arc_active(HypothesesGraph::Arc a, bool newState, int
     {
         property_map<arc_active_count, HypothesesGraph::base_graph>::type& arc_active_count_map = this->get(arc_active_count());
         
-        assert(arc_active_count_map[a].size() > 0);
+        assert(arc_active_count_map.size(a) > 0);
         if(iteration >= 0)
         {
             arc_active_count_map.get_value(a)[iteration] = newState;
@@ -1,4 +1,5 @@
 #include "pgmlink/inferencemodel/constrackinginferencemodel.h"
+#include "pgmlink/instrumentation.h"
 #include <boost/python.hpp>
 #include <iso646.h> // for not, and, or on MSVC
 
@@ -13,8 +14,11 @@ ConsTrackingInferenceModel::ConsTrackingInferenceModel(Parameter& param):
     number_of_division_nodes_(0),
     number_of_appearance_nodes_(0),
     number_of_disappearance_nodes_(0),
+    first_transition_factor_(0),
+    first_division_factor_(0),
     ground_truth_filename_(""),
-    weights_(5)
+    weights_(5),
+    lazy_constraints_(false)
 {
     cplex_param_.verbose_ = true;
     cplex_param_.integerConstraint_ = true;
@@ -26,6 +30,7 @@ ConsTrackingInferenceModel::ConsTrackingInferenceModel(Parameter& param):
 void ConsTrackingInferenceModel::build_from_graph(const HypothesesGraph& hypotheses)
 {
     LOG(logDEBUG) << "ConsTrackingInferenceModel::formulate: entered";
+    frozen_graph_.reset();
 
     LOG(logDEBUG) << "ConsTrackingInferenceModel::formulate: add_transition_nodes";
     add_transition_nodes(hypotheses);
@@ -45,8 +50,28 @@ void ConsTrackingInferenceModel::build_from_graph(const HypothesesGraph& hypothe
     LOG(logINFO) << "number_of_disappearance_nodes_ = " << number_of_disappearance_nodes_;
     LOG(logINFO) << "number_of_division_nodes_ = " << number_of_division_nodes_;
 
-    add_finite_factors(hypotheses);
-    add_constraints_to_pool(hypotheses);
+    {
+        StageTimer stage_timer("add_finite_factors");
+        add_finite_factors(hypotheses);
+    }
+    instrument_count("build_inference_model", "variables", model_.numberOfVariables());
+    instrument_count("build_inference_model", "factors", model_.numberOfFactors());
+
+    {
+        StageTimer stage_timer("add_constraints_to_pool");
+        add_constraints_to_pool(hypotheses);
+        instrument_count("add_constraints_to_pool", "constraints", constraint_pool_.get_num_constraints());
+    }
+    frozen_graph_.reset();
+}
+
+const FrozenHypothesesGraph& ConsTrackingInferenceModel::get_frozen_graph(const HypothesesGraph& g)
+{
+    if (!frozen_graph_ || &frozen_graph_->graph() != &g)
+    {
+        frozen_graph_.reset(new FrozenHypothesesGraph(g));
+    }
+    return *frozen_graph_;
 }
 
 void ConsTrackingInferenceModel::fixFirstDisappearanceNodesToLabels(
@@ -181,7 +206,7 @@ ConsTrackingInferenceModel::HypothesesGraphArcMap &ConsTrackingInferenceModel::g
     return arc_map_;
 }
 
-std::map<HypothesesGraph::Node, size_t>& ConsTrackingInferenceModel::get_detection_factor_node_map()
+ConsTrackingInferenceModel::HypothesesGraphNodeMap& ConsTrackingInferenceModel::get_detection_factor_node_map()
 {
     return detection_f_node_map_;
 }
@@ -189,10 +214,11 @@ std::map<HypothesesGraph::Node, size_t>& ConsTrackingInferenceModel::get_detecti
 void ConsTrackingInferenceModel::add_appearance_nodes(const HypothesesGraph& g)
 {
     size_t count = 0;
+    app_node_map_.reserve(g.maxNodeId() + 1);
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
     {
         model_.addVariable(param_.max_number_objects + 1);
-        app_node_map_[n] = model_.numberOfVariables() - 1;
+        app_node_map_.insert(n, model_.numberOfVariables() - 1);
 
         HypothesesGraph::node_timestep_map& timestep_map = g.get(node_timestep());
         nodes_per_timestep_[timestep_map[n]].push_back(model_.numberOfVariables() - 1);
@@ -208,10 +234,11 @@ void ConsTrackingInferenceModel::add_appearance_nodes(const HypothesesGraph& g)
 void ConsTrackingInferenceModel::add_disappearance_nodes(const HypothesesGraph& g)
 {
     size_t count = 0;
+    dis_node_map_.reserve(g.maxNodeId() + 1);
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
     {
         model_.addVariable(param_.max_number_objects + 1);
-        dis_node_map_[n] = model_.numberOfVariables() - 1;
+        dis_node_map_.insert(n, model_.numberOfVariables() - 1);
 
         HypothesesGraph::node_timestep_map& timestep_map = g.get(node_timestep());
         nodes_per_timestep_[timestep_map[n]].push_back(model_.numberOfVariables() - 1);
@@ -227,10 +254,11 @@ void ConsTrackingInferenceModel::add_disappearance_nodes(const HypothesesGraph&
 void ConsTrackingInferenceModel::add_transition_nodes(const HypothesesGraph& g)
 {
     size_t count = 0;
+    arc_map_.reserve(g.maxArcId() + 1);
     for (HypothesesGraph::ArcIt a(g); a != lemon::INVALID; ++a)
     {
         model_.addVariable(param_.max_number_objects + 1);
-        arc_map_[a] = model_.numberOfVariables() - 1;
+        arc_map_.insert(a, model_.numberOfVariables() - 1);
         // store these nodes by the timestep of the base-appearance node,
         // as well as in the timestep of the disappearance node they enter
         HypothesesGraph::node_timestep_map& timestep_map = g.get(node_timestep());
@@ -250,20 +278,16 @@ void ConsTrackingInferenceModel::add_transition_nodes(const HypothesesGraph& g)
 
 void ConsTrackingInferenceModel::add_division_nodes(const HypothesesGraph& g)
 {
+    const FrozenHypothesesGraph& frozen = get_frozen_graph(g);
     size_t count = 0;
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
     {
-        size_t number_of_outarcs = 0;
-        for (HypothesesGraph::OutArcIt a(g, n); a != lemon::INVALID; ++a)
-        {
-            ++number_of_outarcs;
-        }
-        if (number_of_outarcs > 1)
+        const size_t i = frozen.index(n);
+        if (frozen.out_degree(i) > 1)
         {
             model_.addVariable(2);
-            div_node_map_[n] = model_.numberOfVariables() - 1;
-            HypothesesGraph::node_timestep_map& timestep_map = g.get(node_timestep());
-            nodes_per_timestep_[timestep_map[n]].push_back(model_.numberOfVariables() - 1);
+            div_node_map_.insert(n, model_.numberOfVariables() - 1);
+            nodes_per_timestep_[frozen.timestep(i)].push_back(model_.numberOfVariables() - 1);
 
             assert(model_.numberOfLabels(div_node_map_[n]) == 2);
 
@@ -303,12 +327,10 @@ void ConsTrackingInferenceModel::printResults(const HypothesesGraph& g)
     for (HypothesesGraph::ArcIt a(g); a != lemon::INVALID; ++a)
     {
         c = 0;
-        for( std::vector<bool>::const_iterator i = active_arcs_count[a].begin();
-                i != active_arcs_count[a].end();
-                ++i)
+        for( size_t i = 0; i < active_arcs_count.size(a); ++i)
         {
-            LOG(logDEBUG4) << *i;
-            if (*i)
+            LOG(logDEBUG4) << active_arcs_count.get(a, i);
+            if (active_arcs_count.get(a, i))
             {
                 c++;
             }
@@ -316,16 +338,14 @@ void ConsTrackingInferenceModel::printResults(const HypothesesGraph& g)
         LOG(logDEBUG4) << "total= " << c;
     }
 
-    for(std::map<HypothesesGraph::Node, size_t>::const_iterator it = app_node_map_.begin();
+    for(HypothesesGraphNodeMap::const_iterator it = app_node_map_.begin();
             it != app_node_map_.end(); ++it)
     {
         c = 0;
-        for( std::vector<size_t>::const_iterator i = active_nodes_count[it->first].begin();
-                i != active_nodes_count[it->first].end();
-                ++i)
+        for( size_t i = 0; i < active_nodes_count.size(it->first); ++i)
         {
-            LOG(logINFO) << *i;
-            if (*i)
+            LOG(logINFO) << active_nodes_count.get(it->first, i);
+            if (active_nodes_count.get(it->first, i))
             {
                 c++;
             }
@@ -333,16 +353,14 @@ void ConsTrackingInferenceModel::printResults(const HypothesesGraph& g)
         LOG(logINFO) << "total= " << c << std::endl;
     }
     LOG(logDEBUG4) << "division nodes " << c << std::endl;
-    for(std::map<HypothesesGraph::Node, size_t>::const_iterator it = app_node_map_.begin();
+    for(HypothesesGraphNodeMap::const_iterator it = app_node_map_.begin();
             it != app_node_map_.end(); ++it)
     {
         c = 0;
-        for( std::vector<bool>::const_iterator i = active_divisions_count[it->first].begin();
-                i != active_divisions_count[it->first].end();
-                ++i)
+        for( size_t i = 0; i < active_divisions_count.size(it->first); ++i)
         {
-            LOG(logDEBUG4) << *i << " ";
-            if (*i)
+            LOG(logDEBUG4) << active_divisions_count.get(it->first, i) << " ";
+            if (active_divisions_count.get(it->first, i))
             {
                 c++;
             }
@@ -373,8 +391,6 @@ size_t ConsTrackingInferenceModel::add_detection_factors(const HypothesesGraph&
     //// add detection factors
     ////
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map_ = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map_ =
-        g.get(node_tracklet());
 
     LOG(logDEBUG) << "ConsTrackingInferenceModel::add_finite_factors: add detection factors";
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
@@ -387,8 +403,8 @@ size_t ConsTrackingInferenceModel::add_detection_factors(const HypothesesGraph&
         int node_end_time = -1;
         if (param_.with_tracklets)
         {
-            node_begin_time = tracklet_map_[n].front().Timestep;
-            node_end_time = tracklet_map_[n].back().Timestep;
+            node_begin_time = g.tracklets().front(n).Timestep;
+            node_end_time = g.tracklets().back(n).Timestep;
         }
         else
         {
@@ -411,7 +427,7 @@ size_t ConsTrackingInferenceModel::add_detection_factors(const HypothesesGraph&
             {
                 if (param_.with_tracklets)
                 {
-                    energy = param_.appearance_cost_fn(tracklet_map_[n].front());
+                    energy = param_.appearance_cost_fn(g.tracklets().front(n));
                 }
                 else
                 {
@@ -432,7 +448,7 @@ size_t ConsTrackingInferenceModel::add_detection_factors(const HypothesesGraph&
             {
                 if (param_.with_tracklets)
                 {
-                    energy = param_.disappearance_cost_fn(tracklet_map_[n].back());
+                    energy = param_.disappearance_cost_fn(g.tracklets().back(n));
                 }
                 else
                 {
@@ -458,23 +474,22 @@ size_t ConsTrackingInferenceModel::add_detection_factors(const HypothesesGraph&
             if (param_.with_tracklets)
             {
                 energy = 0;
+                const TrackletView& tracklets = g.tracklets();
                 // add all detection factors of the internal nodes
-                for (std::vector<Traxel>::const_iterator trax_it = tracklet_map_[n].begin();
-                        trax_it != tracklet_map_[n].end(); ++trax_it)
+                for (size_t i = 0; i < tracklets.size(n); ++i)
                 {
-                    e = param_.detection(*trax_it, state);
+                    e = param_.detection(tracklets.traxel(n, i), state);
                     energy += e;
 
-                    energy += generateRandomOffset(Detection, e, *trax_it, 0, state);
+                    energy += generateRandomOffset(Detection, e, tracklets.traxel(n, i), 0, state);
                 }
                 // add all transition factors of the internal arcs
                 Traxel tr_prev;
                 bool first = true;
-                for (std::vector<Traxel>::const_iterator trax_it = tracklet_map_[n].begin();
-                        trax_it != tracklet_map_[n].end(); ++trax_it)
+                for (size_t i = 0; i < tracklets.size(n); ++i)
                 {
-                    LOG(logDEBUG4) << "internal arcs traxel " << *trax_it;
-                    Traxel tr = *trax_it;
+                    LOG(logDEBUG4) << "internal arcs traxel " << tracklets.traxel(n, i);
+                    Traxel tr = tracklets.traxel(n, i);
                     if (!first)
                     {
                         e = param_.transition( get_transition_probability(tr_prev, tr, state) );
@@ -537,7 +552,7 @@ size_t ConsTrackingInferenceModel::add_detection_factors(const HypothesesGraph&
         // and the matrix is constructed such that appearances are along coords[0], ...
         sort(vi.begin(), vi.end());
         model_.addFactor(funcId, vi.begin(), vi.end());
-        detection_f_node_map_[n] = model_.numberOfFactors() - 1;
+        detection_f_node_map_.insert(n, model_.numberOfFactors() - 1);
     }
 
     return factorIndex;
@@ -549,8 +564,6 @@ size_t ConsTrackingInferenceModel::add_transition_factors(const HypothesesGraph&
     //// add transition factors
     ////
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map_ = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map_ =
-        g.get(node_tracklet());
 
     LOG(logDEBUG) << "ConsTrackingInferenceModel::add_finite_factors: add transition factors";
 
@@ -567,8 +580,8 @@ size_t ConsTrackingInferenceModel::add_transition_factors(const HypothesesGraph&
             Traxel tr1, tr2;
             if (param_.with_tracklets)
             {
-                tr1 = tracklet_map_[g.source(a)].back();
-                tr2 = tracklet_map_[g.target(a)].front();
+                tr1 = g.tracklets().back(g.source(a));
+                tr2 = g.tracklets().front(g.target(a));
             }
             else
             {
@@ -606,8 +619,6 @@ size_t ConsTrackingInferenceModel::add_division_factors(const HypothesesGraph& g
     //// add division factors
     ////
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map_ = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map_ =
-        g.get(node_tracklet());
 
     LOG(logDEBUG) << "ConsTrackingInferenceModel::add_finite_factors: add division factors";
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
@@ -627,7 +638,7 @@ size_t ConsTrackingInferenceModel::add_division_factors(const HypothesesGraph& g
             Traxel tr;
             if (param_.with_tracklets)
             {
-                tr = tracklet_map_[n].back();
+                tr = g.tracklets().back(n);
             }
             else
             {
@@ -668,7 +679,9 @@ void ConsTrackingInferenceModel::add_finite_factors(const HypothesesGraph& g)
     LOG(logDEBUG) << "ConsTrackingInferenceModel::add_finite_factors: entered";
     size_t factorIndex = 0;
     factorIndex = add_detection_factors(g, factorIndex);
+    first_transition_factor_ = model_.numberOfFactors();
     factorIndex = add_transition_factors(g, factorIndex);
+    first_division_factor_ = model_.numberOfFactors();
     factorIndex = add_division_factors(g, factorIndex);
     LOG(logDEBUG) << "ConsTrackingInferenceModel::add_finite_factors: finished";
 }
@@ -683,16 +696,18 @@ void ConsTrackingInferenceModel::add_constraints_to_pool(const HypothesesGraph&
                                            param_.with_disappearance,
                                            param_.with_misdetections_allowed);
 
+    const FrozenHypothesesGraph& frozen = get_frozen_graph(g);
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
     {
+        const size_t i = frozen.index(n);
         ////
         //// outgoing transitions
         ////
         {
             std::vector<size_t> transition_nodes;
-            for (HypothesesGraph::OutArcIt a(g, n); a != lemon::INVALID; ++a)
+            for (size_t a = frozen.out_begin(i); a < frozen.out_end(i); ++a)
             {
-                transition_nodes.push_back(arc_map_[a]);
+                transition_nodes.push_back(arc_map_[frozen.arc(a)]);
             }
 
             int division_node = -1;
@@ -711,9 +726,9 @@ void ConsTrackingInferenceModel::add_constraints_to_pool(const HypothesesGraph&
         ////
         {
             std::vector<size_t> transition_nodes;
-            for (HypothesesGraph::InArcIt a(g, n); a != lemon::INVALID; ++a)
+            for (size_t k = frozen.in_begin(i); k < frozen.in_end(i); ++k)
             {
-                transition_nodes.push_back(arc_map_[a]);
+                transition_nodes.push_back(arc_map_[frozen.arc(frozen.in_arc(k))]);
             }
             size_t disappearance_node = dis_node_map_[n];
 
@@ -759,7 +774,20 @@ void ConsTrackingInferenceModel::set_inference_params(size_t numberOfSolutions,
     optimizer_ = boost::shared_ptr<cplex_optimizer>(new cplex_optimizer(get_model(), cplex_param_));
 #endif
 
-    if(param_.with_constraints)
+    // only the best solution is guaranteed to be feasible with lazily added constraints
+    lazy_constraints_ = param_.lazy_constraints && numberOfSolutions == 1;
+    if(param_.lazy_constraints && !lazy_constraints_)
+    {
+        LOG(logWARNING) << "[ConsTrackingInferenceModel] lazy constraints are not supported for "
+                        << numberOfSolutions << " solutions, adding all constraints";
+    }
+
+    if(param_.with_constraints && lazy_constraints_)
+    {
+        LOG(logINFO) << "[ConsTrackingInferenceModel] add_core_constraints";
+        constraint_pool_.add_core_constraints_to_problem(model_, *optimizer_);
+    }
+    else if(param_.with_constraints)
     {
         LOG(logINFO) << "[ConsTrackingInferenceModel] add_constraints ";
         add_constraints(*optimizer_);
@@ -774,19 +802,46 @@ void ConsTrackingInferenceModel::set_inference_params(size_t numberOfSolutions,
 
 ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::infer()
 {
-    opengm::InferenceTermination status = optimizer_->infer();
-    if (status != opengm::NORMAL)
+    IlpSolution solution;
+    size_t num_rounds = 0;
+    size_t num_added_constraints = 0;
+    while(true)
     {
-        throw std::runtime_error("GraphicalModel::infer(): optimizer terminated abnormally");
+        opengm::InferenceTermination status = optimizer_->infer();
+        if (status != opengm::NORMAL)
+        {
+            throw std::runtime_error("GraphicalModel::infer(): optimizer terminated abnormally");
+        }
+
+        opengm::InferenceTermination statusExtract = optimizer_->arg(solution);
+        if (statusExtract != opengm::NORMAL)
+        {
+            throw std::runtime_error("GraphicalModel::infer(): solution extraction terminated abnormally");
+        }
+        ++num_rounds;
+
+        if(!lazy_constraints_)
+        {
+            break;
+        }
+
+        // LPCplex extracts the model anew in every infer() call, so added constraints
+        // take effect in the next round
+        size_t num_violated = constraint_pool_.add_violated_constraints_to_problem(model_, *optimizer_, solution);
+        LOG(logINFO) << "[ConsTrackingInferenceModel] lazy constraints, round " << num_rounds
+                     << ": added " << num_violated << " violated constraints";
+        if(num_violated == 0)
+        {
+            break;
+        }
+        num_added_constraints += num_violated;
     }
 
-    IlpSolution solution;
-    opengm::InferenceTermination statusExtract = optimizer_->arg(solution);
-    if (statusExtract != opengm::NORMAL)
+    if(lazy_constraints_)
     {
-        throw std::runtime_error("GraphicalModel::infer(): solution extraction terminated abnormally");
+        instrument_count("solve", "lazy_rounds", num_rounds);
+        instrument_count("solve", "lazy_constraints", num_added_constraints);
     }
-
     return solution;
 }
 
@@ -817,7 +872,6 @@ void ConsTrackingInferenceModel::write_labeledgraph_to_file(const HypothesesGrap
     // if(with_tracklets_)
     // {
     // property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& traxel_arc_id_map = tracklet_graph_.get(traxel_arc_id());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = g.get(node_tracklet());
     // }
 
 
@@ -879,10 +933,10 @@ void ConsTrackingInferenceModel::write_labeledgraph_to_file(const HypothesesGrap
             cplexid_label_map[id] = ((g.get(arc_label())[a] == state) ? 1 : 0);
             LOG(logDEBUG4) << "arc\t" << cplexid_label_map[id] << "  " << id << "  " <<  get_arc_map()[a] << "  " << state;
             cplexid_weight_class_map[id].clear();
-            if (param_.with_tracklets and (tracklet_map[g.source(a)]).size() > 1)
+            if (param_.with_tracklets and g.tracklets().size(g.source(a)) > 1)
             {
-                cplexid_weight_class_map[id].push_back(std::make_pair(3, (tracklet_map[g.source(a)]).size() - 1));
-                cplexid_weight_class_map[id].push_back(std::make_pair(4, (tracklet_map[g.source(a)]).size()));
+                cplexid_weight_class_map[id].push_back(std::make_pair(3, g.tracklets().size(g.source(a)) - 1));
+                cplexid_weight_class_map[id].push_back(std::make_pair(4, g.tracklets().size(g.source(a))));
             }
             else
             {
@@ -892,7 +946,7 @@ void ConsTrackingInferenceModel::write_labeledgraph_to_file(const HypothesesGrap
     }
 
     // fill labels of Factors (only second order factors need to be exported (others accounted for in variable states))
-    std::map<HypothesesGraph::Node, size_t>& detection_f_node_map = get_detection_factor_node_map();
+    HypothesesGraphNodeMap& detection_f_node_map = get_detection_factor_node_map();
 
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
     {
@@ -906,10 +960,10 @@ void ConsTrackingInferenceModel::write_labeledgraph_to_file(const HypothesesGrap
                 LOG(logDEBUG4) << "detection\t" << cplexid_label_map[id] << "  " << id << "  "
                                <<  detection_f_node_map[n] << "  " << s1 << "  " << s2 << endl;
                 cplexid_weight_class_map[id].clear();
-                if (param_.with_tracklets and (tracklet_map[n]).size() > 1)
+                if (param_.with_tracklets and g.tracklets().size(n) > 1)
                 {
-                    cplexid_weight_class_map[id].push_back(std::make_pair(3, (tracklet_map[n]).size() - 1));
-                    cplexid_weight_class_map[id].push_back(std::make_pair(4, (tracklet_map[n]).size()));
+                    cplexid_weight_class_map[id].push_back(std::make_pair(3, g.tracklets().size(n) - 1));
+                    cplexid_weight_class_map[id].push_back(std::make_pair(4, g.tracklets().size(n)));
                 }
                 else
                 {
@@ -968,14 +1022,12 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
 
     if (!param_.with_tracklets)
     {
-        tracklet_graph.add(tracklet_intern_arc_ids()).add(traxel_arc_id());
+        tracklet_graph.add(traxel_arc_id());
     }
-    property_map<tracklet_intern_arc_ids, HypothesesGraph::base_graph>::type& tracklet_arc_id_map =
-        tracklet_graph.get(tracklet_intern_arc_ids());
     property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& traxel_arc_id_map =
         tracklet_graph.get(traxel_arc_id());
 
-    int iterStep = active_nodes_count[get_appearance_node_map().begin()->first].size();
+    int iterStep = active_nodes_count.size(get_appearance_node_map().begin()->first);
     bool isMAP = (iterStep == 0);
 
     if (isMAP)
@@ -1010,7 +1062,7 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
 
     // write state after inference into 'active'-property maps
     // the node is also active if its appearance node is active
-    for (std::map<HypothesesGraph::Node, size_t>::const_iterator it = get_appearance_node_map().begin();
+    for (HypothesesGraphNodeMap::const_iterator it = get_appearance_node_map().begin();
             it != get_appearance_node_map().end();
             ++it)
     {
@@ -1030,11 +1082,10 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
             }
 
             // set state of tracklet internal arcs
-            std::vector<int> arc_ids = tracklet_arc_id_map[it->first];
-            for (std::vector<int>::const_iterator arc_id_it = arc_ids.begin();
-                    arc_id_it != arc_ids.end(); ++arc_id_it)
+            const TrackletView& tracklets = tracklet_graph.tracklets();
+            for (size_t i = 0; i + 1 < tracklets.size(it->first); ++i)
             {
-                HypothesesGraph::Arc a = g.arcFromId(*arc_id_it);
+                HypothesesGraph::Arc a = g.arcFromId(tracklets.intern_arc_id(it->first, i));
                 assert(active_arcs[a] == false);
                 if (solution[it->second] > 0)
                 {
@@ -1057,7 +1108,7 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
         }
     }
     // the node is also active if its disappearance node is active
-    for (std::map<HypothesesGraph::Node, size_t>::const_iterator it = get_disappearance_node_map().begin();
+    for (HypothesesGraphNodeMap::const_iterator it = get_disappearance_node_map().begin();
             it != get_disappearance_node_map().end(); ++it)
     {
         if (solution[it->second] > 0)
@@ -1083,11 +1134,10 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
                     }
                 }
                 // set state of tracklet internal arcs
-                std::vector<int> arc_ids = tracklet_arc_id_map[it->first];
-                for (std::vector<int>::const_iterator arc_id_it = arc_ids.begin();
-                        arc_id_it != arc_ids.end(); ++arc_id_it)
+                const TrackletView& tracklets = tracklet_graph.tracklets();
+                for (size_t i = 0; i + 1 < tracklets.size(it->first); ++i)
                 {
-                    HypothesesGraph::Arc a = g.arcFromId(*arc_id_it);
+                    HypothesesGraph::Arc a = g.arcFromId(tracklets.intern_arc_id(it->first, i));
                     if (solution[it->second] > 0)
                     {
 
@@ -1119,7 +1169,7 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
         }
     }
 
-    for (std::map<HypothesesGraph::Arc, size_t>::const_iterator it = get_arc_map().begin();
+    for (HypothesesGraphArcMap::const_iterator it = get_arc_map().begin();
             it != get_arc_map().end(); ++it)
     {
         if (solution[it->second] >= 1)
@@ -1141,12 +1191,12 @@ void ConsTrackingInferenceModel::conclude( HypothesesGraph& g,
     // write division node map
     if (param_.with_divisions)
     {
-        for (std::map<HypothesesGraph::Node, size_t>::const_iterator it = get_division_node_map().begin();
+        for (HypothesesGraphNodeMap::const_iterator it = get_division_node_map().begin();
                 it != get_division_node_map().end(); ++it)
         {
             division_nodes.set(it->first, false);
         }
-        for (std::map<HypothesesGraph::Node, size_t>::const_iterator it = get_division_node_map().begin();
+        for (HypothesesGraphNodeMap::const_iterator it = get_division_node_map().begin();
                 it != get_division_node_map().end(); ++it)
         {
 
@@ -1206,7 +1256,7 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
     int latest_timestep = *(timestep_map.endValue());
 
     // extract divisions
-    for(std::map<HypothesesGraph::Node, size_t>::const_iterator it = div_node_map_.begin();
+    for(HypothesesGraphNodeMap::const_iterator it = div_node_map_.begin();
          it != div_node_map_.end(); 
          ++it)
     {
@@ -1216,19 +1266,19 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
         if(param_.with_tracklets)
             node = tracklet2traxel_node_map.at(node).back();
 
-        assert(active_divisions_count[node].size() > solutionIndex);
-        if(active_divisions_count[node][solutionIndex])
-            assert(active_nodes_count[node][solutionIndex]);
+        assert(active_divisions_count.size(node) > solutionIndex);
+        if(active_divisions_count.get(node, solutionIndex))
+            assert(active_nodes_count.get(node, solutionIndex));
 
-        sol[it->second] = active_divisions_count[node][solutionIndex] ? 1 : 0;
+        sol[it->second] = active_divisions_count.get(node, solutionIndex) ? 1 : 0;
     }
 
     std::function<size_t(HypothesesGraph::Node&)> findFlowAlongOutArcs([&](HypothesesGraph::Node& n){
         size_t num_arcs = 0;
         for (HypothesesGraph::OutArcIt oa(g, n); oa != lemon::INVALID; ++oa)
         {
-            assert(active_nodes_count[n][solutionIndex] >= arc_values[oa][solutionIndex]);
-            num_arcs += arc_values[oa][solutionIndex];
+            assert(active_nodes_count.get(n, solutionIndex) >= arc_values.get(oa, solutionIndex));
+            num_arcs += arc_values.get(oa, solutionIndex);
         }
         return num_arcs;
     });
@@ -1237,8 +1287,8 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
         size_t num_arcs = 0;
         for (HypothesesGraph::InArcIt ia(g, n); ia != lemon::INVALID; ++ia)
         {
-            assert(active_nodes_count[n][solutionIndex] >= arc_values[ia][solutionIndex]);
-            num_arcs += arc_values[ia][solutionIndex];
+            assert(active_nodes_count.get(n, solutionIndex) >= arc_values.get(ia, solutionIndex));
+            num_arcs += arc_values.get(ia, solutionIndex);
         }
         return num_arcs;
     });
@@ -1262,7 +1312,7 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
             node_end = tracklet2traxel_node_map.at(n).back();
         }
 
-        size_t node_state = active_nodes_count[node_end][solutionIndex];
+        size_t node_state = active_nodes_count.get(node_end, solutionIndex);
         size_t incoming = findFlowAlongInArcs(node_begin);
         size_t outgoing = findFlowAlongOutArcs(node_end);
         size_t division = 0;
@@ -1287,14 +1337,14 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
     }
 
     // extract transitions
-    for(std::map<HypothesesGraph::Arc, size_t>::const_iterator it = arc_map_.begin();
+    for(HypothesesGraphArcMap::const_iterator it = arc_map_.begin();
          it != arc_map_.end(); 
          ++it)
     {
         HypothesesGraph::Arc arc = it->first;
         
         assert(it->second < sol.size());
-        assert(arc_values[arc].size() > solutionIndex);
+        assert(arc_values.size(arc) > solutionIndex);
         
         if(param_.with_tracklets)
         {
@@ -1316,16 +1366,16 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
             if(!found)
                 throw std::runtime_error("Did not find corresponding arc in non-tracklet hypothesesgraph!");
 
-            assert(active_nodes_count[s][solutionIndex] >= arc_values[arc][solutionIndex]);
-            assert(active_nodes_count[t][solutionIndex] >= arc_values[arc][solutionIndex]);
+            assert(active_nodes_count.get(s, solutionIndex) >= arc_values.get(arc, solutionIndex));
+            assert(active_nodes_count.get(t, solutionIndex) >= arc_values.get(arc, solutionIndex));
         }
         else
         {
             HypothesesGraph::Node s = g.source(arc);
             HypothesesGraph::Node t = g.target(arc);
 
-            if(active_nodes_count[t][solutionIndex] >= arc_values[arc][solutionIndex] && 
-                active_nodes_count[s][solutionIndex] >= arc_values[arc][solutionIndex])
+            if(active_nodes_count.get(t, solutionIndex) >= arc_values.get(arc, solutionIndex) && 
+                active_nodes_count.get(s, solutionIndex) >= arc_values.get(arc, solutionIndex))
             {
                 LOG(logDEBUG4) << "all good";
             }
@@ -1333,14 +1383,14 @@ ConsTrackingInferenceModel::IlpSolution ConsTrackingInferenceModel::extract_solu
             {
                 std::cout << "Problem with arc " << g.id(arc) << " between nodes " << g.id(s) << " and " << g.id(t) << std::endl;
                 std::cout << "\tTimesteps " << timestep_map[s] << " and " << timestep_map[t] << std::endl;
-                std::cout << "\tActive States " << active_nodes_count[s][solutionIndex] << " and " << active_nodes_count[s][solutionIndex] << std::endl;
-                std::cout << "\tArc State " << arc_values[arc][solutionIndex] << std::endl;
+                std::cout << "\tActive States " << active_nodes_count.get(s, solutionIndex) << " and " << active_nodes_count.get(s, solutionIndex) << std::endl;
+                std::cout << "\tArc State " << arc_values.get(arc, solutionIndex) << std::endl;
             }
-            assert(active_nodes_count[t][solutionIndex] >= arc_values[arc][solutionIndex]);
-            assert(active_nodes_count[s][solutionIndex] >= arc_values[arc][solutionIndex]);
+            assert(active_nodes_count.get(t, solutionIndex) >= arc_values.get(arc, solutionIndex));
+            assert(active_nodes_count.get(s, solutionIndex) >= arc_values.get(arc, solutionIndex));
         }
         
-        sol[it->second] = arc_values[arc][solutionIndex];
+        sol[it->second] = arc_values.get(arc, solutionIndex);
     }
 
     return sol;
@@ -1351,6 +1401,38 @@ void ConsTrackingInferenceModel::set_starting_point(const IlpSolution& solution)
     optimizer_->setStartingPoint(solution.begin());
 }
 
+void ConsTrackingInferenceModel::push_away_from_solution(const IlpSolution& solution,
+        const std::vector<double>& weights)
+{
+    typedef pgm::OpengmModelDeprecated::ExplicitFunctionType ExplicitFunctionType;
+
+    // all finite factors own an explicit function, see add_marray_as_explicit_function()
+    std::vector<size_t> labels;
+    for (size_t factor_id = 0; factor_id < model_.numberOfFactors(); ++factor_id)
+    {
+        EnergyType energy_type = Division;
+        if (factor_id < first_transition_factor_)
+        {
+            energy_type = Detection;
+        }
+        else if (factor_id < first_division_factor_)
+        {
+            energy_type = Transition;
+        }
+
+        const GraphicalModelType::FactorType& factor = model_[factor_id];
+        labels.clear();
+        for (GraphicalModelType::FactorType::VariablesIteratorType var = factor.variableIndicesBegin();
+                var != factor.variableIndicesEnd();
+                ++var)
+        {
+            labels.push_back(solution[*var]);
+        }
+        GraphicalModelType::FunctionIdentifier function_id(factor.functionIndex(), factor.functionType());
+        model_.getFunction<ExplicitFunctionType>(function_id)(labels.begin()) += weights[energy_type];
+    }
+}
+
 #endif
 
 } // namespace pgmlink
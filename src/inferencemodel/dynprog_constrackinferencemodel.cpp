@@ -97,7 +97,6 @@ void DynProgConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
 
     HypothesesGraph::node_timestep_map& timestep_map = graph->get(node_timestep());
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = graph->get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = graph->get(node_tracklet());
 
     size_t first_timestep = graph->earliest_timestep();
     size_t last_timestep = graph->latest_timestep();
@@ -115,20 +114,21 @@ void DynProgConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
             double energy = 0.0;
             if (param_.with_tracklets)
             {
+                const TrackletView& tracklets = graph->tracklets();
                 // add all detection factors of the internal nodes
-                for (std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin(); trax_it != tracklet_map[n].end(); ++trax_it)
+                for (size_t i = 0; i < tracklets.size(n); ++i)
                 {
-                    double e = param_.detection(*trax_it, state);
-                    energy += e + generateRandomOffset(Detection, e, *trax_it, 0, state);
+                    double e = param_.detection(tracklets.traxel(n, i), state);
+                    energy += e + generateRandomOffset(Detection, e, tracklets.traxel(n, i), 0, state);
                 }
 
                 // add all transition factors of the internal arcs
                 Traxel tr_prev;
                 bool first = true;
-                for (std::vector<Traxel>::const_iterator trax_it = tracklet_map[n].begin(); trax_it != tracklet_map[n].end(); ++trax_it)
+                for (size_t i = 0; i < tracklets.size(n); ++i)
                 {
-                    LOG(logDEBUG4) << "internal arcs traxel " << *trax_it;
-                    Traxel tr = *trax_it;
+                    LOG(logDEBUG4) << "internal arcs traxel " << tracklets.traxel(n, i);
+                    Traxel tr = tracklets.traxel(n, i);
                     if (!first)
                     {
                         double e = param_.transition(get_transition_probability(tr_prev, tr, state));
@@ -160,8 +160,8 @@ void DynProgConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
         int node_end_time = -1;
         if (param_.with_tracklets)
         {
-            node_begin_time = tracklet_map[n].front().Timestep;
-            node_end_time = tracklet_map[n].back().Timestep;
+            node_begin_time = graph->tracklets().front(n).Timestep;
+            node_end_time = graph->tracklets().back(n).Timestep;
         }
         else
         {
@@ -198,7 +198,7 @@ void DynProgConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
         Traxel tr;
         if(param_.with_tracklets)
         {
-            tr = tracklet_map[n].front();
+            tr = graph->tracklets().front(n);
         }
         else
         {
@@ -209,7 +209,7 @@ void DynProgConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
 
         if(param_.with_tracklets)
         {
-            tr = tracklet_map[n].back();
+            tr = graph->tracklets().back(n);
         }
         double dis_score = -1.0 * param_.disappearance_cost_fn(tr) - generateRandomOffset(Disappearance);
         LOG(logDEBUG3) << "\tapp-score " << app_score << std::endl;
@@ -260,7 +260,7 @@ void DynProgConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
                 Traxel tr;
                 if (param_.with_tracklets)
                 {
-                    tr = tracklet_map[n].back();
+                    tr = graph->tracklets().back(n);
                 }
                 else
                 {
@@ -410,7 +410,7 @@ void DynProgConsTrackInferenceModel::conclude(HypothesesGraph& g,
     property_map<division_active_count, HypothesesGraph::base_graph>::type& active_divisions_count =
         g.get(division_active_count());
 
-    int iterStep = active_nodes_count[g.nodeFromId(0)].size();
+    int iterStep = active_nodes_count.size(g.nodeFromId(0));
     if (iterStep == 0)
     {
         //initialize vectors for storing optimizer results
@@ -428,11 +428,9 @@ void DynProgConsTrackInferenceModel::conclude(HypothesesGraph& g,
 
     if (!param_.with_tracklets)
     {
-        tracklet_graph.add(tracklet_intern_arc_ids()).add(traxel_arc_id());
+        tracklet_graph.add(traxel_arc_id());
     }
 
-    property_map<tracklet_intern_arc_ids, HypothesesGraph::base_graph>::type& tracklet_arc_id_map
-            = tracklet_graph.get(tracklet_intern_arc_ids());
     property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& traxel_arc_id_map
             = tracklet_graph.get(traxel_arc_id());
 
@@ -476,12 +474,10 @@ void DynProgConsTrackInferenceModel::conclude(HypothesesGraph& g,
             }
 
             // set state of tracklet internal arcs
-            std::vector<int> arc_ids = tracklet_arc_id_map[n];
-            for (std::vector<int>::const_iterator arc_id_it = arc_ids.begin();
-                 arc_id_it != arc_ids.end();
-                 ++arc_id_it)
+            const TrackletView& tracklets = tracklet_graph.tracklets();
+            for (size_t i = 0; i + 1 < tracklets.size(n); ++i)
             {
-                HypothesesGraph::Arc a = g.arcFromId(*arc_id_it);
+                HypothesesGraph::Arc a = g.arcFromId(tracklets.intern_arc_id(n, i));
                 active_arcs.set(a, true);
                 active_arcs_count.get_value(a)[iterStep] = true;
                 arc_values.get_value(a)[iterStep]++;
@@ -41,7 +41,6 @@ void FlowConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
 
     HypothesesGraph::node_timestep_map& timestep_map = graph->get(node_timestep());
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = graph->get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = graph->get(node_tracklet());
 
     size_t first_timestep = graph->earliest_timestep();
     size_t last_timestep = graph->latest_timestep();
@@ -56,7 +55,7 @@ void FlowConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
         Traxel tr;
         if(param_.with_tracklets)
         {
-            tr = tracklet_map[n].front();
+            tr = graph->tracklets().front(n);
         }
         else
         {
@@ -96,7 +95,7 @@ void FlowConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
         // disappearance cost
         if(param_.with_tracklets)
         {
-            tr = tracklet_map[n].back();
+            tr = graph->tracklets().back(n);
         }
         if(param_.with_disappearance)
         {
@@ -131,8 +130,8 @@ void FlowConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
         Traxel tr1, tr2;
         if (param_.with_tracklets)
         {
-            tr1 = tracklet_map[graph->source(a)].back();
-            tr2 = tracklet_map[graph->target(a)].front();
+            tr1 = graph->tracklets().back(graph->source(a));
+            tr2 = graph->tracklets().front(graph->target(a));
         }
         else
         {
@@ -170,7 +169,7 @@ void FlowConsTrackInferenceModel::build_from_graph(const HypothesesGraph& g)
                 Traxel tr;
                 if (param_.with_tracklets)
                 {
-                    tr = tracklet_map[n].back();
+                    tr = graph->tracklets().back(n);
                 }
                 else
                 {
@@ -243,7 +242,7 @@ void FlowConsTrackInferenceModel::conclude(HypothesesGraph& g,
     property_map<division_active_count, HypothesesGraph::base_graph>::type& active_divisions_count =
         g.get(division_active_count());
 
-    int iterStep = active_nodes_count[g.nodeFromId(0)].size();
+    int iterStep = active_nodes_count.size(g.nodeFromId(0));
     if (iterStep == 0)
     {
         //initialize vectors for storing optimizer results
@@ -261,11 +260,9 @@ void FlowConsTrackInferenceModel::conclude(HypothesesGraph& g,
 
     if (!param_.with_tracklets)
     {
-        tracklet_graph.add(tracklet_intern_arc_ids()).add(traxel_arc_id());
+        tracklet_graph.add(traxel_arc_id());
     }
 
-    property_map<tracklet_intern_arc_ids, HypothesesGraph::base_graph>::type& tracklet_arc_id_map
-            = tracklet_graph.get(tracklet_intern_arc_ids());
     property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& traxel_arc_id_map
             = tracklet_graph.get(traxel_arc_id());
 
@@ -337,12 +334,10 @@ void FlowConsTrackInferenceModel::conclude(HypothesesGraph& g,
                 }
 
                 // set state of tracklet internal arcs
-                std::vector<int> arc_ids = tracklet_arc_id_map[n];
-                for (std::vector<int>::const_iterator arc_id_it = arc_ids.begin();
-                     arc_id_it != arc_ids.end();
-                     ++arc_id_it)
+                const TrackletView& tracklets = tracklet_graph.tracklets();
+                for (size_t i = 0; i + 1 < tracklets.size(n); ++i)
                 {
-                    HypothesesGraph::Arc a = g.arcFromId(*arc_id_it);
+                    HypothesesGraph::Arc a = g.arcFromId(tracklets.intern_arc_id(n, i));
                     active_arcs.set(a, true);
                     active_arcs_count.get_value(a)[iterStep] = true;
                     arc_values.get_value(a)[iterStep] = flow;
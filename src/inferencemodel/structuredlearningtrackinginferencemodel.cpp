@@ -55,8 +55,6 @@ void StructuredLearningTrackingInferenceModel::fixFirstDisappearanceNodesToLabel
 size_t StructuredLearningTrackingInferenceModel::add_detection_factors(const HypothesesGraph& g, size_t factorIndex)
 {
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map_ = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map_ =
-        g.get(node_tracklet());
 
     LOG(logDEBUG) << "StructuredLearningTrackingInferenceModel::add_finite_factors: add detection factors";
 
@@ -303,7 +301,7 @@ size_t StructuredLearningTrackingInferenceModel::add_detection_factors(const Hyp
         // and the matrix is constructed such that appearances are along coords[0], ...
         sort(vi.begin(), vi.end());
         model_.addFactor(funcId, vi.begin(), vi.end());
-        detection_f_node_map_[n] = model_.numberOfFactors() - 1;
+        detection_f_node_map_.insert(n, model_.numberOfFactors() - 1);
     } // end for node n
     LOG(logDEBUG) << "number of REDUCED border appearance weights    " << counterApp << std::endl;
     LOG(logDEBUG) << "number of REDUCED border disappearance weights " << counterDis << std::endl;
@@ -313,8 +311,6 @@ size_t StructuredLearningTrackingInferenceModel::add_detection_factors(const Hyp
 size_t StructuredLearningTrackingInferenceModel::add_transition_factors(const HypothesesGraph& g, size_t factorIndex)
 {
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map_ = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map_ =
-        g.get(node_tracklet());
 
     LOG(logDEBUG) << "StructuredLearningTrackingInferenceModel::add_finite_factors: add transition factors";
 
@@ -402,8 +398,6 @@ size_t StructuredLearningTrackingInferenceModel::add_division_factors(const Hypo
     }
 
     property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map_ = g.get(node_traxel());
-    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map_ =
-        g.get(node_tracklet());
 
     LOG(logDEBUG) << "StructuredLearningTrackingInferenceModel::add_finite_factors: add division factors";
 
@@ -497,13 +491,15 @@ void StructuredLearningTrackingInferenceModel::add_constraints_to_pool(const Hyp
                                            param_.with_disappearance,
                                            param_.with_misdetections_allowed);
 
+    const FrozenHypothesesGraph& frozen = get_frozen_graph(g);
     for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
     {
+        const size_t i = frozen.index(n);
         {
             std::vector<size_t> transition_nodes;
-            for (HypothesesGraph::OutArcIt a(g, n); a != lemon::INVALID; ++a)
+            for (size_t a = frozen.out_begin(i); a < frozen.out_end(i); ++a)
             {
-                transition_nodes.push_back(arc_map_[a]);
+                transition_nodes.push_back(arc_map_[frozen.arc(a)]);
             }
 
             int division_node = -1;
@@ -518,9 +514,9 @@ void StructuredLearningTrackingInferenceModel::add_constraints_to_pool(const Hyp
 
         {
             std::vector<size_t> transition_nodes;
-            for (HypothesesGraph::InArcIt a(g, n); a != lemon::INVALID; ++a)
+            for (size_t k = frozen.in_begin(i); k < frozen.in_end(i); ++k)
             {
-                transition_nodes.push_back(arc_map_[a]);
+                transition_nodes.push_back(arc_map_[frozen.arc(frozen.in_arc(k))]);
             }
             size_t disappearance_node = dis_node_map_[n];
 
@@ -0,0 +1,203 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "pgmlink/instrumentation.h"
+#include "pgmlink/log.h"
+
+namespace pgmlink
+{
+
+std::string Instrumentation::json_escape(const std::string& s)
+{
+    std::string escaped;
+    escaped.reserve(s.size());
+    for(std::string::const_iterator it = s.begin(); it != s.end(); ++it)
+    {
+        switch(*it)
+        {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\r':
+            escaped += "\\r";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            if(static_cast<unsigned char>(*it) < 0x20)
+            {
+                // remaining control characters
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned int>(*it));
+                escaped += code;
+            }
+            else
+            {
+                escaped += *it;
+            }
+        }
+    }
+    return escaped;
+}
+
+Instrumentation& Instrumentation::instance()
+{
+    static Instrumentation instrumentation;
+    return instrumentation;
+}
+
+Instrumentation::Instrumentation()
+    : enabled_(false)
+{
+}
+
+void Instrumentation::enable(bool enabled)
+{
+    enabled_ = enabled;
+}
+
+void Instrumentation::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stages_.clear();
+    stage_index_.clear();
+}
+
+StageStatistics& Instrumentation::stage(const std::string& name)
+{
+    std::map<std::string, size_t>::const_iterator it = stage_index_.find(name);
+    if(it != stage_index_.end())
+    {
+        return stages_[it->second];
+    }
+    stage_index_[name] = stages_.size();
+    stages_.push_back(StageStatistics());
+    stages_.back().name = name;
+    return stages_.back();
+}
+
+void Instrumentation::add_stage_time(const std::string& stage_name,
+                                     double seconds,
+                                     long heap_delta_kb)
+{
+    const long rss = peak_rss_kb();
+    std::lock_guard<std::mutex> lock(mutex_);
+    StageStatistics& s = stage(stage_name);
+    ++s.calls;
+    s.wall_seconds += seconds;
+    s.peak_rss_kb = rss;
+    s.heap_delta_kb += heap_delta_kb;
+    LOG(logDEBUG) << "Instrumentation: " << stage_name << " took " << seconds
+                  << " s, peak rss " << rss << " kB";
+}
+
+void Instrumentation::set_counter(const std::string& stage_name,
+                                  const std::string& counter,
+                                  size_t value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stage(stage_name).counters[counter] = value;
+}
+
+void Instrumentation::add_counter(const std::string& stage_name,
+                                  const std::string& counter,
+                                  size_t value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stage(stage_name).counters[counter] += value;
+}
+
+std::vector<StageStatistics> Instrumentation::stages() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stages_;
+}
+
+std::string Instrumentation::to_json() const
+{
+    std::vector<StageStatistics> snapshot = stages();
+    std::ostringstream json;
+    json.precision(9);
+    json << "{\"peak_rss_kb\": " << peak_rss_kb() << ", \"stages\": [";
+    for(size_t i = 0; i < snapshot.size(); ++i)
+    {
+        const StageStatistics& s = snapshot[i];
+        json << (i == 0 ? "" : ", ")
+             << "{\"name\": \"" << json_escape(s.name) << "\""
+             << ", \"calls\": " << s.calls
+             << ", \"wall_seconds\": " << s.wall_seconds
+             << ", \"peak_rss_kb\": " << s.peak_rss_kb
+             << ", \"heap_delta_kb\": " << s.heap_delta_kb
+             << ", \"counters\": {";
+        for(std::map<std::string, size_t>::const_iterator it = s.counters.begin();
+                it != s.counters.end(); ++it)
+        {
+            json << (it == s.counters.begin() ? "" : ", ")
+                 << "\"" << json_escape(it->first) << "\": " << it->second;
+        }
+        json << "}}";
+    }
+    json << "]}";
+    return json.str();
+}
+
+void Instrumentation::dump_json(const std::string& filename) const
+{
+    std::ofstream out(filename.c_str());
+    if(!out)
+    {
+        throw std::runtime_error("Instrumentation::dump_json(): could not open " + filename);
+    }
+    out << to_json() << std::endl;
+}
+
+long Instrumentation::peak_rss_kb()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    // reported in bytes on OS X
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+long Instrumentation::heap_in_use_kb()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<long>((info.uordblks + info.hblkhd) / 1024);
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return static_cast<long>((static_cast<unsigned long>(info.uordblks)
+                              + static_cast<unsigned long>(info.hblkhd)) / 1024);
+#else
+    return 0;
+#endif
+}
+
+} /* namespace pgmlink */
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+
+#include "pgmlink/linear_assignment.h"
+
+namespace pgmlink
+{
+
+namespace
+{
+const size_t none = static_cast<size_t>(-1);
+const double infinity = std::numeric_limits<double>::infinity();
+}
+
+std::vector<int> solve_sparse_assignment(size_t n_rows,
+        size_t n_cols,
+        const std::vector<AssignmentCandidate>& candidates,
+        double unassigned_row_cost,
+        double unassigned_col_cost)
+{
+    // cols n_cols + r are the private dummy cols of the rows r. Costs are taken
+    // relative to leaving both row and col unassigned, so dummy cols cost 0
+    // and only candidates with negative relative costs can improve a solution.
+    const size_t n_all_cols = n_cols + n_rows;
+    std::vector<std::vector<std::pair<size_t, double> > > edges(n_rows);
+    std::vector<double> row_potential(n_rows, 0.);
+    std::vector<double> col_potential(n_all_cols, 0.);
+    for (std::vector<AssignmentCandidate>::const_iterator c = candidates.begin(); c != candidates.end(); ++c)
+    {
+        if (c->row >= n_rows || c->col >= n_cols)
+        {
+            throw std::runtime_error("solve_sparse_assignment(): candidate out of range");
+        }
+        const double cost = c->cost - unassigned_row_cost - unassigned_col_cost;
+        if (cost < 0.)
+        {
+            edges[c->row].push_back(std::make_pair(c->col, cost));
+            // keeps the reduced costs of all edges non-negative; the cols
+            // start out equal, as free cols have to be comparable targets
+            row_potential[c->row] = std::max(row_potential[c->row], -cost);
+        }
+    }
+
+    std::vector<size_t> col_of_row(n_rows, none);
+    std::vector<size_t> row_of_col(n_all_cols, none);
+    std::vector<double> cost_of_col(n_all_cols, 0.);
+
+    // shortest path search state, reset after each row
+    std::vector<double> row_distance(n_rows, infinity);
+    std::vector<double> col_distance(n_all_cols, infinity);
+    std::vector<size_t> predecessor(n_all_cols, none);
+    std::vector<double> predecessor_cost(n_all_cols, 0.);
+    std::vector<bool> row_done(n_rows, false);
+    std::vector<bool> col_done(n_all_cols, false);
+    std::vector<size_t> touched_rows, touched_cols;
+
+    // heap entries are (distance, node) with rows as 0..n_rows-1 and cols after them
+    typedef std::pair<double, size_t> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+
+    for (size_t source = 0; source < n_rows; ++source)
+    {
+        row_distance[source] = 0.;
+        touched_rows.push_back(source);
+        heap.push(HeapEntry(0., source));
+
+        size_t target = none;
+        double target_distance = 0.;
+        while (!heap.empty())
+        {
+            const HeapEntry top = heap.top();
+            heap.pop();
+            const double distance = top.first;
+            if (top.second >= n_rows)
+            {
+                const size_t col = top.second - n_rows;
+                if (col_done[col])
+                {
+                    continue;
+                }
+                col_done[col] = true;
+                if (row_of_col[col] == none)
+                {
+                    target = col;
+                    target_distance = distance;
+                    break;
+                }
+                // leave col through its assignment
+                const size_t row = row_of_col[col];
+                const double d = distance - cost_of_col[col] + col_potential[col] - row_potential[row];
+                if (d < row_distance[row])
+                {
+                    if (row_distance[row] == infinity)
+                    {
+                        touched_rows.push_back(row);
+                    }
+                    row_distance[row] = d;
+                    heap.push(HeapEntry(d, row));
+                }
+            }
+            else
+            {
+                const size_t row = top.second;
+                if (row_done[row])
+                {
+                    continue;
+                }
+                row_done[row] = true;
+                const std::vector<std::pair<size_t, double> >& row_edges = edges[row];
+                for (size_t k = 0; k <= row_edges.size(); ++k)
+                {
+                    const size_t col = k < row_edges.size() ? row_edges[k].first : n_cols + row;
+                    const double cost = k < row_edges.size() ? row_edges[k].second : 0.;
+                    if (col == col_of_row[row])
+                    {
+                        continue;
+                    }
+                    const double d = distance + cost + row_potential[row] - col_potential[col];
+                    if (d < col_distance[col])
+                    {
+                        if (col_distance[col] == infinity)
+                        {
+                            touched_cols.push_back(col);
+                        }
+                        col_distance[col] = d;
+                        predecessor[col] = row;
+                        predecessor_cost[col] = cost;
+                        heap.push(HeapEntry(d, n_rows + col));
+                    }
+                }
+            }
+        }
+        // the dummy col of source is always free
+        assert(target != none);
+
+        // update the potentials of the nodes closer than the target, which
+        // keeps all reduced costs non-negative and makes the path tight
+        for (std::vector<size_t>::const_iterator it = touched_rows.begin(); it != touched_rows.end(); ++it)
+        {
+            if (row_done[*it])
+            {
+                row_potential[*it] -= target_distance - row_distance[*it];
+            }
+            row_distance[*it] = infinity;
+            row_done[*it] = false;
+        }
+        for (std::vector<size_t>::const_iterator it = touched_cols.begin(); it != touched_cols.end(); ++it)
+        {
+            if (col_done[*it])
+            {
+                col_potential[*it] -= target_distance - col_distance[*it];
+            }
+            col_distance[*it] = infinity;
+            col_done[*it] = false;
+        }
+        touched_rows.clear();
+        touched_cols.clear();
+        heap = std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> >();
+
+        // augment along the path back to source
+        size_t col = target;
+        while (true)
+        {
+            const size_t row = predecessor[col];
+            const size_t previous_col = col_of_row[row];
+            col_of_row[row] = col;
+            row_of_col[col] = row;
+            cost_of_col[col] = predecessor_cost[col];
+            if (row == source)
+            {
+                break;
+            }
+            col = previous_col;
+        }
+    }
+
+    std::vector<int> result(n_rows, -1);
+    for (size_t row = 0; row < n_rows; ++row)
+    {
+        if (col_of_row[row] < n_cols)
+        {
+            result[row] = static_cast<int>(col_of_row[row]);
+        }
+    }
+    return result;
+}
+
+} // namespace pgmlink
@@ -0,0 +1,383 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <hdf5.h>
+
+#include "pgmlink/features/featurestore.h"
+#include "pgmlink/log.h"
+#include "pgmlink/out_of_core_traxel_store.h"
+
+namespace pgmlink
+{
+
+namespace
+{
+template<typename T>
+T check(T status, const std::string& what)
+{
+    if (status < 0)
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore: " + what);
+    }
+    return status;
+}
+
+std::string frame_group(int timestep)
+{
+    return "timesteps/" + boost::lexical_cast<std::string>(timestep);
+}
+
+bool link_exists(hid_t file, const std::string& path)
+{
+    // H5Lexists needs all parents to exist, so check them one by one
+    size_t pos = 0;
+    while (pos != std::string::npos)
+    {
+        pos = path.find('/', pos + 1);
+        if (H5Lexists(file, path.substr(0, pos).c_str(), H5P_DEFAULT) <= 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> link_names(hid_t file, const std::string& group_name)
+{
+    std::vector<std::string> names;
+    hid_t group = check(H5Gopen2(file, group_name.c_str(), H5P_DEFAULT), "cannot open group " + group_name);
+    H5G_info_t info;
+    H5Gget_info(group, &info);
+    for (hsize_t i = 0; i < info.nlinks; ++i)
+    {
+        const ssize_t length = H5Lget_name_by_idx(group, ".", H5_INDEX_NAME, H5_ITER_INC, i, NULL, 0, H5P_DEFAULT);
+        std::vector<char> name(std::max<ssize_t>(length, 0) + 1);
+        H5Lget_name_by_idx(group, ".", H5_INDEX_NAME, H5_ITER_INC, i, name.data(), name.size(), H5P_DEFAULT);
+        names.push_back(std::string(name.data()));
+    }
+    H5Gclose(group);
+    return names;
+}
+
+// a dataset of rank 1 (columns == 0) or 2 stored as one chunk
+void write_dataset(hid_t file,
+                   const std::string& name,
+                   hid_t type,
+                   const void* data,
+                   hsize_t rows,
+                   hsize_t columns,
+                   bool matrix)
+{
+    const int rank = matrix ? 2 : 1;
+    hsize_t dims[2] = {rows, columns};
+    hid_t space = check(H5Screate_simple(rank, dims, NULL), "cannot create dataspace for " + name);
+    hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+    if (rows > 0 && (!matrix || columns > 0))
+    {
+        H5Pset_chunk(dcpl, rank, dims);
+        if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0)
+        {
+            H5Pset_deflate(dcpl, 4);
+        }
+    }
+    hid_t lcpl = H5Pcreate(H5P_LINK_CREATE);
+    H5Pset_create_intermediate_group(lcpl, 1);
+    hid_t dataset = H5Dcreate2(file, name.c_str(), type, space, lcpl, dcpl, H5P_DEFAULT);
+    H5Pclose(lcpl);
+    H5Pclose(dcpl);
+    H5Sclose(space);
+    check(dataset, "cannot create dataset " + name);
+    herr_t status = 0;
+    if (rows > 0 && (!matrix || columns > 0))
+    {
+        status = H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data);
+    }
+    H5Dclose(dataset);
+    check(status, "cannot write dataset " + name);
+}
+
+// read a dataset of rank 1 or 2, returns the number of columns (1 for rank 1)
+template<typename T>
+size_t read_dataset(hid_t file, const std::string& name, hid_t type, std::vector<T>& values)
+{
+    hid_t dataset = check(H5Dopen2(file, name.c_str(), H5P_DEFAULT), "cannot open dataset " + name);
+    hid_t space = H5Dget_space(dataset);
+    hsize_t dims[2] = {0, 1};
+    const int rank = H5Sget_simple_extent_dims(space, dims, NULL);
+    H5Sclose(space);
+    if (rank < 1 || rank > 2)
+    {
+        H5Dclose(dataset);
+        throw std::runtime_error("OutOfCoreTraxelStore: unexpected rank of dataset " + name);
+    }
+    const size_t columns = rank == 2 ? dims[1] : 1;
+    values.resize(dims[0] * columns);
+    herr_t status = 0;
+    if (!values.empty())
+    {
+        status = H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+    }
+    H5Dclose(dataset);
+    check(status, "cannot read dataset " + name);
+    return columns;
+}
+} // end anonymous namespace
+
+OutOfCoreTraxelStore::OutOfCoreTraxelStore(const std::string& filename, size_t cache_size)
+    : filename_(filename), cache_size_(cache_size), file_(-1), size_(0), frames_loaded_(0)
+{
+    if (cache_size == 0)
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore: the cache has to hold at least one frame");
+    }
+    if (!std::ifstream(filename.c_str()).good())
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore: cannot open " + filename);
+    }
+    file_ = check(H5Fopen(filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT), "cannot open " + filename);
+
+    try
+    {
+        if (H5Lexists(file_, "timesteps", H5P_DEFAULT) > 0)
+        {
+            const std::vector<std::string> names = link_names(file_, "timesteps");
+            for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name)
+            {
+                int timestep;
+                try
+                {
+                    timestep = boost::lexical_cast<int>(*name);
+                }
+                catch (boost::bad_lexical_cast&)
+                {
+                    throw std::runtime_error("OutOfCoreTraxelStore: " + filename + " has a frame named " + *name);
+                }
+                std::vector<unsigned int>& ids = ids_[timestep];
+                read_dataset(file_, frame_group(timestep) + "/ids", H5T_NATIVE_UINT, ids);
+                size_ += ids.size();
+            }
+        }
+    }
+    catch (...)
+    {
+        H5Fclose(file_);
+        throw;
+    }
+    LOG(logINFO) << "OutOfCoreTraxelStore: " << size_ << " traxels in " << ids_.size()
+                 << " timesteps in " << filename;
+}
+
+OutOfCoreTraxelStore::~OutOfCoreTraxelStore()
+{
+    H5Fclose(file_);
+}
+
+void OutOfCoreTraxelStore::append_frame(const std::string& filename,
+                                        int timestep,
+                                        const std::vector<Traxel>& traxels)
+{
+    // the features of the first traxel determine the layout of the frame
+    std::vector<std::string> names;
+    std::vector<size_t> dims;
+    if (!traxels.empty())
+    {
+        const FeatureMap& features = traxels.front().features.get();
+        for (FeatureMap::const_iterator f = features.begin(); f != features.end(); ++f)
+        {
+            if (f->first.empty() || f->first.find('/') != std::string::npos)
+            {
+                throw std::runtime_error("OutOfCoreTraxelStore::append_frame(): cannot store feature \"" + f->first + "\"");
+            }
+            names.push_back(f->first);
+            dims.push_back(f->second.size());
+        }
+    }
+
+    std::vector<unsigned int> ids;
+    std::vector<std::vector<double> > values(names.size());
+    for (std::vector<Traxel>::const_iterator traxel = traxels.begin(); traxel != traxels.end(); ++traxel)
+    {
+        if (traxel->Timestep != timestep)
+        {
+            throw std::runtime_error("OutOfCoreTraxelStore::append_frame(): traxel of another timestep");
+        }
+        const FeatureMap& features = traxel->features.get();
+        if (features.size() != names.size())
+        {
+            throw std::runtime_error("OutOfCoreTraxelStore::append_frame(): traxels of a frame need the same features");
+        }
+        for (size_t k = 0; k < names.size(); ++k)
+        {
+            FeatureMap::const_iterator f = features.find(names[k]);
+            if (f == features.end() || f->second.size() != dims[k])
+            {
+                throw std::runtime_error("OutOfCoreTraxelStore::append_frame(): traxels of a frame need the same features");
+            }
+            values[k].insert(values[k].end(), f->second.begin(), f->second.end());
+        }
+        ids.push_back(traxel->Id);
+    }
+
+    const bool exists = std::ifstream(filename.c_str()).good();
+    hid_t file = exists
+                 ? H5Fopen(filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT)
+                 : H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    check(file, "cannot open " + filename + " for writing");
+    try
+    {
+        const std::string group = frame_group(timestep);
+        if (link_exists(file, group))
+        {
+            throw std::runtime_error("OutOfCoreTraxelStore::append_frame(): timestep "
+                                     + boost::lexical_cast<std::string>(timestep) + " is stored already");
+        }
+        write_dataset(file, group + "/ids", H5T_NATIVE_UINT, ids.data(), ids.size(), 0, false);
+        for (size_t k = 0; k < names.size(); ++k)
+        {
+            write_dataset(file, group + "/features/" + names[k], H5T_NATIVE_DOUBLE,
+                          values[k].data(), ids.size(), dims[k], true);
+        }
+    }
+    catch (...)
+    {
+        H5Fclose(file);
+        throw;
+    }
+    check(H5Fclose(file), "cannot close " + filename);
+}
+
+void OutOfCoreTraxelStore::write(const std::string& filename, const TraxelStore& ts)
+{
+    const std::set<TraxelStoreByTimestep::key_type> steps = pgmlink::timesteps(ts);
+    for (std::set<TraxelStoreByTimestep::key_type>::const_iterator t = steps.begin(); t != steps.end(); ++t)
+    {
+        std::pair<TraxelStoreByTimestep::const_iterator, TraxelStoreByTimestep::const_iterator> traxels =
+            ts.get<by_timestep>().equal_range(*t);
+        append_frame(filename, *t, std::vector<Traxel>(traxels.first, traxels.second));
+    }
+}
+
+std::set<int> OutOfCoreTraxelStore::timesteps() const
+{
+    std::set<int> result;
+    for (std::map<int, std::vector<unsigned int> >::const_iterator it = ids_.begin(); it != ids_.end(); ++it)
+    {
+        result.insert(result.end(), it->first);
+    }
+    return result;
+}
+
+int OutOfCoreTraxelStore::earliest_timestep() const
+{
+    if (ids_.empty())
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore::earliest_timestep(): no timesteps");
+    }
+    return ids_.begin()->first;
+}
+
+int OutOfCoreTraxelStore::latest_timestep() const
+{
+    if (ids_.empty())
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore::latest_timestep(): no timesteps");
+    }
+    return ids_.rbegin()->first;
+}
+
+size_t OutOfCoreTraxelStore::size() const
+{
+    return size_;
+}
+
+const std::vector<unsigned int>& OutOfCoreTraxelStore::ids(int timestep) const
+{
+    std::map<int, std::vector<unsigned int> >::const_iterator it = ids_.find(timestep);
+    if (it == ids_.end())
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore: no timestep "
+                                 + boost::lexical_cast<std::string>(timestep));
+    }
+    return it->second;
+}
+
+boost::shared_ptr<const TraxelStore> OutOfCoreTraxelStore::frame(int timestep) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Cache::iterator it = cache_.begin(); it != cache_.end(); ++it)
+    {
+        if (it->first == timestep)
+        {
+            cache_.splice(cache_.begin(), cache_, it);
+            return cache_.front().second;
+        }
+    }
+
+    boost::shared_ptr<const TraxelStore> loaded = load_frame(timestep);
+    cache_.push_front(std::make_pair(timestep, loaded));
+    if (cache_.size() > cache_size_)
+    {
+        cache_.pop_back();
+    }
+    ++frames_loaded_;
+    return loaded;
+}
+
+Traxel OutOfCoreTraxelStore::traxel(int timestep, unsigned int id) const
+{
+    boost::shared_ptr<const TraxelStore> traxels = frame(timestep);
+    TraxelStoreByTimeid::const_iterator it = traxels->get<by_timeid>().find(boost::make_tuple(timestep, id));
+    if (it == traxels->get<by_timeid>().end())
+    {
+        throw std::runtime_error("OutOfCoreTraxelStore: no traxel " + boost::lexical_cast<std::string>(id)
+                                 + " at timestep " + boost::lexical_cast<std::string>(timestep));
+    }
+    return *it;
+}
+
+size_t OutOfCoreTraxelStore::frames_loaded() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_loaded_;
+}
+
+boost::shared_ptr<const TraxelStore> OutOfCoreTraxelStore::load_frame(int timestep) const
+{
+    const std::vector<unsigned int>& frame_ids = ids(timestep);
+    LOG(logDEBUG1) << "OutOfCoreTraxelStore: loading timestep " << timestep << " from " << filename_;
+
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    boost::shared_ptr<TraxelStore> traxels(new TraxelStore);
+    for (size_t i = 0; i < frame_ids.size(); ++i)
+    {
+        Traxel traxel(frame_ids[i], timestep);
+        add(*traxels, fs, traxel);
+    }
+
+    const std::string group = frame_group(timestep) + "/features";
+    if (H5Lexists(file_, group.c_str(), H5P_DEFAULT) > 0)
+    {
+        const std::vector<std::string> names = link_names(file_, group);
+        std::vector<double> values;
+        for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name)
+        {
+            const size_t columns = read_dataset(file_, group + "/" + *name, H5T_NATIVE_DOUBLE, values);
+            if (values.size() != frame_ids.size() * columns)
+            {
+                throw std::runtime_error("OutOfCoreTraxelStore: feature " + *name + " of timestep "
+                                         + boost::lexical_cast<std::string>(timestep) + " does not match the ids");
+            }
+            for (size_t i = 0; i < frame_ids.size(); ++i)
+            {
+                fs->get_traxel_features(timestep, frame_ids[i])[*name].assign(
+                    values.begin() + i * columns, values.begin() + (i + 1) * columns);
+            }
+        }
+    }
+    return traxels;
+}
+
+} // end namespace pgmlink
@@ -1,8 +1,8 @@
-#define _unused(x) ((void)x)
-
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <limits>
+#include <memory>
 #include <set>
 #include <stdexcept>
 #include <utility>
@@ -42,35 +42,25 @@ Model::Model(boost::shared_ptr<OpengmModel> m,
             )
     : opengm_model(m)
 {
-    node_var_.left = node_var;
-    arc_var_.left = arc_var;
+    node_var_ = node_var;
+    arc_var_ = arc_var;
     init();
 }
 
 const Model::node_var_map& Model::var_of_node() const
 {
-    return node_var_.left;
-}
-
-const Model::var_node_map& Model::node_of_var() const
-{
-    return node_var_.right;
+    return node_var_;
 }
 
 const Model::arc_var_map& Model::var_of_arc() const
 {
-    return arc_var_.left;
-}
-
-const Model::var_arc_map& Model::arc_of_var() const
-{
-    return arc_var_.right;
+    return arc_var_;
 }
 
 Model::var_t Model::var_of_node(node_t e) const
 {
-    node_var_map::const_iterator it = var_of_node().find(e);
-    if(it != var_of_node().end())
+    node_var_map::const_iterator it = node_var_.find(e);
+    if(it != node_var_.end())
     {
         return it->second;
     }
@@ -82,8 +72,8 @@ Model::var_t Model::var_of_node(node_t e) const
 
 Model::var_t Model::var_of_arc(arc_t e) const
 {
-    arc_var_map::const_iterator it = var_of_arc().find(e);
-    if(it != var_of_arc().end())
+    arc_var_map::const_iterator it = arc_var_.find(e);
+    if(it != arc_var_.end())
     {
         return it->second;
     }
@@ -95,10 +85,9 @@ Model::var_t Model::var_of_arc(arc_t e) const
 
 Model::node_t Model::node_of_var(var_t e) const
 {
-    var_node_map::const_iterator it = node_of_var().find(e);
-    if(it != node_of_var().end())
+    if(node_var_.count_value(e))
     {
-        return it->second;
+        return node_var_.key_of(e);
     }
     else
     {
@@ -108,10 +97,9 @@ Model::node_t Model::node_of_var(var_t e) const
 
 Model::arc_t Model::arc_of_var(var_t e) const
 {
-    var_arc_map::const_iterator it = arc_of_var().find(e);
-    if(it != arc_of_var().end())
+    if(arc_var_.count_value(e))
     {
-        return it->second;
+        return arc_var_.key_of(e);
     }
     else
     {
@@ -121,11 +109,11 @@ Model::arc_t Model::arc_of_var(var_t e) const
 
 Model::VarCategory Model::var_category(var_t e) const
 {
-    if(arc_of_var().count(e))
+    if(arc_var_.count_value(e))
     {
         return Model::arc_var;
     }
-    else if(node_of_var().count(e))
+    else if(node_var_.count_value(e))
     {
         return Model::node_var;
     }
@@ -314,19 +302,21 @@ inline void ModelBuilder::add_detection_vars( const HypothesesGraph& hypotheses,
         throw std::runtime_error("chaingraph::ModelBuilder::add_detection_vars(): called without has_detection_vars()");
     }
 
+    m.node_var_.reserve(hypotheses.maxNodeId() + 1);
     for(HypothesesGraph::NodeIt n(hypotheses); n != lemon::INVALID; ++n)
     {
         m.opengm_model->addVariable(2);
-        m.node_var_.left.insert(Model::node_var_map::value_type(n, m.opengm_model->numberOfVariables() - 1));
+        m.node_var_.insert(n, m.opengm_model->numberOfVariables() - 1);
     }
 }
 
 inline void ModelBuilder::add_assignment_vars( const HypothesesGraph& hypotheses, Model& m ) const
 {
+    m.arc_var_.reserve(hypotheses.maxArcId() + 1);
     for(HypothesesGraph::ArcIt a(hypotheses); a != lemon::INVALID; ++a)
     {
         m.opengm_model->addVariable(2);
-        m.arc_var_.left.insert(Model::arc_var_map::value_type(a, m.opengm_model->numberOfVariables() - 1));
+        m.arc_var_.insert(a, m.opengm_model->numberOfVariables() - 1);
     }
 }
 
@@ -388,7 +378,7 @@ TrainableModelBuilder* TrainableModelBuilder::clone() const
 Model* TrainableModelBuilder::build(const HypothesesGraph& hypotheses) const
 {
     //// setup the model
-    Model* model( new Model() );
+    std::auto_ptr<Model> model( new Model() ); // a factor may throw, e.g. if it is too large
 
     // assign the weight ids to event types
     assert(model->opengm_model->numberOfWeights() == 0);
@@ -430,7 +420,7 @@ Model* TrainableModelBuilder::build(const HypothesesGraph& hypotheses) const
         add_incoming_factor( hypotheses, *model, n );
     }
 
-    return model;
+    return model.release();
 }
 
 void TrainableModelBuilder::add_detection_factor( const HypothesesGraph& hypotheses, Model& m, const HypothesesGraph::Node& n ) const
@@ -451,39 +441,91 @@ void TrainableModelBuilder::add_detection_factor( const HypothesesGraph& hypothe
 
 namespace
 {
-std::vector<size_t> DecToBin(size_t number)
+// Value table of an outgoing / incoming factor: a dense table for few
+// variables, only the set configurations for many (see
+// ModelBuilder::sparse_factor_dimension()).
+class FactorTable
 {
-    if ( number == 0 )
+public:
+    FactorTable( const std::vector<size_t>& vi, double init, size_t sparse_dimension )
     {
-        return std::vector<size_t>(1, 0);
+        // the solver enumerates every table, even a sparse one
+        if( vi.size() >= static_cast<size_t>(std::numeric_limits<size_t>::digits) )
+        {
+            throw std::runtime_error("chaingraph::ModelBuilder: factor has too many variables to be enumerated, "
+                                     "use hard constraints and decompose_large_factors()");
+        }
+        if( vi.size() >= sparse_dimension )
+        {
+            sparse_.reset( new OpengmSparseFactor<double>(vi, init) );
+        }
+        else
+        {
+            dense_.reset( new OpengmExplicitFactor<double>(vi, init) );
+        }
     }
-    if ( number == 1 )
+
+    void set_value( const std::vector<size_t>& coords, double v )
     {
-        return std::vector<size_t>(1, 1);
+        if( sparse_ )
+        {
+            sparse_->set_value( coords, v );
+        }
+        else
+        {
+            dense_->set_value( coords, v );
+        }
     }
 
-    if ( number % 2 == 0 )
+    double get_value( const std::vector<size_t>& coords ) const
     {
-        std::vector<size_t> ret = DecToBin(number / 2);
-        ret.push_back(0);
-        return ret;
+        return sparse_ ? sparse_->get_value( coords ) : dense_->get_value( coords );
     }
-    else
+
+    void add_to( OpengmModel& m ) const
     {
-        std::vector<size_t> ret = DecToBin(number / 2);
-        ret.push_back(1);
-        return ret;
+        if( sparse_ )
+        {
+            sparse_->add_to( m );
+        }
+        else
+        {
+            dense_->add_to( m );
+        }
     }
+
+private:
+    boost::scoped_ptr<OpengmSparseFactor<double> > sparse_;
+    boost::scoped_ptr<OpengmExplicitFactor<double> > dense_;
+};
+
+// Low order terms of a decomposed outgoing / incoming factor (see
+// ModelBuilder::decompose_large_factors()).
+void add_unary( OpengmModel& m, size_t var, double off, double on )
+{
+    OpengmExplicitFactor<double> table( &var, &var + 1 );
+    std::vector<size_t> coords(1, 0);
+    table.set_value( coords, off );
+    coords[0] = 1;
+    table.set_value( coords, on );
+    table.add_to( m );
 }
 
-int BinToDec(std::vector<size_t> number)
+void add_both_on( OpengmModel& m, size_t var1, size_t var2, double v )
 {
-    int result = 0, pow = 1;
-    for ( int i = number.size() - 1; i >= 0; --i, pow <<= 1 )
-    {
-        result += number[i] * pow;
-    }
-    return result;
+    size_t vi[] = {var1, var2};
+    OpengmExplicitFactor<double> table( vi, vi + 2 );
+    std::vector<size_t> coords(2, 1); // (1,1), all other configurations are 0
+    table.set_value( coords, v );
+    table.add_to( m );
+}
+
+void add_feature( Model& m, const std::vector<size_t>& vi, const std::vector<size_t>& indicate,
+                  double value, Model::WeightType w )
+{
+    const std::vector<size_t> shape(vi.size(), 2);
+    OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), indicate.begin(), value)
+    .add_as_feature_to( *(m.opengm_model), m.weight_map[w].front() );
 }
 }
 
@@ -511,25 +553,26 @@ inline void TrainableModelBuilder::add_outgoing_factor( const HypothesesGraph& h
         arcs.push_back(a);
     }
 
+    if( decomposed( vi.size() ) )
+    {
+        add_decomposed_outgoing_factor( hypotheses, m, n, arcs );
+        return;
+    }
+
     // construct factor
     const size_t table_dim = vi.size();
     assert(table_dim > 0);
     const std::vector<size_t> shape(table_dim, 2);
     std::vector<size_t> coords;
 
-    std::set<size_t > entries;
-    for(size_t i = 0; i < static_cast<size_t>(std::pow(2., static_cast<int>(table_dim))); ++i)
-    {
-        entries.insert( entries.end(), i );
-    }
+    // all configurations not allowed below are forbidden
+    FactorTable forbidden( vi, forbidden_cost(), sparse_factor_dimension() );
 
     // opportunity configuration; only in case of detection vars
     if(has_detection_vars())
     {
         coords = std::vector<size_t>(table_dim, 0); // (0,0,...,0)
-        size_t check = entries.erase(BinToDec(coords));
-        assert(check == 1);
-        _unused(check); // for build in release mode
+        forbidden.set_value( coords, 0 );
         OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), coords.begin(), opportunity_cost() )
         .add_as_feature_to( *(m.opengm_model), m.weight_map[Model::opp_weight].front() );
     }
@@ -541,9 +584,7 @@ inline void TrainableModelBuilder::add_outgoing_factor( const HypothesesGraph& h
         {
             coords[0] = 1; // (1,0,...,0)
         }
-        size_t check = entries.erase(BinToDec(coords));
-        assert(check == 1);
-        _unused(check); // for build in release mode
+        forbidden.set_value( coords, 0 );
         OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), coords.begin(), disappearance()(traxel_map[n]) )
         .add_as_feature_to( *(m.opengm_model), m.weight_map[Model::dis_weight].front() );
     }
@@ -561,9 +602,7 @@ inline void TrainableModelBuilder::add_outgoing_factor( const HypothesesGraph& h
         for(size_t i = assignment_begin; i < table_dim; ++i)
         {
             coords[i] = 1;
-            size_t check = entries.erase(BinToDec(coords));
-            assert(check == 1);
-            _unused(check); // for build in release mode
+            forbidden.set_value( coords, 0 );
             OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), coords.begin(), move()(traxel_map[n], traxel_map[hypotheses.target(arcs[i - assignment_begin])]) )
             .add_as_feature_to( *(m.opengm_model), m.weight_map[Model::mov_weight].front() );
             coords[i] = 0; // reset coords
@@ -588,9 +627,7 @@ inline void TrainableModelBuilder::add_outgoing_factor( const HypothesesGraph& h
             {
                 coords[i] = 1;
                 coords[j] = 1;
-                size_t check = entries.erase(BinToDec(coords));
-                assert(check == 1);
-                _unused(check); // for build in release mode
+                forbidden.set_value( coords, 0 );
                 OpengmModel::ValueType value = division()(traxel_map[n],
                                                traxel_map[hypotheses.target(arcs[i - assignment_begin])],
                                                traxel_map[hypotheses.target(arcs[j - assignment_begin])]);
@@ -604,22 +641,57 @@ inline void TrainableModelBuilder::add_outgoing_factor( const HypothesesGraph& h
     }
 
     // forbidden configurations
+    forbidden.add_to( *(m.opengm_model) );
+
+    LOG(logDEBUG) << "TrainableChaingraphModelBuilder::add_outgoing_factor(): leaving";
+}
+
+void TrainableModelBuilder::add_decomposed_outgoing_factor( const HypothesesGraph& hypotheses,
+        Model& m,
+        const HypothesesGraph::Node& n,
+        const vector<HypothesesGraph::Arc>& arcs ) const
+{
+    // the terms of ECCV12ModelBuilder::add_decomposed_outgoing_factor(), one
+    // feature per event type so that the weights still apply
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = hypotheses.get(node_traxel());
+    const Traxel& tr = traxel_map[n];
+    const double dis = disappearance()(tr);
+    const std::vector<size_t> off(1, 0), on(1, 1), both_on(2, 1);
+
+    if(has_detection_vars())
+    {
+        const std::vector<size_t> det(1, m.var_of_node(n));
+        add_feature( m, det, off, opportunity_cost(), Model::opp_weight );
+        add_feature( m, det, on, dis, Model::dis_weight );
+    }
+
+    std::vector<double> moves;
+    for(size_t i = 0; i < arcs.size(); ++i)
     {
-        for(std::set<size_t>::iterator it = entries.begin(); it != entries.end(); ++it)
+        const std::vector<size_t> arc(1, m.var_of_arc(arcs[i]));
+        moves.push_back( move()(tr, traxel_map[hypotheses.target(arcs[i])]) );
+        add_feature( m, arc, on, moves[i], Model::mov_weight );
+        add_feature( m, arc, on, -dis, Model::dis_weight );
+    }
+
+    if(has_divisions())
+    {
+        for(size_t i = 0; i < arcs.size(); ++i)
         {
-            coords = DecToBin(*it);
-            // pad with zeros up to coordinate size
-            if(coords.size() < table_dim )
+            for(size_t j = i + 1; j < arcs.size(); ++j)
             {
-                coords.insert(coords.begin(), table_dim - coords.size(), 0);
+                std::vector<size_t> pair;
+                pair.push_back(m.var_of_arc(arcs[i]));
+                pair.push_back(m.var_of_arc(arcs[j]));
+                const double div = division()(tr,
+                                              traxel_map[hypotheses.target(arcs[i])],
+                                              traxel_map[hypotheses.target(arcs[j])]);
+                add_feature( m, pair, both_on, div, Model::div_weight );
+                add_feature( m, pair, both_on, -moves[i] - moves[j], Model::mov_weight );
+                add_feature( m, pair, both_on, dis, Model::dis_weight );
             }
-            assert( coords.size() == table_dim );
-            OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), coords.begin(), forbidden_cost())
-            .add_to( *(m.opengm_model) );
         }
     }
-
-    LOG(logDEBUG) << "TrainableChaingraphModelBuilder::add_outgoing_factor(): leaving";
 }
 
 inline void TrainableModelBuilder::add_incoming_factor( const HypothesesGraph& hypotheses,
@@ -639,25 +711,26 @@ inline void TrainableModelBuilder::add_incoming_factor( const HypothesesGraph& h
         return;
     }
 
+    if( decomposed( vi.size() ) )
+    {
+        add_decomposed_incoming_factor( hypotheses, m, n );
+        return;
+    }
+
     //// construct factor
     const size_t table_dim = vi.size();
     const std::vector<size_t> shape(table_dim, 2);
     std::vector<size_t> coords;
 
-    std::set<size_t > entries;
-    for(size_t i = 0; i < static_cast<size_t>(std::pow(2., static_cast<int>(table_dim))); ++i)
-    {
-        entries.insert( entries.end(), i );
-    }
+    // all configurations not allowed below are forbidden
+    FactorTable forbidden( vi, forbidden_cost(), sparse_factor_dimension() );
 
     // allow opportunity configuration
     // (0,0,...,0)
     if(has_detection_vars())
     {
         coords = std::vector<size_t>(table_dim, 0);
-        size_t check = entries.erase(BinToDec(coords));
-        assert(check == 1);
-        _unused(check); // for build in release mode
+        forbidden.set_value( coords, 0 );
     }
 
     // appearance configuration
@@ -666,9 +739,7 @@ inline void TrainableModelBuilder::add_incoming_factor( const HypothesesGraph& h
     {
         coords[0] = 1; // (1,0,...,0)
     }
-    size_t check = entries.erase(BinToDec(coords));
-    assert(check == 1);
-    _unused(check); // for build in release mode
+    forbidden.set_value( coords, 0 );
     OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), coords.begin(), appearance()(traxel_map[n]) )
     .add_as_feature_to( *(m.opengm_model), m.weight_map[Model::app_weight].front() );
 
@@ -684,29 +755,36 @@ inline void TrainableModelBuilder::add_incoming_factor( const HypothesesGraph& h
     for(size_t i = assignment_begin; i < table_dim; ++i)
     {
         coords[i] = 1;
-        size_t check = entries.erase(BinToDec(coords));
-        assert(check == 1);
-        _unused(check); // for build in release mode
+        forbidden.set_value( coords, 0 );
         coords[i] = 0; // reset coords
     }
 
     // forbidden configurations
-    for(std::set<size_t>::iterator it = entries.begin(); it != entries.end(); ++it)
-    {
-        coords = DecToBin(*it);
-        // zero padding up to table dim
-        if(coords.size() < table_dim )
-        {
-            coords.insert(coords.begin(), table_dim - coords.size(), 0);
-        }
-        assert( coords.size() == table_dim );
-        OpengmWeightedFeature<OpengmModel::ValueType>(vi, shape.begin(), shape.end(), coords.begin(), forbidden_cost())
-        .add_to( *(m.opengm_model) );
-    }
+    forbidden.add_to( *(m.opengm_model) );
 
     LOG(logDEBUG) << "TrainableModelBuilder::add_incoming_factor(): leaving";
 }
 
+void TrainableModelBuilder::add_decomposed_incoming_factor( const HypothesesGraph& hypotheses,
+        Model& m,
+        const HypothesesGraph::Node& n ) const
+{
+    // appearance * det - sum_i arc_i * appearance; without detection vars the
+    // constant appearance is dropped, as the disappearance of the outgoing terms
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = hypotheses.get(node_traxel());
+    const double app = appearance()(traxel_map[n]);
+    const std::vector<size_t> on(1, 1);
+
+    if(has_detection_vars())
+    {
+        add_feature( m, std::vector<size_t>(1, m.var_of_node(n)), on, app, Model::app_weight );
+    }
+    for(HypothesesGraph::InArcIt a(hypotheses, n); a != lemon::INVALID; ++a)
+    {
+        add_feature( m, std::vector<size_t>(1, m.var_of_arc(a)), on, -app, Model::app_weight );
+    }
+}
+
 
 
 ////
@@ -731,7 +809,7 @@ Model* ECCV12ModelBuilder::build(const HypothesesGraph& hypotheses) const
 //	throw std::runtime_error("ECCV12ModelBuilder::build(): option without divisions not yet implemented");
 //      }
 
-    Model* model( new Model() );
+    std::auto_ptr<Model> model( new Model() );
 
     if( has_detection_vars() )
     {
@@ -754,7 +832,7 @@ Model* ECCV12ModelBuilder::build(const HypothesesGraph& hypotheses) const
         add_incoming_factor( hypotheses, *model, n );
     }
 
-    return model;
+    return model.release();
 }
 
 void ECCV12ModelBuilder::add_detection_factor( const HypothesesGraph& hypotheses, Model& m, const HypothesesGraph::Node& n) const
@@ -795,6 +873,12 @@ inline void ECCV12ModelBuilder::add_outgoing_factor( const HypothesesGraph& hypo
         ++count;
     }
 
+    if( decomposed( vi.size() ) )
+    {
+        add_decomposed_outgoing_factor( hypotheses, m, n, arcs );
+        return;
+    }
+
     // construct factor
     if(count == 0)
     {
@@ -820,7 +904,7 @@ inline void ECCV12ModelBuilder::add_outgoing_factor( const HypothesesGraph& hypo
         // no division possible
         size_t table_dim = 2; 		// detection var + 1 * transition var
         std::vector<size_t> coords;
-        OpengmExplicitFactor<double> table( vi, forbidden_cost() );
+        FactorTable table( vi, forbidden_cost(), sparse_factor_dimension() );
 
         // opportunity configuration
         coords = std::vector<size_t>(table_dim, 0); // (0,0)
@@ -844,7 +928,7 @@ inline void ECCV12ModelBuilder::add_outgoing_factor( const HypothesesGraph& hypo
         // build value table
         size_t table_dim = count + 1; 		// detection var + n * transition var
         std::vector<size_t> coords;
-        OpengmExplicitFactor<double> table( vi, forbidden_cost() );
+        FactorTable table( vi, forbidden_cost(), sparse_factor_dimension() );
 
         // opportunity configuration
         coords = std::vector<size_t>(table_dim, 0); // (0,0,...,0)
@@ -896,6 +980,46 @@ inline void ECCV12ModelBuilder::add_outgoing_factor( const HypothesesGraph& hypo
     LOG(logDEBUG) << "ChaingraphECCV12ModelBuilder::add_outgoing_factor(): leaving";
 }
 
+void ECCV12ModelBuilder::add_decomposed_outgoing_factor( const HypothesesGraph& hypotheses,
+        Model& m,
+        const HypothesesGraph::Node& n,
+        const vector<HypothesesGraph::Arc>& arcs ) const
+{
+    // Same energies as the table of add_outgoing_factor() for every
+    // configuration add_hard_constraints() leaves feasible: at most one arc on
+    // (two for a division) and none without detection.
+    //   opportunity * (1 - det) + disappearance * det
+    //   + sum_i arc_i * (move_i - disappearance)
+    //   + sum_i<j arc_i * arc_j * (division_ij - move_i - move_j + disappearance)
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = hypotheses.get(node_traxel());
+    const Traxel& tr = traxel_map[n];
+    const double dis = disappearance()(tr);
+
+    add_unary( *m.opengm_model, m.var_of_node(n), opportunity_cost(), dis );
+
+    std::vector<double> moves;
+    for(size_t i = 0; i < arcs.size(); ++i)
+    {
+        moves.push_back( move()(tr, traxel_map[hypotheses.target(arcs[i])]) );
+        add_unary( *m.opengm_model, m.var_of_arc(arcs[i]), 0, moves[i] - dis );
+    }
+
+    if(has_divisions())
+    {
+        for(size_t i = 0; i < arcs.size(); ++i)
+        {
+            for(size_t j = i + 1; j < arcs.size(); ++j)
+            {
+                const double div = division()(tr,
+                                              traxel_map[hypotheses.target(arcs[i])],
+                                              traxel_map[hypotheses.target(arcs[j])]);
+                add_both_on( *m.opengm_model, m.var_of_arc(arcs[i]), m.var_of_arc(arcs[j]),
+                             div - moves[i] - moves[j] + dis );
+            }
+        }
+    }
+}
+
 inline void ECCV12ModelBuilder::add_incoming_factor( const HypothesesGraph& hypotheses,
         Model& m,
         const HypothesesGraph::Node& n) const
@@ -915,10 +1039,16 @@ inline void ECCV12ModelBuilder::add_incoming_factor( const HypothesesGraph& hypo
     vi.push_back(m.var_of_node(n));
     std::reverse(vi.begin(), vi.end());
 
+    if( decomposed( vi.size() ) )
+    {
+        add_decomposed_incoming_factor( hypotheses, m, n );
+        return;
+    }
+
     //// construct factor
     // build value table
     size_t table_dim = count + 1; // detection var + n * transition var
-    OpengmExplicitFactor<double> table( vi, forbidden_cost() );
+    FactorTable table( vi, forbidden_cost(), sparse_factor_dimension() );
     std::vector<size_t> coords;
 
     // allow opportunity configuration
@@ -946,6 +1076,21 @@ inline void ECCV12ModelBuilder::add_incoming_factor( const HypothesesGraph& hypo
     table.add_to( *m.opengm_model );
     LOG(logDEBUG) << "ECCV12ModelBuilder::add_incoming_factor(): leaving";
 }
+
+void ECCV12ModelBuilder::add_decomposed_incoming_factor( const HypothesesGraph& hypotheses,
+        Model& m,
+        const HypothesesGraph::Node& n) const
+{
+    // appearance * det - sum_i arc_i * appearance, see add_decomposed_outgoing_factor()
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = hypotheses.get(node_traxel());
+    const double app = appearance()(traxel_map[n]);
+
+    add_unary( *m.opengm_model, m.var_of_node(n), 0, app );
+    for(HypothesesGraph::InArcIt a(hypotheses, n); a != lemon::INVALID; ++a)
+    {
+        add_unary( *m.opengm_model, m.var_of_arc(a), 0, -app );
+    }
+}
 #endif
 } /* namespace chaingraph */
 } /* namespace pgm */
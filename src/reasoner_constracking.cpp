@@ -14,6 +14,7 @@
 #include <boost/python.hpp>
 
 #include "pgmlink/hypotheses.h"
+#include "pgmlink/instrumentation.h"
 #include "pgmlink/log.h"
 #include "pgmlink/reasoner_constracking.h"
 #include "pgmlink/tracking.h"
@@ -242,7 +243,9 @@ HypothesesGraph* ConservationTracking::get_prepared_graph(HypothesesGraph & hypo
     if (with_tracklets_)
     {
         LOG(logINFO) << "ConservationTracking::perturbedInference: generating tracklet graph";
-        tracklet2traxel_node_map_ = generateTrackletGraph2(hypotheses, tracklet_graph_);
+        StageTimer stage_timer("build_tracklet_graph");
+        boost::shared_ptr<const TrackletView> tracklets = generateTrackletView(hypotheses, tracklet_graph_);
+        tracklet2traxel_node_map_ = tracklets->tracklet2traxel_node_map();
         graph = &tracklet_graph_;
     }
     else
@@ -255,6 +258,7 @@ HypothesesGraph* ConservationTracking::get_prepared_graph(HypothesesGraph & hypo
     // additional preparations
     if(solver_ == SolverType::FlowSolver)
     {
+        StageTimer stage_timer("compute_energies");
         EnergyComputer computeAndStoreEnergies(param_, true);
 
         // get any traxel from the original hypotheses graph
@@ -352,7 +356,10 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
     inference_model->param_.transition_weight = transition_weight_;
 
     // build inference model
-    inference_model->build_from_graph(*graph);
+    {
+        StageTimer stage_timer("build_inference_model");
+        inference_model->build_from_graph(*graph);
+    }
 
     // fix some node values beforehand
     if(use_app_node_labels_to_fix_values_)
@@ -369,6 +376,7 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
 
     if(solver_ == SolverType::CplexSolver)
     {
+        StageTimer stage_timer("set_inference_params");
         if(with_structured_learning_){
             boost::static_pointer_cast<ConsTrackingInferenceModel>(inference_model)->set_inference_params(
                 numberOfSolutions,
@@ -394,10 +402,16 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
 #endif
 
     // run inference & conclude
-    solutions_.push_back(inference_model->infer());
+    {
+        StageTimer stage_timer("solve");
+        solutions_.push_back(inference_model->infer());
+    }
 
     LOG(logINFO) << "conclude MAP";
-    inference_model->conclude(hypotheses, tracklet_graph_, tracklet2traxel_node_map_, solutions_.back());
+    {
+        StageTimer stage_timer("conclude");
+        inference_model->conclude(hypotheses, tracklet_graph_, tracklet2traxel_node_map_, solutions_.back());
+    }
 
     // print solution energies
 #ifndef NO_ILP
@@ -415,6 +429,7 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
         solutions_.push_back(boost::static_pointer_cast<ConsTrackingInferenceModel>(
                                  inference_model)->extractSolution(k, get_export_filename(k, labels_export_file_name_)));
 
+        StageTimer stage_timer("conclude");
         inference_model->conclude(hypotheses, tracklet_graph_, tracklet2traxel_node_map_, solutions_.back());
     }
 #endif
@@ -430,9 +445,46 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
         boost::shared_ptr<Perturbation> perturbation = create_perturbation();
         boost::shared_ptr<InferenceModel> perturbed_inference_model;
 
+#ifndef NO_ILP
+        // diverse m-best only changes energies, so the MAP model and its constraints can be kept
+        const bool persistent_solver = param_.persistent_solver
+                                       && uncertainty_param_.distributionId == DiverseMbest
+                                       && solver_ == SolverType::CplexSolver
+                                       && !with_structured_learning_;
+#endif
+
         for (size_t iterStep = 1; iterStep < numberOfIterations; ++iterStep)
         {
             LOG(logDEBUG) << "------------> Beginning Iteration " << iterStep << " <-----------\n";
+#ifndef NO_ILP
+            if (persistent_solver)
+            {
+                boost::shared_ptr<ConsTrackingInferenceModel> constrack_inference_model =
+                    boost::static_pointer_cast<ConsTrackingInferenceModel>(inference_model);
+                {
+                    StageTimer stage_timer("set_inference_params");
+                    constrack_inference_model->push_away_from_solution(solutions_.back(),
+                                                                       uncertainty_param_.distributionParam);
+                    constrack_inference_model->set_inference_params(1,
+                                                                    get_export_filename(iterStep, features_file_),
+                                                                    "",
+                                                                    get_export_filename(iterStep, labels_export_file_name_));
+                    // the previous solution satisfies all constraints, only its energy went up
+                    constrack_inference_model->set_starting_point(solutions_.back());
+                }
+                {
+                    StageTimer stage_timer("solve");
+                    solutions_.push_back(constrack_inference_model->infer());
+                }
+                LOG(logINFO) << "conclude iteration " << iterStep;
+                StageTimer stage_timer("conclude");
+                constrack_inference_model->conclude(hypotheses,
+                                                    tracklet_graph_,
+                                                    tracklet2traxel_node_map_,
+                                                    solutions_.back());
+                continue;
+            }
+#endif
             if (uncertainty_param_.distributionId == DiverseMbest)
             {
 #ifndef NO_ILP
@@ -451,7 +503,10 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
             perturbed_inference_model = create_perturbed_inference_model(perturbation);
 
             perturbed_inference_model->use_transition_prediction_cache(inference_model.get());
-            perturbed_inference_model->build_from_graph(*graph);
+            {
+                StageTimer stage_timer("build_inference_model");
+                perturbed_inference_model->build_from_graph(*graph);
+            }
 
             // fix some node values beforehand
             if(use_app_node_labels_to_fix_values_)
@@ -462,6 +517,7 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
 #ifndef NO_ILP
             if(solver_ == SolverType::CplexSolver)
             {
+                StageTimer stage_timer("set_inference_params");
                 boost::static_pointer_cast<ConsTrackingInferenceModel>(perturbed_inference_model)->set_inference_params(1,
                                                                 get_export_filename(iterStep, features_file_),
                                                                 "",
@@ -469,8 +525,12 @@ void ConservationTracking::perturbedInference(HypothesesGraph & hypotheses, bool
             }
 #endif
 
-            solutions_.push_back(perturbed_inference_model->infer());
+            {
+                StageTimer stage_timer("solve");
+                solutions_.push_back(perturbed_inference_model->infer());
+            }
             LOG(logINFO) << "conclude iteration " << iterStep;
+            StageTimer stage_timer("conclude");
             perturbed_inference_model->conclude(hypotheses,
                                                 tracklet_graph_,
                                                 tracklet2traxel_node_map_,
@@ -495,16 +555,7 @@ void ConservationTracking::compute_relative_uncertainty(HypothesesGraph* graph)
     property_map<relative_uncertainty, HypothesesGraph::base_graph>::type &rel_uncertainty = graph->get(relative_uncertainty());
     for (HypothesesGraph::NodeIt n(*graph); n != lemon::INVALID; ++n)
     {
-        double count = 0;
-        auto *active_list = &active_nodes.get_value(n);
-        for (auto is_active = active_list->begin(); is_active != active_list->end(); is_active++)
-        {
-            if (*is_active != 0)
-            {
-                ++count;
-            }
-        }
-
+        double count = active_nodes.count_nonzero(n);
         rel_uncertainty.set(n, count / uncertainty_param_.numberOfIterations);
     }
 }
@@ -61,7 +61,9 @@ void Chaingraph::formulate( const HypothesesGraph& hypotheses )
     LOG(logDEBUG) << "Chaingraph::formulate: entered";
     reset();
 
-    // build the model
+    // build the model; large factors are only decomposed if the hard
+    // constraints exclude their forbidden configurations
+    builder_->decompose_large_factors( with_constraints_ );
     linking_model_ = boost::shared_ptr<pgm::chaingraph::Model>(builder_->build(hypotheses));
 
     // refine the model with hard constraints
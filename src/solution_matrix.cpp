@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "pgmlink/solution_matrix.h"
+
+namespace pgmlink
+{
+
+////
+//// class PackedMatrix
+////
+PackedMatrix::PackedMatrix(unsigned int bits)
+    : bits_(1), rows_(0), columns_(0), words_per_row_(0)
+{
+    while (bits_ < bits && bits_ < 64)
+    {
+        bits_ *= 2;
+    }
+}
+
+void PackedMatrix::resize(size_t rows, size_t columns)
+{
+    if (columns == columns_)
+    {
+        // rows are contiguous, no need to move anything
+        rows_ = rows;
+        words_.resize(rows_ * words_per_row_, 0);
+    }
+    else
+    {
+        relayout(bits_, rows, columns);
+    }
+}
+
+void PackedMatrix::clear()
+{
+    rows_ = 0;
+    columns_ = 0;
+    words_per_row_ = 0;
+    words_.clear();
+}
+
+void PackedMatrix::set(size_t row, size_t column, uint64_t value)
+{
+    if (row >= rows_ || column >= columns_)
+    {
+        throw std::out_of_range("PackedMatrix::set(): entry outside the matrix");
+    }
+    if (bits_ < 64 && value >> bits_ != 0)
+    {
+        unsigned int bits = bits_;
+        while (bits < 64 && value >> bits != 0)
+        {
+            bits *= 2;
+        }
+        relayout(bits, rows_, columns_);
+    }
+    const size_t bit = column * bits_;
+    uint64_t& word = words_[row * words_per_row_ + bit / 64];
+    if (bits_ == 64)
+    {
+        word = value;
+    }
+    else
+    {
+        const uint64_t mask = ((uint64_t(1) << bits_) - 1) << (bit % 64);
+        word = (word & ~mask) | (value << (bit % 64));
+    }
+}
+
+size_t PackedMatrix::count_nonzero(size_t column) const
+{
+    size_t count = 0;
+    for (size_t row = 0; row < rows_; ++row)
+    {
+        if (get(row, column) != 0)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void PackedMatrix::relayout(unsigned int bits, size_t rows, size_t columns)
+{
+    PackedMatrix other(bits);
+    other.rows_ = rows;
+    other.columns_ = columns;
+    other.words_per_row_ = (columns * other.bits_ + 63) / 64;
+    other.words_.assign(rows * other.words_per_row_, 0);
+    const size_t common_rows = std::min(rows, rows_);
+    const size_t common_columns = std::min(columns, columns_);
+    for (size_t row = 0; row < common_rows; ++row)
+    {
+        for (size_t column = 0; column < common_columns; ++column)
+        {
+            const uint64_t value = get(row, column);
+            if (value != 0)
+            {
+                other.set(row, column, value);
+            }
+        }
+    }
+    std::swap(bits_, other.bits_);
+    std::swap(rows_, other.rows_);
+    std::swap(columns_, other.columns_);
+    std::swap(words_per_row_, other.words_per_row_);
+    words_.swap(other.words_);
+}
+
+} /* namespace pgmlink */
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/tuple/tuple.hpp>
+
+#include "pgmlink/features/featurestore.h"
+#include "pgmlink/log.h"
+#include "pgmlink/spatial_tiling.h"
+#include "pgmlink/util.h"
+
+namespace pgmlink
+{
+
+////
+//// class SpatialTiling
+////
+SpatialTiling::SpatialTiling(const FieldOfView& fov,
+                             size_t n_x,
+                             size_t n_y,
+                             size_t n_z,
+                             double halo)
+    : fov_(fov), halo_(halo)
+{
+    if (n_x == 0 || n_y == 0 || n_z == 0)
+    {
+        throw std::runtime_error("SpatialTiling: need at least one tile per dimension");
+    }
+    if (halo < 0.)
+    {
+        throw std::runtime_error("SpatialTiling: halo must not be negative");
+    }
+    n_[0] = n_x;
+    n_[1] = n_y;
+    n_[2] = n_z;
+}
+
+FieldOfView SpatialTiling::core(size_t k) const
+{
+    if (k >= size())
+    {
+        throw std::runtime_error("SpatialTiling::core(): tile index out of range");
+    }
+    const size_t index[3] = {k % n_[0], (k / n_[0]) % n_[1], k / (n_[0] * n_[1])};
+    const std::vector<double>& lb = fov_.lower_bound();
+    const std::vector<double>& ub = fov_.upper_bound();
+    double lower[3], upper[3];
+    for (size_t d = 0; d < 3; ++d)
+    {
+        const double width = (ub[d + 1] - lb[d + 1]) / n_[d];
+        lower[d] = lb[d + 1] + index[d] * width;
+        upper[d] = index[d] + 1 == n_[d] ? ub[d + 1] : lb[d + 1] + (index[d] + 1) * width;
+    }
+    return FieldOfView(lb[0], lower[0], lower[1], lower[2], ub[0], upper[0], upper[1], upper[2]);
+}
+
+FieldOfView SpatialTiling::tile(size_t k) const
+{
+    const FieldOfView c = core(k);
+    const std::vector<double>& lb = fov_.lower_bound();
+    const std::vector<double>& ub = fov_.upper_bound();
+    double lower[3], upper[3];
+    for (size_t d = 0; d < 3; ++d)
+    {
+        lower[d] = std::max(lb[d + 1], c.lower_bound()[d + 1] - halo_);
+        upper[d] = std::min(ub[d + 1], c.upper_bound()[d + 1] + halo_);
+    }
+    return FieldOfView(lb[0], lower[0], lower[1], lower[2], ub[0], upper[0], upper[1], upper[2]);
+}
+
+size_t SpatialTiling::grid_index(size_t dim, double coordinate) const
+{
+    const double lower = fov_.lower_bound()[dim + 1];
+    const double width = (fov_.upper_bound()[dim + 1] - lower) / n_[dim];
+    if (width <= 0. || coordinate <= lower)
+    {
+        return 0;
+    }
+    return std::min(static_cast<size_t>(std::floor((coordinate - lower) / width)), n_[dim] - 1);
+}
+
+size_t SpatialTiling::owner(double x, double y, double z) const
+{
+    return (grid_index(2, z) * n_[1] + grid_index(1, y)) * n_[0] + grid_index(0, x);
+}
+
+size_t SpatialTiling::extract(const TraxelStore& in, TraxelStore& out, size_t k) const
+{
+    TraxelStore shared;
+    const size_t n = filter_by_fov(in, shared, tile(k));
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    for (TraxelStore::const_iterator it = shared.begin(); it != shared.end(); ++it)
+    {
+        Traxel traxel(*it);
+        const FeatureMap features = it->features.get();
+        traxel.set_feature_store(fs);
+        fs->get_traxel_features(traxel) = features;
+        out.get<by_timestep>().insert(traxel);
+    }
+    return n;
+}
+
+////
+//// tiled tracking
+////
+namespace
+{
+const Traxel& find_traxel(const TraxelStore& ts, int timestep, size_t id)
+{
+    TraxelStoreByTimeid::const_iterator it = ts.get<by_timeid>().find(
+                boost::make_tuple(timestep, static_cast<unsigned int>(id)));
+    if (it == ts.get<by_timeid>().end())
+    {
+        throw std::runtime_error("merge_tiled_events(): traxel " + boost::lexical_cast<std::string>(id)
+                                 + " at timestep " + boost::lexical_cast<std::string>(timestep)
+                                 + " not in traxelstore");
+    }
+    return *it;
+}
+
+size_t owner_of(const SpatialTiling& tiling, const Traxel& traxel)
+{
+    return tiling.owner(traxel.X(), traxel.Y(), traxel.Z());
+}
+
+bool is_link(const Event& e)
+{
+    return e.type == Event::Move || e.type == Event::Division;
+}
+
+/// the traxel owning an event, which is at the timestep the event arrives at or the one before
+bool anchor_of(const Event& e, size_t& id, int& timestep_offset)
+{
+    if (e.type == Event::Void || e.traxel_ids.empty())
+    {
+        return false;
+    }
+    id = e.traxel_ids[0];
+    const bool from_previous = is_link(e) || e.type == Event::Disappearance || e.type == Event::MultiFrameMove;
+    timestep_offset = from_previous ? -1 : 0;
+    return true;
+}
+
+Event make_event(Event::EventType type, const std::vector<size_t>& traxel_ids)
+{
+    Event e;
+    e.type = type;
+    e.traxel_ids = traxel_ids;
+    return e;
+}
+} // end anonymous namespace
+
+EventVectorVector merge_tiled_events(const TraxelStore& ts,
+                                     const SpatialTiling& tiling,
+                                     const std::vector<EventVectorVector>& tile_events)
+{
+    if (tile_events.size() != tiling.size())
+    {
+        throw std::runtime_error("merge_tiled_events(): need the events of every tile");
+    }
+    if (ts.empty())
+    {
+        return EventVectorVector();
+    }
+    const int earliest = earliest_timestep(ts);
+    const int num_timesteps = latest_timestep(ts) - earliest + 1;
+
+    // the events of a tile are indexed from the earliest timestep of the tile
+    std::vector<FieldOfView> tiles;
+    for (size_t k = 0; k < tiling.size(); ++k)
+    {
+        tiles.push_back(tiling.tile(k));
+    }
+    std::vector<int> tile_earliest(tiling.size(), std::numeric_limits<int>::max());
+    for (TraxelStore::const_iterator it = ts.begin(); it != ts.end(); ++it)
+    {
+        const double x = it->X(), y = it->Y(), z = it->Z();
+        for (size_t k = 0; k < tiling.size(); ++k)
+        {
+            if (it->Timestep < tile_earliest[k] && tiles[k].contains(it->Timestep, x, y, z))
+            {
+                tile_earliest[k] = it->Timestep;
+            }
+        }
+    }
+
+    // take every event from the tile that owns it
+    EventVectorVector result(num_timesteps);
+    std::vector<std::vector<size_t> > tile_of(num_timesteps);
+    // traxels linked by their own tile through an event owned by another one
+    std::vector<std::set<size_t> > linked_by_owner(num_timesteps);
+    for (size_t k = 0; k < tiling.size(); ++k)
+    {
+        for (size_t i = 0; i < tile_events[k].size(); ++i)
+        {
+            if (tile_events[k][i].empty())
+            {
+                continue;
+            }
+            const int t = tile_earliest[k] + static_cast<int>(i);
+            if (tile_earliest[k] == std::numeric_limits<int>::max() || t - earliest >= num_timesteps)
+            {
+                throw std::runtime_error("merge_tiled_events(): events of tile "
+                                         + boost::lexical_cast<std::string>(k)
+                                         + " exceed the timesteps of its traxels");
+            }
+            for (EventVector::const_iterator e = tile_events[k][i].begin(); e != tile_events[k][i].end(); ++e)
+            {
+                size_t id;
+                int offset;
+                if (!anchor_of(*e, id, offset))
+                {
+                    continue;
+                }
+                if (owner_of(tiling, find_traxel(ts, t + offset, id)) == k)
+                {
+                    result[t - earliest].push_back(*e);
+                    tile_of[t - earliest].push_back(k);
+                }
+                else if (is_link(*e))
+                {
+                    for (size_t j = 1; j < e->traxel_ids.size(); ++j)
+                    {
+                        if (owner_of(tiling, find_traxel(ts, t, e->traxel_ids[j])) == k)
+                        {
+                            linked_by_owner[t - earliest].insert(e->traxel_ids[j]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // reconcile the links into the halos
+    for (int i = 0; i < num_timesteps; ++i)
+    {
+        const int t = earliest + i;
+        EventVector& events = result[i];
+
+        std::map<size_t, std::vector<size_t> > parents_of;
+        for (size_t n = 0; n < events.size(); ++n)
+        {
+            if (is_link(events[n]))
+            {
+                for (size_t j = 1; j < events[n].traxel_ids.size(); ++j)
+                {
+                    parents_of[events[n].traxel_ids[j]].push_back(n);
+                }
+            }
+        }
+        for (std::map<size_t, std::vector<size_t> >::const_iterator child = parents_of.begin();
+                child != parents_of.end(); ++child)
+        {
+            const std::vector<size_t>& claims = child->second;
+            if (claims.size() < 2)
+            {
+                continue;
+            }
+            const size_t owner = owner_of(tiling, find_traxel(ts, t, child->first));
+            size_t winner = claims[0];
+            for (size_t c = 0; c < claims.size(); ++c)
+            {
+                if (tile_of[i][claims[c]] == owner)
+                {
+                    winner = claims[c];
+                    break;
+                }
+            }
+            LOG(logDEBUG1) << "merge_tiled_events(): traxel " << child->first << " at timestep " << t
+                           << " claimed by " << claims.size() << " parents";
+            for (size_t c = 0; c < claims.size(); ++c)
+            {
+                if (claims[c] != winner)
+                {
+                    std::vector<size_t>& ids = events[claims[c]].traxel_ids;
+                    ids.erase(std::find(ids.begin() + 1, ids.end(), child->first));
+                }
+            }
+        }
+
+        // links that lost children, appearances of traxels that are linked
+        // after all or that lost their parent
+        std::set<size_t> linked;
+        for (EventVector::iterator e = events.begin(); e != events.end(); ++e)
+        {
+            if (!is_link(*e))
+            {
+                continue;
+            }
+            if (e->traxel_ids.size() == 1)
+            {
+                *e = make_event(Event::Disappearance, e->traxel_ids);
+            }
+            else if (e->type == Event::Division && e->traxel_ids.size() == 2)
+            {
+                *e = make_event(Event::Move, e->traxel_ids);
+            }
+            linked.insert(e->traxel_ids.begin() + 1, e->traxel_ids.end());
+        }
+        EventVector merged;
+        merged.reserve(events.size());
+        std::set<size_t> appeared;
+        for (EventVector::const_iterator e = events.begin(); e != events.end(); ++e)
+        {
+            if (e->type == Event::Appearance)
+            {
+                if (linked.count(e->traxel_ids[0]) > 0)
+                {
+                    continue;
+                }
+                appeared.insert(e->traxel_ids[0]);
+            }
+            merged.push_back(*e);
+        }
+        for (std::set<size_t>::const_iterator id = linked_by_owner[i].begin(); id != linked_by_owner[i].end(); ++id)
+        {
+            if (linked.count(*id) == 0 && appeared.count(*id) == 0)
+            {
+                merged.push_back(make_event(Event::Appearance, std::vector<size_t>(1, *id)));
+            }
+        }
+        events.swap(merged);
+    }
+    return result;
+}
+
+EventVectorVector track_tiled(const TraxelStore& ts,
+                              const SpatialTiling& tiling,
+                              const TileTracker& tracker,
+                              bool parallel)
+{
+    const int num_tiles = static_cast<int>(tiling.size());
+    LOG(logINFO) << "track_tiled(): tracking " << ts.size() << " traxels in " << num_tiles
+                 << " tiles with a halo of " << tiling.halo();
+
+    // extracting reads the shared feature store, which is not thread safe
+    std::vector<TraxelStore> tile_stores(num_tiles);
+    for (int k = 0; k < num_tiles; ++k)
+    {
+        tiling.extract(ts, tile_stores[k], k);
+    }
+
+    std::vector<EventVectorVector> tile_events(num_tiles);
+    ParallelExceptions exceptions(num_tiles);
+    #pragma omp parallel for schedule(dynamic) if(parallel)
+    for (int k = 0; k < num_tiles; ++k)
+    {
+        try
+        {
+            if (!tile_stores[k].empty())
+            {
+                tile_events[k] = tracker(tile_stores[k]);
+            }
+        }
+        catch (...)
+        {
+            exceptions.capture(k);
+        }
+    }
+    exceptions.rethrow();
+
+    return merge_tiled_events(ts, tiling, tile_events);
+}
+
+} // namespace pgmlink
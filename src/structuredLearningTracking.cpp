@@ -46,6 +46,7 @@
 #include "pgmlink/tracking.h"
 #include <boost/python.hpp>
 #include "pgmlink/field_of_view.h"
+#include "pgmlink/bounding_box_index.h"
 
 #include <stdio.h>
 
@@ -129,13 +130,11 @@ boost::shared_ptr<InferenceModel> StructuredLearningTracking::create_inference_m
         bool withNormalization)
 {
 
-    ep_gap_ = param.ep_gap;
-    cplex_timeout_ = param.cplex_timeout;
-
+        // no member writes here, this is called concurrently for the crops in structuredLearning()
         return boost::make_shared<StructuredLearningTrackingInferenceModel>(
             param,
-            ep_gap_,
-            cplex_timeout_,
+            param.ep_gap,
+            param.cplex_timeout,
             trackingWeights,
             withNormalization,
             fov_,
@@ -540,150 +539,114 @@ void StructuredLearningTracking::structuredLearning(
 
     DSS sltDataset(crops_, trackingWeights_);
 
-    typedef property_map<node_timestep, HypothesesGraph::base_graph>::type node_timestep_map_t;
-    typedef property_map<node_traxel, HypothesesGraph::base_graph>::type node_traxel_map;
-    node_traxel_map& traxel_map = hypotheses_graph_->get(node_traxel());
-    HypothesesGraph::node_timestep_map& timestep_map = hypotheses_graph_->get(node_timestep());
+    std::vector<boost::shared_ptr<HypothesesGraph>> hypothesesSubGraph(numCrops_);
+    std::vector<HypothesesGraph*> graph(numCrops_);
+    std::vector<boost::shared_ptr<InferenceModel>> inference_model(numCrops_);
 
-    property_map<traxel_arc_id, HypothesesGraph::base_graph>::type& arc_id_map = hypotheses_graph_->get(traxel_arc_id());
+    // the parameters are the same for all crops, and the transition classifier is a python object
+    LOG(logINFO) << "[StructuredLearningTracking] Control print: parameters";
+    Parameter param = get_structured_learning_tracking_parameters(
+        forbidden_cost,
+        ep_gap,
+        with_tracklets,
+        detection_weight,
+        division_weight,
+        transition_weight,
+        disappearance_cost,
+        appearance_cost,
+        with_merger_resolution,
+        n_dim,
+        transition_parameter,
+        border_width,
+        with_constraints,
+        uncertaintyParam,
+        cplex_timeout,
+        transition_classifier,
+        solver_,
+        false,
+        num_threads,
+        withNormalization,
+        withClassifierPrior,
+        verbose,
+        withNonNegativeWeights);
+    uncertainty_param_ = uncertaintyParam;
+    ep_gap_ = param.ep_gap;
+    cplex_timeout_ = param.cplex_timeout;
 
-    std::vector<boost::shared_ptr<HypothesesGraph>> hypothesesSubGraph;
-    std::vector<HypothesesGraph*> graph;
-    std::vector<boost::shared_ptr<InferenceModel>> inference_model;
-        
-    // set up graphical models in parallel
-    #ifdef WITH_OPENMP
-    omp_lock_t modelLock;
-    omp_init_lock(&modelLock);
-    #pragma omp parallel for
-    #endif
+    // select the crop subgraphs sequentially: this attaches maps to the shared hypotheses graph
+    BoundingBoxIndex bounding_boxes(*hypotheses_graph_, ndim_);
     for(size_t m=0; m<numCrops_; ++m){
-        LOG(logINFO) << "\n\n GRAPHICAL MODEL.............. " << m << "\n";
-
-        // lock the model
-        #ifdef WITH_OPENMP
-        omp_set_lock(&modelLock);
-        sltDataset.lockModel(m);
-        omp_unset_lock(&modelLock);
-        #else
-        sltDataset.lockModel(m);
-        #endif
-
-        HypothesesGraph::base_graph::NodeMap<bool> selected_nodes(*hypotheses_graph_);
-        for (HypothesesGraph::NodeIt n(*hypotheses_graph_); n != lemon::INVALID; ++n)
-            selected_nodes[n] = false;
-
         LOG(logINFO) << "[StructuredLearningTracking] Control print: select crop nodes";
-        int count = 0;
-        for(int t = crops_[m].lower_bound()[0]; t <= crops_[m].upper_bound()[0]; ++t)
+        HypothesesGraph::base_graph::NodeMap<bool> selected_nodes(*hypotheses_graph_, false);
+        std::vector<HypothesesGraph::Node> crop_nodes = bounding_boxes.query(crops_[m]);
+        for(std::vector<HypothesesGraph::Node>::const_iterator n = crop_nodes.begin(); n != crop_nodes.end(); ++n)
         {
-            for(node_timestep_map_t::ItemIt node(timestep_map, t); node != lemon::INVALID; ++node){
-
-                if(ndim_==2 &&
-                   crops_[m].lower_bound()[1] <= traxel_map[node].X_max() && traxel_map[node].X_min() <= crops_[m].upper_bound()[1] &&
-                   crops_[m].lower_bound()[2] <= traxel_map[node].Y_max() && traxel_map[node].Y_min() <= crops_[m].upper_bound()[2] ||
-                   ndim_==3 &&
-                   crops_[m].lower_bound()[1] <= traxel_map[node].X_max() && traxel_map[node].X_min() <= crops_[m].upper_bound()[1] &&
-                   crops_[m].lower_bound()[2] <= traxel_map[node].Y_max() && traxel_map[node].Y_min() <= crops_[m].upper_bound()[2] &&
-                   crops_[m].lower_bound()[3] <= traxel_map[node].Z_max() && traxel_map[node].Z_min() <= crops_[m].upper_bound()[3] ){
-
-                    selected_nodes[node] = true;
-                    LOG(logDEBUG) << "node: " << traxel_map[node].Id << std::endl;
-                    LOG(logDEBUG) << traxel_map[node].X_min() << ", " << traxel_map[node].Y_min() << ", " << traxel_map[node].Z_min() << std::endl;
-                    LOG(logDEBUG) << traxel_map[node].X() << ", " << traxel_map[node].Y() << ", " << traxel_map[node].Z() << std::endl;
-                    LOG(logDEBUG) << traxel_map[node].X_max() << ", " << traxel_map[node].Y_max() << ", " << traxel_map[node].Z_max() << std::endl;
-
-                    count++;
-                }
-            }
+            selected_nodes[*n] = true;
         }
+        LOG(logDEBUG) << "crop " << m << ": " << crop_nodes.size() << " nodes";
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: select arcs";
-        HypothesesGraph::base_graph::ArcMap<bool> selected_arcs(*hypotheses_graph_);
-        for(HypothesesGraph::ArcIt a(*hypotheses_graph_); a != lemon::INVALID; ++a)
+        HypothesesGraph::base_graph::ArcMap<bool> selected_arcs(*hypotheses_graph_, false);
+        for(std::vector<HypothesesGraph::Node>::const_iterator n = crop_nodes.begin(); n != crop_nodes.end(); ++n)
         {
-            HypothesesGraph::Node from = hypotheses_graph_->source(a);
-            HypothesesGraph::Node to = hypotheses_graph_->target(a);
-
-            if(selected_nodes[from] && selected_nodes[to]){
-                selected_arcs[a] = true;
-            }
-            else{
-                selected_arcs[a] = false;
+            for(HypothesesGraph::OutArcIt a(*hypotheses_graph_, *n); a != lemon::INVALID; ++a)
+            {
+                selected_arcs[a] = selected_nodes[hypotheses_graph_->target(a)];
             }
         }
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: copy subgraph";
-        hypothesesSubGraph.push_back(boost::make_shared<HypothesesGraph>());
+        hypothesesSubGraph[m] = boost::make_shared<HypothesesGraph>();
         HypothesesGraph::copy_subgraph(*hypotheses_graph_, *(hypothesesSubGraph[m]),selected_nodes,selected_arcs);
+    }
 
-        LOG(logINFO) << "[StructuredLearningTracking] Control print: parameters";
-        Parameter param = get_structured_learning_tracking_parameters(
-            forbidden_cost,
-            ep_gap,
-            with_tracklets,
-            detection_weight,
-            division_weight,
-            transition_weight,
-            disappearance_cost,
-            appearance_cost,
-            with_merger_resolution,
-            n_dim,
-            transition_parameter,
-            border_width,
-            with_constraints,
-            uncertaintyParam,
-            cplex_timeout,
-            transition_classifier,
-            solver_,
-            false,
-            num_threads,
-            withNormalization,
-            withClassifierPrior,
-            verbose,
-            withNonNegativeWeights);
-        uncertainty_param_ = uncertaintyParam;
+    // set up graphical models in parallel, every iteration only touches crop m
+    #ifdef WITH_OPENMP
+    omp_lock_t modelLock;
+    omp_init_lock(&modelLock);
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for(int crop=0; crop<(int)numCrops_; ++crop){
+        const size_t m = crop;
+        LOG(logINFO) << "\n\n GRAPHICAL MODEL.............. " << m << "\n";
+
+        // lock the model; the dataset keeps the cache flags of all models
+        // in one std::vector<bool>, so this has to be serialized
+        #ifdef WITH_OPENMP
+        omp_set_lock(&modelLock);
+        sltDataset.lockModel(m);
+        omp_unset_lock(&modelLock);
+        #else
+        sltDataset.lockModel(m);
+        #endif
 
-        //param.transition = transition_;
         ConservationTracking pgm(param);
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: prepared graph";
 
-        graph.push_back( pgm.get_prepared_graph(*(hypothesesSubGraph[m])) );
-
-        size_t numNodes = 0;
-        for (HypothesesGraph::NodeIt n(*(graph[m])); n != lemon::INVALID; ++n)
-        {
-            ++numNodes;
-        }
-
-        size_t numArcs = 0;
-        for(HypothesesGraph::ArcIt a(*(graph[m])); a != lemon::INVALID; ++a)
-        {
-            ++numArcs;
-        }
-
-        LOG(logINFO) << "[StructuredLearningTracking] Control print: prepare tracking";
+        graph[m] = pgm.get_prepared_graph(*(hypothesesSubGraph[m]));
 
-        prepareTracking(pgm, param, sltDataset.getWeights(),withNormalization,withClassifierPrior);
         LOG(logINFO) << "[StructuredLearningTracking] Control print: get inference model";
-        inference_model.push_back(pgm.getInferenceModel());
+        inference_model[m] = create_inference_model(param, sltDataset.getWeights(), withNormalization);
+        pgm.setInferenceModel(inference_model[m]);
+        boost::shared_ptr<StructuredLearningTrackingInferenceModel> slt_inference_model =
+            boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m]);
 
-        boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->setModelStartTime(crops_[m].lower_bound()[0]);
-        boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->setModelEndTime(crops_[m].upper_bound()[0]);
+        slt_inference_model->setModelStartTime(crops_[m].lower_bound()[0]);
+        slt_inference_model->setModelEndTime(crops_[m].upper_bound()[0]);
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: build from graph";
         inference_model[m]->build_from_graph(*(graph[m]));
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: set inference parameters";
-        boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->set_inference_params(
+        slt_inference_model->set_inference_params(
             1,//numberOfSolutions,
             "",//get_export_filename(0, features_file_),
             "",//constraints_file_,
             "");//get_export_filename(0, labels_export_file_name_));
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: set graphical model";
-        sltDataset.setGraphicalModel(m, boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->model());
+        sltDataset.setGraphicalModel(m, slt_inference_model->model());
         sltDataset.resizeGTS(m);
 
         property_map< appearance_label, HypothesesGraph::base_graph>::type& appearance_labels = graph[m]->get(appearance_label());
@@ -691,81 +654,54 @@ void StructuredLearningTracking::structuredLearning(
         property_map< division_label, HypothesesGraph::base_graph>::type& division_labels = graph[m]->get(division_label());
         property_map< arc_label, HypothesesGraph::base_graph>::type& arc_labels = graph[m]->get(arc_label());
 
-        node_traxel_map& traxel_map_gm = graph[m]->get(node_traxel());
-        HypothesesGraph::node_timestep_map& timestep_map_gm = graph[m]->get(node_timestep());
-
         LOG(logINFO) << "[StructuredLearningTracking] Control print: arcs";
-        size_t number_of_transition_nodes = boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->get_number_of_transition_nodes();
+        size_t number_of_transition_nodes = slt_inference_model->get_number_of_transition_nodes();
         size_t indexArcs=0;
         for(HypothesesGraph::ArcIt a(*(graph[m])); a != lemon::INVALID; ++a)
         {
-            LabelType arc_label = arc_labels[a];
-
             sltDataset.setGTS(
                 m,
                 (size_t) indexArcs,
-                (size_t) arc_label);
-            //LOG(logINFO) << " arc node: " << traxel_map_gm[graph[m]->source(a)].Id << "---> " << traxel_map_gm[graph[m]->target(a)].Id << "     arc num" << indexArcs;
+                (size_t) arc_labels[a]);
             ++indexArcs;
         }
         assert ( indexArcs == number_of_transition_nodes);
 
-        LOG(logINFO) << "[StructuredLearningTracking] Control print: appearances";
-        size_t number_of_appearance_nodes = boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->get_number_of_appearance_nodes();
-        size_t indexAppNodes=0;
+        // ground truth of the node variables: appearances, then disappearances, then divisions,
+        // all set in the same pass over the nodes
+        LOG(logINFO) << "[StructuredLearningTracking] Control print: appearances, disappearances and divisions";
+        const size_t number_of_appearance_nodes = slt_inference_model->get_number_of_appearance_nodes();
+        const size_t number_of_disappearance_nodes = slt_inference_model->get_number_of_disappearance_nodes();
+        const bool with_divisions = slt_inference_model->param_.with_divisions;
+        const size_t number_of_nodes = lemon::countNodes(*(graph[m]));
+        const size_t appearance_offset = indexArcs;
+        const size_t disappearance_offset = appearance_offset + number_of_nodes;
+        const size_t division_offset = disappearance_offset + number_of_nodes;
+        size_t indexNodes=0;
+        size_t indexDivNodes=0;
         for (HypothesesGraph::NodeIt n(*(graph[m])); n != lemon::INVALID; ++n){
+            sltDataset.setGTS(m, appearance_offset + indexNodes, (size_t)appearance_labels[n]);
+            sltDataset.setGTS(m, disappearance_offset + indexNodes, (size_t)disappearance_labels[n]);
+            ++indexNodes;
 
-            sltDataset.setGTS(
-                m,
-                (size_t) indexArcs + indexAppNodes,
-                (size_t)appearance_labels[n]);
-            //LOG(logINFO) << "app. node: " << traxel_map_gm[n].Id << "    t " << timestep_map_gm[n] << "    node num " << indexArcs + indexAppNodes;
-            ++indexAppNodes;
-        }
-        assert ( indexAppNodes == number_of_appearance_nodes );
-
-        LOG(logINFO) << "[StructuredLearningTracking] Control print: disappearances";
-        size_t number_of_disappearance_nodes = boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->get_number_of_disappearance_nodes();
-        size_t indexDisAppNodes=0;
-        for (HypothesesGraph::NodeIt n(*(graph[m])); n != lemon::INVALID; ++n){
-
-            sltDataset.setGTS(
-                m,
-                (size_t) indexArcs + indexAppNodes + indexDisAppNodes,
-                (size_t)disappearance_labels[n]);
-            //LOG(logINFO) << "disapp. node: " << traxel_map_gm[n].Id << "    t " << timestep_map_gm[n] <<"    node num " << indexArcs + indexAppNodes + indexDisAppNodes;
-            ++indexDisAppNodes;
-        }
-        assert ( indexDisAppNodes == number_of_disappearance_nodes);
-
-        LOG(logINFO) << "[StructuredLearningTracking] Control print: divisions";
-        if(boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->param_.with_divisions){
-            size_t number_of_division_nodes = boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[m])->get_number_of_division_nodes();
-            std::vector<size_t> division_var_to_node_fun (number_of_division_nodes);
-            size_t indexDivNodes=0;
-            for (HypothesesGraph::NodeIt n(*(graph[m])); n != lemon::INVALID; ++n){
+            if(with_divisions){
                 size_t number_of_outarcs = 0;
-                for (HypothesesGraph::OutArcIt a(*(graph[m]), n); a != lemon::INVALID; ++a)
+                for (HypothesesGraph::OutArcIt a(*(graph[m]), n); a != lemon::INVALID && number_of_outarcs < 2; ++a)
                     ++number_of_outarcs;
                 if (number_of_outarcs > 1){
-                    division_var_to_node_fun[indexDivNodes] = traxel_map[n].Id;
-
-                    sltDataset.setGTS(
-                        m,
-                        (size_t) indexArcs + indexAppNodes + indexDisAppNodes + indexDivNodes,
-                        (size_t)division_labels[n]);
-                    //LOG(logINFO) << "div. node: " << traxel_map_gm[n].Id << "    t " << timestep_map_gm[n] <<"    node num " << indexArcs + indexAppNodes + indexDisAppNodes + indexDivNodes;
+                    sltDataset.setGTS(m, division_offset + indexDivNodes, (size_t)division_labels[n]);
                     ++indexDivNodes;
                 }
             }
-            assert ( indexDivNodes == number_of_division_nodes);
         }
+        assert ( number_of_nodes == number_of_appearance_nodes );
+        assert ( number_of_nodes == number_of_disappearance_nodes );
+        assert ( !with_divisions || indexDivNodes == slt_inference_model->get_number_of_division_nodes() );
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: build model with loss";
         sltDataset.build_model_with_loss(m);
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: unlock model";
-        // unlock the model
         #ifdef WITH_OPENMP
         omp_set_lock(&modelLock);
         sltDataset.unlockModel(m);
@@ -776,6 +712,13 @@ void StructuredLearningTracking::structuredLearning(
 
         LOG(logINFO) << "[StructuredLearningTracking] Control print: end model";
     } // for model m
+    #ifdef WITH_OPENMP
+    omp_destroy_lock(&modelLock);
+    #endif
+    if (numCrops_ > 0)
+    {
+        numWeights_ = boost::static_pointer_cast<StructuredLearningTrackingInferenceModel>(inference_model[0])->getLearningWeights().size();
+    }
 
     opengm::learning::StructMaxMargin<DSS>::Parameter para;
     para.optimizerParameter_.lambda = 1.00;
@@ -1,6 +1,7 @@
 #ifndef OPENGM_UNSIGNED_INTEGER_POW_HXX_
 #define OPENGM_UNSIGNED_INTEGER_POW_HXX_
 #endif
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <set>
@@ -28,12 +29,15 @@
 
 #include "pgmlink/pgm.h"
 #include "pgmlink/hypotheses.h"
+#include "pgmlink/linear_assignment.h"
+#include "pgmlink/instrumentation.h"
 #include "pgmlink/log.h"
 #include "pgmlink/reasoner_pgm.h"
 #include "pgmlink/reasoner_constracking.h"
 #include "pgmlink/merger_resolving.h"
 #include "pgmlink/structured_learning_tracking_dataset.h"
 #include "pgmlink/tracking.h"
+#include "pgmlink/util.h"
 #include <boost/python.hpp>
 
 #include <iso646.h> // for not, and, or on MSVC
@@ -270,6 +274,225 @@ std::vector<std::map<unsigned int, bool> > ChaingraphTracking::detections()
     }
 }
 
+////
+//// class NNTracking
+////
+namespace
+{
+// squared euclidean distance of two traxels over the given features
+double squared_feature_distance(const Traxel& from,
+                                const Traxel& to,
+                                const std::vector<std::string>& features)
+{
+    double distance = 0.;
+    for (std::vector<std::string>::const_iterator name = features.begin(); name != features.end(); ++name)
+    {
+        FeatureMap::const_iterator from_feature = from.features.find(*name);
+        FeatureMap::const_iterator to_feature = to.features.find(*name);
+        if (from_feature == from.features.end() || to_feature == to.features.end())
+        {
+            throw std::runtime_error("NNTracking: feature " + *name + " not in traxel");
+        }
+        if (from_feature->second.size() != to_feature->second.size())
+        {
+            throw std::runtime_error("NNTracking: feature " + *name + " differs in size between traxels");
+        }
+        for (size_t i = 0; i < from_feature->second.size(); ++i)
+        {
+            const double d = from_feature->second[i] - to_feature->second[i];
+            distance += d * d;
+        }
+    }
+    return distance;
+}
+
+struct DivisionCandidate
+{
+    DivisionCandidate(double distance, size_t parent, size_t child, HypothesesGraph::Arc arc)
+        : distance(distance), parent(parent), child(child), arc(arc)
+    {}
+
+    bool operator<(const DivisionCandidate& other) const
+    {
+        return distance < other.distance;
+    }
+
+    double distance;
+    size_t parent, child;
+    HypothesesGraph::Arc arc;
+};
+} // end anonymous namespace
+
+std::vector<std::vector<Event> > NNTracking::operator()(TraxelStore& ts)
+{
+    LOG(logINFO) << "Calling nearest neighbor tracking with the following parameters:\n"
+                 << "\tdivision distance: " << divDist_ << "\n"
+                 << "\tmove distance: " << movDist_ << "\n"
+                 << "\tdistance features: " << distanceFeatures_.size() << "\n"
+                 << "\tdivision threshold: " << divisionThreshold_;
+
+    if (ts.empty())
+    {
+        last_detections_ = boost::shared_ptr<std::vector<std::map<unsigned int, bool> > >(
+                               new std::vector<std::map<unsigned int, bool> >);
+        return std::vector<std::vector<Event> >();
+    }
+
+    std::vector<std::string> features(distanceFeatures_);
+    if (features.empty())
+    {
+        features.push_back("com");
+    }
+    const double max_move = movDist_ * movDist_;
+    const double max_division = divDist_ * divDist_;
+
+    LOG(logDEBUG) << "NNTracking: building hypotheses";
+    SingleTimestepTraxel_HypothesesBuilder::Options builder_opts(6, std::max(divDist_, movDist_));
+    SingleTimestepTraxel_HypothesesBuilder hyp_builder(&ts, builder_opts);
+    boost::shared_ptr<HypothesesGraph> graph = boost::shared_ptr<HypothesesGraph>(hyp_builder.build());
+    HypothesesGraph& g = *graph;
+
+    typedef property_map<node_traxel, HypothesesGraph::base_graph>::type traxel_map_t;
+    typedef property_map<node_timestep, HypothesesGraph::base_graph>::type timestep_map_t;
+    const traxel_map_t& traxel_map = g.get(node_traxel());
+    const timestep_map_t& timestep_map = g.get(node_timestep());
+
+    // the frame pairs are independent, so collect the nodes by timestep up front
+    const int earliest = g.earliest_timestep();
+    const int num_timesteps = g.latest_timestep() - earliest + 1;
+    std::vector<std::vector<HypothesesGraph::Node> > nodes_at(num_timesteps);
+    for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
+    {
+        nodes_at[timestep_map[n] - earliest].push_back(n);
+    }
+
+    LOG(logDEBUG) << "NNTracking: linking " << num_timesteps - 1 << " frame pairs";
+    std::vector<std::vector<HypothesesGraph::Arc> > linked_at(num_timesteps);
+    ParallelExceptions exceptions(num_timesteps);
+    #pragma omp parallel for schedule(dynamic)
+    for (int k = 0; k < num_timesteps - 1; ++k)
+    {
+        try
+        {
+            const std::vector<HypothesesGraph::Node>& from_nodes = nodes_at[k];
+            const std::vector<HypothesesGraph::Node>& to_nodes = nodes_at[k + 1];
+            std::map<int, size_t> to_index;
+            for (size_t j = 0; j < to_nodes.size(); ++j)
+            {
+                to_index[g.id(to_nodes[j])] = j;
+            }
+
+            // moves, where leaving a pair unlinked costs half the maximal
+            // move on either side
+            std::vector<AssignmentCandidate> candidates;
+            std::vector<HypothesesGraph::Arc> candidate_arcs;
+            std::vector<double> candidate_distances;
+            for (size_t i = 0; i < from_nodes.size(); ++i)
+            {
+                for (HypothesesGraph::OutArcIt a(g, from_nodes[i]); a != lemon::INVALID; ++a)
+                {
+                    const size_t j = to_index.find(g.id(g.target(a)))->second;
+                    const double distance = squared_feature_distance(traxel_map[from_nodes[i]],
+                                                                     traxel_map[to_nodes[j]],
+                                                                     features);
+                    candidates.push_back(AssignmentCandidate(i, j, distance));
+                    candidate_arcs.push_back(a);
+                    candidate_distances.push_back(distance);
+                }
+            }
+            const std::vector<int> assignment = solve_sparse_assignment(from_nodes.size(),
+                                                                        to_nodes.size(),
+                                                                        candidates,
+                                                                        max_move / 2,
+                                                                        max_move / 2);
+
+            std::vector<bool> is_linked(to_nodes.size(), false);
+            std::vector<bool> is_dividing(from_nodes.size(), false);
+            for (size_t c = 0; c < candidates.size(); ++c)
+            {
+                if (assignment[candidates[c].row] == static_cast<int>(candidates[c].col)
+                        && !is_linked[candidates[c].col])
+                {
+                    linked_at[k].push_back(candidate_arcs[c]);
+                    is_linked[candidates[c].col] = true;
+                }
+            }
+
+            // divisions: children left over by the assignment are attached to
+            // the nearest linked parent that is likely to divide
+            std::vector<DivisionCandidate> divisions;
+            for (size_t c = 0; c < candidates.size(); ++c)
+            {
+                const size_t parent = candidates[c].row;
+                const size_t child = candidates[c].col;
+                if (is_linked[child] || assignment[parent] < 0 || candidate_distances[c] > max_division)
+                {
+                    continue;
+                }
+                const Traxel& parent_traxel = traxel_map[from_nodes[parent]];
+                FeatureMap::const_iterator div_prob = parent_traxel.features.find("divProb");
+                if (div_prob != parent_traxel.features.end() && !div_prob->second.empty()
+                        && div_prob->second[0] > divisionThreshold_)
+                {
+                    divisions.push_back(DivisionCandidate(candidate_distances[c], parent, child, candidate_arcs[c]));
+                }
+            }
+            std::sort(divisions.begin(), divisions.end());
+            for (std::vector<DivisionCandidate>::const_iterator d = divisions.begin(); d != divisions.end(); ++d)
+            {
+                if (!is_linked[d->child] && !is_dividing[d->parent])
+                {
+                    linked_at[k].push_back(d->arc);
+                    is_linked[d->child] = true;
+                    is_dividing[d->parent] = true;
+                }
+            }
+        }
+        catch (...)
+        {
+            exceptions.capture(k);
+        }
+    }
+    exceptions.rethrow();
+
+    // all detections are kept, only the linked arcs are active
+    g.add(node_active()).add(arc_active());
+    property_map<node_active, HypothesesGraph::base_graph>::type& active_nodes = g.get(node_active());
+    property_map<arc_active, HypothesesGraph::base_graph>::type& active_arcs = g.get(arc_active());
+    for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
+    {
+        active_nodes.set(n, true);
+    }
+    for (HypothesesGraph::ArcIt a(g); a != lemon::INVALID; ++a)
+    {
+        active_arcs.set(a, false);
+    }
+    for (int k = 0; k < num_timesteps; ++k)
+    {
+        for (std::vector<HypothesesGraph::Arc>::const_iterator a = linked_at[k].begin(); a != linked_at[k].end(); ++a)
+        {
+            active_arcs.set(*a, true);
+        }
+    }
+
+    last_detections_ = state_of_nodes(g);
+    prune_inactive(g);
+    return *events(g);
+}
+
+std::vector<std::map<unsigned int, bool> > NNTracking::detections()
+{
+    if (last_detections_)
+    {
+        return *last_detections_;
+    }
+    else
+    {
+        throw std::runtime_error(
+            "NNTracking::detections(): previous tracking result required");
+    }
+}
+
 namespace
 {
 std::vector<double> computeDetProb(double vol, std::vector<double> means, std::vector<double> s2)
@@ -401,6 +624,7 @@ EventVectorVectorVector ConsTracking::operator()(
 
 boost::shared_ptr<HypothesesGraph> ConsTracking::build_hypo_graph(TraxelStore& ts, int max_nearest_neighbors)
 {
+    StageTimer stage_timer("build_hypotheses_graph");
 
     LOG(logDEBUG3) << "entering build_hypo_graph" << std::endl;;
 
@@ -547,6 +771,9 @@ boost::shared_ptr<HypothesesGraph> ConsTracking::build_hypo_graph(TraxelStore& t
         }
     }
 
+    instrument_count("build_hypotheses_graph", "nodes", lemon::countNodes(*hypotheses_graph_));
+    instrument_count("build_hypotheses_graph", "arcs", lemon::countArcs(*hypotheses_graph_));
+
     if(event_vector_dump_filename_ != "none")
     {
         // store the traxel store and the resulting event vector
@@ -706,10 +933,12 @@ EventVectorVectorVector ConsTracking::track_from_param(Parameter& param,
         ilp_solutions_ = pgm.get_ilp_solutions();
         std::cout << "-> constructing unresolved events" << std::endl;
 
-        EventVectorVectorVector all_ev(num_solutions);
-        for (size_t i = 0; i < num_solutions; ++i)
+        EventVectorVectorVector all_ev;
         {
-            all_ev[i] = *events(*hypotheses_graph_, i);
+            StageTimer stage_timer("event_extraction");
+            boost::shared_ptr<EventTable> table = event_table(*hypotheses_graph_, num_solutions);
+            table->to_events(all_ev);
+            instrument_count("event_extraction", "events", table->size());
         }
 
         if(event_vector_dump_filename_ != "none")
@@ -1038,6 +1267,7 @@ EventVectorVector ConsTracking::resolve_mergers(
     boost::python::object transitionClassifier
 )
 {
+    StageTimer stage_timer("resolve_mergers");
     LOG(logINFO) << "-> resolving mergers";
 
     //boost::function<double(const Traxel&, const Traxel&, const size_t)> transition;
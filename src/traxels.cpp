@@ -2,6 +2,7 @@
 #include <cmath>
 #include <stdexcept>
 #include <set>
+#include <typeinfo>
 #include <vector>
 #include "pgmlink/traxels.h"
 #include "pgmlink/field_of_view.h"
@@ -16,40 +17,156 @@ namespace pgmlink
 ////
 double Locator::coordinate_from(const FeatureMap& m, size_t idx) const
 {
-    if(is_applicable(m))
+    FeatureMap::const_iterator it = m.find(feature_name_);
+    if(it == m.end())
     {
-        FeatureMap::const_iterator it;
-        it = m.find(feature_name_);
-        return it->second[idx];
+        throw invalid_argument("Locator::coordinate_from(): FeatureMap is not applicable");
+    }
+    return it->second[idx];
+}
+
+
+////
+//// class CompactLocator
+////
+namespace
+{
+const std::string& compact_locator_feature_name(CompactLocator::Kind kind)
+{
+    static const std::string names[] = {"com", "com_corrected", "CoordMinimum", "CoordMaximum", "intmaxpos"};
+    return names[kind];
+}
+}
+
+bool CompactLocator::from_locator(const Locator& l, CompactLocator& c)
+{
+    const std::type_info& type = typeid(l);
+    if(type == typeid(ComLocator))
+    {
+        c.kind = Com;
+    }
+    else if(type == typeid(ComCorrLocator))
+    {
+        c.kind = ComCorrected;
+    }
+    else if(type == typeid(MinLocator))
+    {
+        c.kind = CoordMinimum;
+    }
+    else if(type == typeid(MaxLocator))
+    {
+        c.kind = CoordMaximum;
+    }
+    else if(type == typeid(IntmaxposLocator))
+    {
+        c.kind = Intmaxpos;
     }
     else
+    {
+        return false;
+    }
+    c.x_scale = l.x_scale;
+    c.y_scale = l.y_scale;
+    c.z_scale = l.z_scale;
+    return true;
+}
+
+Locator* CompactLocator::to_locator() const
+{
+    Locator* l = NULL;
+    switch(kind)
+    {
+        case Com:
+            l = new ComLocator();
+            break;
+        case ComCorrected:
+            l = new ComCorrLocator();
+            break;
+        case CoordMinimum:
+            l = new MinLocator();
+            break;
+        case CoordMaximum:
+            l = new MaxLocator();
+            break;
+        case Intmaxpos:
+            l = new IntmaxposLocator();
+            break;
+        default:
+            throw runtime_error("CompactLocator::to_locator(): unknown kind");
+    }
+    l->x_scale = x_scale;
+    l->y_scale = y_scale;
+    l->z_scale = z_scale;
+    return l;
+}
+
+const std::string& CompactLocator::feature_name() const
+{
+    return compact_locator_feature_name(kind);
+}
+
+double CompactLocator::coordinate_from(const FeatureMap& m, size_t idx) const
+{
+    FeatureMap::const_iterator it = m.find(feature_name());
+    if(it == m.end())
     {
         throw invalid_argument("Locator::coordinate_from(): FeatureMap is not applicable");
     }
+    // the intensity maximum position starts with the intensity
+    return it->second[kind == Intmaxpos ? idx + 1 : idx];
 }
 
 
 ////
 //// class Traxel
 ////
+namespace
+{
+// takes ownership of l
+template<typename LocatorType>
+CompactLocator compact_or_default(LocatorType* l, CompactLocator::Kind kind)
+{
+    CompactLocator c(kind);
+    if(l)
+    {
+        CompactLocator::from_locator(*l, c);
+        delete l;
+    }
+    return c;
+}
+}
+
+Traxel::Traxel(unsigned int id,
+               int timestep,
+               Locator* l,
+               ComCorrLocator* lc,
+               MinLocator* minl,
+               MaxLocator* maxl)
+    : Id(id),
+      Timestep(timestep),
+      custom_locator_(NULL),
+      corr_locator_(compact_or_default(lc, CompactLocator::ComCorrected)),
+      min_locator_(compact_or_default(minl, CompactLocator::CoordMinimum)),
+      max_locator_(compact_or_default(maxl, CompactLocator::CoordMaximum))
+{
+    features = FeatureMapAccessor(this);
+    if(l)
+    {
+        set_locator(l);
+    }
+}
+
 Traxel::Traxel(const Traxel& other):
     Id(other.Id),
     Timestep(other.Timestep),
-    featurestore_(other.featurestore_)
+    featurestore_(other.featurestore_),
+    locator_(other.locator_),
+    custom_locator_(other.custom_locator_ ? other.custom_locator_->clone() : NULL),
+    corr_locator_(other.corr_locator_),
+    min_locator_(other.min_locator_),
+    max_locator_(other.max_locator_)
 {
-    locator_ = other.locator_->clone();
-    corr_locator_ = other.corr_locator_;
     features = FeatureMapAccessor(this, other.features.get());
-
-    if (features.get().count("CoordMinimum") == 1)
-        min_locator_ = other.min_locator_;
-    else
-        min_locator_ = (MinLocator*)other.locator_;
-
-    if (features.get().count("CoordMaximum") == 1)
-        max_locator_ = other.max_locator_;
-    else
-        max_locator_ = (MaxLocator*)other.locator_;
 }
 
 Traxel& Traxel::operator=(const Traxel& other)
@@ -59,32 +176,80 @@ Traxel& Traxel::operator=(const Traxel& other)
     featurestore_ = other.featurestore_;
     features = FeatureMapAccessor(this, other.features.get());
 
+    locator_ = other.locator_;
     corr_locator_ = other.corr_locator_;
-
-    if (features.get().count("CoordMinimum") == 1)
-        min_locator_ = other.min_locator_;
-    else
-        min_locator_ = (MinLocator*)other.locator_;
-
-    if (features.get().count("CoordMaximum") == 1)
-        max_locator_ = other.max_locator_;
-    else
-        max_locator_ = (MaxLocator*)other.locator_;
+    min_locator_ = other.min_locator_;
+    max_locator_ = other.max_locator_;
 
     // This gracefully handles self assignment
-    Locator* temp = other.locator_->clone();
-    delete locator_;
-    locator_ = temp;
+    Locator* temp = other.custom_locator_ ? other.custom_locator_->clone() : NULL;
+    delete custom_locator_;
+    custom_locator_ = temp;
     return *this;
 }
 
 Traxel& Traxel::set_locator(Locator* l)
 {
-    delete locator_;
+    if(l && CompactLocator::from_locator(*l, locator_))
+    {
+        if(l != custom_locator_)
+        {
+            delete l;
+        }
+        l = NULL;
+    }
+    if(l != custom_locator_)
+    {
+        delete custom_locator_;
+    }
+    custom_locator_ = l;
+    return *this;
+}
+
+Traxel& Traxel::set_locator(const CompactLocator& l)
+{
+    delete custom_locator_;
+    custom_locator_ = NULL;
     locator_ = l;
     return *this;
 }
 
+Locator* Traxel::locator()
+{
+    if(!custom_locator_)
+    {
+        custom_locator_ = locator_.to_locator();
+    }
+    return custom_locator_;
+}
+
+void Traxel::set_x_scale(double s)
+{
+    locator_.x_scale = s;
+    if(custom_locator_)
+    {
+        custom_locator_->x_scale = s;
+    }
+}
+
+void Traxel::set_y_scale(double s)
+{
+    locator_.y_scale = s;
+    if(custom_locator_)
+    {
+        custom_locator_->y_scale = s;
+    }
+}
+
+void Traxel::set_z_scale(double s)
+{
+    locator_.z_scale = s;
+    if(custom_locator_)
+    {
+        custom_locator_->z_scale = s;
+    }
+}
+
 boost::shared_ptr<FeatureStore> Traxel::get_feature_store() const
 {
     return featurestore_;
@@ -92,83 +257,84 @@ boost::shared_ptr<FeatureStore> Traxel::get_feature_store() const
 
 double Traxel::X() const
 {
-    return locator_->X(features.get());
+    if(custom_locator_)
+    {
+        return custom_locator_->X(features.get());
+    }
+    return locator_.X(features.get());
 }
 
 double Traxel::Y() const
 {
-    return locator_->Y(features.get());
+    if(custom_locator_)
+    {
+        return custom_locator_->Y(features.get());
+    }
+    return locator_.Y(features.get());
 }
 
 double Traxel::Z() const
 {
-    return locator_->Z(features.get());
+    if(custom_locator_)
+    {
+        return custom_locator_->Z(features.get());
+    }
+    return locator_.Z(features.get());
 }
 
+// the bounding box falls back to the position of traxels without CoordMinimum/CoordMaximum
 double Traxel::X_min() const
 {
-    return min_locator_->X(features.get());
+    const FeatureMap& m = features.get();
+    return min_locator_.is_applicable(m) ? min_locator_.X(m) : X();
 }
 
 double Traxel::Y_min() const
 {
-    return min_locator_->Y(features.get());
+    const FeatureMap& m = features.get();
+    return min_locator_.is_applicable(m) ? min_locator_.Y(m) : Y();
 }
 
 double Traxel::Z_min() const
 {
-    return min_locator_->Z(features.get());
+    const FeatureMap& m = features.get();
+    return min_locator_.is_applicable(m) ? min_locator_.Z(m) : Z();
 }
 
 double Traxel::X_max() const
 {
-    return max_locator_->X(features.get());
+    const FeatureMap& m = features.get();
+    return max_locator_.is_applicable(m) ? max_locator_.X(m) : X();
 }
 
 double Traxel::Y_max() const
 {
-    return max_locator_->Y(features.get());
+    const FeatureMap& m = features.get();
+    return max_locator_.is_applicable(m) ? max_locator_.Y(m) : Y();
 }
 
 double Traxel::Z_max() const
 {
-    return max_locator_->Z(features.get());
+    const FeatureMap& m = features.get();
+    return max_locator_.is_applicable(m) ? max_locator_.Z(m) : Z();
 }
 
 double Traxel::X_corr() const
 {
-    if (features.get().count("com_corrected") == 1)
-    {
-        return corr_locator_->X(features.get());
-    }
-    else
-    {
-        return X();
-    }
+    const FeatureMap& m = features.get();
+    return corr_locator_.is_applicable(m) ? corr_locator_.X(m) : X();
 }
 
 double Traxel::Y_corr() const
 {
-    if (features.get().count("com_corrected") == 1)
-    {
-        return corr_locator_->Y(features.get());
-    }
-    else
-    {
-        return Y();
-    }
+    const FeatureMap& m = features.get();
+    return corr_locator_.is_applicable(m) ? corr_locator_.Y(m) : Y();
 }
 
 double Traxel::Z_corr() const
 {
-    if (features.get().count("com_corrected") == 1)
-    {
-        return corr_locator_->Z(features.get());
-    }
-    else
-    {
-        return Z();
-    }
+    const FeatureMap& m = features.get();
+    return corr_locator_.is_applicable(m) ? corr_locator_.Z(m) : Z();
 }
 
 namespace
@@ -397,14 +563,7 @@ Traxel::FeatureMapAccessor::FeatureMapAccessor(Traxel* parent, const FeatureMap&
 
 const size_t Traxel::FeatureMapAccessor::size() const
 {
-    if(parent_->featurestore_)
-    {
-        return parent_->featurestore_->get_traxel_features(*parent_).size();
-    }
-    else
-    {
-        return feature_map_.size();
-    }
+    return get().size();
 }
 
 feature_array &Traxel::FeatureMapAccessor::operator[](const string &feature_name)
@@ -460,7 +619,13 @@ feature_array Traxel::FeatureMapAccessor::operator[](const string &feature_name)
 {
     if(parent_->featurestore_)
     {
-        return parent_->featurestore_->get_traxel_features(*parent_)[feature_name];
+        const FeatureMap& feature_map = get();
+        FeatureMap::const_iterator it = feature_map.find(feature_name);
+        if(it == feature_map.end())
+        {
+            return feature_array();
+        }
+        return it->second;
     }
     else
     {
@@ -473,45 +638,31 @@ feature_array Traxel::FeatureMapAccessor::operator[](const string &feature_name)
 
 FeatureMap::const_iterator Traxel::FeatureMapAccessor::find(const string &feature_name) const
 {
-    if(parent_->featurestore_)
-    {
-        return parent_->featurestore_->get_traxel_features(*parent_).find(feature_name);
-    }
-    else
-    {
-        return feature_map_.find(feature_name);
-    }
+    return get().find(feature_name);
 }
 
 FeatureMap::const_iterator Traxel::FeatureMapAccessor::begin() const
 {
-    if(parent_->featurestore_)
-    {
-        return parent_->featurestore_->get_traxel_features(*parent_).begin();
-    }
-    else
-    {
-        return feature_map_.begin();
-    }
+    return get().begin();
 }
 
 FeatureMap::const_iterator Traxel::FeatureMapAccessor::end() const
 {
-    if(parent_->featurestore_)
-    {
-        return parent_->featurestore_->get_traxel_features(*parent_).end();
-    }
-    else
-    {
-        return feature_map_.end();
-    }
+    return get().end();
 }
 
 const FeatureMap &Traxel::FeatureMapAccessor::get() const
 {
     if(parent_->featurestore_)
     {
-        return parent_->featurestore_->get_traxel_features(*parent_);
+        // never insert here, the feature computations read traxels from several threads
+        const FeatureMap* feature_map = parent_->featurestore_->find_traxel_features(*parent_);
+        if(feature_map)
+        {
+            return *feature_map;
+        }
+        static const FeatureMap empty_feature_map;
+        return empty_feature_map;
     }
     else
     {
@@ -0,0 +1,61 @@
+#define BOOST_TEST_MODULE bounding_box_index_test
+
+#include <algorithm>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pgmlink/bounding_box_index.h"
+#include "pgmlink/hypotheses.h"
+#include "pgmlink/traxels.h"
+
+using namespace pgmlink;
+using namespace std;
+
+namespace
+{
+HypothesesGraph::Node add_box(HypothesesGraph& g, unsigned int id, int t,
+                              feature_type x_min, feature_type y_min,
+                              feature_type x_max, feature_type y_max)
+{
+    Traxel tr(id, t);
+    feature_array lower(3, 0.), upper(3, 0.);
+    lower[0] = x_min;
+    lower[1] = y_min;
+    upper[0] = x_max;
+    upper[1] = y_max;
+    tr.features["CoordMinimum"] = lower;
+    tr.features["CoordMaximum"] = upper;
+    return g.add_traxel(tr);
+}
+}
+
+BOOST_AUTO_TEST_CASE( BoundingBoxIndex_query )
+{
+    HypothesesGraph g;
+    g.add(node_traxel());
+    HypothesesGraph::Node wide = add_box(g, 1, 0, 0., 0., 50., 5.);
+    HypothesesGraph::Node inside = add_box(g, 2, 0, 20., 20., 25., 25.);
+    add_box(g, 3, 0, 60., 20., 70., 25.); // right of the crop
+    add_box(g, 4, 0, 20., 60., 25., 70.); // above the crop
+    HypothesesGraph::Node later = add_box(g, 5, 1, 28., 28., 35., 35.);
+    add_box(g, 6, 2, 20., 20., 25., 25.); // after the crop
+
+    BoundingBoxIndex index(g, 2);
+    BOOST_CHECK_EQUAL(index.size(), 6);
+
+    // t in [0, 1], x and y in [10, 30]
+    FieldOfView crop(0, 10, 10, 0, 1, 30, 30, 0);
+    vector<HypothesesGraph::Node> nodes = index.query(crop);
+    BOOST_CHECK_EQUAL(nodes.size(), 2);
+    BOOST_CHECK(find(nodes.begin(), nodes.end(), inside) != nodes.end());
+    BOOST_CHECK(find(nodes.begin(), nodes.end(), later) != nodes.end());
+
+    // the wide box starts far left of the crop but reaches into it
+    FieldOfView low_crop(0, 40, 0, 0, 0, 45, 3, 0);
+    nodes = index.query(low_crop);
+    BOOST_REQUIRE_EQUAL(nodes.size(), 1);
+    BOOST_CHECK(nodes[0] == wide);
+
+    BOOST_CHECK_THROW(BoundingBoxIndex(g, 4), std::runtime_error);
+}
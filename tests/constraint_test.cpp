@@ -350,6 +350,54 @@ BOOST_AUTO_TEST_CASE(ConstraintPool_Outgoing_Factor_Test)
     BOOST_CHECK_EQUAL(model.evaluate(labeling.begin()), 0);
 }
 
+BOOST_AUTO_TEST_CASE(ConstraintPool_Lazy_Test)
+{
+    OpengmModelDeprecated::ogmGraphicalModel model;
+    model.addVariable(3); // A
+    model.addVariable(2); // D
+    model.addVariable(3); // T
+    model.addVariable(3); // T
+    model.addVariable(3); // V of the target of the first transition
+
+    ConstraintPool cp(200.0);
+    std::vector<size_t> indices;
+	indices.push_back(2);
+	indices.push_back(3);
+    cp.add_constraint(ConstraintPool::OutgoingConstraint(0, 1, indices));
+    indices.clear();
+	indices.push_back(2);
+    cp.add_constraint(ConstraintPool::IncomingConstraint(indices, 4));
+
+    opengm::ICM<OpengmModelDeprecated::ogmGraphicalModel, OpengmModelDeprecated::ogmAccumulator> inf(model);
+    cp.add_core_constraints_to_problem(model, inf);
+    BOOST_CHECK_EQUAL(model.numberOfFactors(), 0);
+
+    // division into two children, nothing to add
+    std::vector<size_t> labeling;
+	labeling.push_back(1);
+	labeling.push_back(1);
+	labeling.push_back(1);
+	labeling.push_back(1);
+	labeling.push_back(1);
+    BOOST_CHECK_EQUAL(cp.add_violated_constraints_to_problem(model, inf, labeling), 0);
+    BOOST_CHECK_EQUAL(model.numberOfFactors(), 0);
+
+    // two objects leave a single one
+    labeling.clear();
+	labeling.push_back(1);
+	labeling.push_back(0);
+	labeling.push_back(2);
+	labeling.push_back(0);
+	labeling.push_back(1);
+    BOOST_CHECK_EQUAL(cp.add_violated_constraints_to_problem(model, inf, labeling), 2);
+    BOOST_CHECK_EQUAL(model.numberOfFactors(), 2);
+    BOOST_CHECK_EQUAL(model.evaluate(labeling.begin()), 400.0);
+
+    // constraints are only added once
+    BOOST_CHECK_EQUAL(cp.add_violated_constraints_to_problem(model, inf, labeling), 0);
+    BOOST_CHECK_EQUAL(model.numberOfFactors(), 2);
+}
+
 BOOST_AUTO_TEST_CASE(ConstraintPool_Outgoing_Factor_No_Division_Node_Test)
 {
     OpengmModelDeprecated::ogmGraphicalModel model;
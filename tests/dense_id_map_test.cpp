@@ -0,0 +1,82 @@
+#define BOOST_TEST_MODULE dense_id_map_test
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <lemon/list_graph.h>
+
+#include "pgmlink/dense_id_map.h"
+
+using namespace pgmlink;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE( DenseIdMap_nodes )
+{
+    lemon::ListDigraph g;
+    vector<lemon::ListDigraph::Node> nodes;
+    for (size_t i = 0; i < 5; ++i)
+    {
+        nodes.push_back(g.addNode());
+    }
+
+    DenseIdMap<lemon::ListDigraph::Node> m;
+    BOOST_CHECK(m.empty());
+    m.reserve(g.maxNodeId() + 1);
+    // skip a node and insert out of id order
+    m.insert(nodes[3], 7);
+    m.insert(nodes[0], 2);
+    m.insert(nodes[4], 3);
+    BOOST_CHECK_EQUAL(m.size(), 3);
+
+    BOOST_CHECK_EQUAL(m[nodes[3]], 7);
+    BOOST_CHECK_EQUAL(m.at(nodes[0]), 2);
+    BOOST_CHECK_EQUAL(m.count(nodes[4]), 1);
+    BOOST_CHECK_EQUAL(m.count(nodes[1]), 0);
+    BOOST_CHECK(m.find(nodes[1]) == m.end());
+    BOOST_CHECK_THROW(m.at(nodes[1]), std::out_of_range);
+
+    // reverse lookup
+    BOOST_CHECK(m.key_of(7) == nodes[3]);
+    BOOST_CHECK(m.key_of(3) == nodes[4]);
+    BOOST_CHECK_EQUAL(m.count_value(2), 1);
+    BOOST_CHECK_EQUAL(m.count_value(5), 0);
+    BOOST_CHECK_THROW(m.key_of(100), std::out_of_range);
+
+    // iteration follows insertion order
+    DenseIdMap<lemon::ListDigraph::Node>::const_iterator it = m.begin();
+    BOOST_CHECK(it->first == nodes[3]);
+    ++it;
+    BOOST_CHECK(it->first == nodes[0]);
+    BOOST_CHECK_EQUAL(it->second, 2);
+
+    // replacing a value frees the old one, values stay unique
+    m.insert(nodes[3], 8);
+    BOOST_CHECK_EQUAL(m[nodes[3]], 8);
+    BOOST_CHECK_EQUAL(m.count_value(7), 0);
+    BOOST_CHECK(m.key_of(8) == nodes[3]);
+    BOOST_CHECK_EQUAL(m.size(), 3);
+    BOOST_CHECK_THROW(m.insert(nodes[1], 2), std::runtime_error);
+    BOOST_CHECK_THROW(m.insert(lemon::ListDigraph::Node(lemon::INVALID), 9), std::runtime_error);
+
+    m.clear();
+    BOOST_CHECK(m.empty());
+    BOOST_CHECK_EQUAL(m.count(nodes[3]), 0);
+}
+
+BOOST_AUTO_TEST_CASE( DenseIdMap_arcs )
+{
+    lemon::ListDigraph g;
+    lemon::ListDigraph::Node n1 = g.addNode();
+    lemon::ListDigraph::Node n2 = g.addNode();
+    lemon::ListDigraph::Node n3 = g.addNode();
+    lemon::ListDigraph::Arc a1 = g.addArc(n1, n2);
+    lemon::ListDigraph::Arc a2 = g.addArc(n1, n3);
+
+    DenseIdMap<lemon::ListDigraph::Arc> m;
+    m.insert(DenseIdMap<lemon::ListDigraph::Arc>::value_type(a2, 0));
+    m.insert(a1, 1);
+    BOOST_CHECK_EQUAL(m[a1], 1);
+    BOOST_CHECK_EQUAL(m[a2], 0);
+    BOOST_CHECK(m.key_of(0) == a2);
+}
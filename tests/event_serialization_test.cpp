@@ -5,6 +5,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
@@ -295,3 +296,79 @@ BOOST_AUTO_TEST_CASE( Traxelstore_Serialization_Test )
     // should not contain more elements than before
     BOOST_CHECK(it_loaded == ts_loaded.end());
 }
+
+BOOST_AUTO_TEST_CASE( EventTable_Serialization )
+{
+    // two solutions, three timesteps starting at t=4
+    EventVectorVectorVector events(2, EventVectorVector(3));
+    Event move;
+    move.type = Event::Move;
+    move.traxel_ids.push_back(1);
+    move.traxel_ids.push_back(2);
+    move.set_energy(0.5);
+    events[0][1].push_back(move);
+
+    Event resolved;
+    resolved.type = Event::ResolvedTo;
+    for (size_t id = 7; id < 12; ++id)
+    {
+        resolved.traxel_ids.push_back(id);
+    }
+    events[1][2].push_back(resolved);
+
+    Event appearance;
+    appearance.type = Event::Appearance;
+    appearance.traxel_ids.push_back(3);
+    appearance.number_of_features(2);
+    appearance.features(std::vector<double>(2, 1.));
+    appearance.weights(std::vector<double>(2, 2.));
+    events[1][0].push_back(appearance);
+    events[1][0].push_back(move);
+
+    EventTable table(events, 4);
+    BOOST_CHECK_EQUAL(table.size(), 4);
+    BOOST_CHECK_EQUAL(table.n_iterations(), 2);
+    BOOST_CHECK_EQUAL(table.n_timesteps(), 3);
+    BOOST_CHECK_EQUAL(table.timestep(0), 5);
+    BOOST_CHECK_THROW(table.add_event(Event::Move, 7, 0), std::out_of_range);
+
+    std::stringstream ss;
+    {
+        boost::archive::text_oarchive oa(ss);
+        oa & table;
+    }
+    EventTable loaded;
+    {
+        boost::archive::text_iarchive ia(ss);
+        ia & loaded;
+    }
+
+    EventVectorVectorVector converted;
+    loaded.to_events(converted);
+    BOOST_REQUIRE_EQUAL(converted.size(), 2);
+    for (size_t i = 0; i < converted.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(converted[i].size(), 3);
+        for (size_t t = 0; t < 3; ++t)
+        {
+            BOOST_CHECK_EQUAL_COLLECTIONS(converted[i][t].begin(), converted[i][t].end(),
+                                          events[i][t].begin(), events[i][t].end());
+        }
+    }
+    BOOST_CHECK_EQUAL(converted[0][1][0].energy(), 0.5);
+    BOOST_REQUIRE_EQUAL(converted[1][0][0].number_of_features(), 2);
+    BOOST_CHECK_EQUAL(converted[1][0][0].weights()[1], 2.);
+
+    std::vector<EventRecord> from_table, from_vectors;
+    flatten_events(loaded, from_table);
+    flatten_events(events, from_vectors, 4);
+    BOOST_REQUIRE_EQUAL(from_table.size(), from_vectors.size());
+    for (size_t i = 0; i < from_table.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(from_table[i].type, from_vectors[i].type);
+        BOOST_CHECK_EQUAL(from_table[i].timestep, from_vectors[i].timestep);
+        BOOST_CHECK_EQUAL(from_table[i].iteration, from_vectors[i].iteration);
+        BOOST_CHECK_EQUAL_COLLECTIONS(from_table[i].traxel_ids, from_table[i].traxel_ids + EventRecord::max_traxel_ids,
+                                      from_vectors[i].traxel_ids, from_vectors[i].traxel_ids + EventRecord::max_traxel_ids);
+    }
+}
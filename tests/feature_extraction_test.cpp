@@ -5,14 +5,20 @@
 #include <string>
 #include <stdexcept>
 #include <iostream>
+#include <map>
 #include <utility>
+#include <vector>
 
 // boost
 #include <boost/shared_ptr.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/test/unit_test.hpp>
 
+// vigra
+#include <vigra/random_forest.hxx>
+
 // pgmlink
+#include "pgmlink/classifier_auxiliary.h"
 #include "pgmlink/features/feature.h"
 #include "pgmlink/features/feature_calculator.h"
 #include "pgmlink/features/feature_extraction.h"
@@ -20,6 +26,19 @@
 
 namespace fe = pgmlink::feature_extraction;
 
+namespace
+{
+pgmlink::feature_array sum_features( const pgmlink::feature_array& f1, const pgmlink::feature_array& f2 )
+{
+    pgmlink::feature_array ret( f1 );
+    for (size_t i = 0; i < ret.size(); ++i)
+    {
+        ret[i] += f2[i];
+    }
+    return ret;
+}
+}
+
 BOOST_AUTO_TEST_CASE( FeatureCalculator_Test )
 {
     fe::FeatureCalculator* calc = new fe::FeatureCalculator;
@@ -139,3 +158,195 @@ BOOST_AUTO_TEST_CASE( MultipleFeatureExtraction )
     }
 }
 
+
+
+BOOST_AUTO_TEST_CASE( FeatureCalculator_batch )
+{
+    // three pairs of 2d features, one pair per row
+    fe::feature_matrix f1(vigra::Shape2(3, 2));
+    fe::feature_matrix f2(vigra::Shape2(3, 2));
+    for (size_t row = 0; row < 3; ++row)
+    {
+        for (size_t col = 0; col < 2; ++col)
+        {
+            f1(row, col) = 1. + row + 2. * col;
+            f2(row, col) = 0.5 * row * row + col + 0.25;
+        }
+    }
+
+    // the batch results have to agree with the pairwise results
+    const char* names[] = { "ElementWiseSquaredDistance", "AbsoluteDifference", "SquareRooteSquaredDifference",
+                            "Ratio", "AsymmetricRatio", "SquaredDifference"
+                          };
+    fe::feature_matrix result;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        boost::shared_ptr<fe::FeatureCalculator> calc = fe::helpers::CalculatorLookup::extract_calculator( names[i] );
+        calc->calculate_batch( f1, f2, result );
+        BOOST_REQUIRE_EQUAL( result.shape(0), 3 );
+        for (size_t row = 0; row < 3; ++row)
+        {
+            pgmlink::feature_array a1( 2 ), a2( 2 );
+            for (size_t col = 0; col < 2; ++col)
+            {
+                a1[col] = f1(row, col);
+                a2[col] = f2(row, col);
+            }
+            pgmlink::feature_array expected = calc->calculate( a1, a2 );
+            BOOST_REQUIRE_EQUAL( static_cast<size_t>(result.shape(1)), expected.size() );
+            for (size_t col = 0; col < expected.size(); ++col)
+            {
+                BOOST_CHECK_CLOSE( result(row, col), expected[col], 1e-10 );
+            }
+        }
+    }
+
+    // the default implementation calls calculate() row by row
+    fe::PairwiseOperationCalculator sum( &sum_features, "sum" );
+    sum.calculate_batch( f1, f2, result );
+    BOOST_REQUIRE_EQUAL( result.shape(1), 2 );
+    BOOST_CHECK_EQUAL( result(2, 1), f1(2, 1) + f2(2, 1) );
+
+    BOOST_CHECK_THROW( sum.calculate_batch( f1, fe::feature_matrix(vigra::Shape2(2, 2)), result ), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_CASE( MultipleFeatureExtraction_batch )
+{
+    pgmlink::Traxel t1, t2, t3;
+    t1.features["feat"] = pgmlink::feature_array( 2, 1. );
+    t2.features["feat"] = pgmlink::feature_array( 2, 3. );
+    t3.features["feat"] = pgmlink::feature_array( 2, 4. );
+
+    // transitions t1 -> t2 and t1 -> t3
+    fe::ConstTraxelRefVector from, to;
+    from.push_back( &t1 );
+    to.push_back( &t2 );
+    from.push_back( &t1 );
+    to.push_back( &t3 );
+
+    fe::MultipleFeatureExtraction::FeatureList flist;
+    flist["SquaredDifference"].push_back( "feat" );
+    flist["ElementWiseSquaredDistance"].push_back( "feat" );
+    fe::MultipleFeatureExtraction::CombinedFeatureMatrixMap res = fe::helpers::convenience_feature_extraction( flist, from, to );
+    BOOST_REQUIRE_EQUAL( res.size(), 2 );
+
+    const fe::feature_matrix& sq_diff = res[std::make_pair("SquaredDifference", "feat")];
+    BOOST_REQUIRE_EQUAL( sq_diff.shape(0), 2 );
+    BOOST_REQUIRE_EQUAL( sq_diff.shape(1), 1 );
+    BOOST_CHECK_EQUAL( sq_diff(0, 0), 8. );
+    BOOST_CHECK_EQUAL( sq_diff(1, 0), 18. );
+
+    const fe::feature_matrix& elementwise = res[std::make_pair("ElementWiseSquaredDistance", "feat")];
+    BOOST_REQUIRE_EQUAL( elementwise.shape(1), 2 );
+    BOOST_CHECK_EQUAL( elementwise(1, 1), 9. );
+
+    // missing features and mismatched pairs throw
+    fe::FeatureExtractor extractor( "SquaredDifference", "else_feature" );
+    fe::feature_matrix result;
+    BOOST_CHECK_THROW( extractor.extract( from, to, result ), std::runtime_error );
+    to.pop_back();
+    BOOST_CHECK_THROW( fe::FeatureExtractor( "SquaredDifference", "feat" ).extract( from, to, result ), std::runtime_error );
+}
+
+
+BOOST_AUTO_TEST_CASE( Classifier_batch )
+{
+    // transitions and divisions of one timestep
+    std::vector<pgmlink::Traxel> traxels( 6 );
+    for (size_t i = 0; i < traxels.size(); ++i)
+    {
+        traxels[i].Id = i;
+        traxels[i].features["feat"].push_back( 1. + i );
+        traxels[i].features["feat"].push_back( 5. - 0.5 * i );
+    }
+    fe::ConstTraxelRefVector from, to, to_second;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        from.push_back( &traxels[i] );
+        to.push_back( &traxels[i + 3] );
+        to_second.push_back( &traxels[5 - i] );
+    }
+
+    // Ratio goes through the feature_extraction batch API, AbsDiff row by row
+    std::vector<boost::shared_ptr<pgmlink::FeatureExtractor> > move_extractors;
+    move_extractors.push_back( boost::shared_ptr<pgmlink::FeatureExtractor>( new pgmlink::FeatureExtractor(
+                                   boost::shared_ptr<pgmlink::FeatureCalculator>( new pgmlink::RatioCalculator ), "feat" ) ) );
+    move_extractors.push_back( boost::shared_ptr<pgmlink::FeatureExtractor>( new pgmlink::FeatureExtractor(
+                                   boost::shared_ptr<pgmlink::FeatureCalculator>( new pgmlink::AbsoluteDifferenceCalculator ), "feat" ) ) );
+    for (size_t e = 0; e < move_extractors.size(); ++e)
+    {
+        fe::feature_matrix batch;
+        move_extractors[e]->extract( from, to, batch );
+        BOOST_REQUIRE_EQUAL( batch.shape(0), 3 );
+        for (size_t row = 0; row < from.size(); ++row)
+        {
+            pgmlink::feature_array single = move_extractors[e]->extract( *from[row], *to[row] );
+            BOOST_REQUIRE_EQUAL( batch.shape(1), single.size() );
+            for (size_t col = 0; col < single.size(); ++col)
+            {
+                BOOST_CHECK_EQUAL( batch(row, col), single[col] );
+            }
+        }
+    }
+    fe::feature_matrix result;
+    BOOST_CHECK_THROW( move_extractors[1]->extract( from, fe::ConstTraxelRefVector(), result ), std::runtime_error );
+
+    // a small forest on the 3 move features (2 ratios and the absolute difference)
+    fe::feature_matrix samples( vigra::Shape2(20, 3) );
+    vigra::MultiArray<2, double> labels( vigra::Shape2(20, 1) );
+    for (size_t row = 0; row < 20; ++row)
+    {
+        samples(row, 0) = 0.05 * row;
+        samples(row, 1) = 1. - 0.05 * row;
+        samples(row, 2) = 0.5 * row;
+        labels(row, 0) = row < 10 ? 0. : 1.;
+    }
+    vigra::RandomForest<> move_rf( vigra::rf::options().tree_count(10) );
+    move_rf.learn( samples, labels );
+
+    pgmlink::ClassifierMoveRF move_classifier( move_rf, move_extractors, "move" );
+    std::vector<pgmlink::feature_array> probabilities;
+    move_classifier.classify( from, to, probabilities, true );
+    BOOST_REQUIRE_EQUAL( probabilities.size(), 3 );
+    for (size_t row = 0; row < from.size(); ++row)
+    {
+        std::map<unsigned, pgmlink::feature_array> feature_map;
+        move_classifier.classify( *from[row], *to[row], feature_map, true );
+        const pgmlink::feature_array& single = feature_map[to[row]->Id];
+        BOOST_REQUIRE_EQUAL( probabilities[row].size(), single.size() );
+        for (size_t col = 0; col < single.size(); ++col)
+        {
+            BOOST_CHECK_CLOSE( probabilities[row][col], single[col], 1e-10 );
+        }
+    }
+
+    // divisions take the ratios of the children
+    std::vector<boost::shared_ptr<pgmlink::FeatureExtractor> > division_extractors( 1, move_extractors[0] );
+    vigra::RandomForest<> division_rf( vigra::rf::options().tree_count(10) );
+    division_rf.learn( samples.subarray( vigra::Shape2(0, 0), vigra::Shape2(20, 2) ), labels );
+    pgmlink::ClassifierDivisionRF division_classifier( division_rf, division_extractors, "division" );
+    division_classifier.classify( from, to, to_second, probabilities, true );
+    BOOST_REQUIRE_EQUAL( probabilities.size(), 3 );
+    for (size_t row = 0; row < from.size(); ++row)
+    {
+        std::map<std::pair<unsigned, unsigned>, pgmlink::feature_array> feature_map;
+        division_classifier.classify( *from[row], *to[row], *to_second[row], feature_map, true );
+        BOOST_REQUIRE_EQUAL( feature_map.size(), 1 );
+        const pgmlink::feature_array& single = feature_map.begin()->second;
+        BOOST_REQUIRE_EQUAL( probabilities[row].size(), single.size() );
+        for (size_t col = 0; col < single.size(); ++col)
+        {
+            BOOST_CHECK_CLOSE( probabilities[row][col], single[col], 1e-10 );
+        }
+    }
+
+    // classifiers without a batch implementation fall back to the single versions
+    pgmlink::ClassifierConstant constant( 0.25, "move" );
+    pgmlink::ClassifierStrategy& strategy = constant;
+    strategy.classify( from, to, probabilities, true );
+    BOOST_REQUIRE_EQUAL( probabilities.size(), 3 );
+    BOOST_REQUIRE_EQUAL( probabilities[2].size(), 2 );
+    BOOST_CHECK_EQUAL( probabilities[2][0], 0.75 );
+    BOOST_CHECK_EQUAL( probabilities[2][1], 0.25 );
+}
@@ -0,0 +1,106 @@
+#define BOOST_TEST_MODULE feature_matrix_writer_test
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include <stdint.h>
+
+#include <boost/test/unit_test.hpp>
+#include <hdf5.h>
+
+#include "pgmlink/features/feature_matrix_writer.h"
+
+using namespace pgmlink::features;
+using namespace std;
+
+namespace
+{
+template<typename T>
+vector<T> read_dataset(hid_t file, const char* name, hid_t type, hsize_t* dims)
+{
+    hid_t dataset = H5Dopen2(file, name, H5P_DEFAULT);
+    BOOST_REQUIRE(dataset >= 0);
+    hid_t space = H5Dget_space(dataset);
+    const int rank = H5Sget_simple_extent_dims(space, dims, NULL);
+    hsize_t size = 1;
+    for (int i = 0; i < rank; ++i)
+    {
+        size *= dims[i];
+    }
+    vector<T> values(size);
+    H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data());
+    H5Sclose(space);
+    H5Dclose(dataset);
+    return values;
+}
+}
+
+BOOST_AUTO_TEST_CASE( FeatureMatrixWriter_stacked )
+{
+    const char* filename = "feature_matrix_writer_test.h5";
+    remove(filename);
+    {
+        // tiny buffer: most appends are handed to the writer thread right away
+        FeatureMatrixWriter writer(filename, 64);
+        for (size_t track = 0; track < 50; ++track)
+        {
+            // track k has k % 4 rows, stored column-major like a vigra::MultiArray
+            const size_t rows = track % 4;
+            vector<double> matrix(rows * 2);
+            for (size_t i = 0; i < rows; ++i)
+            {
+                matrix[i] = 100. * track + i;
+                matrix[i + rows] = -1. * track;
+            }
+            writer.append("tracks/traxels", track + 10, matrix.data(), rows, 2);
+        }
+        double wrong[3] = {0., 0., 0.};
+        BOOST_CHECK_THROW(writer.append("tracks/traxels", 0, wrong, 1, 3), std::runtime_error);
+
+        double scores[3] = {1., 2., 3.};
+        writer.write("track_outliers_svm", scores, 3, 1);
+    }
+    {
+        // reopening appends to the file, replacing datasets of the same name
+        FeatureMatrixWriter writer(filename);
+        double matrix[2] = {5., 6.};
+        writer.append("divisions/traxels", 3, matrix, 1, 2);
+        writer.write("track_outliers_svm", matrix, 2, 1);
+        writer.close();
+        BOOST_CHECK_THROW(writer.append("divisions/traxels", 4, matrix, 1, 2), std::runtime_error);
+    }
+
+    hid_t file = H5Fopen(filename, H5F_ACC_RDONLY, H5P_DEFAULT);
+    BOOST_REQUIRE(file >= 0);
+    hsize_t dims[2];
+
+    vector<uint64_t> offsets = read_dataset<uint64_t>(file, "tracks/traxels/offsets", H5T_NATIVE_UINT64, dims);
+    BOOST_REQUIRE_EQUAL(dims[0], 51);
+    vector<uint64_t> ids = read_dataset<uint64_t>(file, "tracks/traxels/ids", H5T_NATIVE_UINT64, dims);
+    BOOST_REQUIRE_EQUAL(dims[0], 50);
+    vector<double> values = read_dataset<double>(file, "tracks/traxels/values", H5T_NATIVE_DOUBLE, dims);
+    BOOST_CHECK_EQUAL(dims[0], offsets.back());
+    BOOST_CHECK_EQUAL(dims[1], 2);
+    for (size_t track = 0; track < 50; ++track)
+    {
+        BOOST_CHECK_EQUAL(ids[track], track + 10);
+        BOOST_REQUIRE_EQUAL(offsets[track + 1] - offsets[track], track % 4);
+        for (size_t row = offsets[track]; row < offsets[track + 1]; ++row)
+        {
+            BOOST_CHECK_EQUAL(values[2 * row], 100. * track + row - offsets[track]);
+            BOOST_CHECK_EQUAL(values[2 * row + 1], -1. * track);
+        }
+    }
+
+    values = read_dataset<double>(file, "divisions/traxels/values", H5T_NATIVE_DOUBLE, dims);
+    BOOST_CHECK_EQUAL(dims[0], 1);
+    BOOST_CHECK_EQUAL(values[1], 6.);
+    values = read_dataset<double>(file, "track_outliers_svm", H5T_NATIVE_DOUBLE, dims);
+    BOOST_CHECK_EQUAL(dims[0], 1);
+    BOOST_CHECK_EQUAL(dims[1], 2);
+    BOOST_CHECK_EQUAL(values[1], 6.);
+
+    H5Fclose(file);
+    remove(filename);
+}
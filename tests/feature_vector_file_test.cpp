@@ -0,0 +1,88 @@
+#define BOOST_TEST_MODULE feature_vector_file_test
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pgmlink/features/feature_vector_file.h"
+
+using namespace pgmlink::features;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE( FeatureVectorFile_append_read )
+{
+    const string filename = "feature_vector_file_test.bin";
+    remove(filename.c_str());
+
+    vector<string> names;
+    names.push_back("Mean of track length");
+    names.push_back("x");
+    names.push_back("Variance of sq_diff_com");
+    for (size_t k = 0; k < 5; ++k)
+    {
+        vector<double> features(3, 0.5 * k);
+        features[1] = -1. * k;
+        FeatureVectorFile::append(filename, names, features);
+    }
+    // dimension and names have to match the file
+    BOOST_CHECK_THROW(FeatureVectorFile::append(filename, names, vector<double>(2)), std::runtime_error);
+    vector<string> other_names(names);
+    other_names[1] = "y";
+    BOOST_CHECK_THROW(FeatureVectorFile::append(filename, other_names, vector<double>(3)), std::runtime_error);
+
+    vector<string> read_names;
+    vector<vector<double> > proposals;
+    BOOST_CHECK_EQUAL(FeatureVectorFile::read(filename, read_names, proposals), 5);
+    BOOST_CHECK(read_names == names);
+    BOOST_CHECK_EQUAL(proposals[3][0], 1.5);
+    BOOST_CHECK_EQUAL(proposals[3][1], -3.);
+    BOOST_CHECK_EQUAL(proposals[4][2], 2.);
+
+    // rows start aligned, right after the header
+    const size_t offset = FeatureVectorFile::data_offset(filename);
+    BOOST_CHECK_EQUAL(offset % 8, 0);
+    ifstream in(filename.c_str(), ios::binary | ios::ate);
+    BOOST_CHECK_EQUAL(static_cast<size_t>(in.tellg()), offset + 5 * 3 * sizeof(double));
+
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( FeatureVectorFile_convert_text_file )
+{
+    const string text_filename = "feature_vector_file_test.txt";
+    const string filename = "feature_vector_file_test_converted.bin";
+    {
+        // one line per feature, one column per proposal
+        ofstream text(text_filename.c_str());
+        text << "# features of two proposals\n";
+        text << "1 2\n";
+        text << "\n";
+        text << "3.5 4.5 # comment\n";
+    }
+
+    BOOST_CHECK_EQUAL(FeatureVectorFile::convert_text_file(text_filename, filename), 2);
+    vector<string> names;
+    vector<vector<double> > proposals;
+    BOOST_CHECK_EQUAL(FeatureVectorFile::read(filename, names, proposals), 2);
+    BOOST_REQUIRE_EQUAL(names.size(), 2);
+    BOOST_CHECK_EQUAL(names[1], "1");
+    BOOST_CHECK_EQUAL(proposals[0][0], 1.);
+    BOOST_CHECK_EQUAL(proposals[0][1], 3.5);
+    BOOST_CHECK_EQUAL(proposals[1][1], 4.5);
+
+    // converted files can be appended to
+    vector<double> features(2, 7.);
+    FeatureVectorFile::append(filename, names, features);
+    BOOST_CHECK_EQUAL(FeatureVectorFile::read(filename, names, proposals), 3);
+    BOOST_CHECK_EQUAL(proposals[2][0], 7.);
+
+    BOOST_CHECK_THROW(FeatureVectorFile::convert_text_file(text_filename, filename, vector<string>(3)),
+                      std::runtime_error);
+
+    remove(text_filename.c_str());
+    remove(filename.c_str());
+}
@@ -4,7 +4,9 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
+#include <boost/make_shared.hpp>
 #include <cmath> /* for abs() */
+#include <cstdio> /* for remove() */
 
 #include "pgmlink/log.h"
 #include "pgmlink/features/higher_order_features.h"
@@ -1255,6 +1257,48 @@ BOOST_AUTO_TEST_CASE( DiffusionCalculator_test )
     BOOST_CHECK_EQUAL(diffusion(0, 0), static_cast<FeatureScalar>(31. / 6.));
 }
 
+BOOST_AUTO_TEST_CASE( FusedCalculator_test )
+{
+    LOG(logINFO) << "test case: FusedCalculator_test";
+
+    // the fused calculators have to agree with the chained calculators
+    std::vector<FeatureMatrix> inputs(3);
+    get_feature_matrix(inputs[0]);
+    inputs[1].reshape(vigra::Shape2(1, 2));
+    inputs[1](0, 0) = 3.;
+    inputs[1](0, 1) = 4.;
+
+    std::vector<boost::shared_ptr<TraxelsFeatureCalculator> > fused;
+    std::vector<boost::shared_ptr<TraxelsFeatureCalculator> > chained;
+    fused.push_back(boost::make_shared<EuclideanNormCalculator>());
+    chained.push_back(boost::make_shared < TCompositionCalculator <
+                      SquaredNormCalculator<0>, SquareRootCalculator > > ());
+    fused.push_back(boost::make_shared<SquaredCurveCalculator>());
+    chained.push_back(boost::make_shared < TCompositionCalculator <
+                      CurveCalculator, SquaredNormCalculator<0> > > ());
+    fused.push_back(boost::make_shared<DiffusionCalculator>());
+    chained.push_back(boost::make_shared < TCompositionCalculator <
+                      TCompositionCalculator<DiffCalculator, SquaredNormCalculator<0> >,
+                      MeanCalculator<0> > > ());
+
+    for (size_t i = 0; i < fused.size(); i++)
+    {
+        for (size_t k = 0; k < inputs.size(); k++)
+        {
+            FeatureMatrix fused_result;
+            FeatureMatrix chained_result;
+            fused[i]->calculate(inputs[k], fused_result);
+            chained[i]->calculate(inputs[k], chained_result);
+            BOOST_REQUIRE_EQUAL(fused_result.shape(0), chained_result.shape(0));
+            BOOST_REQUIRE_EQUAL(fused_result.shape(1), chained_result.shape(1));
+            for (size_t j = 0; j < fused_result.size(); j++)
+            {
+                BOOST_CHECK_CLOSE(fused_result[j], chained_result[j], 1e-10);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE( CovarianceCalculator_test )
 {
     LOG(logINFO) << "test case: CovarianceCalculator_test";
@@ -1435,6 +1479,62 @@ BOOST_AUTO_TEST_CASE( SVMOutlierCalculator_serialization )
         BOOST_CHECK_EQUAL(*s_it, *s_load_it);
     }
 }
+
+BOOST_AUTO_TEST_CASE( SVMOutlierCalculator_subsampling )
+{
+    LOG(logINFO) << "test case: SVMOutlierCalculator_subsampling";
+
+    // 300 samples on a grid in the unit square
+    FeatureMatrix x_train(vigra::Shape2(300, 2));
+    for (size_t col = 0; col < 300; col++)
+    {
+        x_train(col, 0) = (col % 17) / 17.0;
+        x_train(col, 1) = (col % 13) / 13.0;
+    }
+    FeatureMatrix x;
+    get_feature_matrix(x);
+
+    SVMOutlierCalculator svmoutlier;
+    BOOST_CHECK_EQUAL(svmoutlier.get_max_training_samples(), SVMOutlierCalculator::default_max_training_samples);
+    BOOST_CHECK_EQUAL(svmoutlier.get_max_training_samples(), 0);
+
+    // a limit above the number of samples trains on all of them
+    FeatureMatrix s_all, s_limit;
+    svmoutlier.set_max_training_samples(0);
+    svmoutlier.train(x_train, 1.0);
+    svmoutlier.calculate(x, s_all);
+    svmoutlier.set_max_training_samples(1000);
+    svmoutlier.train(x_train, 1.0);
+    svmoutlier.calculate(x, s_limit);
+    BOOST_REQUIRE_EQUAL(s_all.shape(0), s_limit.shape(0));
+    for (size_t col = 0; col < static_cast<size_t>(s_all.shape(0)); col++)
+    {
+        BOOST_CHECK_EQUAL(s_all(col, 0), s_limit(col, 0));
+    }
+
+    // subsampled training still scores all columns
+    svmoutlier.set_max_training_samples(50);
+    svmoutlier.train(x_train, 1.0);
+    FeatureMatrix s;
+    svmoutlier.calculate(x, s);
+    BOOST_CHECK_EQUAL(s.shape(0), x.shape(0));
+    BOOST_CHECK_EQUAL(s.shape(1), 1);
+
+    // reuse the trained calculator from a file
+    const std::string filename = "svm_outlier_test.txt";
+    svmoutlier.write_to_file(filename);
+    SVMOutlierCalculator svmoutlier_loaded;
+    svmoutlier_loaded.read_from_file(filename);
+    std::remove(filename.c_str());
+    BOOST_CHECK(svmoutlier_loaded.is_trained());
+    FeatureMatrix s_load;
+    svmoutlier_loaded.calculate(x, s_load);
+    for (size_t col = 0; col < static_cast<size_t>(s.shape(0)); col++)
+    {
+        BOOST_CHECK_EQUAL(s(col, 0), s_load(col, 0));
+    }
+    BOOST_CHECK_THROW(svmoutlier_loaded.read_from_file(filename), std::runtime_error);
+}
 #endif
 
 BOOST_AUTO_TEST_CASE( GraphFeatureCalculator_calculate_vector )
@@ -1471,3 +1571,68 @@ BOOST_AUTO_TEST_CASE( GraphFeatureCalculator_calculate_vector )
     BOOST_CHECK_EQUAL(result(1, 0), 12.);
     BOOST_CHECK_EQUAL(result(2, 0), 14.);
 }
+
+BOOST_AUTO_TEST_CASE( TraxelsFeatureCalculator_parallel )
+{
+    LOG(logINFO) << "test case: TraxelsFeatureCalculator_parallel";
+
+    // subsets of 1 to 5 traxels, the first one without the feature
+    std::vector<Traxel> traxels(500);
+    for (size_t i = 1; i < traxels.size(); i++)
+    {
+        traxels[i].features["com"].push_back(static_cast<double>(i % 7));
+        traxels[i].features["com"].push_back(static_cast<double>(i * i % 11));
+    }
+    ConstTraxelRefVectors subsets(1, ConstTraxelRefVector(1, &traxels[0]));
+    for (size_t i = 1; i < traxels.size(); )
+    {
+        ConstTraxelRefVector subset;
+        for (size_t j = 0; j < subsets.size() % 5 + 1 && i < traxels.size(); j++, i++)
+        {
+            subset.push_back(&traxels[i]);
+        }
+        subsets.push_back(subset);
+    }
+
+    boost::shared_ptr<TraxelsFeaturesIdentity> com_extractor_ptr(
+        new TraxelsFeaturesIdentity("com")
+    );
+    DiffCalculator diff_calculator;
+
+    // the return matrix does not depend on the execution mode
+    FeatureMatrix serial;
+    FeatureMatrix parallel;
+    diff_calculator.calculate_for_all(subsets, serial, com_extractor_ptr, false);
+    diff_calculator.calculate_for_all(subsets, parallel, com_extractor_ptr, true);
+    BOOST_REQUIRE_EQUAL(serial.shape(0), subsets.size());
+    BOOST_REQUIRE_EQUAL(serial.shape(1), 2);
+    BOOST_REQUIRE(serial.shape() == parallel.shape());
+    BOOST_CHECK_EQUAL_COLLECTIONS(serial.begin(), serial.end(), parallel.begin(), parallel.end());
+    // empty first result, the row count comes from the second subset
+    BOOST_CHECK_EQUAL(serial(0, 0), 0.);
+    BOOST_CHECK_EQUAL(serial(0, 1), 0.);
+    BOOST_CHECK_EQUAL(serial(1, 0), 1.);
+    BOOST_CHECK_EQUAL(serial(1, 1), 3.);
+
+    std::vector<FeatureMatrix> serial_results;
+    std::vector<FeatureMatrix> parallel_results;
+    TraxelsFeaturesIdentity com_extractor("com");
+    diff_calculator.calculate_for_each(subsets, serial_results, com_extractor, 2, false);
+    diff_calculator.calculate_for_each(subsets, parallel_results, com_extractor, 2, true);
+    BOOST_REQUIRE_EQUAL(serial_results.size(), subsets.size());
+    BOOST_REQUIRE_EQUAL(parallel_results.size(), subsets.size());
+    for (size_t i = 0; i < subsets.size(); i++)
+    {
+        if (subsets[i].size() < 2)
+        {
+            BOOST_CHECK_EQUAL(serial_results[i].size(), 0);
+            BOOST_CHECK_EQUAL(parallel_results[i].size(), 0);
+            continue;
+        }
+        BOOST_CHECK_EQUAL(serial_results[i].shape(0), subsets[i].size() - 1);
+        BOOST_REQUIRE(serial_results[i].shape() == parallel_results[i].shape());
+        BOOST_CHECK_EQUAL_COLLECTIONS(
+            serial_results[i].begin(), serial_results[i].end(),
+            parallel_results[i].begin(), parallel_results[i].end());
+    }
+}
@@ -1,7 +1,9 @@
 #define BOOST_TEST_MODULE hypotheses_test
 
+#include <cstdio>
 #include <vector>
 #include <string>
+#include <set>
 #include <iostream>
 
 #include <boost/archive/text_oarchive.hpp>
@@ -14,6 +16,8 @@
 #include <lemon/maps.h>
 
 #include "pgmlink/hypotheses.h"
+#include "pgmlink/frozen_hypotheses_graph.h"
+#include "pgmlink/out_of_core_traxel_store.h"
 #include "pgmlink/traxels.h"
 #include <pgmlink/features/feature.h>
 
@@ -298,6 +302,212 @@ BOOST_AUTO_TEST_CASE( SingleTimestepTraxel_HypothesesBuilder_build_forward_backw
 }
 
 
+namespace
+{
+// (from timestep, from id, to timestep, to id) of all arcs
+std::set<std::vector<int> > arcs_by_traxels(HypothesesGraph& g)
+{
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g.get(node_traxel());
+    std::set<std::vector<int> > arcs;
+    for(HypothesesGraph::ArcIt a(g); a != lemon::INVALID; ++a)
+    {
+        const Traxel& from = traxel_map[g.source(a)];
+        const Traxel& to = traxel_map[g.target(a)];
+        std::vector<int> arc;
+        arc.push_back(from.Timestep);
+        arc.push_back(from.Id);
+        arc.push_back(to.Timestep);
+        arc.push_back(to.Id);
+        arcs.insert(arc);
+    }
+    return arcs;
+}
+}
+
+BOOST_AUTO_TEST_CASE( IncrementalHypothesesBuilder_add_timestep )
+{
+    // three frames of traxels on a line, the last frame after a gap
+    TraxelStore ts;
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    const int timesteps[] = {0, 1, 2, 4};
+    unsigned int id = 1;
+    for (size_t t = 0; t < 4; ++t)
+    {
+        for (size_t i = 0; i < 4; ++i, ++id)
+        {
+            Traxel tr;
+            tr.Id = id;
+            tr.Timestep = timesteps[t];
+            feature_array com(3, 0.);
+            com[0] = 2. * i + 0.3 * t;
+            com[1] = (i % 2) * t;
+            tr.features["com"] = com;
+            add(ts, fs, tr);
+        }
+    }
+
+    SingleTimestepTraxel_HypothesesBuilder::Options builder_opts(2, // max_nn
+            10, // max_distance
+            true, // forward_backward
+            false, // consider_divisions
+            0.5 //division_threshold
+                                                                );
+    SingleTimestepTraxel_HypothesesBuilder builder(&ts, builder_opts);
+    boost::shared_ptr<HypothesesGraph> batch(builder.build());
+
+    IncrementalHypothesesBuilder incremental(builder_opts);
+    for (size_t t = 0; t < 4; ++t)
+    {
+        std::pair<TraxelStoreByTimestep::const_iterator, TraxelStoreByTimestep::const_iterator> frame =
+            ts.get<by_timestep>().equal_range(timesteps[t]);
+        incremental.add_timestep(std::vector<Traxel>(frame.first, frame.second));
+    }
+    incremental.add_timestep(std::vector<Traxel>());
+    HypothesesGraph& g = *incremental.get_graph();
+
+    BOOST_CHECK_EQUAL(lemon::countNodes(g), lemon::countNodes(*batch));
+    BOOST_CHECK_EQUAL(lemon::countArcs(g), lemon::countArcs(*batch));
+    BOOST_CHECK(g.timesteps() == batch->timesteps());
+    std::set<std::vector<int> > arcs = arcs_by_traxels(g);
+    BOOST_CHECK(arcs == arcs_by_traxels(*batch));
+    for (std::set<std::vector<int> >::const_iterator arc = arcs.begin(); arc != arcs.end(); ++arc)
+    {
+        BOOST_CHECK_EQUAL((*arc)[2], (*arc)[0] + 1);
+    }
+
+    // timesteps have to increase, frames must not mix timesteps
+    std::vector<Traxel> frame;
+    Traxel tr;
+    tr.Id = 100;
+    tr.Timestep = 3;
+    frame.push_back(tr);
+    BOOST_CHECK_THROW(incremental.add_timestep(frame), std::runtime_error);
+    frame[0].Timestep = 5;
+    tr.Timestep = 6;
+    frame.push_back(tr);
+    BOOST_CHECK_THROW(incremental.add_timestep(frame), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( SingleTimestepTraxel_HypothesesBuilder_out_of_core )
+{
+    // frames with a gap, and a feature which is not kept in the graph
+    TraxelStore ts;
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    const int timesteps[] = {0, 1, 2, 4};
+    unsigned int id = 1;
+    for (size_t t = 0; t < 4; ++t)
+    {
+        for (size_t i = 0; i < 4; ++i, ++id)
+        {
+            Traxel tr;
+            tr.Id = id;
+            tr.Timestep = timesteps[t];
+            feature_array com(3, 0.);
+            com[0] = 2. * i + 0.3 * t;
+            com[1] = (i % 2) * t;
+            tr.features["com"] = com;
+            tr.features["count"] = feature_array(1, 10. * i);
+            add(ts, fs, tr);
+        }
+    }
+    const std::string filename = "hypotheses_test_out_of_core.h5";
+    std::remove(filename.c_str());
+    OutOfCoreTraxelStore::write(filename, ts);
+
+    SingleTimestepTraxel_HypothesesBuilder::Options builder_opts(2, // max_nn
+            10, // max_distance
+            true, // forward_backward
+            false, // consider_divisions
+            0.5 //division_threshold
+                                                                );
+    SingleTimestepTraxel_HypothesesBuilder builder(&ts, builder_opts);
+    boost::shared_ptr<HypothesesGraph> in_memory(builder.build());
+
+    {
+        OutOfCoreTraxelStore store(filename, 2);
+        boost::shared_ptr<FeatureStore> resident_fs = boost::make_shared<FeatureStore>();
+        SingleTimestepTraxel_HypothesesBuilder out_of_core_builder(&store, resident_fs, builder_opts);
+        boost::shared_ptr<HypothesesGraph> g(out_of_core_builder.build());
+
+        BOOST_CHECK_EQUAL(lemon::countNodes(*g), lemon::countNodes(*in_memory));
+        BOOST_CHECK(g->timesteps() == in_memory->timesteps());
+        BOOST_CHECK(arcs_by_traxels(*g) == arcs_by_traxels(*in_memory));
+
+        property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g->get(node_traxel());
+        for (HypothesesGraph::NodeIt n(*g); n != lemon::INVALID; ++n)
+        {
+            const Traxel& tr = traxel_map[n];
+            BOOST_CHECK(tr.get_feature_store() == resident_fs);
+            BOOST_CHECK(tr.features.find("com") != tr.features.end());
+            BOOST_CHECK(tr.features.find("count") == tr.features.end());
+        }
+        BOOST_CHECK_LE(store.frames_loaded(), 2 * store.timesteps().size());
+    }
+    std::remove(filename.c_str());
+}
+
+
+BOOST_AUTO_TEST_CASE( SingleTimestepTraxel_HypothesesBuilder_out_of_core_divisions )
+{
+    // the neighbor search reads com_corrected of the query traxel and divProb,
+    // so both have to stay resident without being asked for
+    TraxelStore ts;
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    unsigned int id = 1;
+    for (int t = 0; t < 3; ++t)
+    {
+        for (size_t i = 0; i < 4; ++i, ++id)
+        {
+            Traxel tr;
+            tr.Id = id;
+            tr.Timestep = t;
+            feature_array com(3, 0.);
+            com[0] = 3. * i + 0.3 * t;
+            com[1] = (i % 2) * t;
+            feature_array com_corrected(com);
+            com_corrected[0] += 1.6;
+            tr.features["com"] = com;
+            tr.features["com_corrected"] = com_corrected;
+            tr.features["divProb"] = feature_array(1, (i % 2) ? 0.9 : 0.1);
+            tr.features["count"] = feature_array(1, 10. * i);
+            add(ts, fs, tr);
+        }
+    }
+    const std::string filename = "hypotheses_test_out_of_core_divisions.h5";
+    std::remove(filename.c_str());
+    OutOfCoreTraxelStore::write(filename, ts);
+
+    SingleTimestepTraxel_HypothesesBuilder::Options builder_opts(1, // max_nn
+            10, // max_distance
+            true, // forward_backward
+            true, // consider_divisions
+            0.5 //division_threshold
+                                                                );
+    SingleTimestepTraxel_HypothesesBuilder builder(&ts, builder_opts);
+    boost::shared_ptr<HypothesesGraph> in_memory(builder.build());
+
+    {
+        OutOfCoreTraxelStore store(filename, 2);
+        boost::shared_ptr<FeatureStore> resident_fs = boost::make_shared<FeatureStore>();
+        SingleTimestepTraxel_HypothesesBuilder out_of_core_builder(&store, resident_fs, builder_opts);
+        boost::shared_ptr<HypothesesGraph> g(out_of_core_builder.build());
+
+        BOOST_CHECK_EQUAL(lemon::countNodes(*g), lemon::countNodes(*in_memory));
+        BOOST_CHECK_EQUAL(lemon::countArcs(*g), lemon::countArcs(*in_memory));
+        BOOST_CHECK(arcs_by_traxels(*g) == arcs_by_traxels(*in_memory));
+
+        property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g->get(node_traxel());
+        for (HypothesesGraph::NodeIt n(*g); n != lemon::INVALID; ++n)
+        {
+            const Traxel& tr = traxel_map[n];
+            BOOST_CHECK(tr.features.find("com") != tr.features.end());
+            BOOST_CHECK(tr.features.find("com_corrected") != tr.features.end());
+            BOOST_CHECK(tr.features.find("divProb") != tr.features.end());
+            BOOST_CHECK(tr.features.find("count") == tr.features.end());
+        }
+    }
+    std::remove(filename.c_str());
+}
 BOOST_AUTO_TEST_CASE( SingleTimestepTraxel_HypothesesBuilder_build_divisions )
 {
     Traxel tr11, tr12, tr21, tr22, tr23;
@@ -515,6 +725,66 @@ BOOST_AUTO_TEST_CASE( SingleTimestepTraxel_HypothesesGraph_generateTraxelGraph )
 }
 
 
+BOOST_AUTO_TEST_CASE( HypothesesGraph_generateTrackletView )
+{
+    // 1 - 2 - 3 - 4
+    //           \
+    //             5
+    HypothesesGraph traxel_graph;
+    traxel_graph.add(node_traxel()).add(arc_distance());
+    std::vector<HypothesesGraph::Node> nodes;
+    for(int t = 0; t < 4; ++t)
+    {
+        nodes.push_back(traxel_graph.add_node(t));
+    }
+    nodes.push_back(traxel_graph.add_node(3));
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        traxel_graph.get(node_traxel()).set(nodes[i], Traxel(i + 1, traxel_graph.get(node_timestep())[nodes[i]]));
+    }
+    HypothesesGraph::Arc a12 = traxel_graph.addArc(nodes[0], nodes[1]);
+    HypothesesGraph::Arc a23 = traxel_graph.addArc(nodes[1], nodes[2]);
+    traxel_graph.addArc(nodes[2], nodes[3]);
+    traxel_graph.addArc(nodes[2], nodes[4]);
+    for(HypothesesGraph::ArcIt a(traxel_graph); a != lemon::INVALID; ++a)
+    {
+        traxel_graph.get(arc_distance()).set(a, 1. + traxel_graph.id(a));
+    }
+
+    HypothesesGraph tracklet_graph;
+    boost::shared_ptr<const TrackletView> view = generateTrackletView(traxel_graph, tracklet_graph);
+    BOOST_CHECK(view->references_traxel_graph());
+    BOOST_CHECK(!tracklet_graph.has_property(node_tracklet()));
+    BOOST_CHECK_EQUAL(lemon::countNodes(tracklet_graph), 3);
+    BOOST_CHECK_EQUAL(lemon::countArcs(tracklet_graph), 2);
+
+    HypothesesGraph materialized_graph;
+    std::map<HypothesesGraph::Node, std::vector<HypothesesGraph::Node> > node_map =
+        generateTrackletGraph2(traxel_graph, materialized_graph);
+    BOOST_CHECK(view->tracklet2traxel_node_map() == node_map);
+
+    property_map<node_tracklet, HypothesesGraph::base_graph>::type& tracklet_map = materialized_graph.get(node_tracklet());
+    for(HypothesesGraph::NodeIt n(tracklet_graph); n != lemon::INVALID; ++n)
+    {
+        BOOST_REQUIRE_EQUAL(view->size(n), tracklet_map[n].size());
+        BOOST_CHECK_EQUAL(materialized_graph.tracklets().size(n), tracklet_map[n].size());
+        for(size_t i = 0; i < view->size(n); ++i)
+        {
+            BOOST_CHECK_EQUAL(view->traxel(n, i).Id, tracklet_map[n][i].Id);
+            BOOST_CHECK(view->traxel_node(n, i) == node_map[n][i]);
+        }
+        if(view->front(n).Id == 1)
+        {
+            BOOST_REQUIRE_EQUAL(view->size(n), 3);
+            BOOST_CHECK_EQUAL(view->intern_arc_id(n, 0), traxel_graph.id(a12));
+            BOOST_CHECK_EQUAL(view->intern_arc_id(n, 1), traxel_graph.id(a23));
+            BOOST_CHECK_EQUAL(view->intern_dist(n, 1), traxel_graph.get(arc_distance())[a23]);
+            BOOST_CHECK_EQUAL(materialized_graph.tracklets().intern_arc_id(n, 1), traxel_graph.id(a23));
+        }
+    }
+}
+
+
 BOOST_AUTO_TEST_CASE( SingleTimestepTraxel_HypothesesGraph_eventVector )
 {
     HypothesesGraph traxel_graph;
@@ -1244,3 +1514,265 @@ BOOST_AUTO_TEST_CASE( HypothesesGraph_SaveToDot )
                                      5); // trans param
     BOOST_CHECK(true);
 }
+
+BOOST_AUTO_TEST_CASE( HypothesesGraph_flat_state_and_events )
+{
+    // 1 - 2
+    //   \
+    //     3
+    HypothesesGraph g;
+    HypothesesGraph::Node n1 = g.add_node(0);
+    HypothesesGraph::Node n2 = g.add_node(1);
+    HypothesesGraph::Node n3 = g.add_node(1);
+    HypothesesGraph::Arc a12 = g.addArc(n1, n2);
+    HypothesesGraph::Arc a13 = g.addArc(n1, n3);
+
+    g.add(node_traxel()).add(node_active2()).add(arc_active());
+    g.get(node_traxel()).set(n1, Traxel(1, 0));
+    g.get(node_traxel()).set(n2, Traxel(2, 1));
+    g.get(node_traxel()).set(n3, Traxel(3, 1));
+    g.get(node_active2()).set(n1, 1);
+    g.get(node_active2()).set(n2, 1);
+    g.get(node_active2()).set(n3, 0);
+    g.get(arc_active()).set(a12, true);
+    g.get(arc_active()).set(a13, false);
+
+    boost::shared_ptr<HypothesesGraphState> state = hypotheses_graph_state(g);
+    BOOST_CHECK_EQUAL(state->n_iterations, 1);
+    BOOST_CHECK_EQUAL(state->node_ids.size(), 3);
+    BOOST_CHECK_EQUAL(state->node_active_count.size(), 3);
+    BOOST_CHECK_EQUAL(state->arc_active_count.size(), 2);
+    for(size_t i = 0; i < state->node_ids.size(); ++i)
+    {
+        HypothesesGraph::Node n = g.nodeFromId(state->node_ids[i]);
+        BOOST_CHECK_EQUAL(state->node_active_count[i], g.get(node_active2())[n]);
+        BOOST_CHECK_EQUAL(state->node_traxel_ids[i], g.get(node_traxel())[n].Id);
+    }
+    for(size_t i = 0; i < state->arc_ids.size(); ++i)
+    {
+        HypothesesGraph::Arc a = g.arcFromId(state->arc_ids[i]);
+        BOOST_CHECK_EQUAL(state->arc_active_count[i], g.get(arc_active())[a] ? 1 : 0);
+        BOOST_CHECK_EQUAL(state->arc_sources[i], g.id(g.source(a)));
+    }
+
+    std::vector<EventRecord> records;
+    EventVectorVector ev = *events(g);
+    flatten_events(ev, records);
+    size_t n_events = 0;
+    for(size_t t = 0; t < ev.size(); ++t)
+    {
+        n_events += ev[t].size();
+    }
+    BOOST_CHECK_EQUAL(records.size(), n_events);
+    for(size_t i = 0; i < records.size(); ++i)
+    {
+        if(records[i].type == Event::Move)
+        {
+            BOOST_CHECK_EQUAL(records[i].n_traxel_ids, 2);
+            BOOST_CHECK_EQUAL(records[i].traxel_ids[0], 1);
+            BOOST_CHECK_EQUAL(records[i].traxel_ids[1], 2);
+            BOOST_CHECK(records[i].traxel_ids[2] == EventRecord::invalid_id);
+            BOOST_CHECK_EQUAL(records[i].timestep, 1);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( HypothesesGraph_multi_events )
+{
+    // t=0   t=1   t=2   t=3
+    //  1 --- 2 --- 4 --- 6
+    //          \
+    //            5 --- 7
+    //        3
+    HypothesesGraph g;
+    HypothesesGraph::Node n1 = g.add_node(0);
+    HypothesesGraph::Node n2 = g.add_node(1);
+    HypothesesGraph::Node n3 = g.add_node(1);
+    HypothesesGraph::Node n4 = g.add_node(2);
+    HypothesesGraph::Node n5 = g.add_node(2);
+    HypothesesGraph::Node n6 = g.add_node(3);
+    HypothesesGraph::Node n7 = g.add_node(3);
+    HypothesesGraph::Arc a12 = g.addArc(n1, n2);
+    HypothesesGraph::Arc a24 = g.addArc(n2, n4);
+    HypothesesGraph::Arc a25 = g.addArc(n2, n5);
+    HypothesesGraph::Arc a46 = g.addArc(n4, n6);
+    HypothesesGraph::Arc a57 = g.addArc(n5, n7);
+
+    g.add(node_traxel()).add(node_active_count()).add(arc_active_count()).add(division_active_count());
+    HypothesesGraph::Node nodes[] = {n1, n2, n3, n4, n5, n6, n7};
+    // iteration 0: 1 -> 2 divides into 4 and 5, 3 disappears
+    // iteration 1: 1 -> 2 -> 4 -> 6, 3 disappears, 5 appears and moves to 7
+    for (unsigned int i = 0; i < 7; ++i)
+    {
+        g.get(node_traxel()).set(nodes[i], Traxel(i + 1, g.get(node_timestep())[nodes[i]]));
+        g.get(node_active_count()).set(nodes[i], std::vector<size_t>(2, 1));
+        g.get(division_active_count()).set(nodes[i], std::vector<bool>(2, false));
+    }
+    std::vector<bool> both(2, true), first(2, false);
+    first[0] = true;
+    g.get(arc_active_count()).set(a12, both);
+    g.get(arc_active_count()).set(a24, both);
+    g.get(arc_active_count()).set(a25, first);
+    g.get(arc_active_count()).set(a46, both);
+    g.get(arc_active_count()).set(a57, both);
+    g.get(division_active_count()).set(n2, first);
+
+    boost::shared_ptr<EventVectorVectorVector> all = multi_events(g);
+    BOOST_REQUIRE_EQUAL(all->size(), 2);
+    for (size_t i = 0; i < all->size(); ++i)
+    {
+        EventVectorVector single = *events(g, i);
+        BOOST_REQUIRE_EQUAL((*all)[i].size(), single.size());
+        for (size_t t = 0; t < single.size(); ++t)
+        {
+            BOOST_CHECK_EQUAL_COLLECTIONS((*all)[i][t].begin(), (*all)[i][t].end(),
+                                          single[t].begin(), single[t].end());
+        }
+    }
+    boost::shared_ptr<EventTable> table = event_table(g);
+    BOOST_CHECK_EQUAL(table->n_iterations(), 2);
+    BOOST_CHECK_EQUAL(table->n_timesteps(), 4);
+    EventVectorVectorVector from_table;
+    table->to_events(from_table);
+    BOOST_REQUIRE_EQUAL(from_table.size(), 2);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        for (size_t t = 0; t < from_table[i].size(); ++t)
+        {
+            BOOST_CHECK_EQUAL_COLLECTIONS(from_table[i][t].begin(), from_table[i][t].end(),
+                                          (*all)[i][t].begin(), (*all)[i][t].end());
+        }
+    }
+
+    BOOST_REQUIRE_EQUAL((*all)[0].size(), 4);
+    BOOST_REQUIRE_EQUAL((*all)[0][2].size(), 2);
+    BOOST_CHECK((*all)[0][2][0].type == Event::Division || (*all)[0][2][1].type == Event::Division);
+    BOOST_REQUIRE_EQUAL((*all)[1][2].size(), 3);
+    BOOST_CHECK((*all)[1][2][0].type != Event::Division && (*all)[1][2][1].type != Event::Division);
+    BOOST_CHECK_EQUAL((*all)[1][2][2].type, Event::Appearance);
+
+    // timesteps 2 and 3 only, still including the events arriving from timestep 1
+    boost::shared_ptr<EventVectorVectorVector> range = multi_events(g, 1, 2, 3);
+    BOOST_REQUIRE_EQUAL(range->size(), 1);
+    BOOST_REQUIRE_EQUAL((*range)[0].size(), 2);
+    for (size_t t = 0; t < 2; ++t)
+    {
+        BOOST_CHECK_EQUAL_COLLECTIONS((*range)[0][t].begin(), (*range)[0][t].end(),
+                                      (*all)[0][t + 2].begin(), (*all)[0][t + 2].end());
+    }
+    BOOST_CHECK_EQUAL(events(g, 1, 3, 100)->size(), 1);
+    BOOST_CHECK_EQUAL(events(g, 1, 5, 100)->size(), 0);
+
+    // one frozen graph shared by the calls for every iteration
+    const FrozenHypothesesGraph frozen(g);
+    for (size_t i = 0; i < all->size(); ++i)
+    {
+        EventVectorVector single = *events(frozen, i);
+        BOOST_REQUIRE_EQUAL((*all)[i].size(), single.size());
+        for (size_t t = 0; t < single.size(); ++t)
+        {
+            BOOST_CHECK_EQUAL_COLLECTIONS((*all)[i][t].begin(), (*all)[i][t].end(),
+                                          single[t].begin(), single[t].end());
+        }
+    }
+    BOOST_CHECK_EQUAL(event_table(frozen)->size(), table->size());
+    BOOST_CHECK_EQUAL(multi_events(frozen, 1, 2, 3)->size(), 1);
+
+    // freezing one iteration of timesteps 1 and 2 only, uncertainties still count all iterations
+    const FrozenSolution full(frozen);
+    const FrozenSolution part(frozen, 0, 1, 1, 2);
+    BOOST_CHECK_EQUAL(part.n_iterations(), 2);
+    for (size_t n = frozen.timestep_begin(1); n < frozen.timestep_end(2); ++n)
+    {
+        BOOST_CHECK_EQUAL(part.node_active(n, 0), full.node_active(n, 0));
+        BOOST_CHECK_EQUAL(part.division_active(n, 0), full.division_active(n, 0));
+    }
+    BOOST_CHECK(part.arc_active(frozen.index(a12), 0));
+    BOOST_CHECK(part.arc_active(frozen.index(a25), 0));
+    BOOST_CHECK_EQUAL(part.arc_uncertainty(frozen.index(a25), 0), 0.5);
+    BOOST_CHECK_EQUAL(part.arc_uncertainty(frozen.index(a25), 0), full.arc_uncertainty(frozen.index(a25), 0));
+    BOOST_CHECK_EQUAL(part.arc_uncertainty(frozen.index(a24), 0), 0.);
+    BOOST_CHECK_EQUAL(part.division_uncertainty(frozen.index(n2), 0), 0.5);
+}
+
+BOOST_AUTO_TEST_CASE( HypothesesGraph_freeze )
+{
+    // t=0   t=1   t=2   t=4
+    //  1 --- 3 --- 4
+    //    \
+    //  2   --------- 5      6
+    HypothesesGraph g;
+    HypothesesGraph::Node n4 = g.add_node(2);
+    HypothesesGraph::Node n1 = g.add_node(0);
+    HypothesesGraph::Node n3 = g.add_node(1);
+    HypothesesGraph::Node n2 = g.add_node(0);
+    HypothesesGraph::Node n5 = g.add_node(2);
+    HypothesesGraph::Node n6 = g.add_node(4);
+    HypothesesGraph::Arc a13 = g.addArc(n1, n3);
+    HypothesesGraph::Arc a15 = g.addArc(n1, n5);
+    HypothesesGraph::Arc a34 = g.addArc(n3, n4);
+
+    g.add(node_traxel()).add(node_active2()).add(arc_active());
+    HypothesesGraph::Node nodes[] = {n1, n2, n3, n4, n5, n6};
+    for (unsigned int i = 0; i < 6; ++i)
+    {
+        g.get(node_traxel()).set(nodes[i], Traxel(i + 1, g.get(node_timestep())[nodes[i]]));
+        g.get(node_active2()).set(nodes[i], i + 1 == 2 ? 0 : 1);
+    }
+    g.get(node_active2()).set(n3, 2);
+    g.get(arc_active()).set(a13, true);
+    g.get(arc_active()).set(a15, false);
+    g.get(arc_active()).set(a34, true);
+
+    FrozenHypothesesGraph frozen(g);
+    BOOST_CHECK_EQUAL(frozen.num_nodes(), 6);
+    BOOST_CHECK_EQUAL(frozen.num_arcs(), 3);
+    BOOST_CHECK_EQUAL(frozen.earliest_timestep(), 0);
+    BOOST_CHECK_EQUAL(frozen.latest_timestep(), 4);
+
+    // nodes ordered by timestep, timestep 3 is empty
+    const size_t sizes[] = {2, 1, 2, 0, 1};
+    for (int t = 0; t <= 4; ++t)
+    {
+        BOOST_CHECK_EQUAL(frozen.timestep_end(t) - frozen.timestep_begin(t), sizes[t]);
+        for (size_t i = frozen.timestep_begin(t); i < frozen.timestep_end(t); ++i)
+        {
+            BOOST_CHECK_EQUAL(frozen.timestep(i), t);
+        }
+    }
+    BOOST_CHECK_EQUAL(frozen.timestep_begin(-1), frozen.timestep_end(-1));
+    BOOST_CHECK_EQUAL(frozen.timestep_begin(5), frozen.timestep_end(5));
+
+    for (size_t i = 0; i < frozen.num_nodes(); ++i)
+    {
+        BOOST_CHECK_EQUAL(frozen.index(frozen.node(i)), i);
+        BOOST_CHECK_EQUAL(frozen.traxel_id(i), g.get(node_traxel())[frozen.node(i)].Id);
+        for (size_t a = frozen.out_begin(i); a < frozen.out_end(i); ++a)
+        {
+            BOOST_CHECK_EQUAL(frozen.source(a), i);
+            BOOST_CHECK(g.source(frozen.arc(a)) == frozen.node(i));
+            BOOST_CHECK_EQUAL(frozen.index(frozen.arc(a)), a);
+        }
+        for (size_t k = frozen.in_begin(i); k < frozen.in_end(i); ++k)
+        {
+            BOOST_CHECK_EQUAL(frozen.target(frozen.in_arc(k)), i);
+        }
+    }
+    BOOST_CHECK_EQUAL(frozen.out_degree(frozen.index(n1)), 2);
+    BOOST_CHECK_EQUAL(frozen.out_degree(frozen.index(n2)), 0);
+    BOOST_CHECK_EQUAL(frozen.in_degree(frozen.index(n4)), 1);
+    BOOST_CHECK_EQUAL(frozen.in_degree(frozen.index(n5)), 1);
+    BOOST_CHECK_EQUAL(frozen.in_degree(frozen.index(n6)), 0);
+
+    FrozenSolution solution(frozen);
+    BOOST_CHECK_EQUAL(solution.n_iterations(), 1);
+    BOOST_CHECK(solution.with_mergers());
+    BOOST_CHECK(!solution.with_division_detection());
+    BOOST_CHECK(!solution.with_origin());
+    BOOST_CHECK_EQUAL(solution.node_active(frozen.index(n3), 0), 2);
+    BOOST_CHECK_EQUAL(solution.node_active(frozen.index(n2), 0), 0);
+    BOOST_CHECK(solution.arc_active(frozen.index(a13), 0));
+    BOOST_CHECK(!solution.arc_active(frozen.index(a15), 0));
+    BOOST_CHECK_EQUAL(solution.arc_uncertainty(frozen.index(a13), 0), 0.);
+    BOOST_CHECK_EQUAL(solution.origin(0), FrozenSolution::no_origin);
+}
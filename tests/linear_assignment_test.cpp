@@ -0,0 +1,143 @@
+#define BOOST_TEST_MODULE linear_assignment_test
+
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include "pgmlink/linear_assignment.h"
+
+using namespace pgmlink;
+using namespace std;
+
+namespace
+{
+double assignment_cost(const vector<int>& assignment,
+                       size_t n_cols,
+                       const vector<AssignmentCandidate>& candidates,
+                       double row_cost,
+                       double col_cost)
+{
+    double cost = 0.;
+    vector<bool> col_used(n_cols, false);
+    for (size_t row = 0; row < assignment.size(); ++row)
+    {
+        if (assignment[row] < 0)
+        {
+            cost += row_cost;
+            continue;
+        }
+        BOOST_REQUIRE(!col_used[assignment[row]]);
+        col_used[assignment[row]] = true;
+        double c = -1.;
+        for (size_t k = 0; k < candidates.size(); ++k)
+        {
+            if (candidates[k].row == row && candidates[k].col == static_cast<size_t>(assignment[row])
+                    && (c < 0. || candidates[k].cost < c))
+            {
+                c = candidates[k].cost;
+            }
+        }
+        BOOST_REQUIRE(c >= 0.);
+        cost += c;
+    }
+    for (size_t col = 0; col < n_cols; ++col)
+    {
+        cost += col_used[col] ? 0. : col_cost;
+    }
+    return cost;
+}
+
+// exhaustive search over all assignments
+void brute_force(size_t row,
+                 vector<int>& assignment,
+                 size_t n_cols,
+                 const vector<AssignmentCandidate>& candidates,
+                 double row_cost,
+                 double col_cost,
+                 double& best)
+{
+    if (row == assignment.size())
+    {
+        const double cost = assignment_cost(assignment, n_cols, candidates, row_cost, col_cost);
+        best = best < 0. || cost < best ? cost : best;
+        return;
+    }
+    for (int col = -1; col < static_cast<int>(n_cols); ++col)
+    {
+        bool allowed = col < 0;
+        for (size_t k = 0; k < candidates.size() && !allowed; ++k)
+        {
+            allowed = candidates[k].row == row && candidates[k].col == static_cast<size_t>(col);
+        }
+        for (size_t r = 0; r < row && allowed && col >= 0; ++r)
+        {
+            allowed = assignment[r] != col;
+        }
+        if (allowed)
+        {
+            assignment[row] = col;
+            brute_force(row + 1, assignment, n_cols, candidates, row_cost, col_cost, best);
+        }
+    }
+    assignment[row] = -1;
+}
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE( solve_sparse_assignment_simple )
+{
+    vector<AssignmentCandidate> candidates;
+    candidates.push_back(AssignmentCandidate(0, 0, 1.));
+    candidates.push_back(AssignmentCandidate(0, 1, 2.));
+    candidates.push_back(AssignmentCandidate(1, 0, 2.));
+    candidates.push_back(AssignmentCandidate(1, 1, 10.));
+    candidates.push_back(AssignmentCandidate(2, 2, 100.));
+
+    // row 0 has to give way to row 1, row 2 is cheaper to leave unassigned
+    vector<int> assignment = solve_sparse_assignment(3, 3, candidates, 5., 5.);
+    BOOST_REQUIRE_EQUAL(assignment.size(), 3);
+    BOOST_CHECK_EQUAL(assignment[0], 1);
+    BOOST_CHECK_EQUAL(assignment[1], 0);
+    BOOST_CHECK_EQUAL(assignment[2], -1);
+
+    // nothing is worth assigning
+    assignment = solve_sparse_assignment(3, 3, candidates, 0.5, 0.5);
+    BOOST_CHECK_EQUAL(assignment[0], -1);
+    BOOST_CHECK_EQUAL(assignment[1], -1);
+    BOOST_CHECK_EQUAL(assignment[2], -1);
+
+    BOOST_CHECK(solve_sparse_assignment(0, 3, vector<AssignmentCandidate>(), 1., 1.).empty());
+    BOOST_CHECK_THROW(solve_sparse_assignment(3, 2, candidates, 1., 1.), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( solve_sparse_assignment_optimal )
+{
+    srand(42);
+    for (size_t trial = 0; trial < 200; ++trial)
+    {
+        const size_t n_rows = 1 + rand() % 6;
+        const size_t n_cols = 1 + rand() % 6;
+        vector<AssignmentCandidate> candidates;
+        for (size_t row = 0; row < n_rows; ++row)
+        {
+            for (size_t col = 0; col < n_cols; ++col)
+            {
+                if (rand() % 2 == 0)
+                {
+                    candidates.push_back(AssignmentCandidate(row, col, rand() % 20));
+                }
+            }
+        }
+        const double row_cost = rand() % 10;
+        const double col_cost = rand() % 10;
+
+        const vector<int> assignment = solve_sparse_assignment(n_rows, n_cols, candidates, row_cost, col_cost);
+        BOOST_REQUIRE_EQUAL(assignment.size(), n_rows);
+        vector<int> scratch(n_rows, -1);
+        double best = -1.;
+        brute_force(0, scratch, n_cols, candidates, row_cost, col_cost, best);
+        BOOST_CHECK_CLOSE(assignment_cost(assignment, n_cols, candidates, row_cost, col_cost), best, 1e-9);
+    }
+}
@@ -0,0 +1,202 @@
+#define BOOST_TEST_MODULE out_of_core_traxel_store_test
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pgmlink/conservationtracking_parameter.h"
+#include "pgmlink/energy_computer.h"
+#include "pgmlink/features/featurestore.h"
+#include "pgmlink/hypotheses.h"
+#include "pgmlink/out_of_core_traxel_store.h"
+#include "pgmlink/traxels.h"
+
+using namespace pgmlink;
+using namespace std;
+
+namespace
+{
+TraxelStore make_traxels(boost::shared_ptr<FeatureStore> fs)
+{
+    TraxelStore ts;
+    for (int t = 0; t < 5; ++t)
+    {
+        for (unsigned int id = 1; id <= static_cast<unsigned int>(t % 3 + 1); ++id)
+        {
+            Traxel traxel(id, t);
+            add(ts, fs, traxel);
+            FeatureMap& features = fs->get_traxel_features(t, id);
+            features["com"].push_back(10. * t + id);
+            features["com"].push_back(-1. * id);
+            features["com"].push_back(0.5);
+            features["detProb"].push_back(0.1 * id);
+            features["detProb"].push_back(1. - 0.1 * id);
+        }
+    }
+    return ts;
+}
+}
+
+BOOST_AUTO_TEST_CASE( OutOfCoreTraxelStore_roundtrip )
+{
+    const string filename = "out_of_core_traxel_store_test.h5";
+    remove(filename.c_str());
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    const TraxelStore ts = make_traxels(fs);
+    OutOfCoreTraxelStore::write(filename, ts);
+
+    OutOfCoreTraxelStore store(filename, 2);
+    BOOST_CHECK_EQUAL(store.size(), ts.size());
+    BOOST_CHECK_EQUAL(store.timesteps().size(), 5);
+    BOOST_CHECK_EQUAL(store.earliest_timestep(), 0);
+    BOOST_CHECK_EQUAL(store.latest_timestep(), 4);
+    BOOST_CHECK_EQUAL(store.ids(2).size(), 3);
+    BOOST_CHECK_EQUAL(store.frames_loaded(), 0);
+
+    for (TraxelStore::const_iterator it = ts.begin(); it != ts.end(); ++it)
+    {
+        const Traxel traxel = store.traxel(it->Timestep, it->Id);
+        BOOST_CHECK_EQUAL(traxel.X(), it->X());
+        BOOST_CHECK_EQUAL(traxel.Y(), it->Y());
+        BOOST_CHECK_EQUAL(traxel.Z(), it->Z());
+        BOOST_CHECK(traxel.features.get() == it->features.get());
+    }
+
+    boost::shared_ptr<const TraxelStore> frame = store.frame(3);
+    BOOST_CHECK_EQUAL(frame->size(), 1);
+    BOOST_CHECK(frame->begin()->get_feature_store() != fs);
+
+    BOOST_CHECK_THROW(store.traxel(3, 7), std::runtime_error);
+    BOOST_CHECK_THROW(store.frame(5), std::runtime_error);
+    BOOST_CHECK_THROW(store.ids(-1), std::runtime_error);
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( OutOfCoreTraxelStore_cache )
+{
+    const string filename = "out_of_core_traxel_store_cache_test.h5";
+    remove(filename.c_str());
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    OutOfCoreTraxelStore::write(filename, make_traxels(fs));
+
+    OutOfCoreTraxelStore store(filename, 2);
+    boost::shared_ptr<const TraxelStore> frame0 = store.frame(0);
+    store.frame(1);
+    BOOST_CHECK(store.frame(0) == frame0);
+    BOOST_CHECK_EQUAL(store.frames_loaded(), 2);
+
+    // frame 1 was used least recently
+    store.frame(2);
+    store.frame(0);
+    BOOST_CHECK_EQUAL(store.frames_loaded(), 3);
+    store.frame(1);
+    BOOST_CHECK_EQUAL(store.frames_loaded(), 4);
+
+    // frames in use stay valid after they were dropped
+    store.frame(3);
+    store.frame(4);
+    BOOST_CHECK(store.frame(0) != frame0);
+    BOOST_CHECK_EQUAL(frame0->begin()->features["detProb"][0], 0.1);
+
+    BOOST_CHECK_THROW(OutOfCoreTraxelStore(filename, 0), std::runtime_error);
+    BOOST_CHECK_THROW(OutOfCoreTraxelStore("no_such_file.h5"), std::runtime_error);
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( OutOfCoreTraxelStore_append_frame )
+{
+    const string filename = "out_of_core_traxel_store_append_test.h5";
+    remove(filename.c_str());
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    vector<Traxel> traxels;
+    for (unsigned int id = 0; id < 2; ++id)
+    {
+        Traxel traxel(id, 7);
+        traxel.set_feature_store(fs);
+        fs->get_traxel_features(7, id)["com"] = feature_array(3, id);
+        traxels.push_back(traxel);
+    }
+    OutOfCoreTraxelStore::append_frame(filename, 7, traxels);
+    OutOfCoreTraxelStore::append_frame(filename, 9, vector<Traxel>());
+    BOOST_CHECK_THROW(OutOfCoreTraxelStore::append_frame(filename, 7, traxels), std::runtime_error);
+    BOOST_CHECK_THROW(OutOfCoreTraxelStore::append_frame(filename, 8, traxels), std::runtime_error);
+
+    // all traxels of a frame need the same features
+    Traxel other(2, 8);
+    other.set_feature_store(fs);
+    fs->get_traxel_features(8, 2)["com"] = feature_array(2, 0.);
+    vector<Traxel> mixed(1, other);
+    Traxel another(3, 8);
+    another.set_feature_store(fs);
+    fs->get_traxel_features(8, 3)["com"] = feature_array(3, 0.);
+    mixed.push_back(another);
+    BOOST_CHECK_THROW(OutOfCoreTraxelStore::append_frame(filename, 8, mixed), std::runtime_error);
+
+    OutOfCoreTraxelStore store(filename);
+    BOOST_CHECK_EQUAL(store.size(), 2);
+    BOOST_CHECK_EQUAL(store.timesteps().size(), 2);
+    BOOST_CHECK(store.frame(9)->empty());
+    BOOST_CHECK_EQUAL(store.traxel(7, 1).features["com"][2], 1.);
+    remove(filename.c_str());
+}
+
+BOOST_AUTO_TEST_CASE( OutOfCoreTraxelStore_energies )
+{
+    // energies computed from the store equal the in-core ones, detProb is
+    // not resident in the graph, and every frame is read at most once even
+    // with a cache of a single frame
+    const string filename = "out_of_core_traxel_store_test_energies.h5";
+    remove(filename.c_str());
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    TraxelStore ts = make_traxels(fs);
+    OutOfCoreTraxelStore::write(filename, ts);
+
+    Parameter param(1,
+                    [](const Traxel& tr, const size_t state) { return tr.features["detProb"][state]; },
+                    [](const Traxel& tr, const size_t state) { return state * tr.features["com"][0]; },
+                    [](const double prob) { return 1. - prob; });
+    const SingleTimestepTraxel_HypothesesBuilder::Options options(2, 100);
+
+    SingleTimestepTraxel_HypothesesBuilder in_core_builder(&ts, options);
+    boost::shared_ptr<HypothesesGraph> in_core(in_core_builder.build());
+    EnergyComputer energies(param);
+    energies(*in_core, fs);
+
+    OutOfCoreTraxelStore store(filename, 1);
+    boost::shared_ptr<FeatureStore> resident_fs = boost::make_shared<FeatureStore>();
+    SingleTimestepTraxel_HypothesesBuilder out_of_core_builder(&store, resident_fs, options);
+    boost::shared_ptr<HypothesesGraph> g(out_of_core_builder.build());
+    const size_t frames_loaded = store.frames_loaded();
+    energies(*g, resident_fs, store);
+    BOOST_CHECK_LE(store.frames_loaded() - frames_loaded, store.timesteps().size());
+
+    const char* node_energies[] = {"detEnergy", "divEnergy", "appEnergy", "disEnergy"};
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g->get(node_traxel());
+    for (HypothesesGraph::NodeIt n(*g); n != lemon::INVALID; ++n)
+    {
+        const Traxel& tr = traxel_map[n];
+        for (size_t i = 0; i < 4; ++i)
+        {
+            const feature_array& expected = fs->get_traxel_features(tr.Timestep, tr.Id)[node_energies[i]];
+            const feature_array& actual = resident_fs->get_traxel_features(tr)[node_energies[i]];
+            BOOST_REQUIRE_EQUAL(expected.size(), 2);
+            BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+        }
+    }
+    size_t n_arcs = 0;
+    for (HypothesesGraph::ArcIt a(*g); a != lemon::INVALID; ++a, ++n_arcs)
+    {
+        const Traxel& from = traxel_map[g->source(a)];
+        const Traxel& to = traxel_map[g->target(a)];
+        const feature_array& expected = fs->get_traxel_features(from, to)["transEnergy"];
+        const feature_array& actual = resident_fs->get_traxel_features(from, to)["transEnergy"];
+        BOOST_REQUIRE_EQUAL(expected.size(), 2);
+        BOOST_CHECK_EQUAL_COLLECTIONS(actual.begin(), actual.end(), expected.begin(), expected.end());
+    }
+    BOOST_CHECK_EQUAL(n_arcs, lemon::countArcs(*in_core));
+    remove(filename.c_str());
+}
@@ -1,6 +1,7 @@
 #define BOOST_TEST_MODULE graphical_model_test
 
 #include <iostream>
+#include <limits>
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
@@ -62,5 +63,65 @@ BOOST_AUTO_TEST_CASE( ogm_model_building )
                 BOOST_CHECK_EQUAL(f(1, 1, 1), 8);
             }
 }
+
+BOOST_AUTO_TEST_CASE( ogm_sparse_factor )
+{
+    pgm::OpengmModel gm;
+    for(size_t i = 0; i < 8; ++i)
+    {
+        gm.addVariable(2);
+    }
+
+    // unsorted variable indices, as for the outgoing factors of the chaingraph
+    size_t vi_array[] = {4, 1, 7, 2};
+    std::vector<size_t> vi(vi_array, vi_array + 4);
+    pgm::OpengmSparseFactor<double> sparse(vi, 100.);
+    pgm::OpengmExplicitFactor<double> dense(vi, 100.);
+
+    std::vector<size_t> coords(4, 0);
+    sparse.set_value(coords, 1.);
+    dense.set_value(coords, 1.);
+    coords[0] = 1;
+    for(size_t i = 1; i < 4; ++i)
+    {
+        coords[i] = 1;
+        sparse.set_value(coords, 10. + i);
+        dense.set_value(coords, 10. + i);
+        coords[i] = 0;
+    }
+    coords[2] = 1;
+    coords[3] = 1;
+    sparse.set_value(coords, 20.);
+    dense.set_value(coords, 20.);
+
+    BOOST_CHECK_EQUAL(sparse.function().entries().size(), 5);
+    BOOST_CHECK_EQUAL(sparse.function().size(), 16);
+    sparse.add_to(gm);
+    dense.add_to(gm);
+    BOOST_REQUIRE_EQUAL(gm.numberOfFactors(), 2);
+
+    // same values for all configurations, in the sorted variable order of the factors
+    size_t n_forbidden = 0;
+    for(size_t config = 0; config < 16; ++config)
+    {
+        size_t labels[] = {config & 1, (config >> 1) & 1, (config >> 2) & 1, (config >> 3) & 1};
+        BOOST_CHECK_EQUAL(gm[0](labels), gm[1](labels));
+        if(gm[0](labels) == 100.)
+        {
+            ++n_forbidden;
+        }
+    }
+    BOOST_CHECK_EQUAL(n_forbidden, 11);
+
+    // variables 1, 2, 4, 7 -> detection 4 on, transitions 7 and 2 on
+    size_t division[] = {0, 1, 1, 1};
+    BOOST_CHECK_EQUAL(gm[0](division), 20.);
+
+    // more configurations than size_t can count
+    pgm::SparseFunction huge(std::numeric_limits<size_t>::digits, 100.);
+    BOOST_CHECK_THROW(huge.size(), opengm::RuntimeError);
+    pgm::SparseFunction largest(std::numeric_limits<size_t>::digits - 1, 100.);
+    BOOST_CHECK_EQUAL(largest.size(), size_t(1) << (std::numeric_limits<size_t>::digits - 1));
+}
 // EOF
 
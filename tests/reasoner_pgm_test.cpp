@@ -1,5 +1,7 @@
 #define BOOST_TEST_MODULE reasoner_pgm_test
 
+#include <algorithm>
+#include <limits>
 #include <vector>
 #include <iostream>
 
@@ -21,6 +23,7 @@
 #include "pgmlink/graph.h"
 #include "pgmlink/hypotheses.h"
 #include "pgmlink/features/feature.h"
+#include "pgmlink/pgm_chaingraph.h"
 #include "pgmlink/reasoner_pgm.h"
 #include "pgmlink/traxels.h"
 
@@ -362,3 +365,224 @@ BOOST_AUTO_TEST_CASE( HypothesesGraph_build_hyp_mrf )
     prune_inactive(*graph);
 
 }
+
+namespace
+{
+void add_traxel(TraxelStore& ts, boost::shared_ptr<FeatureStore> fs, unsigned int id, int timestep, double x)
+{
+    Traxel tr;
+    tr.Id = id;
+    tr.Timestep = timestep;
+    feature_array com(3, 0.);
+    com[0] = x;
+    tr.features["com"] = com;
+    add(ts, fs, tr);
+}
+
+// squared distances of both children to the parent
+struct DistanceDivision
+{
+    double operator()(const Traxel& parent, const Traxel& child1, const Traxel& child2) const
+    {
+        return SquaredDistance()(parent, child1) + SquaredDistance()(parent, child2);
+    }
+};
+
+// labels of the variables 0 .. n_vars - 1, one bit of config each
+std::vector<size_t> labeling(size_t config, size_t n_vars)
+{
+    std::vector<size_t> labels(n_vars);
+    for (size_t i = 0; i < n_vars; ++i)
+    {
+        labels[i] = (config >> i) & 1;
+    }
+    return labels;
+}
+
+// the configurations chaingraph::ModelBuilder::add_hard_constraints() leaves feasible
+bool feasible(const HypothesesGraph& g, const pgm::chaingraph::Model& m, const std::vector<size_t>& labels)
+{
+    for (HypothesesGraph::NodeIt n(g); n != lemon::INVALID; ++n)
+    {
+        const size_t detection = labels[m.var_of_node(n)];
+        size_t outgoing = 0, incoming = 0;
+        for (HypothesesGraph::OutArcIt a(g, n); a != lemon::INVALID; ++a)
+        {
+            outgoing += labels[m.var_of_arc(a)];
+        }
+        for (HypothesesGraph::InArcIt a(g, n); a != lemon::INVALID; ++a)
+        {
+            incoming += labels[m.var_of_arc(a)];
+        }
+        if ((!detection && outgoing + incoming > 0) || outgoing > 2 || incoming > 1)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t count_sparse_factors(const pgm::OpengmModel& m)
+{
+    size_t count = 0;
+    for (size_t f = 0; f < m.numberOfFactors(); ++f)
+    {
+        // pgm::SparseFunction is the fourth function type of pgm::OpengmModel
+        if (m[f].functionType() == 3)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t max_factor_order(const pgm::OpengmModel& m)
+{
+    size_t order = 0;
+    for (size_t f = 0; f < m.numberOfFactors(); ++f)
+    {
+        order = std::max(order, static_cast<size_t>(m[f].numberOfVariables()));
+    }
+    return order;
+}
+
+// arc states of the MAP solution in arc order
+std::vector<bool> map_arcs(const pgm::chaingraph::ModelBuilder& b, bool with_constraints, HypothesesGraph& g)
+{
+    Chaingraph mrf(b, with_constraints, 0., false);
+    mrf.formulate(g);
+    mrf.infer();
+    mrf.conclude(g);
+    property_map<arc_active, HypothesesGraph::base_graph>::type& active = g.get(arc_active());
+    std::vector<bool> states;
+    for (HypothesesGraph::ArcIt a(g); a != lemon::INVALID; ++a)
+    {
+        states.push_back(active[a]);
+    }
+    return states;
+}
+}
+
+BOOST_AUTO_TEST_CASE( Chaingraph_sparse_and_decomposed_factors )
+{
+    // 1 (x=0) divides into 1 (x=1) and 2 (x=4), 2 (x=10) moves to 3 (x=11);
+    // every detection has arcs to all detections of the next frame, so the
+    // outgoing factors have 4 and the incoming factors 3 variables
+    TraxelStore ts;
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    add_traxel(ts, fs, 1, 0, 0.);
+    add_traxel(ts, fs, 2, 0, 10.);
+    add_traxel(ts, fs, 1, 1, 1.);
+    add_traxel(ts, fs, 2, 1, 4.);
+    add_traxel(ts, fs, 3, 1, 11.);
+    SingleTimestepTraxel_HypothesesBuilder hyp_builder(&ts, SingleTimestepTraxel_HypothesesBuilder::Options(3, 100));
+    boost::shared_ptr<HypothesesGraph> g(hyp_builder.build());
+    BOOST_REQUIRE_EQUAL(lemon::countArcs(*g), 6);
+
+    pgm::chaingraph::ECCV12ModelBuilder eccv12;
+    pgm::chaingraph::TrainableModelBuilder trainable;
+    std::vector<pgm::chaingraph::ModelBuilder*> builders;
+    builders.push_back(&eccv12);
+    builders.push_back(&trainable);
+
+    // dense tables, sparse tables and decomposed factors of both builders
+    std::vector<boost::shared_ptr<pgm::chaingraph::Model> > dense, sparse, decomposed;
+    for (size_t i = 0; i < builders.size(); ++i)
+    {
+        pgm::chaingraph::ModelBuilder& b = *builders[i];
+        b.appearance(ConstantFeature(1000))
+        .disappearance(ConstantFeature(1000))
+        .move(SquaredDistance())
+        .opportunity_cost(0)
+        .forbidden_cost(100000)
+        .with_detection_vars(ConstantFeature(10), ConstantFeature(5000))
+        .with_divisions(DistanceDivision());
+
+        b.sparse_factor_dimension(100);
+        dense.push_back(boost::shared_ptr<pgm::chaingraph::Model>(b.build(*g)));
+        b.sparse_factor_dimension(2);
+        sparse.push_back(boost::shared_ptr<pgm::chaingraph::Model>(b.build(*g)));
+        b.decompose_large_factors(true);
+        decomposed.push_back(boost::shared_ptr<pgm::chaingraph::Model>(b.build(*g)));
+        b.decompose_large_factors(false);
+
+        BOOST_CHECK_EQUAL(count_sparse_factors(*dense[i]->opengm_model), 0);
+        BOOST_CHECK_EQUAL(count_sparse_factors(*sparse[i]->opengm_model), 5);
+        BOOST_CHECK_EQUAL(sparse[i]->opengm_model->numberOfFactors(), dense[i]->opengm_model->numberOfFactors());
+        BOOST_CHECK_EQUAL(count_sparse_factors(*decomposed[i]->opengm_model), 0);
+        BOOST_CHECK_EQUAL(max_factor_order(*decomposed[i]->opengm_model), 2);
+    }
+
+    // Both builders have the same energies with unit weights. Sparse tables
+    // agree everywhere, decomposed factors on the feasible configurations.
+    const pgm::OpengmModel& reference = *dense[0]->opengm_model;
+    const size_t n_vars = reference.numberOfVariables();
+    BOOST_REQUIRE_EQUAL(n_vars, 11);
+    size_t n_feasible = 0;
+    for (size_t config = 0; config < (size_t(1) << n_vars); ++config)
+    {
+        const std::vector<size_t> labels = labeling(config, n_vars);
+        const double energy = reference.evaluate(labels.begin());
+        const bool is_feasible = feasible(*g, *dense[0], labels);
+        n_feasible += is_feasible;
+        for (size_t i = 0; i < builders.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL(dense[i]->opengm_model->evaluate(labels.begin()), energy);
+            BOOST_CHECK_EQUAL(sparse[i]->opengm_model->evaluate(labels.begin()), energy);
+            if (is_feasible)
+            {
+                BOOST_CHECK_EQUAL(decomposed[i]->opengm_model->evaluate(labels.begin()), energy);
+            }
+        }
+    }
+    BOOST_CHECK_GT(n_feasible, 0);
+
+    // same MAP solution with dense tables, with decomposed factors (hard
+    // constraints) and with sparse tables (soft constraints)
+    std::vector<bool> expected;
+    property_map<node_traxel, HypothesesGraph::base_graph>::type& traxel_map = g->get(node_traxel());
+    for (HypothesesGraph::ArcIt a(*g); a != lemon::INVALID; ++a)
+    {
+        const unsigned int from = traxel_map[g->source(a)].Id;
+        const unsigned int to = traxel_map[g->target(a)].Id;
+        expected.push_back((from == 1 && to != 3) || (from == 2 && to == 3));
+    }
+    for (size_t i = 0; i < builders.size(); ++i)
+    {
+        builders[i]->sparse_factor_dimension(100);
+        BOOST_CHECK(map_arcs(*builders[i], true, *g) == expected);
+        builders[i]->sparse_factor_dimension(2);
+        BOOST_CHECK(map_arcs(*builders[i], true, *g) == expected);
+        BOOST_CHECK(map_arcs(*builders[i], false, *g) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Chaingraph_factor_too_large_to_enumerate )
+{
+    // one detection with more candidate arcs than a table index has bits
+    const size_t n_children = std::numeric_limits<size_t>::digits;
+    HypothesesGraph g;
+    g.add(node_traxel());
+    Traxel tr;
+    tr.Id = 1;
+    tr.Timestep = 0;
+    HypothesesGraph::Node parent = g.add_node(0);
+    g.get(node_traxel()).set(parent, tr);
+    tr.Timestep = 1;
+    for (size_t i = 0; i < n_children; ++i)
+    {
+        HypothesesGraph::Node child = g.add_node(1);
+        tr.Id = i + 1;
+        g.get(node_traxel()).set(child, tr);
+        g.addArc(parent, child);
+    }
+
+    pgm::chaingraph::ECCV12ModelBuilder b(ConstantFeature(1000), ConstantFeature(1000), ConstantFeature(1));
+    b.with_detection_vars().with_divisions(ConstantFeature(5));
+    BOOST_CHECK_THROW(b.build(g), std::runtime_error);
+
+    b.decompose_large_factors(true);
+    boost::scoped_ptr<pgm::chaingraph::Model> m(b.build(g));
+    BOOST_CHECK_EQUAL(m->opengm_model->numberOfVariables(), 2 * n_children + 1);
+    BOOST_CHECK_EQUAL(max_factor_order(*m->opengm_model), 2);
+}
@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE solution_matrix_test
+
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pgmlink/frozen_hypotheses_graph.h"
+#include "pgmlink/hypotheses.h"
+#include "pgmlink/solution_matrix.h"
+
+using namespace pgmlink;
+using namespace std;
+
+BOOST_AUTO_TEST_CASE( PackedMatrix_set_get )
+{
+    PackedMatrix m;
+    m.resize(2, 100);
+    BOOST_CHECK_EQUAL(m.bits(), 1);
+    m.set(0, 3, 1);
+    m.set(1, 99, 1);
+    BOOST_CHECK_EQUAL(m.get(0, 3), 1);
+    BOOST_CHECK_EQUAL(m.get(1, 99), 1);
+    BOOST_CHECK_EQUAL(m.get(0, 99), 0);
+    // outside the matrix
+    BOOST_CHECK_EQUAL(m.get(2, 0), 0);
+    BOOST_CHECK_THROW(m.set(2, 0, 1), std::out_of_range);
+
+    // widening keeps all entries
+    m.set(1, 50, 5);
+    BOOST_CHECK_EQUAL(m.bits(), 4);
+    m.set(0, 0, 1000);
+    BOOST_CHECK_EQUAL(m.bits(), 16);
+    BOOST_CHECK_EQUAL(m.get(0, 3), 1);
+    BOOST_CHECK_EQUAL(m.get(1, 99), 1);
+    BOOST_CHECK_EQUAL(m.get(1, 50), 5);
+    BOOST_CHECK_EQUAL(m.get(0, 0), 1000);
+    BOOST_CHECK_EQUAL(m.count_nonzero(99), 1);
+
+    // adding rows and columns
+    m.resize(3, 120);
+    BOOST_CHECK_EQUAL(m.get(1, 50), 5);
+    BOOST_CHECK_EQUAL(m.get(2, 50), 0);
+    m.set(2, 119, 7);
+    BOOST_CHECK_EQUAL(m.get(2, 119), 7);
+}
+
+BOOST_AUTO_TEST_CASE( SolutionCountMap_vector_interface )
+{
+    HypothesesGraph g;
+    HypothesesGraph::Node n1 = g.add_node(0);
+    HypothesesGraph::Node n2 = g.add_node(1);
+    g.add(node_active_count());
+    property_map<node_active_count, HypothesesGraph::base_graph>::type& counts = g.get(node_active_count());
+    BOOST_CHECK_EQUAL(counts.size(n1), 0);
+    BOOST_CHECK(counts[n1].empty());
+
+    vector<size_t> counts1(2, 1);
+    counts1[1] = 1000;
+    counts.set(n1, counts1);
+    BOOST_CHECK(counts[n1] == counts1);
+    BOOST_CHECK_EQUAL(counts.get(n1, 1), 1000);
+    // past the stored iterations
+    BOOST_CHECK_EQUAL(counts.get(n1, 2), 0);
+    BOOST_CHECK_EQUAL(counts.get(n2, 0), 0);
+    BOOST_CHECK_THROW(counts.set(n2, 0, 1), std::out_of_range);
+
+    // editing in place through get_value()
+    counts.get_value(n2).push_back(0);
+    counts.get_value(n2).push_back(3);
+    counts.get_value(n2)[0] = 2;
+    counts.get_value(n2).back()++;
+    BOOST_CHECK_EQUAL(counts.size(n2), 2);
+    BOOST_CHECK_EQUAL(counts.get(n2, 0), 2);
+    BOOST_CHECK_EQUAL(counts.get(n2, 1), 4);
+    BOOST_CHECK_EQUAL(counts.count_nonzero(n2), 2);
+    counts.get_value(n2) = vector<size_t>(3, 0);
+    BOOST_CHECK_EQUAL(counts.count_nonzero(n2), 0);
+    BOOST_CHECK_EQUAL(counts.get(n1, 1), 1000);
+    counts.get_value(n2) = vector<size_t>(3, 7);
+
+    // a node reusing the id of an erased one starts without solutions
+    const int id = g.id(n2);
+    g.erase(n2);
+    HypothesesGraph::Node n3 = g.add_node(1);
+    BOOST_REQUIRE_EQUAL(g.id(n3), id);
+    // initialized like the other nodes
+    BOOST_CHECK_EQUAL(counts.size(n3), 2);
+    BOOST_CHECK_EQUAL(counts.count_nonzero(n3), 0);
+    counts.get_value(n3).resize(3);
+    BOOST_CHECK_EQUAL(counts.count_nonzero(n3), 0);
+
+    // new ids beyond the initial columns
+    for (int i = 0; i < 100; ++i)
+    {
+        g.add_node(2);
+    }
+    HypothesesGraph::Node n4 = g.add_node(2);
+    counts.get_value(n4).push_back(1);
+    BOOST_CHECK_EQUAL(counts.get(n4, 0), 1);
+    BOOST_CHECK_EQUAL(counts.get(n1, 1), 1000);
+}
+
+BOOST_AUTO_TEST_CASE( SolutionCountMap_direct_writes_reach_all_readers )
+{
+    HypothesesGraph g;
+    HypothesesGraph::Node n1 = g.add_node(0);
+    HypothesesGraph::Node n2 = g.add_node(1);
+    HypothesesGraph::Arc a = g.addArc(n1, n2);
+    g.add(node_active2()).add(arc_active()).add(division_active());
+    g.add(node_active_count()).add(arc_active_count()).add(division_active_count());
+
+    // two iterations: n1 -> n2, then n1 as a merger of 2 disappearing
+    vector<size_t> counts1(2, 1), counts2(2, 1);
+    counts1[1] = 2;
+    counts2[1] = 0;
+    vector<bool> arc_counts(2, false);
+    arc_counts[0] = true;
+    g.get(node_active_count()).set(n1, counts1);
+    g.get(node_active_count()).set(n2, counts2);
+    g.get(arc_active_count()).set(a, arc_counts);
+    g.get(division_active_count()).set(n1, vector<bool>(2, false));
+    g.get(division_active_count()).set(n2, vector<bool>(2, false));
+
+    {
+        const FrozenHypothesesGraph frozen(g);
+        const FrozenSolution solution(frozen);
+        BOOST_CHECK_EQUAL(solution.n_iterations(), 2);
+        BOOST_CHECK_EQUAL(solution.node_active(frozen.index(n1), 1), 2);
+        BOOST_CHECK(solution.arc_active(frozen.index(a), 0));
+        BOOST_CHECK(!solution.arc_active(frozen.index(a), 1));
+    }
+
+    // the setters and direct writers like resolve_mergers() share one storage
+    g.set_arc_active(a, true, 1);
+    BOOST_CHECK(g.get_arc_active(a, 1));
+    g.get(arc_active_count()).set(a, vector<bool>(1, false));
+    g.get(arc_active_count()).get_value(a).push_back(true);
+    {
+        const FrozenHypothesesGraph frozen(g);
+        const FrozenSolution solution(frozen);
+        BOOST_CHECK(!solution.arc_active(frozen.index(a), 0));
+        BOOST_CHECK(solution.arc_active(frozen.index(a), 1));
+    }
+    BOOST_CHECK_EQUAL(g.get(node_active_count()).count_nonzero(n2), 1);
+}
@@ -0,0 +1,259 @@
+#define BOOST_TEST_MODULE spatial_tiling_test
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pgmlink/features/featurestore.h"
+#include "pgmlink/spatial_tiling.h"
+#include "pgmlink/traxels.h"
+
+using namespace pgmlink;
+using namespace std;
+
+namespace
+{
+void add_traxel(TraxelStore& ts, boost::shared_ptr<FeatureStore> fs,
+                int t, unsigned int id, double x, double y, int parent = -1)
+{
+    Traxel traxel(id, t);
+    add(ts, fs, traxel);
+    FeatureMap& features = fs->get_traxel_features(t, id);
+    features["com"].push_back(x);
+    features["com"].push_back(y);
+    features["com"].push_back(0.);
+    if (parent >= 0)
+    {
+        features["parent"].push_back(parent);
+    }
+}
+
+Event make_event(Event::EventType type, size_t id1, size_t id2 = 0, size_t id3 = 0)
+{
+    Event e;
+    e.type = type;
+    e.traxel_ids.push_back(id1);
+    if (type == Event::Move || type == Event::Division)
+    {
+        e.traxel_ids.push_back(id2);
+    }
+    if (type == Event::Division)
+    {
+        e.traxel_ids.push_back(id3);
+    }
+    return e;
+}
+
+// links every traxel to the parent named by its "parent" feature, if the
+// parent is in the store
+EventVectorVector track_by_parent(TraxelStore& ts)
+{
+    const int earliest = earliest_timestep(ts);
+    const int latest = latest_timestep(ts);
+    EventVectorVector events(latest - earliest + 1);
+    for (int t = earliest + 1; t <= latest; ++t)
+    {
+        map<size_t, vector<size_t> > children;
+        for (TraxelStore::iterator it = ts.get<by_timestep>().lower_bound(t);
+                it != ts.get<by_timestep>().upper_bound(t); ++it)
+        {
+            FeatureMap::const_iterator parent = it->features.find("parent");
+            if (parent != it->features.end()
+                    && ts.get<by_timeid>().count(boost::make_tuple(t - 1, static_cast<unsigned int>(parent->second[0]))))
+            {
+                children[static_cast<size_t>(parent->second[0])].push_back(it->Id);
+            }
+            else
+            {
+                events[t - earliest].push_back(make_event(Event::Appearance, it->Id));
+            }
+        }
+        for (TraxelStore::iterator it = ts.get<by_timestep>().lower_bound(t - 1);
+                it != ts.get<by_timestep>().upper_bound(t - 1); ++it)
+        {
+            const vector<size_t>& c = children[it->Id];
+            if (c.empty())
+            {
+                events[t - earliest].push_back(make_event(Event::Disappearance, it->Id));
+            }
+            else if (c.size() == 1)
+            {
+                events[t - earliest].push_back(make_event(Event::Move, it->Id, c[0]));
+            }
+            else
+            {
+                events[t - earliest].push_back(make_event(Event::Division, it->Id, c[0], c[1]));
+            }
+        }
+    }
+    return events;
+}
+
+void sort_events(EventVectorVector& events)
+{
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        sort(events[i].begin(), events[i].end());
+    }
+}
+} // end anonymous namespace
+
+BOOST_AUTO_TEST_CASE( SpatialTiling_geometry )
+{
+    FieldOfView fov(0, 0, 0, 0, 10, 100, 50, 0);
+    SpatialTiling tiling(fov, 4, 2, 1, 5.);
+    BOOST_CHECK_EQUAL(tiling.size(), 8);
+
+    // x fastest, then y
+    FieldOfView core = tiling.core(5);
+    BOOST_CHECK_EQUAL(core.lower_bound()[1], 25.);
+    BOOST_CHECK_EQUAL(core.upper_bound()[1], 50.);
+    BOOST_CHECK_EQUAL(core.lower_bound()[2], 25.);
+    BOOST_CHECK_EQUAL(core.upper_bound()[2], 50.);
+    BOOST_CHECK_EQUAL(core.lower_bound()[0], 0.);
+    BOOST_CHECK_EQUAL(core.upper_bound()[0], 10.);
+
+    // the halo is clipped to the field of view
+    FieldOfView tile = tiling.tile(5);
+    BOOST_CHECK_EQUAL(tile.lower_bound()[1], 20.);
+    BOOST_CHECK_EQUAL(tile.upper_bound()[1], 55.);
+    BOOST_CHECK_EQUAL(tile.lower_bound()[2], 20.);
+    BOOST_CHECK_EQUAL(tile.upper_bound()[2], 50.);
+
+    BOOST_CHECK_EQUAL(tiling.owner(30., 30., 0.), 5);
+    // shared faces belong to the upper tile, outside to the nearest
+    BOOST_CHECK_EQUAL(tiling.owner(25., 0., 0.), 1);
+    BOOST_CHECK_EQUAL(tiling.owner(100., 50., 0.), 7);
+    BOOST_CHECK_EQUAL(tiling.owner(-3., 80., 0.), 4);
+
+    BOOST_CHECK_THROW(tiling.core(8), std::runtime_error);
+    BOOST_CHECK_THROW(SpatialTiling(fov, 0, 1), std::runtime_error);
+    BOOST_CHECK_THROW(SpatialTiling(fov, 1, 1, 1, -1.), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( SpatialTiling_extract )
+{
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    TraxelStore ts;
+    add_traxel(ts, fs, 0, 1, 10., 10.);
+    add_traxel(ts, fs, 0, 2, 48., 10.);
+    add_traxel(ts, fs, 0, 3, 90., 10.);
+    SpatialTiling tiling(FieldOfView(0, 0, 0, 0, 10, 100, 50, 0), 2, 1, 1, 5.);
+
+    TraxelStore tile;
+    BOOST_CHECK_EQUAL(tiling.extract(ts, tile, 1), 2);
+    BOOST_CHECK_EQUAL(tile.size(), 2);
+    TraxelStoreByTimeid::iterator it = tile.get<by_timeid>().find(boost::make_tuple(0, 2u));
+    BOOST_REQUIRE(it != tile.get<by_timeid>().end());
+    BOOST_CHECK_EQUAL(it->X(), 48.);
+
+    // the tile has a feature store of its own
+    BOOST_CHECK(it->get_feature_store() != fs);
+    Traxel traxel(*it);
+    traxel.features["cellness"].push_back(1.);
+    BOOST_CHECK(fs->get_traxel_features(0, 2).find("cellness") == fs->get_traxel_features(0, 2).end());
+}
+
+BOOST_AUTO_TEST_CASE( track_tiled_matches_untiled )
+{
+    // tracks crossing tile borders, one of them dividing in the halo
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    TraxelStore ts;
+    add_traxel(ts, fs, 0, 1, 20., 20.);
+    add_traxel(ts, fs, 0, 2, 47., 10.);
+    add_traxel(ts, fs, 0, 3, 80., 40.);
+    add_traxel(ts, fs, 1, 1, 24., 23., 1);
+    add_traxel(ts, fs, 1, 2, 51., 12., 2);
+    add_traxel(ts, fs, 1, 3, 47., 9., 2);
+    add_traxel(ts, fs, 1, 4, 60., 30.);
+    add_traxel(ts, fs, 2, 1, 26., 26., 1);
+    add_traxel(ts, fs, 2, 2, 55., 11., 2);
+    add_traxel(ts, fs, 2, 3, 52., 8., 3);
+    add_traxel(ts, fs, 2, 4, 49., 31., 4);
+    add_traxel(ts, fs, 3, 1, 28., 27., 1);
+    add_traxel(ts, fs, 3, 2, 44., 33., 4);
+
+    EventVectorVector untiled = track_by_parent(ts);
+    sort_events(untiled);
+
+    SpatialTiling tiling(FieldOfView(0, 0, 0, 0, 3, 100, 50, 0), 2, 2, 1, 15.);
+    EventVectorVector tiled = track_tiled(ts, tiling, &track_by_parent);
+    sort_events(tiled);
+    BOOST_REQUIRE_EQUAL(tiled.size(), untiled.size());
+    for (size_t i = 0; i < tiled.size(); ++i)
+    {
+        BOOST_CHECK(tiled[i] == untiled[i]);
+    }
+
+    // same result without threads
+    EventVectorVector serial = track_tiled(ts, tiling, &track_by_parent, false);
+    sort_events(serial);
+    BOOST_CHECK(serial == tiled);
+}
+
+BOOST_AUTO_TEST_CASE( track_tiled_rethrows_tracker_exceptions )
+{
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    TraxelStore ts;
+    add_traxel(ts, fs, 0, 1, 20., 20.);
+    add_traxel(ts, fs, 0, 2, 80., 20.);
+    SpatialTiling tiling(FieldOfView(0, 0, 0, 0, 1, 100, 50, 0), 2, 1, 1, 5.);
+
+    // the original exception leaves track_tiled, whatever its type
+    struct Throwing
+    {
+        static EventVectorVector c_string(TraxelStore&)
+        {
+            throw "tracker failed";
+        }
+        static EventVectorVector logic_error(TraxelStore&)
+        {
+            throw std::logic_error("tracker failed");
+        }
+    };
+    BOOST_CHECK_THROW(track_tiled(ts, tiling, &Throwing::c_string), const char*);
+    BOOST_CHECK_THROW(track_tiled(ts, tiling, &Throwing::logic_error), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE( merge_tiled_events_reconciles_halos )
+{
+    boost::shared_ptr<FeatureStore> fs(new FeatureStore);
+    TraxelStore ts;
+    add_traxel(ts, fs, 0, 1, 40., 10.);
+    add_traxel(ts, fs, 0, 2, 70., 10.);
+    add_traxel(ts, fs, 0, 5, 30., 10.);
+    add_traxel(ts, fs, 1, 3, 55., 10.);
+    add_traxel(ts, fs, 1, 4, 45., 10.);
+    add_traxel(ts, fs, 1, 6, 52., 10.);
+    SpatialTiling tiling(FieldOfView(0, 0, 0, 0, 1, 100, 50, 0), 2, 1, 1, 20.);
+
+    vector<EventVectorVector> tile_events(2, EventVectorVector(2));
+    // both tiles claim traxel 3, which is owned by tile 1
+    tile_events[0][1].push_back(make_event(Event::Division, 1, 3, 4));
+    tile_events[1][1].push_back(make_event(Event::Move, 2, 3));
+    // traxel 6 is linked in its own tile only, by a parent that tile 0 lets disappear
+    tile_events[0][1].push_back(make_event(Event::Disappearance, 5));
+    tile_events[1][1].push_back(make_event(Event::Move, 5, 6));
+    // not owned by tile 1
+    tile_events[1][1].push_back(make_event(Event::Appearance, 4));
+
+    EventVectorVector merged = merge_tiled_events(ts, tiling, tile_events);
+    sort_events(merged);
+    EventVectorVector expected(2);
+    expected[1].push_back(make_event(Event::Move, 1, 4));
+    expected[1].push_back(make_event(Event::Move, 2, 3));
+    expected[1].push_back(make_event(Event::Disappearance, 5));
+    expected[1].push_back(make_event(Event::Appearance, 6));
+    sort_events(expected);
+    BOOST_REQUIRE_EQUAL(merged.size(), 2);
+    BOOST_CHECK(merged[0].empty());
+    BOOST_CHECK(merged[1] == expected[1]);
+
+    tile_events[1][1].push_back(make_event(Event::Appearance, 7));
+    BOOST_CHECK_THROW(merge_tiled_events(ts, tiling, tile_events), std::runtime_error);
+    BOOST_CHECK_THROW(merge_tiled_events(ts, tiling, vector<EventVectorVector>(1)), std::runtime_error);
+}
@@ -0,0 +1,152 @@
+#define BOOST_TEST_MODULE tracking_test
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pgmlink/event.h"
+#include "pgmlink/traxels.h"
+#include "pgmlink/tracking.h"
+
+using namespace pgmlink;
+using namespace std;
+
+namespace
+{
+void add_traxel(TraxelStore& ts, boost::shared_ptr<FeatureStore> fs,
+                int timestep, unsigned int id, double x, double y,
+                double div_prob = -1.)
+{
+    Traxel t;
+    t.Id = id;
+    t.Timestep = timestep;
+    feature_array com(3, 0.);
+    com[0] = x;
+    com[1] = y;
+    t.features["com"] = com;
+    if (div_prob >= 0.)
+    {
+        t.features["divProb"] = feature_array(1, div_prob);
+    }
+    add(ts, fs, t);
+}
+
+// type followed by the traxel ids, with the children of a division sorted
+vector<size_t> event_key(const Event& e)
+{
+    vector<size_t> key(1, static_cast<size_t>(e.type));
+    key.insert(key.end(), e.traxel_ids.begin(), e.traxel_ids.end());
+    if (e.type == Event::Division)
+    {
+        std::sort(key.begin() + 2, key.end());
+    }
+    return key;
+}
+
+vector<size_t> event_key(Event::EventType type, size_t id1, size_t id2 = 0, size_t id3 = 0)
+{
+    Event e;
+    e.type = type;
+    e.traxel_ids.push_back(id1);
+    if (type == Event::Move || type == Event::Division)
+    {
+        e.traxel_ids.push_back(id2);
+    }
+    if (type == Event::Division)
+    {
+        e.traxel_ids.push_back(id3);
+    }
+    return event_key(e);
+}
+
+vector<vector<size_t> > sorted_keys(const vector<Event>& events)
+{
+    vector<vector<size_t> > keys;
+    for (vector<Event>::const_iterator e = events.begin(); e != events.end(); ++e)
+    {
+        keys.push_back(event_key(*e));
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+void check_events(const vector<Event>& events, vector<vector<size_t> > expected)
+{
+    std::sort(expected.begin(), expected.end());
+    const vector<vector<size_t> > actual = sorted_keys(events);
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL_COLLECTIONS(actual[i].begin(), actual[i].end(),
+                                      expected[i].begin(), expected[i].end());
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE( NNTracking_events )
+{
+    //  t=0          1              2
+    //  1 (0,0)    - 1 (3,0)      - 1 (6,0)
+    //  2 (100,0)  - 2 (102,0)    - 2 (104,0)
+    //             \ 3 (100,15)   - 3 (100,18)
+    //  3 (200,0)    4 (200,20)
+    //
+    // 2 divides: its second child is 15 away, beyond the move distance but
+    // within the division distance. 3 -> 4 is a hypothesis (20 < 30) but
+    // beyond the move distance, so 3 disappears and 4 appears.
+    TraxelStore ts;
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    add_traxel(ts, fs, 0, 1, 0., 0.);
+    add_traxel(ts, fs, 0, 2, 100., 0., 0.9);
+    add_traxel(ts, fs, 0, 3, 200., 0.);
+    add_traxel(ts, fs, 1, 1, 3., 0.);
+    add_traxel(ts, fs, 1, 2, 102., 0.);
+    add_traxel(ts, fs, 1, 3, 100., 15.);
+    add_traxel(ts, fs, 1, 4, 200., 20.);
+    add_traxel(ts, fs, 2, 1, 6., 0.);
+    add_traxel(ts, fs, 2, 2, 104., 0.);
+    add_traxel(ts, fs, 2, 3, 100., 18.);
+
+    NNTracking tracking(30, 10);
+    vector<vector<Event> > events = tracking(ts);
+    BOOST_REQUIRE_EQUAL(events.size(), 3);
+
+    BOOST_CHECK(events[0].empty());
+
+    vector<vector<size_t> > expected;
+    expected.push_back(event_key(Event::Move, 1, 1));
+    expected.push_back(event_key(Event::Division, 2, 2, 3));
+    expected.push_back(event_key(Event::Disappearance, 3));
+    expected.push_back(event_key(Event::Appearance, 4));
+    check_events(events[1], expected);
+
+    expected.clear();
+    expected.push_back(event_key(Event::Move, 1, 1));
+    expected.push_back(event_key(Event::Move, 2, 2));
+    expected.push_back(event_key(Event::Move, 3, 3));
+    expected.push_back(event_key(Event::Disappearance, 4));
+    check_events(events[2], expected);
+
+    // every detection is kept
+    vector<map<unsigned int, bool> > detections = tracking.detections();
+    BOOST_REQUIRE_EQUAL(detections.size(), 3);
+    BOOST_CHECK_EQUAL(detections[1].size(), 4);
+    BOOST_CHECK(detections[1][4]);
+
+    // without divProb above the threshold, the far child is left unassigned
+    NNTracking no_divisions(30, 10, vector<string>(0), 0.95);
+    events = no_divisions(ts);
+    BOOST_REQUIRE_EQUAL(events.size(), 3);
+    expected.clear();
+    expected.push_back(event_key(Event::Move, 1, 1));
+    expected.push_back(event_key(Event::Move, 2, 2));
+    expected.push_back(event_key(Event::Appearance, 3));
+    expected.push_back(event_key(Event::Disappearance, 3));
+    expected.push_back(event_key(Event::Appearance, 4));
+    check_events(events[1], expected);
+}
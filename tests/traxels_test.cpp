@@ -6,6 +6,7 @@
 
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/test/unit_test.hpp>
 #include <boost/test/floating_point_comparison.hpp>
 #include <boost/tuple/tuple.hpp>
@@ -94,6 +95,30 @@ BOOST_AUTO_TEST_CASE( Traxel_XYZ )
     BOOST_CHECK_EQUAL(t.Z(), com[2]);
 }
 
+BOOST_AUTO_TEST_CASE( Traxel_const_feature_access_does_not_insert )
+{
+    boost::shared_ptr<FeatureStore> fs = boost::make_shared<FeatureStore>();
+    Traxel stored(1, 0);
+    stored.set_feature_store(fs);
+    stored.features["com"] = feature_array(3, 1.);
+
+    // a copy shares the store, but nothing is stored under its new id
+    Traxel missing(stored);
+    missing.Id = 2;
+    const Traxel& const_missing = missing;
+    BOOST_CHECK_EQUAL(const_missing.features.size(), 0);
+    BOOST_CHECK(const_missing.features.get().empty());
+    BOOST_CHECK(const_missing.features.find("com") == const_missing.features.end());
+    BOOST_CHECK(const_missing.features["com"].empty());
+    BOOST_CHECK(fs->find_traxel_features(missing) == NULL);
+
+    const Traxel& const_stored = stored;
+    BOOST_CHECK_EQUAL(const_stored.features.size(), 1);
+    BOOST_CHECK_EQUAL(const_stored.features["com"].size(), 3);
+    BOOST_CHECK(const_stored.features["volume"].empty());
+    BOOST_CHECK_EQUAL(fs->find_traxel_features(stored)->size(), 1);
+}
+
 BOOST_AUTO_TEST_CASE( Traxel_resolution_scaling )
 {
     ComLocator* locator = new ComLocator();
@@ -111,6 +136,40 @@ BOOST_AUTO_TEST_CASE( Traxel_resolution_scaling )
     BOOST_CHECK_EQUAL(t.Z(), 12.3 * com[2]);
 }
 
+BOOST_AUTO_TEST_CASE( Traxel_compact_locator )
+{
+    Traxel t;
+    t.set_locator(CompactLocator(CompactLocator::Intmaxpos, 2.));
+    feature_array intmaxpos(4);
+    intmaxpos[0] = 100;
+    intmaxpos[1] = 3;
+    intmaxpos[2] = 4;
+    intmaxpos[3] = 5;
+    t.features["intmaxpos"] = intmaxpos;
+    BOOST_CHECK_EQUAL(t.X(), 6.);
+    BOOST_CHECK_EQUAL(t.Y(), 4.);
+
+    // copies carry kind and scales
+    t.set_z_scale(10.);
+    Traxel copy(t);
+    BOOST_CHECK_EQUAL(copy.X(), 6.);
+    BOOST_CHECK_EQUAL(copy.Z(), 50.);
+
+    // without a bounding box the position is used
+    BOOST_CHECK_EQUAL(copy.X_min(), copy.X());
+    BOOST_CHECK_EQUAL(copy.Y_max(), copy.Y());
+    BOOST_CHECK_EQUAL(copy.X_corr(), copy.X());
+
+    // changes through the locator object take effect
+    BOOST_CHECK( typeid(*copy.locator()) == typeid(IntmaxposLocator) );
+    copy.locator()->y_scale = 3.;
+    BOOST_CHECK_EQUAL(copy.Y(), 12.);
+    BOOST_CHECK_EQUAL(t.Y(), 4.);
+    Traxel assigned;
+    assigned = copy;
+    BOOST_CHECK_EQUAL(assigned.Y(), 12.);
+}
+
 BOOST_AUTO_TEST_CASE( Traxel_distance_to )
 {
     // prepare mock objects
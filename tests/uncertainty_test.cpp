@@ -473,6 +473,41 @@ BOOST_AUTO_TEST_CASE( diverseUncertainty )
     BOOST_CHECK_EQUAL(events[2][1][1].type, Event::Disappearance);
     BOOST_CHECK_EQUAL(events[2][2][0].type, Event::Move);
 
+    // keeping the MAP model for all iterations gives the same solutions
+    ConsTracking builder = ConsTracking(1, false, double(1.1), 20, true, 0.3, "none", fov);
+    boost::shared_ptr<HypothesesGraph> graph = builder.build_hypo_graph(ts);
+    Parameter persistentParams = builder.get_conservation_tracking_parameters(
+                                     0, // forbidden_cost
+                                     0.0, // ep_gap
+                                     false, // with_tracklets
+                                     10.0, // detection_weight
+                                     10.0, //division_weight
+                                     10.0, //transition_weight
+                                     10., // disappearance_cost,
+                                     10., // appearance_cost
+                                     false, //with_merger_resolution
+                                     3, //n_dim
+                                     5, //transition_parameter
+                                     0, //border_width for app/disapp costs
+                                     true, //with_constraints
+                                     uparam);
+    persistentParams.persistent_solver = true;
+    ConsTracking persistent = ConsTracking(graph, ts, persistentParams, uparam, fov);
+    EventVectorVectorVector persistent_events = persistent.track_from_param(persistentParams);
+
+    BOOST_REQUIRE_EQUAL(persistent_events.size(), 3);
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        BOOST_REQUIRE_EQUAL(persistent_events[i].size(), events[i].size());
+        for (size_t t = 0; t < events[i].size(); ++t)
+        {
+            BOOST_REQUIRE_EQUAL(persistent_events[i][t].size(), events[i][t].size());
+            for (size_t k = 0; k < events[i][t].size(); ++k)
+            {
+                BOOST_CHECK_EQUAL(persistent_events[i][t][k].type, events[i][t][k].type);
+            }
+        }
+    }
 }
 
 #ifdef WITH_MODIFIED_OPENGM
@@ -1,6 +1,11 @@
 #define BOOST_TEST_MODULE util_test
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 #include <utility>
 
@@ -8,6 +13,9 @@
 #include <boost/test/floating_point_comparison.hpp>
 
 #include "pgmlink/util.h"
+#include "pgmlink/instrumentation.h"
+#include "pgmlink/async_log.h"
+#include "pgmlink/log.h"
 
 using namespace pgmlink;
 using namespace std;
@@ -64,3 +72,131 @@ BOOST_AUTO_TEST_CASE( reorder_test )
     BOOST_CHECK_EQUAL(v[3], 7);
     BOOST_CHECK_EQUAL(v[4], 9);
 }
+
+BOOST_AUTO_TEST_CASE( parallel_exceptions_test )
+{
+    const int n = 100;
+    ParallelExceptions exceptions(n);
+    #pragma omp parallel for
+    for (int i = 0; i < n; ++i)
+    {
+        try
+        {
+            if (i == 40)
+            {
+                throw "iteration 40";
+            }
+            if (i == 70)
+            {
+                throw std::out_of_range("iteration 70");
+            }
+        }
+        catch (...)
+        {
+            exceptions.capture(i);
+        }
+    }
+    // the first failed iteration wins, with its original type
+    BOOST_CHECK_THROW(exceptions.rethrow(), const char*);
+
+    ParallelExceptions none(n);
+    BOOST_CHECK_NO_THROW(none.rethrow());
+}
+
+BOOST_AUTO_TEST_CASE( instrumentation_test )
+{
+    Instrumentation& instrumentation = Instrumentation::instance();
+    instrumentation.reset();
+
+    // disabled: nothing is recorded
+    instrumentation.enable(false);
+    {
+        StageTimer timer("disabled");
+        instrument_count("disabled", "items", 3);
+    }
+    BOOST_CHECK_EQUAL(instrumentation.stages().size(), 0);
+
+    instrumentation.enable(true);
+    for(size_t i = 0; i < 2; ++i)
+    {
+        StageTimer timer("second");
+        instrument_count("first", "items", 4);
+    }
+    instrumentation.add_counter("second", "items", 2);
+    instrumentation.add_counter("second", "items", 3);
+    instrumentation.enable(false);
+
+    vector<StageStatistics> stages = instrumentation.stages();
+    BOOST_REQUIRE_EQUAL(stages.size(), 2);
+    // stages keep the order of their first appearance
+    BOOST_CHECK_EQUAL(stages[0].name, "first");
+    BOOST_CHECK_EQUAL(stages[0].calls, 0);
+    BOOST_CHECK_EQUAL(stages[0].counters["items"], 4);
+    BOOST_CHECK_EQUAL(stages[1].name, "second");
+    BOOST_CHECK_EQUAL(stages[1].calls, 2);
+    BOOST_CHECK_EQUAL(stages[1].counters["items"], 5);
+    BOOST_CHECK(stages[1].wall_seconds >= 0.);
+
+    string json = instrumentation.to_json();
+    BOOST_CHECK(json.find("\"name\": \"second\", \"calls\": 2") != string::npos);
+
+    instrumentation.reset();
+    BOOST_CHECK_EQUAL(instrumentation.stages().size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( async_log_test )
+{
+    const LogLevel old_level = FILELog::getReportingLevel();
+    FILELog::getReportingLevel() = logINFO;
+    const size_t n_threads = 4;
+    const size_t n_messages = 1000;
+
+    AsyncLogOptions options;
+    options.buffer_capacity = 64; // small, so that the threads have to wait for the writer
+    options.filename = "async_log_test.txt";
+    AsyncLog::start(options);
+    BOOST_CHECK(AsyncLog::running());
+    BOOST_CHECK_THROW(AsyncLog::start(options), std::runtime_error);
+    vector<std::thread> threads;
+    for(size_t t = 0; t < n_threads; ++t)
+    {
+        threads.push_back(std::thread([=]()
+        {
+            for(size_t i = 0; i < n_messages; ++i)
+            {
+                LOG(logINFO) << "thread " << t << " message " << i;
+            }
+        }));
+    }
+    for(size_t t = 0; t < n_threads; ++t)
+    {
+        threads[t].join();
+    }
+    AsyncLog::flush();
+    AsyncLog::stop();
+    BOOST_CHECK(!AsyncLog::running());
+
+    ifstream in(options.filename.c_str());
+    string line;
+    size_t n_lines = 0;
+    while(getline(in, line))
+    {
+        BOOST_CHECK_EQUAL(line.substr(0, 2), "- ");
+        BOOST_CHECK(line.find(" INFO: thread ") != string::npos);
+        ++n_lines;
+    }
+    BOOST_CHECK_EQUAL(n_lines, n_threads * n_messages);
+
+    // binary records convert to the same text format
+    options.filename = "async_log_test.bin";
+    options.binary = true;
+    AsyncLog::start(options);
+    LOG(logINFO) << "binary message";
+    AsyncLog::stop();
+    ostringstream converted;
+    AsyncLog::convert_binary(options.filename, converted);
+    BOOST_CHECK_EQUAL(converted.str().substr(0, 2), "- ");
+    BOOST_CHECK(converted.str().find(" INFO: binary message\n") != string::npos);
+
+    FILELog::getReportingLevel() = old_level;
+}